@@ -13,7 +13,6 @@
 ################################################################################
 
 include(common.pri)
-include(vendor/quazip/quazip.pri)
 
 TARGET = "Deep Storage Browser"
 
@@ -52,7 +51,5 @@ win32 {
 	# macro compile error on Windows.
 	# See http://qt-project.org/forums/viewthread/22133
 	DEFINES += NOMINMAX
-	DEFINES += QUAZIP_STATIC
-	DEFINES += QUAZIP_BUILD
 	RC_FILE = deep_storage_browser.rc
 }
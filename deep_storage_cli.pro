@@ -0,0 +1,52 @@
+################################################################################
+#  Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+#  Licensed under the Apache License, Version 2.0 (the "License"). You may not
+#  use this file except in compliance with the License. A copy of the License
+#  is located at
+#
+#  http://www.apache.org/licenses/LICENSE-2.0
+#
+#  or in the "license" file accompanying this file.
+#  This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+#  CONDITIONS OF ANY KIND, either express or implied. See the License for the
+#  specific language governing permissions and limitations under the License.
+################################################################################
+
+# Headless command-line transfer application.  It's built only from the
+# transfer engine and doesn't need QtGui/QtWidgets or a display.
+
+include(engine.pri)
+
+TARGET = deep_storage_cli
+
+QT -= gui
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG -= release
+CONFIG += debug_and_release warn_on
+
+DEFINES += HEADLESS
+
+Debug:DESTDIR = debug
+Debug:OBJECTS_DIR = debug/.cli_obj
+Debug:MOC_DIR = debug/.cli_moc
+
+Release:DESTDIR = release
+Release:OBJECTS_DIR = release/.cli_obj
+Release:MOC_DIR = release/.cli_moc
+Release:DEFINES += NO_DEBUG
+
+HEADERS += \
+	src/cli/cli_logger.h \
+	src/cli/shard_worker.h \
+	src/cli/transfer_runner.h
+
+SOURCES += \
+	src/cli/cli_logger.cc \
+	src/cli/main.cc \
+	src/cli/shard_worker.cc \
+	src/cli/transfer_runner.cc
+
+win32 {
+	DEFINES += NOMINMAX
+}
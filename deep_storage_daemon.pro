@@ -0,0 +1,51 @@
+################################################################################
+#  Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+#  Licensed under the Apache License, Version 2.0 (the "License"). You may not
+#  use this file except in compliance with the License. A copy of the License
+#  is located at
+#
+#  http://www.apache.org/licenses/LICENSE-2.0
+#
+#  or in the "license" file accompanying this file.
+#  This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+#  CONDITIONS OF ANY KIND, either express or implied. See the License for the
+#  specific language governing permissions and limitations under the License.
+################################################################################
+
+# Background transfer daemon that GUIs can hand their BulkGet/BulkPut jobs
+# off to so they survive the GUI exiting.  Like the headless command-line
+# application, it's built only from the transfer engine.
+
+include(engine.pri)
+
+TARGET = deep_storage_daemon
+
+QT -= gui
+CONFIG += console
+CONFIG -= app_bundle
+CONFIG -= release
+CONFIG += debug_and_release warn_on
+
+DEFINES += HEADLESS
+
+Debug:DESTDIR = debug
+Debug:OBJECTS_DIR = debug/.daemon_obj
+Debug:MOC_DIR = debug/.daemon_moc
+
+Release:DESTDIR = release
+Release:OBJECTS_DIR = release/.daemon_obj
+Release:MOC_DIR = release/.daemon_moc
+Release:DEFINES += NO_DEBUG
+
+HEADERS += \
+	src/cli/cli_logger.h \
+	src/daemon/transfer_daemon.h
+
+SOURCES += \
+	src/cli/cli_logger.cc \
+	src/daemon/main.cc \
+	src/daemon/transfer_daemon.cc
+
+win32 {
+	DEFINES += NOMINMAX
+}
@@ -0,0 +1,123 @@
+################################################################################
+#  Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+#  Licensed under the Apache License, Version 2.0 (the "License"). You may not
+#  use this file except in compliance with the License. A copy of the License
+#  is located at
+#
+#  http://www.apache.org/licenses/LICENSE-2.0
+#
+#  or in the "license" file accompanying this file.
+#  This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+#  CONDITIONS OF ANY KIND, either express or implied. See the License for the
+#  specific language governing permissions and limitations under the License.
+################################################################################
+
+# Define the settings and sources for the transfer engine (Client and
+# everything it needs), which has no GUI dependencies.  It's shared by the
+# GUI, headless and test applications' project files.
+
+VERSION = 1.2.1
+
+QT += concurrent core network
+
+DEFINES += APP_VERSION=\\\"$$VERSION\\\"
+
+INCLUDEPATH += $${PWD}/src
+INCLUDEPATH += $${PWD}/vendor
+
+HEADERS = \
+	$${PWD}/src/helpers/number_helper.h \
+	$${PWD}/src/helpers/time_helper.h \
+	$${PWD}/src/lib/work_items/archive_get_work_item.h \
+	$${PWD}/src/lib/work_items/bulk_work_item.h \
+	$${PWD}/src/lib/work_items/bulk_get_work_item.h \
+	$${PWD}/src/lib/work_items/bulk_put_work_item.h \
+	$${PWD}/src/lib/work_items/delete_work_item.h \
+	$${PWD}/src/lib/work_items/manifest_get_work_item.h \
+	$${PWD}/src/lib/work_items/migration_work_item.h \
+	$${PWD}/src/lib/work_items/object_work_item.h \
+	$${PWD}/src/lib/work_items/stream_get_work_item.h \
+	$${PWD}/src/lib/work_items/stream_put_work_item.h \
+	$${PWD}/src/lib/work_items/work_item.h \
+	$${PWD}/src/lib/archive_writer.h \
+	$${PWD}/src/lib/client.h \
+	$${PWD}/src/lib/concurrency_controller.h \
+	$${PWD}/src/lib/folder_watcher.h \
+	$${PWD}/src/lib/list_page_sizer.h \
+	$${PWD}/src/lib/listing_cache.h \
+	$${PWD}/src/lib/logger.h \
+	$${PWD}/src/lib/manifest_reader.h \
+	$${PWD}/src/lib/ring_buffer.h \
+	$${PWD}/src/lib/shard_directory.h \
+	$${PWD}/src/lib/stream_manifest.h \
+	$${PWD}/src/lib/transfer_filter.h \
+	$${PWD}/src/lib/transfer_scheduler.h \
+	$${PWD}/src/lib/errors/ds3_error.h \
+	$${PWD}/src/lib/ipc/transfer_channel.h \
+	$${PWD}/src/lib/requests/listing_parser.h \
+	$${PWD}/src/lib/requests/request_engine.h \
+	$${PWD}/src/models/ds3_url.h \
+	$${PWD}/src/models/job.h \
+	$${PWD}/src/models/listing.h \
+	$${PWD}/src/models/session.h
+
+SOURCES = \
+	$${PWD}/src/helpers/number_helper.cc \
+	$${PWD}/src/helpers/time_helper.cc \
+	$${PWD}/src/lib/archive_writer.cc \
+	$${PWD}/src/lib/client.cc \
+	$${PWD}/src/lib/concurrency_controller.cc \
+	$${PWD}/src/lib/folder_watcher.cc \
+	$${PWD}/src/lib/list_page_sizer.cc \
+	$${PWD}/src/lib/listing_cache.cc \
+	$${PWD}/src/lib/manifest_reader.cc \
+	$${PWD}/src/lib/ring_buffer.cc \
+	$${PWD}/src/lib/shard_directory.cc \
+	$${PWD}/src/lib/stream_manifest.cc \
+	$${PWD}/src/lib/transfer_filter.cc \
+	$${PWD}/src/lib/transfer_scheduler.cc \
+	$${PWD}/src/lib/errors/ds3_error.cc \
+	$${PWD}/src/lib/ipc/transfer_channel.cc \
+	$${PWD}/src/lib/requests/listing_parser.cc \
+	$${PWD}/src/lib/requests/request_engine.cc \
+	$${PWD}/src/lib/work_items/archive_get_work_item.cc \
+	$${PWD}/src/lib/work_items/bulk_work_item.cc \
+	$${PWD}/src/lib/work_items/bulk_get_work_item.cc \
+	$${PWD}/src/lib/work_items/bulk_put_work_item.cc \
+	$${PWD}/src/lib/work_items/delete_work_item.cc \
+	$${PWD}/src/lib/work_items/manifest_get_work_item.cc \
+	$${PWD}/src/lib/work_items/migration_work_item.cc \
+	$${PWD}/src/lib/work_items/object_work_item.cc \
+	$${PWD}/src/lib/work_items/stream_get_work_item.cc \
+	$${PWD}/src/lib/work_items/stream_put_work_item.cc \
+	$${PWD}/src/lib/work_items/work_item.cc \
+	$${PWD}/src/models/ds3_url.cc \
+	$${PWD}/src/models/job.cc \
+	$${PWD}/src/models/session.cc
+
+msvc {
+	LIBS += ds3.lib
+	LIBS += libcurl.lib
+	LIBS += zlib_a.lib
+	QMAKE_CXXFLAGS += /WX /D_CRT_SECURE_NO_WARNINGS
+} else {
+	# Necessary on OSX at least
+	exists(/usr/local/include) {
+		INCLUDEPATH += /usr/local/include
+	}
+	# Necessary on OSX at least
+	exists(/usr/local/lib) {
+		LIBS += -L/usr/local/lib
+	}
+
+	LIBS += -lds3 -lcurl -lz
+}
+
+# Archive GETs write zip files with the bundled QuaZip
+include($${PWD}/vendor/quazip/quazip.pri)
+win32 {
+	DEFINES += QUAZIP_STATIC
+	DEFINES += QUAZIP_BUILD
+}
+
+gcc: QMAKE_CXXFLAGS += -Werror
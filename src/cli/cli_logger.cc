@@ -0,0 +1,56 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <stdio.h>
+#include <QDateTime>
+
+#include "cli/cli_logger.h"
+
+static const QString LOG_TIMESTAMP_FORMAT = "MMMM d h:mm:ss";
+CliLogger* CliLogger::s_instance = 0;
+
+CliLogger*
+CliLogger::Instance()
+{
+	if (!s_instance) {
+		s_instance = new CliLogger();
+	}
+	return s_instance;
+}
+
+CliLogger::CliLogger()
+	: m_logLevel(WARNING)
+{
+}
+
+void
+CliLogger::Log(Level level, const QString& msg)
+{
+	// FILE messages are a record of every object transferred.  They
+	// only go to the GUI's log file so only show them when debugging.
+	if (level == FILE) {
+		level = DEBUG;
+	}
+	if (level < m_logLevel) {
+		return;
+	}
+
+	QString currentTimeStamp = QDateTime::currentDateTime().toString(LOG_TIMESTAMP_FORMAT);
+	QByteArray line = (currentTimeStamp + ": " + msg + "\n").toLocal8Bit();
+	m_lock.lock();
+	fputs(line.constData(), stderr);
+	m_lock.unlock();
+}
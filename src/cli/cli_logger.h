@@ -0,0 +1,50 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef CLI_LOGGER_H
+#define CLI_LOGGER_H
+
+#include <QMutex>
+#include <QString>
+
+// CliLogger, the headless replacement for Console.  Messages are written to
+// stderr so stdout is left for machine-readable progress.
+class CliLogger
+{
+public:
+	enum Level { DEBUG, INFO, WARNING, ERR, FILE };
+
+	static CliLogger* Instance();
+
+	void Log(Level level, const QString& msg);
+	void SetLogLevel(Level level);
+
+private:
+	CliLogger();
+
+	static CliLogger* s_instance;
+
+	QMutex m_lock;
+	Level m_logLevel;
+};
+
+inline void
+CliLogger::SetLogLevel(Level level)
+{
+	m_logLevel = level;
+}
+
+#endif
@@ -0,0 +1,422 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <stdio.h>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+#include <QTextStream>
+#include <ds3.h>
+
+#include "cli/cli_logger.h"
+#include "cli/shard_worker.h"
+#include "cli/transfer_runner.h"
+#include "global.h"
+#include "lib/client.h"
+#include "lib/logger.h"
+#include "lib/shard_directory.h"
+#include "lib/transfer_filter.h"
+#include "models/job.h"
+#include "models/session.h"
+
+// Start with the session the GUI last connected with (if any) so the
+// headless application can be used with little more than a source and
+// destination.
+static void
+ReadSavedSession(Session* session)
+{
+	QSettings settings;
+	int size = settings.beginReadArray("sessions");
+	if (size > 0) {
+		settings.setArrayIndex(0);
+		session->SetHost(settings.value("host").toString());
+		session->SetProtocol(settings.value("protocol").toInt());
+		session->SetPort(settings.value("port").toString());
+		session->SetDataHosts(settings.value("dataHosts").toStringList());
+		session->SetProxy(settings.value("proxy").toString());
+		session->SetWithCertificateVerification(settings.value("withCertificateVerification").toBool());
+		session->SetAccessId(settings.value("accessID").toString());
+		session->SetSecretKey(settings.value("secretKey").toString());
+	}
+	settings.endArray();
+}
+
+// One source per line.  Blank lines and lines starting with # are ignored.
+static bool
+ReadManifest(const QString& fileName, QStringList* sources)
+{
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		return false;
+	}
+	QTextStream in(&file);
+	while (!in.atEnd()) {
+		QString line = in.readLine().trimmed();
+		if (!line.isEmpty() && !line.startsWith("#")) {
+			*sources << line;
+		}
+	}
+	return true;
+}
+
+static int
+Usage(const QCommandLineParser& parser, const QString& error)
+{
+	QTextStream err(stderr);
+	err << error << endl << endl << parser.helpText();
+	return TransferRunner::EXIT_USAGE;
+}
+
+int
+main(int argc, char *argv[])
+{
+	QCoreApplication app(argc, argv);
+	// Same as the GUI so the saved session and transfer settings are shared
+	app.setOrganizationName("Spectra Logic");
+	app.setOrganizationDomain("spectralogic.com");
+	app.setApplicationName(APP_NAME);
+	app.setApplicationVersion(APP_VERSION);
+
+	// Job is used as an argument in a signal/slot connection
+	qRegisterMetaType<Job>();
+
+	CliLogger::Instance();
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription("Transfer objects to and from a DS3 " \
+					 "system without the GUI.\n\n" \
+					 "  get <bucket[/path]>... <directory>\n" \
+					 "  get --archive <zip|tar file> <bucket[/path]>...\n" \
+					 "  get --stream <bucket/object> <file|->\n" \
+					 "  put <bucket[/prefix]> <file|directory>...\n" \
+					 "  put --stream <bucket/object> < data\n" \
+					 "  restore <manifest> <directory>\n" \
+					 "  shard <manifest> <shared directory>\n" \
+					 "  work <shared directory> <directory>");
+	parser.addHelpOption();
+	parser.addVersionOption();
+	parser.addPositionalArgument("command", "get, put, restore, shard or work");
+	parser.addPositionalArgument("arguments", "Sources and destination");
+
+	QCommandLineOption hostOption("host", "DS3 system DNS name or IP address.", "host");
+	QCommandLineOption portOption("port", "DS3 system port.", "port");
+	QCommandLineOption httpsOption("https", "Use HTTPS.");
+	QCommandLineOption verifyOption("verify-certificate", "Verify the DS3 system's SSL certificate.");
+	QCommandLineOption dataHostsOption("data-hosts", "Comma separated additional data interfaces.", "hosts");
+	QCommandLineOption proxyOption("proxy", "Proxy server.", "proxy");
+	QCommandLineOption accessIdOption("access-id", "S3 access ID (or DS3_ACCESS_KEY).", "id");
+	QCommandLineOption secretKeyOption("secret-key", "S3 secret key (or DS3_SECRET_KEY).", "key");
+	QCommandLineOption manifestOption("manifest", "Read additional sources, one per line, from file.", "file");
+	QCommandLineOption archiveOption("archive", "get the objects in to a single .zip or .tar file instead of a directory.", "file");
+	QCommandLineOption streamOption("stream", "put stdin as a streamed object cut in to parts, or get one streamed object in to a file (- for stdout).");
+	QCommandLineOption partSizeOption("part-size", "MiB per part of a streamed put (default 64).", "MiB", "64");
+	QCommandLineOption includeOption("include", "Only transfer files in folders that match glob (repeatable).", "glob");
+	QCommandLineOption excludeOption("exclude", "Skip files and folders in folders that match glob (repeatable).", "glob");
+	QCommandLineOption includeRegexOption("include-regex", "Like --include with a regular expression.", "regex");
+	QCommandLineOption excludeRegexOption("exclude-regex", "Like --exclude with a regular expression.", "regex");
+	QCommandLineOption minSizeOption("min-size", "Skip files in folders smaller than bytes.", "bytes");
+	QCommandLineOption maxSizeOption("max-size", "Skip files in folders larger than bytes.", "bytes");
+	QCommandLineOption newerThanOption("newer-than", "Skip files in folders last modified before an ISO 8601 time.", "time");
+	QCommandLineOption olderThanOption("older-than", "Skip files in folders last modified at or after an ISO 8601 time.", "time");
+	QCommandLineOption reportOption("report", "Where restore writes each manifest line's outcome (default <manifest>.report.csv).", "file");
+	QCommandLineOption shardSizeOption("shard-size", "Objects per shard (default 100000).", "objects", "100000");
+	QCommandLineOption leaseTimeOption("lease-time", "Seconds before an unrenewed shard lease can be reclaimed (default 300).", "seconds", "300");
+	QCommandLineOption intervalOption("progress-interval", "Milliseconds between progress lines (default 1000).", "ms", "1000");
+	QCommandLineOption verboseOption(QStringList() << "v" << "verbose", "Log informational (-v) messages to stderr.");
+	QCommandLineOption debugOption("debug", "Log debug messages to stderr.");
+	parser.addOption(hostOption);
+	parser.addOption(portOption);
+	parser.addOption(httpsOption);
+	parser.addOption(verifyOption);
+	parser.addOption(dataHostsOption);
+	parser.addOption(proxyOption);
+	parser.addOption(accessIdOption);
+	parser.addOption(secretKeyOption);
+	parser.addOption(manifestOption);
+	parser.addOption(archiveOption);
+	parser.addOption(streamOption);
+	parser.addOption(partSizeOption);
+	parser.addOption(includeOption);
+	parser.addOption(excludeOption);
+	parser.addOption(includeRegexOption);
+	parser.addOption(excludeRegexOption);
+	parser.addOption(minSizeOption);
+	parser.addOption(maxSizeOption);
+	parser.addOption(newerThanOption);
+	parser.addOption(olderThanOption);
+	parser.addOption(reportOption);
+	parser.addOption(shardSizeOption);
+	parser.addOption(leaseTimeOption);
+	parser.addOption(intervalOption);
+	parser.addOption(verboseOption);
+	parser.addOption(debugOption);
+	parser.process(app);
+
+	if (parser.isSet(debugOption)) {
+		CliLogger::Instance()->SetLogLevel(CliLogger::DEBUG);
+	} else if (parser.isSet(verboseOption)) {
+		CliLogger::Instance()->SetLogLevel(CliLogger::INFO);
+	}
+
+	// Splitting a manifest into shards for "work" doesn't need a DS3 system
+	QStringList args = parser.positionalArguments();
+	if (!args.isEmpty() && args[0] == "shard") {
+		bool ok = false;
+		int shardSize = parser.value(shardSizeOption).toInt(&ok);
+		if (args.size() != 3) {
+			return Usage(parser, "shard takes a manifest and a shared directory");
+		}
+		if (!ok || shardSize <= 0) {
+			return Usage(parser, "Invalid shard size");
+		}
+		QString error;
+		int numShards = ShardDirectory::CreateShards(args[1], args[2],
+							     shardSize, &error);
+		if (numShards < 0) {
+			LOG_ERROR("ERROR:       " + error);
+			return TransferRunner::EXIT_FAILED;
+		}
+		QTextStream(stdout) << "{\"event\":\"summary\",\"shards\":"
+				    << numShards << "}" << endl;
+		return TransferRunner::EXIT_OK;
+	}
+
+	Session session;
+	ReadSavedSession(&session);
+	if (parser.isSet(hostOption)) {
+		session.SetHost(parser.value(hostOption));
+	}
+	if (parser.isSet(portOption)) {
+		session.SetPort(parser.value(portOption));
+	}
+	if (parser.isSet(httpsOption)) {
+		session.SetProtocol(Session::HTTPS);
+	}
+	if (parser.isSet(verifyOption)) {
+		session.SetWithCertificateVerification(true);
+	}
+	if (parser.isSet(dataHostsOption)) {
+		session.SetDataHosts(parser.value(dataHostsOption).split(",", QString::SkipEmptyParts));
+	}
+	if (parser.isSet(proxyOption)) {
+		session.SetProxy(parser.value(proxyOption));
+	}
+	QString accessId = qgetenv("DS3_ACCESS_KEY");
+	QString secretKey = qgetenv("DS3_SECRET_KEY");
+	if (parser.isSet(accessIdOption)) {
+		session.SetAccessId(parser.value(accessIdOption));
+	} else if (!accessId.isEmpty()) {
+		session.SetAccessId(accessId);
+	}
+	if (parser.isSet(secretKeyOption)) {
+		session.SetSecretKey(parser.value(secretKeyOption));
+	} else if (!secretKey.isEmpty()) {
+		session.SetSecretKey(secretKey);
+	}
+	if (session.GetHost().isEmpty() || session.GetAccessId().isEmpty() ||
+	    session.GetSecretKey().isEmpty()) {
+		return Usage(parser, "A host, access ID and secret key are required");
+	}
+
+	if (args.isEmpty()) {
+		return Usage(parser, "No command given");
+	}
+	QString command = args.takeFirst();
+	if (command != "get" && command != "put" && command != "restore" &&
+	    command != "work") {
+		return Usage(parser, "Unknown command " + command);
+	}
+	if (args.isEmpty()) {
+		return Usage(parser, "No destination given");
+	}
+
+	bool ok = false;
+	int progressInterval = parser.value(intervalOption).toInt(&ok);
+	if (!ok || progressInterval <= 0) {
+		return Usage(parser, "Invalid progress interval");
+	}
+
+	// Only get and put enumerate folders
+	TransferFilter filter;
+	QStringList patterns = parser.values(includeOption);
+	for (int i = 0; i < patterns.size(); i++) {
+		filter.AddInclude(patterns[i]);
+	}
+	patterns = parser.values(excludeOption);
+	for (int i = 0; i < patterns.size(); i++) {
+		filter.AddExclude(patterns[i]);
+	}
+	QString error;
+	patterns = parser.values(includeRegexOption);
+	for (int i = 0; i < patterns.size(); i++) {
+		if (!filter.AddIncludeRegex(patterns[i], &error)) {
+			return Usage(parser, error);
+		}
+	}
+	patterns = parser.values(excludeRegexOption);
+	for (int i = 0; i < patterns.size(); i++) {
+		if (!filter.AddExcludeRegex(patterns[i], &error)) {
+			return Usage(parser, error);
+		}
+	}
+	if (parser.isSet(minSizeOption)) {
+		filter.SetMinSize(parser.value(minSizeOption).toULongLong(&ok));
+		if (!ok) {
+			return Usage(parser, "Invalid minimum size");
+		}
+	}
+	if (parser.isSet(maxSizeOption)) {
+		filter.SetMaxSize(parser.value(maxSizeOption).toULongLong(&ok));
+		if (!ok) {
+			return Usage(parser, "Invalid maximum size");
+		}
+	}
+	if (parser.isSet(newerThanOption)) {
+		QDateTime time = QDateTime::fromString(parser.value(newerThanOption),
+						       Qt::ISODate);
+		if (!time.isValid()) {
+			return Usage(parser, "Invalid --newer-than time");
+		}
+		filter.SetModifiedAfter(time);
+	}
+	if (parser.isSet(olderThanOption)) {
+		QDateTime time = QDateTime::fromString(parser.value(olderThanOption),
+						       Qt::ISODate);
+		if (!time.isValid()) {
+			return Usage(parser, "Invalid --older-than time");
+		}
+		filter.SetModifiedBefore(time);
+	}
+
+	QString destination;
+	QStringList sources;
+	QString report;
+	bool toArchive = command == "get" && parser.isSet(archiveOption);
+	bool streaming = (command == "get" || command == "put") &&
+			 parser.isSet(streamOption);
+	uint64_t partSize = 0;
+	int leaseTime = 0;
+	if (command == "work") {
+		if (args.size() != 2) {
+			return Usage(parser, "work takes a shared directory and a directory");
+		}
+		sources << args[0];
+		destination = args[1];
+		leaseTime = parser.value(leaseTimeOption).toInt(&ok);
+		if (!ok || leaseTime <= 0) {
+			return Usage(parser, "Invalid lease time");
+		}
+	} else if (command == "restore") {
+		// A restore manifest can list millions of objects so, unlike
+		// --manifest, it's streamed by the Client rather than read here
+		if (args.size() != 2) {
+			return Usage(parser, "restore takes a manifest and a directory");
+		}
+		sources << args[0];
+		destination = args[1];
+		report = parser.value(reportOption);
+		if (report.isEmpty()) {
+			report = sources[0] + ".report.csv";
+		}
+	} else if (streaming) {
+		// The object is the source of a get and the destination of a
+		// put, whose data comes from stdin
+		QString object = command == "get" ? args.takeFirst() : args[0];
+		if (object.section("/", 1, -1, QString::SectionSkipEmpty).isEmpty()) {
+			return Usage(parser, "--stream needs a bucket/object");
+		}
+		if (command == "get") {
+			if (args.size() != 1) {
+				return Usage(parser, "get --stream takes an object and a file");
+			}
+			sources << object;
+			destination = args[0];
+		} else {
+			if (args.size() != 1) {
+				return Usage(parser, "put --stream takes only an object");
+			}
+			sources << "-";
+			destination = object;
+		}
+		uint64_t partSizeInMiB = parser.value(partSizeOption).toULongLong(&ok);
+		if (!ok || partSizeInMiB == 0 || partSizeInMiB >= 2048) {
+			return Usage(parser, "Invalid part size");
+		}
+		partSize = partSizeInMiB * 1024 * 1024;
+	} else {
+		// get's destination is last, put's is first
+		if (toArchive) {
+			destination = parser.value(archiveOption);
+		} else if (command == "get") {
+			destination = args.takeLast();
+		} else {
+			destination = args.takeFirst();
+		}
+		sources = args;
+		if (parser.isSet(manifestOption) &&
+		    !ReadManifest(parser.value(manifestOption), &sources)) {
+			return Usage(parser, "Unable to read " + parser.value(manifestOption));
+		}
+	}
+	if (sources.isEmpty()) {
+		return Usage(parser, "No sources given");
+	}
+	if (command != "put" && !toArchive && !streaming &&
+	    !QFileInfo(destination).isDir()) {
+		return Usage(parser, destination + " is not a directory");
+	}
+
+	Client* client = new Client(&session);
+	int ret = TransferRunner::EXIT_FAILED;
+	if (command == "work") {
+		ShardWorker worker(client, sources[0], destination,
+				   leaseTime * 1000);
+		QObject::connect(&worker, SIGNAL(Finished(int)), &app, SLOT(quit()));
+		worker.Start();
+		app.exec();
+		ret = worker.GetExitCode();
+	} else {
+		TransferRunner runner(client, progressInterval);
+		runner.SetFilter(filter);
+		QObject::connect(&runner, SIGNAL(Finished(int)), &app, SLOT(quit()));
+		bool started = true;
+		if (toArchive) {
+			started = runner.Archive(sources, destination);
+		} else if (streaming && command == "get") {
+			started = runner.StreamGet(sources[0], destination);
+		} else if (streaming) {
+			started = runner.StreamPut(destination, partSize);
+		} else if (command == "get") {
+			runner.Get(sources, destination);
+		} else if (command == "put") {
+			runner.Put(destination, sources);
+		} else {
+			started = runner.Restore(sources[0], destination, report);
+		}
+		if (started) {
+			app.exec();
+			ret = runner.GetExitCode();
+		}
+	}
+
+	delete client;
+	ds3_cleanup();
+
+	return ret;
+}
@@ -0,0 +1,161 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <stdio.h>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSysInfo>
+
+#include "cli/shard_worker.h"
+#include "cli/transfer_runner.h"
+#include "lib/client.h"
+#include "lib/logger.h"
+
+ShardWorker::ShardWorker(Client* client, const QString& path,
+			 const QString& destination, int leaseTimeInMs,
+			 QObject* parent)
+	: QObject(parent),
+	  m_client(client),
+	  m_shards(path, QSysInfo::machineHostName() + "-" +
+			 QString::number(QCoreApplication::applicationPid())),
+	  m_destination(QDir(destination).absolutePath()),
+	  m_numShards(0),
+	  m_numFailedObjects(0),
+	  m_exitCode(TransferRunner::EXIT_OK),
+	  m_out(stdout)
+{
+	m_shards.SetLeaseTime(leaseTimeInMs);
+
+	connect(m_client, SIGNAL(JobProgressUpdate(const Job)),
+		this, SLOT(UpdateJob(const Job)));
+
+	// Leases are renewed well before they expire.  While idle, this is
+	// also how often other workers' shards are checked for.
+	m_timer = new QTimer(this);
+	m_timer->setInterval(leaseTimeInMs / 3);
+	connect(m_timer, SIGNAL(timeout()), this, SLOT(RenewOrLease()));
+}
+
+void
+ShardWorker::Start()
+{
+	m_timer->start();
+	// Once the event loop is running since Finished might be emitted
+	// right away
+	QTimer::singleShot(0, this, SLOT(RenewOrLease()));
+}
+
+void
+ShardWorker::RenewOrLease()
+{
+	if (m_jobID.isNull()) {
+		LeaseNext();
+	} else if (!m_shards.Renew(m_shardPath)) {
+		// Another worker already has it so stop duplicating its work
+		LOG_WARNING("Lost the lease on " + m_shardPath);
+		m_client->CancelBulkJob(m_jobID);
+	}
+}
+
+void
+ShardWorker::LeaseNext()
+{
+	if (!m_shards.Lease(&m_shardPath)) {
+		// Other workers might still be running the last shards.  If
+		// one of them dies, its shards can be reclaimed once their
+		// leases expire.
+		if (m_shards.IsFinished()) {
+			Finish(m_numFailedObjects > 0 ? TransferRunner::EXIT_FAILED :
+							TransferRunner::EXIT_OK);
+		}
+		return;
+	}
+
+	m_jobID = m_client->ManifestGet(m_shardPath, m_destination,
+					m_shards.GetReportPath(m_shardPath));
+	if (m_jobID.isNull()) {
+		// ManifestGet already logged why.  The lease is left to expire
+		// so another worker can try it.
+		Finish(TransferRunner::EXIT_FAILED);
+		return;
+	}
+	m_numShards++;
+	Print("leased", m_shardPath);
+}
+
+void
+ShardWorker::UpdateJob(const Job job)
+{
+	if (job.GetID() != m_jobID ||
+	    (job.GetState() != Job::FINISHED && job.GetState() != Job::CANCELED)) {
+		return;
+	}
+
+	// A canceled shard is given back for a worker to run again, unless
+	// this worker canceled it because another one already had
+	bool stop = false;
+	if (job.GetState() == Job::FINISHED) {
+		m_numFailedObjects += job.GetNumFailedObjects();
+		bool completed = m_shards.Complete(m_shardPath);
+		Print(completed ? "done" : "lost", m_shardPath, &job);
+	} else if (m_shards.Release(m_shardPath)) {
+		// Whoever canceled it didn't want this worker to carry on
+		Print("canceled", m_shardPath, &job);
+		stop = true;
+	} else {
+		Print("lost", m_shardPath, &job);
+	}
+
+	m_jobID = QUuid();
+	m_shardPath.clear();
+	if (stop) {
+		Finish(TransferRunner::EXIT_CANCELED);
+	} else {
+		LeaseNext();
+	}
+}
+
+void
+ShardWorker::Finish(int exitCode)
+{
+	m_timer->stop();
+	m_exitCode = exitCode;
+
+	QJsonObject summary;
+	summary["event"] = QString("summary");
+	summary["shards"] = m_numShards;
+	summary["failedObjects"] = (double)m_numFailedObjects;
+	summary["exitCode"] = m_exitCode;
+	m_out << QJsonDocument(summary).toJson(QJsonDocument::Compact) << endl;
+	emit Finished(m_exitCode);
+}
+
+void
+ShardWorker::Print(const QString& state, const QString& shardPath,
+		   const Job* job)
+{
+	QJsonObject line;
+	line["event"] = QString("shard");
+	line["shard"] = QFileInfo(shardPath).fileName();
+	line["state"] = state;
+	if (job != NULL) {
+		line["failedObjects"] = (double)job->GetNumFailedObjects();
+	}
+	m_out << QJsonDocument(line).toJson(QJsonDocument::Compact) << endl;
+}
@@ -0,0 +1,92 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef SHARD_WORKER_H
+#define SHARD_WORKER_H
+
+#include <QObject>
+#include <QString>
+#include <QTextStream>
+#include <QTimer>
+#include <QUuid>
+
+#include "lib/shard_directory.h"
+#include "models/job.h"
+
+class Client;
+
+// ShardWorker, repeatedly leases a shard from a ShardDirectory and restores
+// it with Client::ManifestGet until no shards are left.  Several workers,
+// on the same or different hosts, can share one directory.  Shard events
+// and a final summary are printed to stdout as JSON lines:
+//
+//   {"event":"shard","shard":"000001.csv","state":"leased"}
+//   {"event":"shard","shard":"000001.csv","state":"done","failedObjects":0}
+//   {"event":"summary","shards":1,"failedObjects":0,"exitCode":0}
+//
+// A shard's state is "lost" instead of "done" if its lease expired and
+// another worker reclaimed it.  If its job is canceled some other way, the
+// shard's state is "canceled", it's returned to pending for another worker
+// and this one stops.
+class ShardWorker : public QObject
+{
+	Q_OBJECT
+
+public:
+	ShardWorker(Client* client, const QString& path,
+		    const QString& destination, int leaseTimeInMs,
+		    QObject* parent = 0);
+
+	void Start();
+
+	// Only valid once Finished has been emitted.  One of
+	// TransferRunner::ExitCode.
+	int GetExitCode() const;
+
+signals:
+	void Finished(int exitCode);
+
+private slots:
+	void UpdateJob(const Job job);
+	void RenewOrLease();
+
+private:
+	void LeaseNext();
+	void Finish(int exitCode);
+	// job is the shard's finished job, if any
+	void Print(const QString& state, const QString& shardPath,
+		   const Job* job = NULL);
+
+	Client* m_client;
+	ShardDirectory m_shards;
+	QString m_destination;
+	QTimer* m_timer;
+	// The shard currently leased and the job restoring it
+	QString m_shardPath;
+	QUuid m_jobID;
+	int m_numShards;
+	uint64_t m_numFailedObjects;
+	int m_exitCode;
+	QTextStream m_out;
+};
+
+inline int
+ShardWorker::GetExitCode() const
+{
+	return m_exitCode;
+}
+
+#endif
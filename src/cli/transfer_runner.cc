@@ -0,0 +1,225 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <stdio.h>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "cli/transfer_runner.h"
+#include "lib/client.h"
+#include "models/ds3_url.h"
+
+static const char* TYPE_NAMES[] = { "GET", "PUT", "DELETE" };
+
+static const char* STATE_NAMES[] = { "INITIALIZING",
+				     "QUEUED",
+				     "PREPARING",
+				     "INPROGRESS",
+				     "CANCELING",
+				     "CANCELED",
+				     "FINISHED" };
+
+TransferRunner::TransferRunner(Client* client, int progressIntervalInMs,
+			       QObject* parent)
+	: QObject(parent),
+	  m_client(client),
+	  m_draining(false),
+	  m_exitCode(EXIT_OK),
+	  m_out(stdout)
+{
+	connect(m_client, SIGNAL(JobProgressUpdate(const Job)),
+		this, SLOT(UpdateJob(const Job)));
+
+	m_timer = new QTimer(this);
+	m_timer->setInterval(progressIntervalInMs);
+	connect(m_timer, SIGNAL(timeout()), this, SLOT(CheckJobs()));
+}
+
+void
+TransferRunner::Get(const QStringList& sources, const QString& destination)
+{
+	m_client->BulkGet(ToDS3URLs(sources), QDir(destination).absolutePath(),
+			  m_filter);
+	m_timer->start();
+}
+
+bool
+TransferRunner::Archive(const QStringList& sources, const QString& archive)
+{
+	if (m_client->ArchiveGet(ToDS3URLs(sources),
+				 QFileInfo(archive).absoluteFilePath()).isNull()) {
+		return false;
+	}
+	m_timer->start();
+	return true;
+}
+
+void
+TransferRunner::Put(const QString& destination, const QStringList& sources)
+{
+	QString bucketName = destination.section("/", 0, 0, QString::SectionSkipEmpty);
+	QString prefix = destination.section("/", 1, -1, QString::SectionSkipEmpty);
+	QList<QUrl> urls;
+	for (int i = 0; i < sources.size(); i++) {
+		urls << QUrl::fromLocalFile(QFileInfo(sources[i]).absoluteFilePath());
+	}
+	m_client->BulkPut(bucketName, prefix, urls, m_filter);
+	m_timer->start();
+}
+
+bool
+TransferRunner::StreamPut(const QString& destination, uint64_t partSize)
+{
+	QString bucketName = destination.section("/", 0, 0, QString::SectionSkipEmpty);
+	QString objName = destination.section("/", 1, -1, QString::SectionSkipEmpty);
+	if (!m_stream.open(stdin, QIODevice::ReadOnly)) {
+		return false;
+	}
+	m_client->StreamPut(&m_stream, bucketName, objName, partSize);
+	m_timer->start();
+	return true;
+}
+
+bool
+TransferRunner::StreamGet(const QString& source, const QString& destination)
+{
+	QString bucketName = source.section("/", 0, 0, QString::SectionSkipEmpty);
+	QString objName = source.section("/", 1, -1, QString::SectionSkipEmpty);
+	QString description = destination;
+	if (destination == "-") {
+		// stdout is the data so keep the progress out of it
+		m_stderr.open(stderr, QIODevice::WriteOnly);
+		m_out.setDevice(&m_stderr);
+		m_stream.open(stdout, QIODevice::WriteOnly);
+		description = "stdout";
+	} else {
+		m_stream.setFileName(destination);
+		m_stream.open(QIODevice::WriteOnly | QIODevice::Truncate);
+		description = QFileInfo(destination).absoluteFilePath();
+	}
+	if (!m_stream.isOpen()) {
+		QTextStream(stderr) << "Unable to open " << destination << ", "
+				    << m_stream.errorString() << endl;
+		return false;
+	}
+	m_client->StreamGet(bucketName, objName, &m_stream, description);
+	m_timer->start();
+	return true;
+}
+
+bool
+TransferRunner::Restore(const QString& manifest, const QString& destination,
+			const QString& report)
+{
+	if (m_client->ManifestGet(manifest, QDir(destination).absolutePath(),
+				  report).isNull()) {
+		return false;
+	}
+	m_timer->start();
+	return true;
+}
+
+void
+TransferRunner::UpdateJob(const Job job)
+{
+	// Client sends snapshots of in progress jobs many times a second.
+	// Only state changes are printed right away.
+	QHash<QUuid, Job>::const_iterator ji = m_jobs.constFind(job.GetID());
+	bool stateChanged = ji == m_jobs.constEnd() ||
+			    ji.value().GetState() != job.GetState();
+	m_jobs.insert(job.GetID(), job);
+	if (stateChanged) {
+		Print("state", job);
+	}
+}
+
+void
+TransferRunner::CheckJobs()
+{
+	QHash<QUuid, Job>::const_iterator ji;
+	for (ji = m_jobs.constBegin(); ji != m_jobs.constEnd(); ji++) {
+		if (ji.value().GetState() == Job::INPROGRESS) {
+			Print("progress", ji.value());
+		}
+	}
+
+	// A job's final state update is queued right before Client forgets
+	// about the job so wait one more interval for it to arrive
+	if (m_client->GetNumActiveJobs() > 0) {
+		m_draining = false;
+		return;
+	}
+	if (!m_draining) {
+		m_draining = true;
+		return;
+	}
+	m_timer->stop();
+	if (m_stream.isOpen()) {
+		m_stream.close();
+	}
+
+	uint64_t numFailedObjects = 0;
+	bool canceled = false;
+	for (ji = m_jobs.constBegin(); ji != m_jobs.constEnd(); ji++) {
+		numFailedObjects += ji.value().GetNumFailedObjects();
+		canceled = canceled || ji.value().WasCanceled();
+	}
+	if (numFailedObjects > 0) {
+		m_exitCode = EXIT_FAILED;
+	} else if (canceled) {
+		m_exitCode = EXIT_CANCELED;
+	}
+
+	QJsonObject summary;
+	summary["event"] = QString("summary");
+	summary["jobs"] = m_jobs.size();
+	summary["failedObjects"] = (double)numFailedObjects;
+	summary["exitCode"] = m_exitCode;
+	m_out << QJsonDocument(summary).toJson(QJsonDocument::Compact) << endl;
+	emit Finished(m_exitCode);
+}
+
+QList<QUrl>
+TransferRunner::ToDS3URLs(const QStringList& sources) const
+{
+	QList<QUrl> urls;
+	for (int i = 0; i < sources.size(); i++) {
+		QString path = sources[i];
+		if (!path.startsWith("/")) {
+			path.prepend("/");
+		}
+		urls << DS3URL(m_client->GetEndpoint(), path);
+	}
+	return urls;
+}
+
+void
+TransferRunner::Print(const QString& event, const Job& job)
+{
+	QJsonObject line;
+	line["event"] = event;
+	line["id"] = job.GetID().toString();
+	line["type"] = QString(TYPE_NAMES[job.GetType()]);
+	line["state"] = QString(STATE_NAMES[job.GetState()]);
+	line["destination"] = job.GetDestination();
+	// JSON numbers are doubles, which are exact up to 2^53 bytes
+	line["size"] = (double)job.GetSize();
+	line["transferred"] = (double)job.GetBytesTransferred();
+	line["failedObjects"] = (double)job.GetNumFailedObjects();
+	m_out << QJsonDocument(line).toJson(QJsonDocument::Compact) << endl;
+}
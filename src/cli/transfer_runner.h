@@ -0,0 +1,120 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef TRANSFER_RUNNER_H
+#define TRANSFER_RUNNER_H
+
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+#include <QTimer>
+#include <QUrl>
+#include <QUuid>
+
+#include "lib/transfer_filter.h"
+#include "models/job.h"
+
+class Client;
+
+// TransferRunner, drives headless Client::BulkGet/BulkPut/ManifestGet/ArchiveGet
+// transfers and prints their progress to stdout, one JSON object per line:
+//
+//   {"event":"state","id":"{...}","type":"GET","state":"INPROGRESS",...}
+//   {"event":"progress","id":"{...}","size":1024,"transferred":512,...}
+//   {"event":"summary","jobs":1,"failedObjects":0,"exitCode":0}
+//
+// "state" lines are printed whenever a job changes state and "progress"
+// lines for every in progress job once per progress interval.  Finished is
+// emitted with one of the ExitCodes once the Client has no jobs left.
+class TransferRunner : public QObject
+{
+	Q_OBJECT
+
+public:
+	enum ExitCode { EXIT_OK = 0,
+			EXIT_FAILED = 1,
+			EXIT_USAGE = 2,
+			EXIT_CANCELED = 3 };
+
+	TransferRunner(Client* client, int progressIntervalInMs,
+		       QObject* parent = 0);
+
+	// Used by Get and Put for the objects/files under folders
+	void SetFilter(const TransferFilter& filter);
+
+	// sources are "bucket", "bucket/folder/" or "bucket/object" paths.
+	// destination must be an existing directory.
+	void Get(const QStringList& sources, const QString& destination);
+	// Get sources in to a single zip or tar file.  Returns false if it
+	// can't be created.
+	bool Archive(const QStringList& sources, const QString& archive);
+	// destination is "bucket" or "bucket/prefix"
+	void Put(const QString& destination, const QStringList& sources);
+	// Upload stdin as a streamed object.  destination is "bucket/object".
+	bool StreamPut(const QString& destination, uint64_t partSize);
+	// Write a streamed object to a file, or to stdout if destination is
+	// "-", in which case progress is printed to stderr instead.  Returns
+	// false if the file can't be created.
+	bool StreamGet(const QString& source, const QString& destination);
+	// Restore the objects listed in a manifest file.  Returns false if
+	// the manifest or report can't be opened.
+	bool Restore(const QString& manifest, const QString& destination,
+		     const QString& report);
+
+	// Only valid once Finished has been emitted
+	ExitCode GetExitCode() const;
+
+signals:
+	void Finished(int exitCode);
+
+private slots:
+	void UpdateJob(const Job job);
+	void CheckJobs();
+
+private:
+	// "bucket/path" sources as DS3 URLs
+	QList<QUrl> ToDS3URLs(const QStringList& sources) const;
+	void Print(const QString& event, const Job& job);
+
+	Client* m_client;
+	QTimer* m_timer;
+	QHash<QUuid, Job> m_jobs;
+	bool m_draining;
+	ExitCode m_exitCode;
+	TransferFilter m_filter;
+	QTextStream m_out;
+	// stdin, stdout or the file of a streamed PUT/GET
+	QFile m_stream;
+	QFile m_stderr;
+};
+
+inline void
+TransferRunner::SetFilter(const TransferFilter& filter)
+{
+	m_filter = filter;
+}
+
+inline TransferRunner::ExitCode
+TransferRunner::GetExitCode() const
+{
+	return m_exitCode;
+}
+
+#endif
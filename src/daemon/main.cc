@@ -0,0 +1,53 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QCoreApplication>
+#include <QStringList>
+#include <ds3.h>
+
+#include "cli/cli_logger.h"
+#include "daemon/transfer_daemon.h"
+#include "global.h"
+#include "models/job.h"
+
+int
+main(int argc, char *argv[])
+{
+	QCoreApplication app(argc, argv);
+	// Same as the GUI so the transfer settings are shared
+	app.setOrganizationName("Spectra Logic");
+	app.setOrganizationDomain("spectralogic.com");
+	app.setApplicationName(APP_NAME);
+	app.setApplicationVersion(APP_VERSION);
+
+	// Job is used as an argument in a signal/slot connection
+	qRegisterMetaType<Job>();
+
+	if (app.arguments().contains("--verbose")) {
+		CliLogger::Instance()->SetLogLevel(CliLogger::INFO);
+	}
+
+	int ret = 1;
+	TransferDaemon* daemon = new TransferDaemon;
+	if (daemon->Listen()) {
+		ret = app.exec();
+	}
+	delete daemon;
+
+	ds3_cleanup();
+
+	return ret;
+}
@@ -0,0 +1,214 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QLocalSocket>
+
+#include "daemon/transfer_daemon.h"
+#include "lib/client.h"
+#include "lib/ipc/transfer_channel.h"
+#include "lib/logger.h"
+
+TransferDaemon::TransferDaemon(QObject* parent)
+	: QObject(parent),
+	  m_server(new QLocalServer(this))
+{
+	// Sessions, including their secret keys, are sent over the socket
+	m_server->setSocketOptions(QLocalServer::UserAccessOption);
+	connect(m_server, SIGNAL(newConnection()),
+		this, SLOT(AcceptConnections()));
+}
+
+TransferDaemon::~TransferDaemon()
+{
+	QHash<QString, Client*>::iterator ci;
+	for (ci = m_clients.begin(); ci != m_clients.end(); ci++) {
+		ci.value()->CancelActiveJobs();
+		delete ci.value();
+	}
+}
+
+bool
+TransferDaemon::Listen()
+{
+	QLocalSocket probe;
+	probe.connectToServer(TransferChannel::SERVER_NAME);
+	if (probe.waitForConnected(1000)) {
+		LOG_ERROR("ERROR:       The transfer daemon is already running");
+		return false;
+	}
+
+	// Clean up after a daemon that didn't exit cleanly
+	QLocalServer::removeServer(TransferChannel::SERVER_NAME);
+	if (!m_server->listen(TransferChannel::SERVER_NAME)) {
+		LOG_ERROR("ERROR:       Unable to start the transfer daemon, " +
+			  m_server->errorString());
+		return false;
+	}
+	LOG_INFO("Transfer daemon listening on " + m_server->fullServerName());
+	return true;
+}
+
+void
+TransferDaemon::AcceptConnections()
+{
+	while (m_server->hasPendingConnections()) {
+		TransferChannel* channel = new TransferChannel(m_server->nextPendingConnection(),
+							       this);
+		connect(channel, SIGNAL(Disconnected()),
+			this, SLOT(RemoveChannel()));
+		connect(channel, SIGNAL(Attached(const QUuid&, const Session&)),
+			this, SLOT(Attach(const QUuid&, const Session&)));
+		connect(channel, SIGNAL(GetSubmitted(const Session&, const QList<QUrl>&, const QString&, const TransferFilter&)),
+			this, SLOT(SubmitGet(const Session&, const QList<QUrl>&, const QString&, const TransferFilter&)));
+		connect(channel, SIGNAL(PutSubmitted(const Session&, const QString&, const QString&, const QList<QUrl>&, const TransferFilter&, TransferScheduler::Priority)),
+			this, SLOT(SubmitPut(const Session&, const QString&, const QString&, const QList<QUrl>&, const TransferFilter&, TransferScheduler::Priority)));
+		connect(channel, SIGNAL(CancelRequested(const QUuid&)),
+			this, SLOT(CancelJob(const QUuid&)));
+		m_channels << channel;
+		LOG_INFO("GUI connected, " + QString::number(m_channels.size()) +
+			 " connected");
+	}
+}
+
+void
+TransferDaemon::Attach(const QUuid& sessionID, const Session& session)
+{
+	TransferChannel* channel = qobject_cast<TransferChannel*>(sender());
+	QString key = GetClientKey(session);
+	QHash<QUuid, Job>::iterator ji;
+	for (ji = m_jobs.begin(); ji != m_jobs.end(); ji++) {
+		Job& job = ji.value();
+		// Jobs left behind by a session that's gone, e.g. because
+		// its GUI exited
+		if (m_jobClients.value(ji.key()) == key &&
+		    FindChannel(job.GetSessionID()) == NULL) {
+			job.SetSessionID(sessionID);
+		}
+		if (job.GetSessionID() == sessionID) {
+			channel->SendJobUpdate(job);
+		}
+	}
+}
+
+void
+TransferDaemon::RemoveChannel()
+{
+	TransferChannel* channel = qobject_cast<TransferChannel*>(sender());
+	m_channels.removeAll(channel);
+	channel->deleteLater();
+	LOG_INFO("GUI disconnected, " + QString::number(m_channels.size()) +
+		 " connected");
+}
+
+QString
+TransferDaemon::GetClientKey(const Session& session)
+{
+	return Client::BuildEndpoint(&session, session.GetHost()) + " " +
+	       session.GetAccessId();
+}
+
+Client*
+TransferDaemon::GetClient(const Session& session)
+{
+	QString key = GetClientKey(session);
+	Client* client = m_clients.value(key);
+	if (client == NULL) {
+		client = new Client(&session);
+		connect(client, SIGNAL(JobProgressUpdate(const Job)),
+			this, SLOT(SendJobUpdate(const Job)));
+		m_clients.insert(key, client);
+	}
+	return client;
+}
+
+TransferChannel*
+TransferDaemon::FindChannel(const QUuid& sessionID) const
+{
+	for (int i = 0; i < m_channels.size(); i++) {
+		if (m_channels[i]->GetSessionID() == sessionID) {
+			return m_channels[i];
+		}
+	}
+	return NULL;
+}
+
+void
+TransferDaemon::SubmitGet(const Session& session, const QList<QUrl>& urls,
+			  const QString& destination, const TransferFilter& filter)
+{
+	TransferChannel* channel = qobject_cast<TransferChannel*>(sender());
+	GetClient(session)->BulkGet(urls, destination, filter,
+				    channel->GetSessionID());
+}
+
+void
+TransferDaemon::SubmitPut(const Session& session, const QString& bucketName,
+			  const QString& prefix, const QList<QUrl>& urls,
+			  const TransferFilter& filter,
+			  TransferScheduler::Priority priority)
+{
+	TransferChannel* channel = qobject_cast<TransferChannel*>(sender());
+	GetClient(session)->BulkPut(bucketName, prefix, urls, filter, priority,
+				    channel->GetSessionID());
+}
+
+// Sessions can only cancel their own jobs, including ones they've taken over
+// (see Attach)
+void
+TransferDaemon::CancelJob(const QUuid& jobID)
+{
+	TransferChannel* channel = qobject_cast<TransferChannel*>(sender());
+	QHash<QUuid, Job>::const_iterator ji = m_jobs.constFind(jobID);
+	if (ji == m_jobs.constEnd() ||
+	    ji.value().GetSessionID() != channel->GetSessionID()) {
+		LOG_WARNING("Ignoring a request to cancel job " +
+			    jobID.toString() + ", which isn't the session's");
+		return;
+	}
+	Client* client = m_clients.value(m_jobClients.value(jobID));
+	if (client != NULL) {
+		client->CancelBulkJob(jobID);
+	}
+}
+
+void
+TransferDaemon::SendJobUpdate(const Job job)
+{
+	QUuid jobID = job.GetID();
+	Job update = job;
+	if (m_jobs.contains(jobID)) {
+		// It might have been taken over by another session
+		update.SetSessionID(m_jobs[jobID].GetSessionID());
+	} else {
+		Client* client = qobject_cast<Client*>(sender());
+		m_jobClients.insert(jobID, m_clients.key(client));
+	}
+
+	if (update.IsFinished() || update.WasCanceled()) {
+		m_jobs.remove(jobID);
+		m_jobClients.remove(jobID);
+	} else if (!update.HasURLs() && m_jobs.contains(jobID)) {
+		// Progress updates only carry what changed
+		m_jobs[jobID].UpdateProgress(update);
+	} else {
+		m_jobs.insert(jobID, update);
+	}
+
+	TransferChannel* channel = FindChannel(update.GetSessionID());
+	if (channel != NULL) {
+		channel->SendJobUpdate(update);
+	}
+}
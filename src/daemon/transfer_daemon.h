@@ -0,0 +1,84 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef TRANSFER_DAEMON_H
+#define TRANSFER_DAEMON_H
+
+#include <QHash>
+#include <QList>
+#include <QLocalServer>
+#include <QObject>
+#include <QString>
+#include <QUrl>
+#include <QUuid>
+
+#include "lib/transfer_filter.h"
+#include "lib/transfer_scheduler.h"
+#include "models/job.h"
+#include "models/session.h"
+
+class Client;
+class TransferChannel;
+
+// TransferDaemon, runs BulkGet/BulkPut jobs on behalf of any number of GUI
+// sessions connected over TransferChannels.  There's one Client per DS3
+// session so every GUI's jobs share the same TransferScheduler and thread
+// pools.  Each job is tagged with the GUI session that submitted it and
+// only that session is sent its updates.  Jobs keep running when GUIs
+// disconnect, and the first session for the same DS3 system to attach
+// afterwards takes them over and is sent their latest snapshots.
+class TransferDaemon : public QObject
+{
+	Q_OBJECT
+
+public:
+	TransferDaemon(QObject* parent = 0);
+	~TransferDaemon();
+
+	// Returns false if another daemon is already running or the server
+	// can't be started
+	bool Listen();
+
+private slots:
+	void AcceptConnections();
+	void RemoveChannel();
+	void Attach(const QUuid& sessionID, const Session& session);
+	void SubmitGet(const Session& session, const QList<QUrl>& urls,
+		       const QString& destination, const TransferFilter& filter);
+	void SubmitPut(const Session& session, const QString& bucketName,
+		       const QString& prefix, const QList<QUrl>& urls,
+		       const TransferFilter& filter,
+		       TransferScheduler::Priority priority);
+	void CancelJob(const QUuid& jobID);
+	void SendJobUpdate(const Job job);
+
+private:
+	static QString GetClientKey(const Session& session);
+	Client* GetClient(const Session& session);
+	TransferChannel* FindChannel(const QUuid& sessionID) const;
+
+	QLocalServer* m_server;
+	QList<TransferChannel*> m_channels;
+	// Keyed by endpoint and access ID
+	QHash<QString, Client*> m_clients;
+	// The latest snapshot of every unfinished job, tagged with the
+	// session it's currently sent to
+	QHash<QUuid, Job> m_jobs;
+	// The key of the Client running each unfinished job
+	QHash<QUuid, QString> m_jobClients;
+};
+
+#endif
@@ -0,0 +1,86 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QDate>
+
+#include "helpers/time_helper.h"
+
+static const qint64 MSECS_PER_DAY = 86400000LL;
+// QDate's Julian day for 1970-01-01
+static const qint64 UNIX_EPOCH_JULIAN_DAY = 2440588LL;
+
+// Read count digits starting at pos
+static bool
+ReadDigits(const QString& str, int pos, int count, int* value)
+{
+	int result = 0;
+	for (int i = pos; i < pos + count; i++) {
+		ushort c = str.at(i).unicode();
+		if (c < '0' || c > '9') {
+			return false;
+		}
+		result = result * 10 + (c - '0');
+	}
+	*value = result;
+	return true;
+}
+
+bool
+TimeHelper::ParseRESTTimestamp(const QString& timestamp, qint64* msecs)
+{
+	// yyyy-MM-ddThh:mm:ssZ is the shortest form
+	if (timestamp.size() < 20 ||
+	    timestamp.at(4) != '-' || timestamp.at(7) != '-' ||
+	    timestamp.at(10) != 'T' ||
+	    timestamp.at(13) != ':' || timestamp.at(16) != ':') {
+		return false;
+	}
+
+	int year, month, day, hour, minute, second;
+	if (!ReadDigits(timestamp, 0, 4, &year) ||
+	    !ReadDigits(timestamp, 5, 2, &month) ||
+	    !ReadDigits(timestamp, 8, 2, &day) ||
+	    !ReadDigits(timestamp, 11, 2, &hour) ||
+	    !ReadDigits(timestamp, 14, 2, &minute) ||
+	    !ReadDigits(timestamp, 17, 2, &second)) {
+		return false;
+	}
+
+	int pos = 19;
+	int millis = 0;
+	if (timestamp.at(pos) == '.') {
+		pos++;
+		int scale = 100;
+		while (pos < timestamp.size() && timestamp.at(pos).isDigit()) {
+			millis += (timestamp.at(pos).unicode() - '0') * scale;
+			scale /= 10;
+			pos++;
+		}
+	}
+	if (pos != timestamp.size() - 1 || timestamp.at(pos) != 'Z') {
+		return false;
+	}
+
+	QDate date(year, month, day);
+	if (!date.isValid() || hour > 23 || minute > 59 || second > 60) {
+		return false;
+	}
+
+	qint64 days = date.toJulianDay() - UNIX_EPOCH_JULIAN_DAY;
+	*msecs = days * MSECS_PER_DAY +
+		 ((hour * 60 + minute) * 60 + second) * 1000LL + millis;
+	return true;
+}
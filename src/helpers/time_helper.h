@@ -0,0 +1,33 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef TIME_HELPER_H
+#define TIME_HELPER_H
+
+#include <QString>
+
+class TimeHelper
+{
+public:
+	// Parse a DS3 REST timestamp (e.g. 2015-05-18T15:02:11.000Z) in to
+	// milliseconds since the epoch.  This is called for every object in
+	// a listing so, unlike QDateTime::fromString, it reads the fixed
+	// format directly and doesn't allocate.  The fractional seconds are
+	// optional.
+	static bool ParseRESTTimestamp(const QString& timestamp, qint64* msecs);
+};
+
+#endif
@@ -0,0 +1,517 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <string.h>
+#include <zlib.h>
+#include <QFileInfo>
+
+#include "lib/archive_writer.h"
+#include "lib/manifest_reader.h"
+#include "quazip/quazipnewinfo.h"
+
+static const int TAR_BLOCK_SIZE = 512;
+// The largest size a ustar header's 11 octal digit size field can hold
+static const uint64_t TAR_MAX_OCTAL_SIZE = 077777777777ULL;
+// zip entries this large need the zip64 extensions
+static const uint64_t ZIP_MAX_SIZE = 0xffffffffULL;
+static const quint32 ZIP_CENTRAL_HEADER_SIGNATURE = 0x02014b50;
+// The fixed size parts of zip headers and where their fields are
+static const int ZIP_CENTRAL_HEADER_SIZE = 46;
+static const int ZIP_CENTRAL_CRC_OFFSET = 16;
+static const int ZIP_CENTRAL_NAME_LENGTH_OFFSET = 28;
+static const int ZIP_CENTRAL_EXTRA_LENGTH_OFFSET = 30;
+static const int ZIP_CENTRAL_COMMENT_LENGTH_OFFSET = 32;
+static const int ZIP_LOCAL_CRC_OFFSET = 14;
+
+// Read a little endian number of size bytes from data at offset
+static quint32
+GetLittleEndian(const QByteArray& data, int offset, int size)
+{
+	quint32 value = 0;
+	for (int i = size - 1; i >= 0; i--) {
+		value = (value << 8) | (unsigned char)data[offset + i];
+	}
+	return value;
+}
+
+static bool
+WriteZipCrc(QFile* file, qint64 offset, quint32 crc)
+{
+	char bytes[4];
+	for (int i = 0; i < 4; i++) {
+		bytes[i] = (char)((crc >> (8 * i)) & 0xff);
+	}
+	return file->seek(offset) && file->write(bytes, 4) == 4;
+}
+
+// Write value as a NUL terminated, zero padded octal number filling field
+static void
+PutOctal(char* field, int fieldSize, uint64_t value)
+{
+	QByteArray octal = QByteArray::number((qulonglong)value, 8);
+	octal = octal.rightJustified(fieldSize - 1, '0');
+	memcpy(field, octal.constData(), fieldSize - 1);
+	field[fieldSize - 1] = '\0';
+}
+
+// A pax extended header record, "<length> <key>=<value>\n", where length
+// includes itself
+static QByteArray
+PaxRecord(const QByteArray& key, const QByteArray& value)
+{
+	int length = key.size() + value.size() + 3;
+	int digits = QByteArray::number(length).size();
+	while (QByteArray::number(length + digits).size() != digits) {
+		digits++;
+	}
+	return QByteArray::number(length + digits) + " " + key + "=" + value + "\n";
+}
+
+ArchiveWriter::Format
+ArchiveWriter::FormatFromFileName(const QString& fileName)
+{
+	if (fileName.endsWith(".tar", Qt::CaseInsensitive)) {
+		return TAR;
+	}
+	return ZIP;
+}
+
+ArchiveWriter::ArchiveWriter(const QString& path)
+	: m_path(path),
+	  m_format(FormatFromFileName(path)),
+	  m_created(QDateTime::currentDateTime()),
+	  m_file(path),
+	  m_zip(NULL),
+	  m_zipFile(NULL),
+	  m_numZipEntries(0),
+	  m_manifestFile(path + ".manifest.csv"),
+	  m_entryOffset(0),
+	  m_entrySize(0),
+	  m_open(false)
+{
+}
+
+ArchiveWriter::~ArchiveWriter()
+{
+	QString error;
+	Close(&error);
+	delete m_zipFile;
+	delete m_zip;
+}
+
+bool
+ArchiveWriter::Open(QString* error)
+{
+	if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		*error = "Unable to write " + m_path + ", " + m_file.errorString();
+		return false;
+	}
+	if (!m_manifestFile.open(QIODevice::WriteOnly | QIODevice::Truncate |
+				 QIODevice::Text)) {
+		*error = "Unable to write " + m_manifestFile.fileName() + ", " +
+			 m_manifestFile.errorString();
+		m_file.close();
+		return false;
+	}
+	m_manifest.setDevice(&m_manifestFile);
+	m_manifest.setCodec("UTF-8");
+	m_manifest << "name,offset,size" << endl;
+
+	if (m_format == ZIP) {
+		m_zip = new QuaZip(&m_file);
+		m_zip->setAutoClose(false);
+		m_zip->setFileNameCodec("UTF-8");
+		if (!m_zip->open(QuaZip::mdCreate)) {
+			*error = "Unable to create the zip archive " + m_path +
+				 ", error " + QString::number(m_zip->getZipError());
+			m_file.close();
+			return false;
+		}
+		m_zipFile = new QuaZipFile(m_zip);
+	}
+	m_open = true;
+	return true;
+}
+
+bool
+ArchiveWriter::Close(QString* error)
+{
+	if (!m_open) {
+		return true;
+	}
+	m_open = false;
+
+	bool ok = true;
+	qint64 centralDirOffset = 0;
+	if (m_format == ZIP) {
+		if (m_zipFile->isOpen()) {
+			m_zipFile->close();
+		}
+		centralDirOffset = m_file.pos();
+		m_zip->close();
+		if (m_zip->getZipError() != ZIP_OK) {
+			*error = "Unable to finish the zip archive " + m_path +
+				 ", error " + QString::number(m_zip->getZipError());
+			ok = false;
+		}
+	} else {
+		// Two empty blocks end a tar archive
+		QByteArray end(2 * TAR_BLOCK_SIZE, '\0');
+		if (m_file.write(end) != end.size()) {
+			*error = "Unable to finish the tar archive " + m_path +
+				 ", " + m_file.errorString();
+			ok = false;
+		}
+	}
+	m_file.close();
+	if (ok && !m_zipCrcs.isEmpty()) {
+		ok = FixZipCentralDirectory(centralDirOffset, error);
+	}
+	m_manifest.flush();
+	m_manifestFile.close();
+	return ok;
+}
+
+bool
+ArchiveWriter::AddEntry(const QString& name, const QByteArray& data,
+			QString* error)
+{
+	if (BeginEntry(name, data.size(), error) == NULL) {
+		return false;
+	}
+	QIODevice* device = m_format == ZIP ? (QIODevice*)m_zipFile : &m_file;
+	if (device->write(data) != data.size()) {
+		*error = "Unable to write " + name + " to " + m_path + ", " +
+			 device->errorString();
+	}
+	return EndEntry(error);
+}
+
+bool
+ArchiveWriter::AddDirectory(const QString& name, QString* error)
+{
+	QString dirName = name.endsWith("/") ? name : name + "/";
+	if (m_format == ZIP) {
+		return OpenZipEntry(dirName, 0, error) && CloseZipEntry(error);
+	}
+	return WriteTarHeader(dirName, '5', 0, error);
+}
+
+QIODevice*
+ArchiveWriter::BeginEntry(const QString& name, uint64_t size, QString* error)
+{
+	m_entryName = name;
+	m_entrySize = size;
+	if (m_format == ZIP) {
+		if (!OpenZipEntry(name, size, error)) {
+			return NULL;
+		}
+		m_entryOffset = m_file.pos();
+		return m_zipFile;
+	}
+
+	if (!WriteTarHeader(name, '0', size, error)) {
+		return NULL;
+	}
+	m_entryOffset = m_file.pos();
+	return &m_file;
+}
+
+// The entry is only added to the manifest if all of its data was written.
+// A short tar entry is filled out with zeros to keep the archive readable.
+bool
+ArchiveWriter::EndEntry(QString* error)
+{
+	uint64_t written;
+	bool ok = true;
+	if (m_format == ZIP) {
+		written = m_zipFile->pos();
+		ok = CloseZipEntry(error);
+	} else {
+		written = m_file.pos() - m_entryOffset;
+		if (written < m_entrySize) {
+			QByteArray zeros(qMin(m_entrySize - written,
+					      (uint64_t)1024 * 1024), '\0');
+			uint64_t filled = written;
+			while (ok && filled < m_entrySize) {
+				qint64 n = qMin((uint64_t)zeros.size(),
+						m_entrySize - filled);
+				ok = m_file.write(zeros.constData(), n) == n;
+				filled += n;
+			}
+		}
+		ok = ok && WriteTarPadding(m_entrySize, error);
+	}
+
+	if (ok && written != m_entrySize) {
+		*error = m_entryName + " is " + QString::number(written) +
+			 " bytes instead of " + QString::number(m_entrySize);
+		ok = false;
+	} else if (ok) {
+		RecordEntry(m_entryName, m_entryOffset, m_entrySize);
+	} else if (error->isEmpty()) {
+		*error = "Unable to write " + m_entryName + " to " + m_path +
+			 ", " + m_file.errorString();
+	}
+	m_entryName.clear();
+	return ok;
+}
+
+bool
+ArchiveWriter::ReserveEntry(const QString& name, uint64_t size,
+			    qint64* dataOffset, QString* error)
+{
+	if (m_format == ZIP) {
+		// Zip entries can't be skipped over so the room is written
+		// as zeros, with a checksum that's corrected later
+		ZipReservation reservation;
+		reservation.index = m_numZipEntries;
+		reservation.headerOffset = m_file.pos();
+		if (!OpenZipEntry(name, size, error)) {
+			return false;
+		}
+		*dataOffset = m_file.pos();
+		QByteArray zeros(qMin(size, (uint64_t)1024 * 1024), '\0');
+		uint64_t filled = 0;
+		while (filled < size) {
+			qint64 n = qMin((uint64_t)zeros.size(), size - filled);
+			if (m_zipFile->write(zeros.constData(), n) != n) {
+				*error = "Unable to write " + m_path + ", " +
+					 m_zipFile->errorString();
+				QString closeError;
+				CloseZipEntry(&closeError);
+				return false;
+			}
+			filled += n;
+		}
+		if (!CloseZipEntry(error)) {
+			return false;
+		}
+		m_zipReservations.insert(*dataOffset, reservation);
+		m_file.flush();
+		return true;
+	}
+
+	if (!WriteTarHeader(name, '0', size, error)) {
+		return false;
+	}
+	*dataOffset = m_file.pos();
+	// The skipped over data is written by another handle.  Since the
+	// file is extended by the next write, the padding is written now in
+	// case this is the last entry.
+	uint64_t padding = (TAR_BLOCK_SIZE - size % TAR_BLOCK_SIZE) % TAR_BLOCK_SIZE;
+	if (!m_file.seek(*dataOffset + size) ||
+	    m_file.write(QByteArray(padding, '\0')) != (qint64)padding) {
+		*error = "Unable to write " + m_path + ", " + m_file.errorString();
+		return false;
+	}
+	// Written to disk so the other handle doesn't race with our buffer
+	m_file.flush();
+	return true;
+}
+
+bool
+ArchiveWriter::FinishReservedEntry(const QString& name, qint64 dataOffset,
+				   uint64_t size, QString* error)
+{
+	if (m_format == ZIP) {
+		ZipReservation reservation = m_zipReservations.take(dataOffset);
+		QFile file(m_path);
+		if (!file.open(QIODevice::ReadWrite) || !file.seek(dataOffset)) {
+			*error = "Unable to read " + m_path + ", " +
+				 file.errorString();
+			return false;
+		}
+		char buffer[64 * 1024];
+		uLong crc = crc32(0L, Z_NULL, 0);
+		uint64_t checked = 0;
+		while (checked < size) {
+			qint64 n = file.read(buffer, qMin((uint64_t)sizeof(buffer),
+							  size - checked));
+			if (n <= 0) {
+				*error = "Unable to read " + name + " from " +
+					 m_path + ", " + file.errorString();
+				return false;
+			}
+			crc = crc32(crc, (const Bytef*)buffer, (uInt)n);
+			checked += n;
+		}
+		if (!WriteZipCrc(&file, reservation.headerOffset +
+				 ZIP_LOCAL_CRC_OFFSET, (quint32)crc)) {
+			*error = "Unable to write " + m_path + ", " +
+				 file.errorString();
+			return false;
+		}
+		m_zipCrcs.insert(reservation.index, (quint32)crc);
+	}
+	RecordEntry(name, dataOffset, size);
+	return true;
+}
+
+void
+ArchiveWriter::RecordEntry(const QString& name, qint64 dataOffset,
+			   uint64_t size)
+{
+	m_manifest << ManifestReader::QuoteCSV(name) << "," << dataOffset
+		   << "," << size << "\n";
+}
+
+// Names and sizes that don't fit in a ustar header are written to a pax
+// extended header first
+bool
+ArchiveWriter::WriteTarHeader(const QString& name, char type, uint64_t size,
+			      QString* error)
+{
+	QByteArray utf8Name = name.toUtf8();
+	QByteArray pax;
+	QByteArray headerName = utf8Name;
+	QByteArray prefix;
+	if (utf8Name.size() > 100) {
+		// ustar splits long names in to a prefix and name at a /
+		int slash = utf8Name.lastIndexOf('/', utf8Name.endsWith('/') ?
+						   utf8Name.size() - 2 : -1);
+		if (slash > 0 && slash <= 155 && utf8Name.size() - slash - 1 <= 100) {
+			prefix = utf8Name.left(slash);
+			headerName = utf8Name.mid(slash + 1);
+		} else {
+			pax += PaxRecord("path", utf8Name);
+			headerName = utf8Name.left(100);
+		}
+	}
+	if (size > TAR_MAX_OCTAL_SIZE) {
+		pax += PaxRecord("size", QByteArray::number((qulonglong)size));
+	}
+	if (!pax.isEmpty()) {
+		if (!WriteTarHeader("PaxHeader/" + QString::fromUtf8(headerName.right(90)),
+				    'x', pax.size(), error) ||
+		    m_file.write(pax) != pax.size() ||
+		    !WriteTarPadding(pax.size(), error)) {
+			if (error->isEmpty()) {
+				*error = "Unable to write " + m_path + ", " +
+					 m_file.errorString();
+			}
+			return false;
+		}
+	}
+
+	char header[TAR_BLOCK_SIZE];
+	memset(header, 0, sizeof(header));
+	memcpy(header, headerName.constData(), qMin(headerName.size(), 100));
+	PutOctal(header + 100, 8, type == '5' ? 0755 : 0644);
+	PutOctal(header + 108, 8, 0);
+	PutOctal(header + 116, 8, 0);
+	PutOctal(header + 124, 12, size > TAR_MAX_OCTAL_SIZE ? 0 : size);
+	PutOctal(header + 136, 12, m_created.toTime_t());
+	header[156] = type;
+	memcpy(header + 257, "ustar", 6);
+	memcpy(header + 263, "00", 2);
+	memcpy(header + 345, prefix.constData(), qMin(prefix.size(), 155));
+
+	// The checksum is calculated with its own field set to spaces
+	memset(header + 148, ' ', 8);
+	unsigned int checksum = 0;
+	for (int i = 0; i < TAR_BLOCK_SIZE; i++) {
+		checksum += (unsigned char)header[i];
+	}
+	PutOctal(header + 148, 7, checksum);
+
+	if (m_file.write(header, sizeof(header)) != (qint64)sizeof(header)) {
+		*error = "Unable to write " + m_path + ", " + m_file.errorString();
+		return false;
+	}
+	return true;
+}
+
+bool
+ArchiveWriter::WriteTarPadding(uint64_t size, QString* error)
+{
+	qint64 padding = (TAR_BLOCK_SIZE - size % TAR_BLOCK_SIZE) % TAR_BLOCK_SIZE;
+	if (m_file.write(QByteArray(padding, '\0')) != padding) {
+		*error = "Unable to write " + m_path + ", " + m_file.errorString();
+		return false;
+	}
+	return true;
+}
+
+// Entries are stored rather than compressed so the manifest's offsets point
+// at the actual data
+bool
+ArchiveWriter::OpenZipEntry(const QString& name, uint64_t size, QString* error)
+{
+	QuaZipNewInfo info(name);
+	info.dateTime = m_created;
+	m_zip->setZip64Enabled(size >= ZIP_MAX_SIZE);
+	if (!m_zipFile->open(QIODevice::WriteOnly, info, NULL, 0, 0, 0)) {
+		*error = "Unable to add " + name + " to " + m_path + ", error " +
+			 QString::number(m_zipFile->getZipError());
+		return false;
+	}
+	m_numZipEntries++;
+	return true;
+}
+
+bool
+ArchiveWriter::CloseZipEntry(QString* error)
+{
+	m_zipFile->close();
+	if (m_zipFile->getZipError() != ZIP_OK) {
+		*error = "Unable to write " + m_path + ", error " +
+			 QString::number(m_zipFile->getZipError());
+		return false;
+	}
+	return true;
+}
+
+// Correct the checksums of reserved entries in the central directory, which
+// starts at offset, once QuaZip has written it.  Its entries are in the
+// order they were added.
+bool
+ArchiveWriter::FixZipCentralDirectory(qint64 offset, QString* error)
+{
+	QFile file(m_path);
+	if (!file.open(QIODevice::ReadWrite)) {
+		*error = "Unable to write " + m_path + ", " + file.errorString();
+		return false;
+	}
+	int numFixed = 0;
+	for (int i = 0; numFixed < m_zipCrcs.size(); i++) {
+		QByteArray header;
+		if (file.seek(offset)) {
+			header = file.read(ZIP_CENTRAL_HEADER_SIZE);
+		}
+		if (header.size() != ZIP_CENTRAL_HEADER_SIZE ||
+		    GetLittleEndian(header, 0, 4) != ZIP_CENTRAL_HEADER_SIGNATURE) {
+			*error = "Unable to find entry " + QString::number(i) +
+				 " in the central directory of " + m_path;
+			return false;
+		}
+		QHash<int, quint32>::const_iterator ci = m_zipCrcs.constFind(i);
+		if (ci != m_zipCrcs.constEnd()) {
+			if (!WriteZipCrc(&file, offset + ZIP_CENTRAL_CRC_OFFSET,
+					 ci.value())) {
+				*error = "Unable to write " + m_path + ", " +
+					 file.errorString();
+				return false;
+			}
+			numFixed++;
+		}
+		offset += ZIP_CENTRAL_HEADER_SIZE +
+			  GetLittleEndian(header, ZIP_CENTRAL_NAME_LENGTH_OFFSET, 2) +
+			  GetLittleEndian(header, ZIP_CENTRAL_EXTRA_LENGTH_OFFSET, 2) +
+			  GetLittleEndian(header, ZIP_CENTRAL_COMMENT_LENGTH_OFFSET, 2);
+	}
+	return true;
+}
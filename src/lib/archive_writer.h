@@ -0,0 +1,136 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef ARCHIVE_WRITER_H
+#define ARCHIVE_WRITER_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QTextStream>
+
+#include "quazip/quazip.h"
+#include "quazip/quazipfile.h"
+
+// ArchiveWriter, writes objects as the entries of a single zip or tar file
+// instead of one file per object.  Entries are appended one after another
+// so the archive is written sequentially, apart from reserved entries.  Every entry's data is stored
+// uncompressed and its offset in the archive is written to a manifest,
+// <archive>.manifest.csv:
+//
+//   name,offset,size
+//
+// so an entry can be read straight out of the archive.  ArchiveWriter isn't
+// thread safe.
+class ArchiveWriter
+{
+public:
+	enum Format { ZIP, TAR };
+
+	// .tar archives are TAR, anything else is ZIP
+	static Format FormatFromFileName(const QString& fileName);
+
+	ArchiveWriter(const QString& path);
+	// Closes the archive if it's still open
+	~ArchiveWriter();
+
+	// Create the archive and its manifest.  Returns false and sets
+	// error if either can't be.
+	bool Open(QString* error);
+	// Finish the archive (e.g. write the zip central directory)
+	bool Close(QString* error);
+
+	Format GetFormat() const;
+	const QString& GetPath() const;
+
+	// Add a complete entry
+	bool AddEntry(const QString& name, const QByteArray& data,
+		      QString* error);
+	bool AddDirectory(const QString& name, QString* error);
+
+	// Add an entry by writing size bytes of data to the returned device
+	// between BeginEntry and EndEntry.  No other entry can be added until
+	// it's ended.
+	QIODevice* BeginEntry(const QString& name, uint64_t size,
+			      QString* error);
+	bool EndEntry(QString* error);
+
+	// Write an entry's header and leave room for its data, which can
+	// then be written in any order, and from any thread, by another
+	// handle to the archive at dataOffset.  A zip entry's room has to be
+	// filled with zeros.  FinishReservedEntry must be called once the data
+	// has all been written.
+	bool ReserveEntry(const QString& name, uint64_t size,
+			  qint64* dataOffset, QString* error);
+	// Add a reserved entry to the manifest.  A zip entry's checksum isn't
+	// known until now so it's read back and corrected in the local header
+	// now and in the central directory by Close.
+	bool FinishReservedEntry(const QString& name, qint64 dataOffset,
+				 uint64_t size, QString* error);
+
+private:
+	struct ZipReservation
+	{
+		// Position of the entry in the central directory
+		int index;
+		qint64 headerOffset;
+	};
+
+	void RecordEntry(const QString& name, qint64 dataOffset, uint64_t size);
+	bool WriteTarHeader(const QString& name, char type, uint64_t size,
+			    QString* error);
+	bool WriteTarPadding(uint64_t size, QString* error);
+	bool OpenZipEntry(const QString& name, uint64_t size, QString* error);
+	bool CloseZipEntry(QString* error);
+	bool FixZipCentralDirectory(qint64 offset, QString* error);
+
+	QString m_path;
+	Format m_format;
+	QDateTime m_created;
+	// The archive itself, which QuaZip writes to for ZIP
+	QFile m_file;
+	QuaZip* m_zip;
+	QuaZipFile* m_zipFile;
+	int m_numZipEntries;
+	// Reserved zip entries by data offset
+	QHash<qint64, ZipReservation> m_zipReservations;
+	// The checksums of finished reserved entries by their index
+	QHash<int, quint32> m_zipCrcs;
+	QFile m_manifestFile;
+	QTextStream m_manifest;
+
+	// The entry currently being written by BeginEntry
+	QString m_entryName;
+	qint64 m_entryOffset;
+	uint64_t m_entrySize;
+	bool m_open;
+};
+
+inline ArchiveWriter::Format
+ArchiveWriter::GetFormat() const
+{
+	return m_format;
+}
+
+inline const QString&
+ArchiveWriter::GetPath() const
+{
+	return m_path;
+}
+
+#endif
@@ -15,20 +15,44 @@
  */
 
 #include <stdlib.h>
+#include <algorithm>
 #include <QtConcurrent>
+#include <QBuffer>
 #include <QDir>
 #include <QDirIterator>
+#include <QElapsedTimer>
 #include <QFileInfo>
+#include <QCoreApplication>
 #include <QHash>
+#include <QLocalSocket>
+#include <QProcess>
 #include <QRegularExpression>
+#include <QScopedPointer>
+#include <QSettings>
 
+#include "helpers/time_helper.h"
+#include "lib/work_items/archive_get_work_item.h"
 #include "lib/work_items/bulk_get_work_item.h"
 #include "lib/work_items/bulk_put_work_item.h"
+#include "lib/work_items/delete_work_item.h"
+#include "lib/work_items/manifest_get_work_item.h"
+#include "lib/work_items/migration_work_item.h"
 #include "lib/work_items/object_work_item.h"
+#include "lib/work_items/stream_get_work_item.h"
+#include "lib/work_items/stream_put_work_item.h"
+#include "lib/ipc/transfer_channel.h"
+#include "lib/requests/request_engine.h"
 #include "lib/client.h"
+#include "lib/concurrency_controller.h"
+#include "lib/listing_cache.h"
+#include "lib/ring_buffer.h"
+#include "lib/stream_manifest.h"
+#include "lib/transfer_scheduler.h"
 #include "lib/logger.h"
 #include "models/ds3_url.h"
 #include "models/session.h"
+#include "quazip/quazipfile.h"
+#include "quazip/quazipfileinfo.h"
 
 using QtConcurrent::run;
 
@@ -38,11 +62,64 @@ const QString Client::DELIMITER = "/";
 // on the amount of RAM in the server.
 const uint64_t Client::BULK_PAGE_LIMIT = 100000;
 
-// 0 = don't specify it in requests and let the S3 server determine the max
+// 0 = don't specify it in requests and let the S3 server determine the max.
+// The browser picks its own page sizes with ListPageSizer.
 const uint32_t Client::MAX_KEYS = 0;
 
+// How often ProcessJobChunk checks whether a job was canceled while it's
+// waiting for a free transfer slot
+const int Client::ACQUIRE_TIMEOUT_IN_MS = 250;
+
+// Drops with no more than this many objects and bytes are transferred with
+// plain object GETs/PUTs instead of a DS3 bulk job.  Both can be overridden
+// with the transfers/fastPathMaxObjects and transfers/fastPathMaxBytes
+// settings (0 disables the fast path).
+const int Client::FAST_PATH_MAX_OBJECTS = 16;
+const uint64_t Client::FAST_PATH_MAX_BYTES = 8 * 1024 * 1024;
+
+// When the size-class planner is enabled (transfers/splitBySize), PUT files
+// at least this large (transfers/largeObjectThreshold) are moved out of the
+// page being prepared and into their own job.
+const uint64_t Client::LARGE_OBJECT_THRESHOLD = 1024 * 1024 * 1024;
+
+// Objects being GET into a zip archive that are no larger than this are
+// buffered in memory so they can be transferred in parallel and then added
+// to the archive one at a time.  Larger ones are streamed straight in to the
+// archive, holding up the others.
+const uint64_t Client::ARCHIVE_BUFFER_SIZE = 4 * 1024 * 1024;
+
+// Streamed uploads are cut in to parts of this size by default.  Up to
+// STREAM_PARTS_IN_FLIGHT parts are buffered, and transferred, at once.
+const uint64_t Client::STREAM_PART_SIZE = 64 * 1024 * 1024;
+// Each part is held in a QByteArray, whose size is an int
+const uint64_t Client::MAX_STREAM_PART_SIZE = 2047ULL * 1024 * 1024;
+const int Client::STREAM_PARTS_IN_FLIGHT = 4;
+
+// How many DS3 delete objects requests a DeleteWorkItem sends at once
+const int Client::DELETE_REQUESTS_IN_FLIGHT = 4;
+
+// How often the progress of in progress jobs is sent to the GUI.  Transfer
+// threads only report job state changes.
+const int Client::PROGRESS_INTERVAL_IN_MS = 100;
+
+// The transfer daemon's executable, which is expected to be installed
+// alongside the GUI's, and how long to wait for it to accept a connection
+const QString Client::DAEMON_NAME = "deep_storage_daemon";
+const int Client::DAEMON_CONNECT_TIMEOUT_IN_MS = 5000;
+
+// Drops with the same direction, bucket/prefix or destination made within
+// this long of each other are merged into a single job
+const int Client::COALESCE_WINDOW_IN_MS = 2000;
+
 static size_t read_from_file(void* buffer, size_t size, size_t count, void* user_data);
 static size_t write_to_file(void* buffer, size_t size, size_t count, void* user_data);
+static size_t read_from_ring_buffer(void* buffer, size_t size, size_t count, void* user_data);
+static size_t write_to_ring_buffer(void* buffer, size_t size, size_t count, void* user_data);
+
+// Every Client in this process so a migration can find the Client of the
+// session the objects were dragged from
+static QList<Client*> s_clients;
+static QMutex s_clientsLock;
 
 // Simple struct to wrap a Client and an ObjectWorkItem so the C SDK can
 // send both to the file read/write callback functions.
@@ -52,32 +129,173 @@ struct ClientAndObjectWorkItem
 	ObjectWorkItem* objectWorkItem;
 };
 
+// The data of a migrated object's blob as it passes through a RingBuffer.
+// The source GET skips the bytes of its blob that come before the target
+// blob and drops the ones after it.
+struct MigrationStream
+{
+	MigrationWorkItem* workItem;
+	RingBuffer* buffer;
+	uint64_t skip;
+	uint64_t remaining;
+};
+
 Client::Client(const Session* session)
+	: m_listingCache(NULL),
+	  m_session(*session),
+	  m_daemon(NULL),
+	  m_sessionID(QUuid::createUuid()),
+	  m_daemonSocket(NULL),
+	  m_daemonStarted(false)
 {
 	m_creds = ds3_create_creds(session->GetAccessId().toUtf8().constData(),
 				   session->GetSecretKey().toUtf8().constData());
 
-	QString protocol = session->GetProtocolName();
 	m_host = session->GetHost();
-	m_endpoint = protocol + "://" + m_host;
-	QString port = session->GetPort();
-	if (!port.isEmpty() && port != "80" && port != "443") {
-		m_endpoint += ":" + port;
-	}
+	m_endpoint = BuildEndpoint(session, m_host);
 
-	m_client = ds3_create_client(m_endpoint.toUtf8().constData(), m_creds);
 	QString proxy = session->GetProxy();
-	if (!proxy.isEmpty()) {
-		ds3_client_proxy(m_client, proxy.toUtf8().constData());
+	m_client = CreateDS3Client(m_endpoint, proxy);
+
+	m_requestEngine = new RequestEngine(m_endpoint, session);
+
+	m_coalesceTimer = new QTimer(this);
+	m_coalesceTimer->setInterval(COALESCE_WINDOW_IN_MS / 4);
+	connect(m_coalesceTimer, SIGNAL(timeout()),
+		this, SLOT(SubmitCoalescedWorkItems()));
+
+	m_progressTimer = new QTimer(this);
+	m_progressTimer->setInterval(PROGRESS_INTERVAL_IN_MS);
+	connect(m_progressTimer, SIGNAL(timeout()),
+		this, SLOT(EmitJobProgress()));
+	m_progressTimer->start();
+
+	// Every job's ConcurrencyController is bounded by MAX_LIMIT so this
+	// many threads can keep at least one job at its maximum.
+	m_transferPool.setMaxThreadCount(ConcurrencyController::MAX_LIMIT);
+
+	// Object data is striped across the primary endpoint and any
+	// additional data interfaces.  Each data path gets its own C SDK
+	// client (and thus its own curl connection) so that transfers
+	// through different interfaces don't serialize on each other.
+	QStringList dataHosts = session->GetDataHosts();
+	dataHosts.prepend(m_host);
+	dataHosts.removeDuplicates();
+	for (int i = 0; i < dataHosts.size(); i++) {
+		DataPath dataPath;
+		dataPath.endpoint = BuildEndpoint(session, dataHosts.at(i));
+		dataPath.client = CreateDS3Client(dataPath.endpoint, proxy);
+		dataPath.outstandingBytes = 0;
+		m_dataPaths << dataPath;
+		if (i > 0) {
+			LOG_DEBUG("Using additional data path " + dataPath.endpoint);
+		}
 	}
+
+	s_clientsLock.lock();
+	s_clients << this;
+	s_clientsLock.unlock();
 }
 
 Client::~Client()
 {
+	s_clientsLock.lock();
+	s_clients.removeAll(this);
+	s_clientsLock.unlock();
+	TransferScheduler::Instance()->RemoveClient(this);
+	m_transferPool.waitForDone();
+	delete m_requestEngine;
+	delete m_listingCache;
+	for (int i = 0; i < m_dataPaths.size(); i++) {
+		ds3_free_client(m_dataPaths[i].client);
+	}
 	ds3_free_creds(m_creds);
 	ds3_free_client(m_client);
 }
 
+Client*
+Client::FindClient(const QUrl& url)
+{
+	QUrl endpoint = url.adjusted(QUrl::RemovePath | QUrl::RemoveQuery |
+				     QUrl::RemoveFragment);
+	Client* client = NULL;
+	s_clientsLock.lock();
+	for (int i = 0; i < s_clients.size() && client == NULL; i++) {
+		if (QUrl(s_clients[i]->GetEndpoint()) == endpoint) {
+			client = s_clients[i];
+		}
+	}
+	s_clientsLock.unlock();
+	return client;
+}
+
+QString
+Client::BuildEndpoint(const Session* session, const QString& host)
+{
+	QString endpoint = session->GetProtocolName() + "://" + host;
+	QString port = session->GetPort();
+	if (!port.isEmpty() && port != "80" && port != "443") {
+		endpoint += ":" + port;
+	}
+	return endpoint;
+}
+
+ds3_client*
+Client::CreateDS3Client(const QString& endpoint, const QString& proxy)
+{
+	ds3_client* client = ds3_create_client(endpoint.toUtf8().constData(),
+					       m_creds);
+	if (!proxy.isEmpty()) {
+		ds3_client_proxy(client, proxy.toUtf8().constData());
+	}
+	return client;
+}
+
+ConcurrencyController*
+Client::CreateConcurrencyController() const
+{
+	QSettings settings;
+	int min = settings.value("transfers/minConcurrency",
+				 ConcurrencyController::DEFAULT_MIN).toInt();
+	int max = settings.value("transfers/maxConcurrency",
+				 ConcurrencyController::DEFAULT_MAX).toInt();
+	return new ConcurrencyController(min, max);
+}
+
+bool
+Client::IsSplitBySizeEnabled() const
+{
+	QSettings settings;
+	return settings.value("transfers/splitBySize", false).toBool();
+}
+
+// Pick the data path with the fewest bytes currently being transferred
+// through it and account for the given transfer against it.  The returned
+// index must be passed to ReleaseDataPath once the transfer is done.
+int
+Client::AcquireDataPath(uint64_t length)
+{
+	m_dataPathsLock.lock();
+	int index = 0;
+	for (int i = 1; i < m_dataPaths.size(); i++) {
+		if (m_dataPaths[i].outstandingBytes <
+		    m_dataPaths[index].outstandingBytes) {
+			index = i;
+		}
+	}
+	m_dataPaths[index].outstandingBytes += length;
+	m_dataPathsLock.unlock();
+	return index;
+}
+
+void
+Client::ReleaseDataPath(int index, uint64_t length)
+{
+	m_dataPathsLock.lock();
+	m_dataPaths[index].outstandingBytes -= length;
+	m_dataPathsLock.unlock();
+}
+
 int
 Client::GetNumActiveJobs() const
 {
@@ -90,6 +308,17 @@ Client::GetNumActiveJobs() const
 void
 Client::CancelActiveJobs()
 {
+	QList<BulkWorkItem*> queued;
+	QHashIterator<QString, CoalescingWorkItem> ci(m_coalescing);
+	while (ci.hasNext()) {
+		ci.next();
+		BulkWorkItem* workItem = ci.value().workItem;
+		workItem->SetState(Job::CANCELING);
+		queued << workItem;
+	}
+	m_coalescing.clear();
+	m_coalesceTimer->stop();
+
 	m_bulkWorkItemsLock.lock();
 	QHashIterator<QUuid, BulkWorkItem*> i(m_bulkWorkItems);
 	while (i.hasNext()) {
@@ -99,30 +328,68 @@ Client::CancelActiveJobs()
 		if (state != Job::CANCELING && state != Job::CANCELED &&
 		    state != Job::FINISHED) {
 			workItem->SetState(Job::CANCELING);
+			if (TransferScheduler::Instance()->Dequeue(workItem)) {
+				queued << workItem;
+			}
 		}
 	}
 	m_bulkWorkItemsLock.unlock();
+
+	for (int j = 0; j < queued.size(); j++) {
+		DeleteOrRequeueBulkWorkItem(queued.at(j));
+	}
 }
 
-QFuture<ds3_get_service_response*>
+QFuture<ServiceListing>
 Client::GetService()
 {
-	QFuture<ds3_get_service_response*> future = run(this, &Client::DoGetService);
-	return future;
+	LOG_INFO("BULK GET     BUCKETS   "+m_endpoint);
+	return m_requestEngine->GetService();
 }
 
-QFuture<ds3_get_bucket_response*>
+QFuture<BucketListing>
 Client::GetBucket(const QString& bucketName, const QString& prefix,
-		  const QString& marker, bool silent, const QString& delimiter)
+		  const QString& marker, bool silent, const QString& delimiter,
+		  uint32_t maxKeys)
+{
+	LOG_DEBUG("GET          Bucket    " + bucketName +
+		  ", prefix: " + prefix + ", marker: " + marker);
+
+	QString logFileMsg = "BULK GET     OBJECTS   "+m_endpoint+"/";
+	logFileMsg += bucketName;
+	QStringList logQueryParams;
+	if (!prefix.isEmpty()) {
+		logQueryParams << "prefix=" + prefix;
+	}
+	if (!delimiter.isEmpty()) {
+		logQueryParams << "delimiter=" + delimiter;
+	}
+	if (!marker.isEmpty()) {
+		logQueryParams << "marker=" + marker;
+	}
+	if (maxKeys > 0) {
+		logQueryParams << "max-keys=" + QString::number(maxKeys);
+	}
+	if (!logQueryParams.isEmpty()) {
+		logFileMsg += "&"+logQueryParams.join("&");
+	}
+	if (!silent) {
+		LOG_INFO(logFileMsg);
+	}
+
+	return m_requestEngine->GetBucket(bucketName, prefix, delimiter,
+					  marker, maxKeys);
+}
+
+ListingCache*
+Client::GetListingCache()
 {
-	QFuture<ds3_get_bucket_response*> future = run(this,
-						       &Client::DoGetBucket,
-						       bucketName,
-						       prefix,
-						       delimiter,
-						       marker,
-						       silent);
-	return future;
+	if (m_listingCache == NULL) {
+		QString dir = ListingCache::GetDefaultDir(m_endpoint,
+							  m_session.GetAccessId());
+		m_listingCache = new ListingCache(dir);
+	}
+	return m_listingCache;
 }
 
 void
@@ -159,7 +426,12 @@ void
 Client::DeleteObjects(const QString& bucketName, const QStringList& objectNames)
 {
 	ds3_request* request = ds3_init_delete_objects(bucketName.toUtf8().constData());
-	LOG_INFO("DELETE       OBJECTS    "+bucketName+"/{"+objectNames.join(",")+"}");
+	if (objectNames.size() <= 10) {
+		LOG_INFO("DELETE       OBJECTS    "+bucketName+"/{"+objectNames.join(",")+"}");
+	} else {
+		LOG_INFO("DELETE       OBJECTS    "+bucketName+"/{"+objectNames.first()+",...} (" +
+			 QString::number(objectNames.size()) + " objects)");
+	}
 
 	ds3_bulk_object_list *bulkObjList = ds3_init_bulk_object_list(objectNames.size());
 
@@ -172,6 +444,7 @@ Client::DeleteObjects(const QString& bucketName, const QStringList& objectNames)
 	ds3_error* ds3Error = ds3_delete_objects(m_client, request, bulkObjList);
 
 	ds3_free_request(request);
+	ds3_free_bulk_object_list(bulkObjList);
 
 	if (ds3Error != NULL) {
 		DS3Error error(ds3Error);
@@ -198,34 +471,401 @@ Client::DeleteFolders(const QString& bucketName, const QStringList& folderNames)
 	}
 }
 
+QUuid
+Client::BulkDelete(const QString& bucketName,
+		   const QStringList& objectNames,
+		   bool deleteBucket)
+{
+	QList<QUrl> urls;
+	if (objectNames.isEmpty()) {
+		urls << DS3URL(m_endpoint, "/" + bucketName + "/");
+	}
+	for (int i = 0; i < objectNames.size(); i++) {
+		urls << DS3URL(m_endpoint, "/" + bucketName + "/" + objectNames[i]);
+	}
+	DeleteWorkItem* workItem = new DeleteWorkItem(m_host, urls, deleteBucket);
+	workItem->SetBucketName(bucketName);
+	// Deletes don't move any data so they shouldn't wait long behind
+	// transfers
+	workItem->SetPriority(TransferScheduler::HIGH);
+	return SubmitWorkItem(workItem);
+}
+
+void
+Client::AttachToDaemon()
+{
+	if (m_daemon != NULL || m_daemonSocket != NULL) {
+		return;
+	}
+	m_daemonSocket = new QLocalSocket(this);
+	connect(m_daemonSocket, SIGNAL(connected()),
+		this, SLOT(HandleDaemonConnected()));
+	connect(m_daemonSocket, SIGNAL(error(QLocalSocket::LocalSocketError)),
+		this, SLOT(HandleDaemonConnectError()));
+	m_daemonConnectTimer.start();
+	ConnectToDaemon();
+}
+
+void
+Client::ConnectToDaemon()
+{
+	if (m_daemonSocket != NULL) {
+		m_daemonSocket->connectToServer(TransferChannel::SERVER_NAME);
+	}
+}
+
+// The daemon is started the first time it can't be reached and then
+// retried, from the event loop so the GUI never waits on it, until
+// DAEMON_CONNECT_TIMEOUT_IN_MS has passed.
+void
+Client::HandleDaemonConnectError()
+{
+	if (m_daemonSocket == NULL) {
+		return;
+	}
+	if (!m_daemonStarted) {
+		m_daemonStarted = true;
+		QString daemon = QCoreApplication::applicationDirPath() + "/" + DAEMON_NAME;
+		LOG_INFO("Starting the transfer daemon, " + daemon);
+		if (QProcess::startDetached(daemon)) {
+			m_daemonConnectTimer.restart();
+		} else {
+			m_daemonConnectTimer.invalidate();
+		}
+	}
+	if (!m_daemonConnectTimer.isValid() ||
+	    m_daemonConnectTimer.hasExpired(DAEMON_CONNECT_TIMEOUT_IN_MS)) {
+		LOG_WARNING("Unable to connect to the transfer daemon.  " \
+			    "Jobs will only run while the application is open.");
+		disconnect(m_daemonSocket, 0, this, 0);
+		m_daemonSocket->deleteLater();
+		m_daemonSocket = NULL;
+		return;
+	}
+	QTimer::singleShot(DAEMON_CONNECT_TIMEOUT_IN_MS / 20,
+			   this, SLOT(ConnectToDaemon()));
+}
+
+void
+Client::HandleDaemonConnected()
+{
+	LOG_INFO("Connected to the transfer daemon");
+	disconnect(m_daemonSocket, 0, this, 0);
+	m_daemon = new TransferChannel(m_daemonSocket, this);
+	m_daemonSocket = NULL;
+	connect(m_daemon, SIGNAL(JobUpdated(const Job&)),
+		this, SLOT(HandleDaemonJobUpdate(const Job&)));
+	connect(m_daemon, SIGNAL(Disconnected()),
+		this, SLOT(DetachFromDaemon()));
+	m_daemon->Attach(m_sessionID, m_session);
+}
+
+void
+Client::HandleDaemonJobUpdate(const Job& job)
+{
+	// The daemon only sends a session its own jobs but make sure since
+	// other sessions might be for the same host
+	if (job.GetSessionID() != m_sessionID) {
+		return;
+	}
+	if (job.IsFinished() || job.WasCanceled()) {
+		m_daemonJobs.remove(job.GetID());
+	} else {
+		m_daemonJobs.insert(job.GetID());
+	}
+	emit JobProgressUpdate(job);
+}
+
 void
-Client::BulkGet(const QList<QUrl> urls, const QString& destination)
+Client::DetachFromDaemon()
 {
+	LOG_WARNING("Lost the connection to the transfer daemon.  New jobs " \
+		    "will only run while the application is open.");
+	m_daemon->deleteLater();
+	m_daemon = NULL;
+	m_daemonJobs.clear();
+}
+
+void
+Client::BulkGet(const QList<QUrl> urls, const QString& destination,
+		const TransferFilter& filter, const QUuid& sessionID)
+{
+	if (m_daemon != NULL) {
+		m_daemon->SubmitGet(m_session, urls, destination, filter);
+		return;
+	}
+
+	QString key = "GET " + sessionID.toString() + " " + destination + " " +
+		      filter.ToString();
+	bool fastPath = IsFastPathDrop(urls, true);
+	if (!fastPath && m_coalescing.contains(key)) {
+		BulkWorkItem* workItem = m_coalescing[key].workItem;
+		LOG_DEBUG("Coalescing GET into job " + workItem->GetID().toString());
+		workItem->AppendURLs(urls);
+		Job job = workItem->ToJob();
+		emit JobProgressUpdate(job);
+		return;
+	}
+
 	BulkGetWorkItem* workItem = new BulkGetWorkItem(m_host, urls,
 							destination);
-	m_bulkWorkItemsLock.lock();
-	m_bulkWorkItems[workItem->GetID()] = workItem;
-	m_bulkWorkItemsLock.unlock();
-	workItem->SetState(Job::QUEUED);
-	Job job = workItem->ToJob();
-	emit JobProgressUpdate(job);
-	run(this, &Client::PrepareBulkGets, workItem);
+	workItem->SetFilter(filter);
+	workItem->SetSessionID(sessionID);
+	workItem->SetConcurrencyController(CreateConcurrencyController());
+	ApplyChunkOrdering(workItem);
+	RegisterWorkItem(workItem);
+	if (fastPath) {
+		// Waiting to coalesce, or in the TransferScheduler's queue,
+		// would take longer than the transfer itself
+		StartBulkWorkItem(workItem);
+		return;
+	}
+	StartCoalescing(key, workItem);
+}
+
+QUuid
+Client::ManifestGet(const QString& manifestPath,
+		    const QString& destination,
+		    const QString& reportPath)
+{
+	ManifestGetWorkItem* workItem = new ManifestGetWorkItem(m_host,
+								manifestPath,
+								destination,
+								reportPath);
+	QString error;
+	if (!workItem->Open(&error)) {
+		LOG_ERROR("ERROR:       " + error);
+		delete workItem;
+		return QUuid();
+	}
+	workItem->SetConcurrencyController(CreateConcurrencyController());
+	ApplyChunkOrdering(workItem);
+	// Not coalesced since each manifest has its own report
+	return SubmitWorkItem(workItem);
+}
+
+QUuid
+Client::ArchiveGet(const QList<QUrl> urls, const QString& archivePath)
+{
+	ArchiveGetWorkItem* workItem = new ArchiveGetWorkItem(m_host, urls,
+							      archivePath);
+	QString error;
+	if (!workItem->Open(&error)) {
+		LOG_ERROR("ERROR:       " + error);
+		delete workItem;
+		return QUuid();
+	}
+	workItem->SetConcurrencyController(CreateConcurrencyController());
+	ApplyChunkOrdering(workItem);
+	// Not coalesced since each job has its own archive
+	return SubmitWorkItem(workItem);
+}
+
+QUuid
+Client::StreamPut(QIODevice* input,
+		  const QString& bucketName,
+		  const QString& objName,
+		  uint64_t partSize)
+{
+	if (partSize == 0 || partSize > MAX_STREAM_PART_SIZE) {
+		uint64_t clamped = partSize == 0 ? STREAM_PART_SIZE :
+						   MAX_STREAM_PART_SIZE;
+		LOG_WARNING("Stream part size " +
+			    QString::number(partSize) + " is out of range, using " +
+			    QString::number(clamped));
+		partSize = clamped;
+	}
+	StreamPutWorkItem* workItem = new StreamPutWorkItem(m_host, input,
+							    bucketName, objName,
+							    partSize);
+	return SubmitWorkItem(workItem);
+}
+
+QUuid
+Client::StreamGet(const QString& bucketName,
+		  const QString& objName,
+		  QIODevice* output,
+		  const QString& destination)
+{
+	StreamGetWorkItem* workItem = new StreamGetWorkItem(m_host, bucketName,
+							    objName, output,
+							    destination);
+	return SubmitWorkItem(workItem);
 }
 
 void
 Client::BulkPut(const QString& bucketName,
 		const QString& prefix,
-		const QList<QUrl> urls)
+		const QList<QUrl> urls,
+		const TransferFilter& filter,
+		TransferScheduler::Priority priority,
+		const QUuid& sessionID)
 {
+	if (m_daemon != NULL) {
+		m_daemon->SubmitPut(m_session, bucketName, prefix, urls, filter,
+				    priority);
+		return;
+	}
+
+	QString key = "PUT " + sessionID.toString() + " " +
+		      QString::number(priority) + " " + bucketName + "/" +
+		      prefix + " " + filter.ToString();
+	bool fastPath = IsFastPathDrop(urls, false);
+	if (!fastPath && m_coalescing.contains(key)) {
+		BulkWorkItem* workItem = m_coalescing[key].workItem;
+		LOG_DEBUG("Coalescing PUT into job " + workItem->GetID().toString());
+		workItem->AppendURLs(urls);
+		Job job = workItem->ToJob();
+		emit JobProgressUpdate(job);
+		return;
+	}
+
 	BulkPutWorkItem* workItem = new BulkPutWorkItem(m_host, urls,
 							bucketName, prefix);
+	workItem->SetFilter(filter);
+	workItem->SetPriority(priority);
+	workItem->SetSessionID(sessionID);
+	workItem->SetConcurrencyController(CreateConcurrencyController());
+	RegisterWorkItem(workItem);
+	if (fastPath) {
+		StartBulkWorkItem(workItem);
+		return;
+	}
+	StartCoalescing(key, workItem);
+}
+
+void
+Client::Migrate(Client* source,
+		const QList<QUrl> urls,
+		const QString& bucketName,
+		const QString& prefix)
+{
+	MigrationWorkItem* workItem = new MigrationWorkItem(m_host, source, urls,
+							    bucketName, prefix);
+	// Copies between systems are background work that shouldn't hold up
+	// the user's own transfers
+	workItem->SetPriority(TransferScheduler::LOW);
+	workItem->SetConcurrencyController(CreateConcurrencyController());
+	SubmitWorkItem(workItem);
+}
+
+// Track a new work item and report it as queued.  Returns its job's ID.
+QUuid
+Client::RegisterWorkItem(BulkWorkItem* workItem)
+{
 	m_bulkWorkItemsLock.lock();
 	m_bulkWorkItems[workItem->GetID()] = workItem;
 	m_bulkWorkItemsLock.unlock();
 	workItem->SetState(Job::QUEUED);
 	Job job = workItem->ToJob();
 	emit JobProgressUpdate(job);
-	run(this, &Client::PrepareBulkPuts, workItem);
+	return job.GetID();
+}
+
+// RegisterWorkItem and hand it straight to the TransferScheduler without
+// coalescing it
+QUuid
+Client::SubmitWorkItem(BulkWorkItem* workItem)
+{
+	QUuid jobID = RegisterWorkItem(workItem);
+	TransferScheduler::Instance()->Submit(this, workItem);
+	return jobID;
+}
+
+void
+Client::ApplyChunkOrdering(BulkGetWorkItem* workItem)
+{
+	QSettings settings;
+	if (settings.value("transfers/chunkOrdering").toString() == "inOrder") {
+		workItem->SetChunkOrdering(IN_ORDER);
+	}
+}
+
+void
+Client::StartCoalescing(const QString& key, BulkWorkItem* workItem)
+{
+	CoalescingWorkItem coalescing;
+	coalescing.workItem = workItem;
+	coalescing.age.start();
+	m_coalescing.insert(key, coalescing);
+	if (!m_coalesceTimer->isActive()) {
+		m_coalesceTimer->start();
+	}
+}
+
+void
+Client::SubmitCoalescedWorkItems()
+{
+	QMutableHashIterator<QString, CoalescingWorkItem> i(m_coalescing);
+	while (i.hasNext()) {
+		i.next();
+		if (i.value().age.hasExpired(COALESCE_WINDOW_IN_MS)) {
+			BulkWorkItem* workItem = i.value().workItem;
+			i.remove();
+			TransferScheduler::Instance()->Submit(this, workItem);
+		}
+	}
+	if (m_coalescing.isEmpty()) {
+		m_coalesceTimer->stop();
+	}
+}
+
+void
+Client::EmitJobProgress()
+{
+	QList<Job> jobs;
+	QHash<QUuid, Job> lastProgress;
+	m_bulkWorkItemsLock.lock();
+	QHash<QUuid, BulkWorkItem*>::const_iterator wi;
+	for (wi = m_bulkWorkItems.constBegin(); wi != m_bulkWorkItems.constEnd(); wi++) {
+		if (wi.value()->GetState() != Job::INPROGRESS) {
+			continue;
+		}
+		Job job = wi.value()->ToProgressJob();
+		lastProgress[wi.key()] = job;
+		if (!m_lastProgress.contains(wi.key()) ||
+		    !m_lastProgress[wi.key()].HasSameProgress(job)) {
+			jobs << job;
+		}
+	}
+	m_bulkWorkItemsLock.unlock();
+	// Also drops the jobs that are no longer in progress
+	m_lastProgress = lastProgress;
+
+	// Emitted outside the lock since slots might call back into Client
+	for (int i = 0; i < jobs.size(); i++) {
+		emit JobProgressUpdate(jobs[i]);
+	}
+}
+
+BulkWorkItem*
+Client::TakeCoalescingWorkItem(const QUuid& workItemID)
+{
+	QMutableHashIterator<QString, CoalescingWorkItem> i(m_coalescing);
+	while (i.hasNext()) {
+		i.next();
+		BulkWorkItem* workItem = i.value().workItem;
+		if (workItem->GetID() == workItemID) {
+			i.remove();
+			return workItem;
+		}
+	}
+	return NULL;
+}
+
+void
+Client::StartBulkWorkItem(BulkWorkItem* workItem)
+{
+	if (workItem->GetType() == Job::GET) {
+		run(this, &Client::PrepareBulkGets,
+		    static_cast<BulkGetWorkItem*>(workItem));
+	} else if (workItem->GetType() == Job::DELETE_OBJECTS) {
+		run(this, &Client::DoBulkDelete,
+		    static_cast<DeleteWorkItem*>(workItem));
+	} else {
+		run(this, &Client::PrepareBulkPuts,
+		    static_cast<BulkPutWorkItem*>(workItem));
+	}
 }
 
 void
@@ -233,6 +873,7 @@ Client::GetObject(const QString& bucket,
 		  const QString& object,
 		  const QString& fileName,
 		  uint64_t offset,
+		  uint64_t length,
 		  BulkGetWorkItem* bulkGetWorkItem)
 {
 	QDir dir(fileName);
@@ -248,24 +889,46 @@ Client::GetObject(const QString& bucket,
 		}
 	}
 
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadWrite)) {
+		LOG_ERROR("ERROR:       GET OBJECT failed, unable to open file "+fileName);
+		return;
+	}
+	file.seek(offset);
+	GetObjectData(bucket, object, &file, offset, length, bulkGetWorkItem);
+}
+
+// GET an object, or the blob of one at offset, into an open device that's
+// already positioned where the data belongs
+void
+Client::GetObjectData(const QString& bucket,
+		      const QString& object,
+		      QIODevice* device,
+		      uint64_t offset,
+		      uint64_t length,
+		      BulkGetWorkItem* bulkGetWorkItem)
+{
+	// Work items that took the fast path don't have a job
 	QString jobID = bulkGetWorkItem->GetJobID();
-	ds3_request* request = ds3_init_get_object_for_job(bucket.toUtf8().constData(),
-							   object.toUtf8().constData(),
-							   offset,
-							   jobID.toUtf8().constData());
-	ds3_error* ds3Error = NULL;
-	ObjectWorkItem objWorkItem(bucket, object, fileName, bulkGetWorkItem);
+	ds3_request* request;
+	if (jobID.isEmpty()) {
+		request = ds3_init_get_object(bucket.toUtf8().constData(),
+					      object.toUtf8().constData(),
+					      length);
+	} else {
+		request = ds3_init_get_object_for_job(bucket.toUtf8().constData(),
+						      object.toUtf8().constData(),
+						      offset,
+						      jobID.toUtf8().constData());
+	}
+	ObjectWorkItem objWorkItem(bucket, object, device, bulkGetWorkItem);
 	ClientAndObjectWorkItem caowi;
 	caowi.client = this;
 	caowi.objectWorkItem = &objWorkItem;
-	if (objWorkItem.OpenFile(QIODevice::ReadWrite)) {
-		objWorkItem.SeekFile(offset);
-		ds3Error = ds3_get_object(m_client, request,
-					  &caowi, write_to_file);
-	} else {
-		LOG_ERROR("ERROR:       GET OBJECT failed, unable to open file "+fileName);
-	}
-
+	int dataPath = AcquireDataPath(length);
+	ds3_error* ds3Error = ds3_get_object(m_dataPaths[dataPath].client,
+					     request, &caowi, write_to_file);
+	ReleaseDataPath(dataPath, length);
 	ds3_free_request(request);
 
 	if (ds3Error != NULL) {
@@ -275,50 +938,197 @@ Client::GetObject(const QString& bucket,
 	}
 }
 
-QFuture<ds3_get_objects_response*>
-Client::GetObjects(const QString& bucketName, const QString& id,
-		  const QString& name, object_type type, const QString& version)
-{
-	QFuture<ds3_get_objects_response*> future = run(this,
-						       &Client::DoGetObjects,
-						       bucketName,
-						       id,
-						       name,
-						       type,
-						       version);
-	return future;
-}
-
+// GET an object, or a blob of one, in to its entry in the work item's
+// archive.  See ArchiveGetWorkItem.
 void
-Client::PutObject(const QString& bucket,
-		  const QString& object,
-		  const QString& fileName,
-		  uint64_t offset,
-		  uint64_t length,
-		  BulkPutWorkItem* workItem)
+Client::ArchiveObject(ArchiveGetWorkItem* workItem, const QString& objName,
+		      const QString& filePath, uint64_t offset,
+		      uint64_t length)
 {
-	QString jobID = workItem->GetJobID();
-	ds3_request* request = ds3_init_put_object_for_job(bucket.toUtf8().constData(),
-							   object.toUtf8().constData(),
-							   offset, length,
-							   jobID.toUtf8().constData());
-	ds3_error* ds3Error = NULL;
-	QFileInfo fileInfo(fileName);
-	if (fileInfo.isDir()) {
-		// "folder" objects don't have a size nor do they have any
-		// data associated with them
-		ds3Error = ds3_put_object(m_client, request, NULL, NULL);
-	} else {
-		ObjectWorkItem objWorkItem(bucket, object, fileName, workItem);
-		ClientAndObjectWorkItem caowi;
-		caowi.client = this;
-		caowi.objectWorkItem = &objWorkItem;
-		if (objWorkItem.OpenFile(QIODevice::ReadOnly)) {
-			objWorkItem.SeekFile(offset);
-			ds3Error = ds3_put_object(m_client, request,
-						  &caowi, read_from_file);
-		} else {
-			LOG_ERROR("ERROR:       PUT OBJECT failed, unable to open file "+fileName);
+	QString bucketName = workItem->GetBucketName();
+	QString entryName = workItem->GetEntryName(filePath);
+	QString error;
+	if (objName.endsWith("/")) {
+		if (!workItem->AddDirectory(entryName, &error)) {
+			throw DS3Error(error);
+		}
+		return;
+	}
+
+	uint64_t size = length;
+	workItem->GetObjSize(objName, &size);
+	ArchiveWriter* writer = workItem->GetWriter();
+	if (writer->GetFormat() == ArchiveWriter::TAR || length < size) {
+		qint64 dataOffset = 0;
+		if (!workItem->ReserveEntry(entryName, size, &dataOffset, &error)) {
+			throw DS3Error(error);
+		}
+		// Each blob is written through its own handle so they don't
+		// have to wait for each other
+		QFile archive(writer->GetPath());
+		if (!archive.open(QIODevice::ReadWrite) ||
+		    !archive.seek(dataOffset + offset)) {
+			throw DS3Error("Unable to write " + writer->GetPath() +
+				       ", " + archive.errorString());
+		}
+		GetObjectData(bucketName, objName, &archive, offset, length,
+			      workItem);
+		if (!archive.flush()) {
+			throw DS3Error("Unable to write " + writer->GetPath() +
+				       ", " + archive.errorString());
+		}
+		archive.close();
+		if (!workItem->AddReservedBytes(entryName, length, &error)) {
+			throw DS3Error(error);
+		}
+	} else if (length <= ARCHIVE_BUFFER_SIZE) {
+		QBuffer buffer;
+		buffer.open(QIODevice::WriteOnly);
+		GetObjectData(bucketName, objName, &buffer, offset, length,
+			      workItem);
+		QMutexLocker locker(workItem->GetWriterLock());
+		if (!writer->AddEntry(entryName, buffer.data(), &error)) {
+			throw DS3Error(error);
+		}
+	} else {
+		// Streamed straight in to the archive.  Other entries wait for
+		// the writer until it's done.
+		QMutexLocker locker(workItem->GetWriterLock());
+		QIODevice* entry = writer->BeginEntry(entryName, length, &error);
+		if (entry == NULL) {
+			throw DS3Error(error);
+		}
+		try {
+			GetObjectData(bucketName, objName, entry, offset, length,
+				      workItem);
+		}
+		catch (DS3Error&) {
+			// The partial entry is left out of the manifest
+			writer->EndEntry(&error);
+			throw;
+		}
+		if (!writer->EndEntry(&error)) {
+			throw DS3Error(error);
+		}
+	}
+}
+
+QFuture<BucketListing>
+Client::GetObjects(const QString& bucketName, const QString& id,
+		  const QString& name, object_type type, const QString& version)
+{
+	LOG_DEBUG("GetObjects - bucket: " + bucketName +
+		  ", name: " + name);
+
+	QString logMsg = "List Objects (GET " + m_endpoint + "/";
+	logMsg += bucketName;
+	QStringList logQueryParams;
+	if (!name.isEmpty()) {
+		logQueryParams << "name=" + name;
+	}
+	if (!id.isEmpty()) {
+		logQueryParams << "id=" + id;
+	}
+	if (type == DATA) {
+		logQueryParams << "type=DATA";
+	}
+	if (!version.isEmpty()) {
+		logQueryParams << "version=" + version;
+	}
+	if (!logQueryParams.isEmpty()) {
+		logMsg += "&" + logQueryParams.join("&");
+	}
+	logMsg += ")";
+	LOG_INFO(logMsg);
+
+	return m_requestEngine->GetObjects(bucketName, id, name, type, version);
+}
+
+void
+Client::PutObject(const QString& bucket,
+		  const QString& object,
+		  const QString& fileName,
+		  uint64_t offset,
+		  uint64_t length,
+		  BulkPutWorkItem* workItem)
+{
+	// Work items that took the fast path don't have a job
+	QString jobID = workItem->GetJobID();
+	ds3_request* request;
+	if (jobID.isEmpty()) {
+		request = ds3_init_put_object(bucket.toUtf8().constData(),
+					      object.toUtf8().constData(),
+					      length);
+	} else {
+		request = ds3_init_put_object_for_job(bucket.toUtf8().constData(),
+						      object.toUtf8().constData(),
+						      offset, length,
+						      jobID.toUtf8().constData());
+	}
+	ds3_error* ds3Error = NULL;
+	QString zipPath;
+	QString memberName;
+	bool isZipMember = workItem->GetZipMember(object, &zipPath, &memberName);
+	bool isDir;
+	if (isZipMember) {
+		// The archive's own folder object has no member name
+		isDir = memberName.isEmpty() || memberName.endsWith("/");
+	} else {
+		isDir = QFileInfo(fileName).isDir();
+	}
+	if (isDir) {
+		// "folder" objects don't have a size nor do they have any
+		// data associated with them
+		int dataPath = AcquireDataPath(0);
+		ds3Error = ds3_put_object(m_dataPaths[dataPath].client,
+					  request, NULL, NULL);
+		ReleaseDataPath(dataPath, 0);
+	} else {
+		// Zip members are decompressed straight from the archive.
+		// Their data can't be seeked so the blobs of a member split
+		// into more than one are read from a decompressor they share.
+		uint64_t size = length;
+		bool shared = isZipMember && workItem->GetObjSize(object, &size) &&
+			      length < size;
+		QString readerError;
+		QuaZipFile member(zipPath, memberName, QuaZip::csSensitive);
+		QScopedPointer<ObjectWorkItem> objWorkItem;
+		bool opened;
+		if (shared) {
+			QuaZipFile* reader = workItem->AcquireZipReader(object, offset,
+									&readerError);
+			objWorkItem.reset(new ObjectWorkItem(bucket, object,
+							     reader, workItem));
+			opened = reader != NULL;
+		} else if (isZipMember) {
+			objWorkItem.reset(new ObjectWorkItem(bucket, object,
+							     &member, workItem));
+			opened = member.open(QIODevice::ReadOnly);
+		} else {
+			objWorkItem.reset(new ObjectWorkItem(bucket, object,
+							     fileName, workItem));
+			opened = objWorkItem->OpenFile(QIODevice::ReadOnly) &&
+				 objWorkItem->SeekFile(offset);
+		}
+		ClientAndObjectWorkItem caowi;
+		caowi.client = this;
+		caowi.objectWorkItem = objWorkItem.data();
+		if (opened) {
+			int dataPath = AcquireDataPath(length);
+			ds3Error = ds3_put_object(m_dataPaths[dataPath].client,
+						  request, &caowi,
+						  read_from_file);
+			ReleaseDataPath(dataPath, length);
+		} else if (!readerError.isEmpty()) {
+			LOG_ERROR("ERROR:       PUT OBJECT failed, "+readerError);
+		} else if (isZipMember) {
+			LOG_ERROR("ERROR:       PUT OBJECT failed, unable to read "+memberName+" from zip archive "+zipPath);
+		} else {
+			LOG_ERROR("ERROR:       PUT OBJECT failed, unable to open file "+fileName);
+		}
+		objWorkItem.reset();
+		if (shared && opened) {
+			workItem->ReleaseZipReader(object, size);
 		}
 	}
 	ds3_free_request(request);
@@ -334,42 +1144,620 @@ Client::PutObject(const QString& bucket,
 	}
 }
 
+// PUT a whole object, outside of any job, with the data read from an open
+// device
 void
-Client::CancelBulkJob(QUuid workItemID)
+Client::PutObjectData(const QString& bucket,
+		      const QString& object,
+		      QIODevice* device,
+		      uint64_t length,
+		      BulkPutWorkItem* bulkPutWorkItem)
 {
-	LOG_DEBUG("BULK CANCEL  JOB       "+workItemID.toString());
+	ds3_request* request = ds3_init_put_object(bucket.toUtf8().constData(),
+						   object.toUtf8().constData(),
+						   length);
+	ObjectWorkItem objWorkItem(bucket, object, device, bulkPutWorkItem);
+	ClientAndObjectWorkItem caowi;
+	caowi.client = this;
+	caowi.objectWorkItem = &objWorkItem;
+	int dataPath = AcquireDataPath(length);
+	ds3_error* ds3Error = ds3_put_object(m_dataPaths[dataPath].client,
+					     request, &caowi, read_from_file);
+	ReleaseDataPath(dataPath, length);
+	ds3_free_request(request);
 
-	m_bulkWorkItemsLock.lock();
-	if (m_bulkWorkItems.contains(workItemID)) {
-		BulkWorkItem* workItem = m_bulkWorkItems[workItemID];
-		Job::State state = workItem->GetState();
-		if (state != Job::CANCELING && state != Job::CANCELED &&
-		    state != Job::FINISHED) {
-			workItem->SetState(Job::CANCELING);
+	if (ds3Error != NULL) {
+		DS3Error error(ds3Error);
+		ds3_free_error(ds3Error);
+		throw (error);
+	}
+}
+
+// Delete everything a DeleteWorkItem covers.  Listing pages are read while
+// the previous pages' objects are being deleted, a DeleteWorkItem::BATCH_SIZE
+// batch at a time, so the objects never all have to be held in memory.
+// Deleting objects doesn't disturb the listing since each page starts after
+// the last object of the previous one.  A folder that can't be listed is
+// counted as a failure and the rest of the URLs are still deleted, but the
+// bucket itself is then left in place.
+void
+Client::DoBulkDelete(DeleteWorkItem* workItem)
+{
+	workItem->SetState(Job::INPROGRESS);
+	workItem->SetTransferStartIfNull();
+	Job job = workItem->ToJob();
+	emit JobProgressUpdate(job);
+
+	QString bucketName = workItem->GetBucketName();
+	QSemaphore inFlight(DELETE_REQUESTS_IN_FLIGHT);
+	QList<QFuture<bool> > deletes;
+	QStringList batch;
+	uint64_t batchSize = 0;
+	for (QList<QUrl>::const_iterator& ui(workItem->GetUrlsIterator());
+	     ui != workItem->GetUrlsConstEnd() && !workItem->WasCanceled();
+	     ui++) {
+		DS3URL url(*ui);
+		QString objName = url.GetObjectName();
+		if (!url.IsBucketOrFolder() && workItem->AddToBatch(objName, 0)) {
+			batch = workItem->TakeBatch(&batchSize);
+			inFlight.acquire();
+			deletes << run(&m_transferPool, this,
+				       &Client::DeleteObjectBatch,
+				       workItem, batch, batchSize, &inFlight);
+		}
+		QString marker;
+		bool truncated = url.IsBucketOrFolder();
+		while (truncated && !workItem->WasCanceled()) {
+			ds3_get_bucket_response* response;
+			try {
+				response = DoGetBucket(bucketName, objName, "", marker);
+			}
+			catch (DS3Error& e) {
+				LOG_ERROR("ERROR:       DELETE failed to list " +
+					  bucketName + "/" + objName + ", " +
+					  e.ToString());
+				workItem->MarkListingFailed();
+				break;
+			}
+			for (size_t i = 0; i < response->num_objects; i++) {
+				ds3_object rawObject = response->objects[i];
+				workItem->AddListedSize(rawObject.size);
+				if (workItem->AddToBatch(QString::fromUtf8(rawObject.name->value),
+							 rawObject.size)) {
+					batch = workItem->TakeBatch(&batchSize);
+					inFlight.acquire();
+					deletes << run(&m_transferPool, this,
+						       &Client::DeleteObjectBatch,
+						       workItem, batch, batchSize,
+						       &inFlight);
+				}
+			}
+			truncated = response->is_truncated;
+			if (truncated) {
+				marker = QString::fromUtf8(response->next_marker->value);
+			}
+			ds3_free_bucket_response(response);
 		}
 	}
-	m_bulkWorkItemsLock.unlock();
+	if (!workItem->IsBatchEmpty() && !workItem->WasCanceled()) {
+		batch = workItem->TakeBatch(&batchSize);
+		inFlight.acquire();
+		deletes << run(&m_transferPool, this, &Client::DeleteObjectBatch,
+			       workItem, batch, batchSize, &inFlight);
+	}
+	bool failed = false;
+	for (int i = 0; i < deletes.size(); i++) {
+		if (!deletes[i].result()) {
+			failed = true;
+		}
+	}
+
+	if (workItem->ShouldDeleteBucket() && !failed &&
+	    !workItem->WasCanceled()) {
+		try {
+			DeleteBucket(bucketName);
+		}
+		catch (DS3Error& e) {
+			LOG_ERROR("ERROR:       DELETE BUCKET failed, " + e.ToString());
+			workItem->IncNumFailedObjects();
+		}
+	}
+	DeleteOrRequeueBulkWorkItem(workItem);
 }
 
-ds3_get_service_response*
-Client::DoGetService()
+// Runs on the transfer pool.  Returns false if the objects couldn't be
+// deleted.
+bool
+Client::DeleteObjectBatch(DeleteWorkItem* workItem, QStringList objectNames,
+			  uint64_t size, QSemaphore* inFlight)
 {
-	ds3_request* request = ds3_init_get_service();
-	LOG_INFO("BULK GET     BUCKETS   "+m_endpoint);
+	bool ok = true;
+	if (!workItem->WasCanceled()) {
+		try {
+			DeleteObjects(workItem->GetBucketName(), objectNames);
+			workItem->UpdateBytesTransferred(size);
+		}
+		catch (DS3Error& e) {
+			QString msg = e.ToString();
+			if (e.GetStatusCode() == 403 &&
+			    e.GetErrorBody().contains("spectra-", Qt::CaseInsensitive)) {
+				msg = "Buckets that start with \"spectra-\" " \
+				      "are reserved and objects within them " \
+				      "cannot be deleted";
+			}
+			LOG_ERROR("ERROR:       DELETE OBJECTS failed, " + msg);
+			workItem->IncNumFailedObjects(objectNames.size());
+			ok = false;
+		}
+	}
+	inFlight->release();
+	return ok;
+}
+
+// Read the input a part at a time and PUT each part while the next ones
+// are read.  The manifest is only PUT once every part has been so a failed
+// or canceled upload never looks complete.
+void
+Client::DoStreamPut(StreamPutWorkItem* workItem)
+{
+	workItem->SetState(Job::INPROGRESS);
+	workItem->SetTransferStartIfNull();
+	Job job = workItem->ToJob();
+	emit JobProgressUpdate(job);
 
-	ds3_get_service_response *response;
-	ds3_error* ds3Error = ds3_get_service(m_client,
-					       request,
-					       &response);
+	QString bucketName = workItem->GetBucketName();
+	QString objName = workItem->GetObjectName();
+	QIODevice* input = workItem->GetInput();
+	qint64 partSize = workItem->GetPartSize();
+	QSemaphore inFlight(STREAM_PARTS_IN_FLIGHT);
+	QList<QFuture<bool> > puts;
+	bool failed = false;
+	bool atEnd = false;
+	while (!atEnd && !workItem->WasCanceled()) {
+		// Waiting for a part to be PUT before reading the next one is
+		// what bounds the memory used
+		inFlight.acquire();
+		QByteArray part((int)partSize, Qt::Uninitialized);
+		qint64 filled = 0;
+		while (filled < partSize) {
+			qint64 bytesRead = input->read(part.data() + filled,
+						       partSize - filled);
+			if (bytesRead < 0) {
+				LOG_ERROR("ERROR:       PUT OBJECT failed, unable to read the input, " +
+					  input->errorString());
+				workItem->IncNumFailedObjects();
+				failed = true;
+				atEnd = true;
+				break;
+			}
+			// Files return 0 at the end while pipes and sockets
+			// have to be waited on
+			if (bytesRead == 0 && !input->waitForReadyRead(-1)) {
+				atEnd = true;
+				break;
+			}
+			filled += bytesRead;
+		}
+		part.resize(filled);
+		if (failed || part.isEmpty()) {
+			inFlight.release();
+			break;
+		}
+		QString partName = StreamManifest::GetPartName(objName,
+							       workItem->GetManifest().GetNumParts());
+		workItem->AppendPart(part.size());
+		puts << run(&m_transferPool, this, &Client::PutStreamPart,
+			    workItem, partName, part, &inFlight);
+	}
+	for (int i = 0; i < puts.size(); i++) {
+		if (!puts[i].result()) {
+			failed = true;
+		}
+	}
+
+	if (failed) {
+		LOG_ERROR("ERROR:       PUT OBJECT failed, " + objName +
+			  " wasn't written since not all of its parts were uploaded");
+	} else if (!workItem->WasCanceled()) {
+		QByteArray manifest = workItem->GetManifest().ToByteArray();
+		workItem->SetPlannedSize(workItem->GetManifest().GetSize() +
+					 manifest.size());
+		QBuffer buffer(&manifest);
+		buffer.open(QIODevice::ReadOnly);
+		try {
+			PutObjectData(bucketName, objName, &buffer,
+				      manifest.size(), workItem);
+			LOG_INFO("PUT OBJECT   " + objName + " streamed in " +
+				 QString::number(puts.size()) + " parts");
+		}
+		catch (DS3Error& e) {
+			workItem->IncNumFailedObjects();
+			LOG_ERROR("ERROR:       PUT OBJECT failed, " + objName +
+				  " - " + e.ToString());
+		}
+	}
+	DeleteOrRequeueBulkWorkItem(workItem);
+}
+
+bool
+Client::PutStreamPart(StreamPutWorkItem* workItem, QString partName,
+		      QByteArray data, QSemaphore* inFlight)
+{
+	bool ok = true;
+	QBuffer buffer(&data);
+	buffer.open(QIODevice::ReadOnly);
+	try {
+		PutObjectData(workItem->GetBucketName(), partName, &buffer,
+			      data.size(), workItem);
+		LOG_FILE(QString("     PUT     OBJECT    ")+"/"+workItem->GetBucketName()+"/"+partName);
+	}
+	catch (DS3Error& e) {
+		ok = false;
+		if (!workItem->WasCanceled()) {
+			workItem->IncNumFailedObjects();
+		}
+		LOG_ERROR("ERROR:       PUT OBJECT failed, "+partName+" - "+e.ToString());
+	}
+	inFlight->release();
+	return ok;
+}
+
+// GET a streamed object's manifest and then its parts, STREAM_PARTS_IN_FLIGHT
+// at a time, writing each one to the output once the ones before it have
+// been
+void
+Client::DoStreamGet(StreamGetWorkItem* workItem)
+{
+	workItem->SetState(Job::INPROGRESS);
+	workItem->SetTransferStartIfNull();
+	Job job = workItem->ToJob();
+	emit JobProgressUpdate(job);
+
+	QString bucketName = workItem->GetBucketName();
+	QString objName = workItem->GetObjectName();
+	uint64_t manifestSize = 0;
+	QBuffer manifestBuffer;
+	manifestBuffer.open(QIODevice::WriteOnly);
+	StreamManifest manifest;
+	QString error;
+	if (!GetObjectSize(bucketName, objName, &manifestSize)) {
+		error = "not found";
+	} else {
+		try {
+			GetObjectData(bucketName, objName, &manifestBuffer, 0,
+				      manifestSize, workItem);
+			manifest.Parse(manifestBuffer.data(), &error);
+		}
+		catch (DS3Error& e) {
+			error = e.ToString();
+		}
+	}
+	if (!error.isEmpty()) {
+		LOG_ERROR("ERROR:       GET OBJECT failed, unable to read the " \
+			  "stream manifest " + objName + " - " + error);
+		workItem->IncNumFailedObjects();
+		DeleteOrRequeueBulkWorkItem(workItem);
+		return;
+	}
+	workItem->SetManifest(manifest);
+	workItem->SetPlannedSize(manifest.GetSize() + manifestSize);
+
+	QIODevice* output = workItem->GetOutput();
+	QList<QFuture<bool> > gets;
+	QList<QByteArray*> parts;
+	int next = 0;
+	for (int i = 0; i < manifest.GetNumParts(); i++) {
+		while (next < manifest.GetNumParts() &&
+		       gets.size() < STREAM_PARTS_IN_FLIGHT &&
+		       !workItem->WasCanceled()) {
+			parts << new QByteArray;
+			gets << run(&m_transferPool, this,
+				    &Client::GetStreamPart, workItem, next++,
+				    parts.last());
+		}
+		if (gets.isEmpty()) {
+			break;
+		}
+		QFuture<bool> get = gets.takeFirst();
+		QScopedPointer<QByteArray> part(parts.takeFirst());
+		if (!get.result()) {
+			break;
+		}
+		if (output->write(*part) != part->size()) {
+			LOG_ERROR("ERROR:       GET OBJECT failed, unable to write " +
+				  workItem->GetDestination() + ", " +
+				  output->errorString());
+			workItem->IncNumFailedObjects();
+			break;
+		}
+	}
+	// Whatever is still in flight after a failure is abandoned
+	for (int i = 0; i < gets.size(); i++) {
+		gets[i].waitForFinished();
+		delete parts[i];
+	}
+	DeleteOrRequeueBulkWorkItem(workItem);
+}
+
+bool
+Client::GetStreamPart(StreamGetWorkItem* workItem, int index,
+		      QByteArray* data)
+{
+	QString partName = StreamManifest::GetPartName(workItem->GetObjectName(),
+						       index);
+	uint64_t size = workItem->GetManifest().GetPartSize(index);
+	data->reserve(size);
+	QBuffer buffer(data);
+	buffer.open(QIODevice::WriteOnly);
+	try {
+		GetObjectData(workItem->GetBucketName(), partName, &buffer, 0,
+			      size, workItem);
+		if ((uint64_t)data->size() != size) {
+			throw DS3Error("Expected " + QString::number(size) +
+				       " bytes but got " +
+				       QString::number(data->size()));
+		}
+		LOG_FILE(QString("     GET     OBJECT    ")+"/"+workItem->GetBucketName()+"/"+partName);
+	}
+	catch (DS3Error& e) {
+		if (!workItem->WasCanceled()) {
+			workItem->IncNumFailedObjects();
+		}
+		LOG_ERROR("ERROR:       GET OBJECT failed, "+partName+" - "+e.ToString());
+		return false;
+	}
+	return true;
+}
+
+// PUT a blob of a migrated object with the data streamed from the source.
+// The source GETs run on the source Client's transfer pool and write into
+// a RingBuffer that the PUT reads from so only the RingBuffer's capacity
+// is held in memory no matter how large the blob is.  The PUT isn't
+// started until the source has staged all of the blob's data since that
+// can take far longer, e.g. from tape, than an idle connection lasts.
+void
+Client::MigrateObject(MigrationWorkItem* workItem, const QString& objName,
+		      const QString& sourceObjName, uint64_t offset,
+		      uint64_t length)
+{
+	Client* source = workItem->GetSource();
+	if (length > 0 &&
+	    !source->WaitForSourceRange(workItem, sourceObjName, offset, length)) {
+		// Canceled
+		return;
+	}
+
+	QString bucketName = workItem->GetBucketName();
+	ds3_request* request = ds3_init_put_object_for_job(bucketName.toUtf8().constData(),
+							   objName.toUtf8().constData(),
+							   offset, length,
+							   workItem->GetJobID().toUtf8().constData());
+	ds3_error* ds3Error = NULL;
+	int dataPath = AcquireDataPath(length);
+	if (length == 0) {
+		// Folder objects and empty files don't have any data
+		ds3Error = ds3_put_object(m_dataPaths[dataPath].client,
+					  request, NULL, NULL);
+		ReleaseDataPath(dataPath, length);
+		ds3_free_request(request);
+		if (ds3Error != NULL) {
+			DS3Error error(ds3Error);
+			ds3_free_error(ds3Error);
+			throw (error);
+		}
+		return;
+	}
+
+	RingBuffer buffer;
+	QFuture<QString> get = run(&source->m_transferPool, source,
+				   &Client::StreamSourceRange, workItem,
+				   sourceObjName, offset, length, &buffer);
+	MigrationStream stream;
+	stream.workItem = workItem;
+	stream.buffer = &buffer;
+	stream.skip = 0;
+	stream.remaining = length;
+	ds3Error = ds3_put_object(m_dataPaths[dataPath].client, request,
+				  &stream, read_from_ring_buffer);
+	ReleaseDataPath(dataPath, length);
 	ds3_free_request(request);
 
+	// If the GET gave up first, its error is the interesting one.
+	// Otherwise, stop it in case the PUT failed part way through.
+	bool getFailedFirst = buffer.WasAborted();
+	buffer.Abort();
+	QString getError = get.result();
+
+	if (workItem->WasCanceled()) {
+		// The abort is expected
+		if (ds3Error != NULL) {
+			ds3_free_error(ds3Error);
+		}
+		return;
+	}
+	if (getFailedFirst || (ds3Error == NULL && !getError.isEmpty())) {
+		if (ds3Error != NULL) {
+			ds3_free_error(ds3Error);
+		}
+		throw DS3Error("Reading " + workItem->GetSourceBucketName() + "/" +
+			       sourceObjName + " from the source, " + getError);
+	}
 	if (ds3Error != NULL) {
 		DS3Error error(ds3Error);
 		ds3_free_error(ds3Error);
 		throw (error);
 	}
+}
 
-	return response;
+// Called on the migration's source Client from the source's transfer pool.
+// Write bytes [offset, offset + length) of a source object into buffer by
+// GETing the source blobs that overlap them.  Returns an error message or
+// an empty string on success.  buffer is closed for writing on success or
+// aborted on failure.
+QString
+Client::StreamSourceRange(MigrationWorkItem* workItem,
+			  const QString& sourceObjName,
+			  uint64_t offset, uint64_t length,
+			  RingBuffer* buffer)
+{
+	QString bucketName = workItem->GetSourceBucketName();
+	QString jobID = workItem->GetSourceJobID();
+	uint64_t end = offset + length;
+	QList<MigrationWorkItem::SourceBlob> blobs = workItem->GetSourceBlobs(sourceObjName);
+	QString error;
+	uint64_t streamed = 0;
+	for (int i = 0; i < blobs.size() && error.isEmpty(); i++) {
+		const MigrationWorkItem::SourceBlob& blob = blobs[i];
+		if (blob.offset >= end || blob.offset + blob.length <= offset) {
+			continue;
+		}
+		if (!WaitForSourceChunk(workItem, blob.chunkNumber)) {
+			error = "the job was canceled";
+			break;
+		}
+
+		ds3_request* request = ds3_init_get_object_for_job(bucketName.toUtf8().constData(),
+								   sourceObjName.toUtf8().constData(),
+								   blob.offset,
+								   jobID.toUtf8().constData());
+		MigrationStream stream;
+		stream.workItem = workItem;
+		stream.buffer = buffer;
+		stream.skip = offset > blob.offset ? offset - blob.offset : 0;
+		stream.remaining = qMin(end, blob.offset + blob.length) -
+				   qMax(offset, blob.offset);
+		streamed += stream.remaining;
+		int dataPath = AcquireDataPath(blob.length);
+		ds3_error* ds3Error = ds3_get_object(m_dataPaths[dataPath].client,
+						     request, &stream,
+						     write_to_ring_buffer);
+		ReleaseDataPath(dataPath, blob.length);
+		ds3_free_request(request);
+		if (ds3Error != NULL) {
+			error = DS3Error(ds3Error).ToString();
+			ds3_free_error(ds3Error);
+		} else if (stream.remaining > 0) {
+			error = "the source returned less data than expected";
+		}
+	}
+
+	if (error.isEmpty() && streamed < length) {
+		error = "the object isn't part of the source job";
+	}
+	if (error.isEmpty()) {
+		buffer->CloseWrite();
+	} else {
+		buffer->Abort();
+	}
+	return error;
+}
+
+// Called on the migration's source Client.  Wait until the source has
+// staged every chunk holding part of bytes [offset, offset + length) of a
+// source object.  Returns false if the job was canceled first.
+bool
+Client::WaitForSourceRange(MigrationWorkItem* workItem,
+			   const QString& sourceObjName,
+			   uint64_t offset, uint64_t length)
+{
+	uint64_t end = offset + length;
+	QList<MigrationWorkItem::SourceBlob> blobs = workItem->GetSourceBlobs(sourceObjName);
+	for (int i = 0; i < blobs.size(); i++) {
+		const MigrationWorkItem::SourceBlob& blob = blobs[i];
+		if (blob.offset >= end || blob.offset + blob.length <= offset) {
+			continue;
+		}
+		if (!WaitForSourceChunk(workItem, blob.chunkNumber)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Called on the migration's source Client.  Wait until the source has
+// staged a chunk of the migration's source job.  Returns false if the job
+// was canceled first.
+bool
+Client::WaitForSourceChunk(MigrationWorkItem* workItem, uint64_t chunkNumber)
+{
+	while (!workItem->IsSourceChunkAvailable(chunkNumber)) {
+		if (workItem->WasCanceled()) {
+			return false;
+		}
+		// Whichever transfer finds the next poll due asks the source
+		// for every transfer waiting on it.  The lock is released
+		// before waiting for the next poll so the other transfers can
+		// keep checking for their chunks and for a cancel.
+		QMutex* pollLock = workItem->GetSourcePollLock();
+		pollLock->lock();
+		qint64 now = QDateTime::currentMSecsSinceEpoch();
+		qint64 wait = workItem->GetNextSourcePoll() - now;
+		if (wait <= 0 && !workItem->IsSourceChunkAvailable(chunkNumber)) {
+			uint64_t retryAfter = 60;
+			try {
+				ds3_get_available_chunks_response* chunksResponse;
+				chunksResponse = GetAvailableJobChunks(workItem->GetSourceJobID());
+				retryAfter = chunksResponse->retry_after;
+				workItem->AddSourceChunksAvailable(chunksResponse->object_list);
+				ds3_free_available_chunks_response(chunksResponse);
+			}
+			catch (DS3Error& e) {
+				LOG_ERROR("ERROR:       GET JOB CHUNKS failed on the " \
+					  "migration source, " + e.ToString());
+			}
+			wait = (qint64)retryAfter * 1000;
+			workItem->SetNextSourcePoll(QDateTime::currentMSecsSinceEpoch() + wait);
+			if (!workItem->IsSourceChunkAvailable(chunkNumber)) {
+				LOG_INFO("MIGRATE      JOB CHUNK Not ready on the source. " \
+					 "Sleeping for " + QString::number(retryAfter) +
+					 " seconds.");
+			}
+		}
+		pollLock->unlock();
+		if (wait > 0 && !workItem->IsSourceChunkAvailable(chunkNumber)) {
+			QThread::msleep(qMin(wait, (qint64)ACQUIRE_TIMEOUT_IN_MS));
+		}
+	}
+	return true;
+}
+
+void
+Client::CancelBulkJob(QUuid workItemID)
+{
+	LOG_DEBUG("BULK CANCEL  JOB       "+workItemID.toString());
+
+	if (m_daemon != NULL && m_daemonJobs.contains(workItemID)) {
+		m_daemon->CancelJob(workItemID);
+		return;
+	}
+
+	BulkWorkItem* queued = TakeCoalescingWorkItem(workItemID);
+	if (queued != NULL) {
+		queued->SetState(Job::CANCELING);
+		DeleteOrRequeueBulkWorkItem(queued);
+		return;
+	}
+
+	m_bulkWorkItemsLock.lock();
+	if (m_bulkWorkItems.contains(workItemID)) {
+		BulkWorkItem* workItem = m_bulkWorkItems[workItemID];
+		Job::State state = workItem->GetState();
+		if (state != Job::CANCELING && state != Job::CANCELED &&
+		    state != Job::FINISHED) {
+			workItem->SetState(Job::CANCELING);
+			// Jobs that haven't been admitted by the scheduler
+			// yet have nothing running that would notice the
+			// cancel so finish them off here.
+			if (TransferScheduler::Instance()->Dequeue(workItem)) {
+				queued = workItem;
+			}
+		}
+	}
+	m_bulkWorkItemsLock.unlock();
+
+	if (queued != NULL) {
+		DeleteOrRequeueBulkWorkItem(queued);
+	}
 }
 
 ds3_get_bucket_response*
@@ -422,57 +1810,37 @@ Client::DoGetBucket(const QString& bucketName, const QString& prefix,
 	return response;
 }
 
-ds3_get_objects_response*
-Client::DoGetObjects(const QString& bucketName, const QString& id,
-		     const QString& name, object_type type, const QString& version)
+// Check an object listed under a selected folder, named relative to the
+// folder, against a job's filter
+static bool
+IsAcceptedObject(const TransferFilter& filter, const QString& relativeName,
+		 const ds3_object& rawObject, bool isDir)
 {
-	LOG_DEBUG("DoGetObjects - bucket: " + bucketName +
-		  ", name: " + name);
-
-	ds3_request* request = ds3_init_get_objects(bucketName.toUtf8().constData());
-	QString logMsg = "List Objects (GET " + m_endpoint + "/";
-	logMsg += bucketName;
-	QStringList logQueryParams;
-	if (!name.isEmpty()) {
-		ds3_request_set_name(request, name.toUtf8().constData());
-		logQueryParams << "name=" + name;
-	}
-	if (!id.isEmpty()) {
-		ds3_request_set_id(request, id.toUtf8().constData());
-		logQueryParams << "id=" + id;
-	}
-	if (type == DATA) {
-		ds3_request_set_type(request, type);
-		logQueryParams << "type=DATA";
-	}
-	if (!version.isEmpty()) {
-		ds3_request_set_version(request, version.toUtf8().constData());
-		logQueryParams << "version=" + version;
+	if (isDir) {
+		return filter.AcceptsFolder(relativeName);
 	}
-	if (!logQueryParams.isEmpty()) {
-		logMsg += "&" + logQueryParams.join("&");
+	QDateTime modified;
+	qint64 msecs;
+	if (rawObject.last_modified != NULL &&
+	    TimeHelper::ParseRESTTimestamp(QString::fromUtf8(rawObject.last_modified->value),
+					   &msecs)) {
+		modified = QDateTime::fromMSecsSinceEpoch(msecs, Qt::UTC);
 	}
-	logMsg += ")";
-	LOG_INFO(logMsg);
-
-	ds3_get_objects_response* response;
-	ds3_error* ds3Error = ds3_get_objects(m_client,
-					     request,
-					     &response);
-	ds3_free_request(request);
+	return filter.Accepts(relativeName, rawObject.size, modified);
+}
 
-	if (ds3Error != NULL) {
-		DS3Error error(ds3Error);
-		ds3_free_error(ds3Error);
-		throw (error);
+void
+Client::PrepareBulkGets(BulkGetWorkItem* workItem)
+{
+	if (workItem->HasManifest()) {
+		PrepareManifestGets(static_cast<ManifestGetWorkItem*>(workItem));
+		return;
+	}
+	if (workItem->HasStream()) {
+		DoStreamGet(static_cast<StreamGetWorkItem*>(workItem));
+		return;
 	}
 
-	return response;
-}
-
-void
-Client::PrepareBulkGets(BulkGetWorkItem* workItem)
-{
 	LOG_DEBUG("PREPARE BULK OBJECT");
 
 	workItem->SetState(Job::PREPARING);
@@ -483,6 +1851,7 @@ Client::PrepareBulkGets(BulkGetWorkItem* workItem)
 
 	QString prevBucket;
 	QString destination = workItem->GetDestination();
+	const TransferFilter& filter = workItem->GetFilter();
 
 	for (QList<QUrl>::const_iterator& ui(workItem->GetUrlsIterator());
 	     ui != workItem->GetUrlsConstEnd();
@@ -536,8 +1905,17 @@ Client::PrepareBulkGets(BulkGetWorkItem* workItem)
 					if (getBucketRes != NULL) {
 						marker = QString::fromUtf8(getBucketRes->next_marker->value);
 					}
-					getBucketRes = DoGetBucket(bucket, prefix,
-								   "", marker);
+					try {
+						getBucketRes = DoGetBucket(bucket, prefix,
+									   "", marker);
+					}
+					catch (DS3Error&) {
+						// DoGetBucket already logged it
+						workItem->IncNumFailedObjects();
+						workItem->SetState(Job::CANCELING);
+						DeleteOrRequeueBulkWorkItem(workItem);
+						return;
+					}
 					i = 0;
 				}
 				if (getBucketRes->num_objects == 0) {
@@ -561,12 +1939,20 @@ Client::PrepareBulkGets(BulkGetWorkItem* workItem)
 					QString subFilePath = QDir::cleanPath(destination + "/" +
 									      lastPathPart + "/" +
 									      objNameMinusPrefix);
-					if (subFullObjName.endsWith("/")) {
+					bool isDir = subFullObjName.endsWith("/");
+					if (!filter.IsEmpty() &&
+					    !IsAcceptedObject(filter, objNameMinusPrefix,
+							      rawObject, isDir)) {
+						continue;
+					}
+					if (isDir) {
 						workItem->AppendDirsToCreate(subFilePath);
 					} else if (QFile(subFilePath).exists()) {
 						LOG_ERROR("ERROR:       "+subFilePath+" already exists. Skipping");
+						workItem->IncNumFailedObjects();
 					} else {
 						workItem->InsertObjMap(subFullObjName, subFilePath);
+						workItem->SetObjSize(subFullObjName, rawObject.size);
 					}
 				}
 			} while (getBucketRes->is_truncated);
@@ -574,8 +1960,18 @@ Client::PrepareBulkGets(BulkGetWorkItem* workItem)
 			workItem->SetGetBucketResponse(NULL);
 		} else if (QFile(filePath).exists()) {
 			LOG_ERROR("ERROR:       "+filePath+" already exists. Skipping");
+			workItem->IncNumFailedObjects();
 		} else {
 			workItem->InsertObjMap(fullObjName, filePath);
+			// Use the size the browser already knows, if any.
+			// Archive entries must be sized before their data
+			// arrives so they're looked up otherwise.
+			uint64_t size = 0;
+			if (url.GetObjectSize(&size) ||
+			    (workItem->HasArchive() &&
+			     GetObjectSize(bucket, fullObjName, &size))) {
+				workItem->SetObjSize(fullObjName, size);
+			}
 		}
 
 		prevBucket = bucket;
@@ -590,96 +1986,515 @@ Client::PrepareBulkGets(BulkGetWorkItem* workItem)
 	}
 }
 
-void
-Client::PrepareBulkPuts(BulkPutWorkItem* workItem)
+// Read the next page of a restore manifest.  A page ends early when the
+// bucket changes or an object is listed twice since a DS3 bulk GET is for
+// a single bucket and can only include an object once.
+void
+Client::PrepareManifestGets(ManifestGetWorkItem* workItem)
+{
+	LOG_DEBUG("PREPARE MANIFEST OBJECTS");
+
+	workItem->SetState(Job::PREPARING);
+	Job job = workItem->ToJob();
+	emit JobProgressUpdate(job);
+
+	workItem->ClearObjMap();
+
+	QString prevBucket;
+	QDir destination(workItem->GetDestination());
+	ManifestEntry entry;
+	while (workItem->ReadEntry(&entry)) {
+		if (workItem->WasCanceled()) {
+			workItem->PutBack(entry);
+			DeleteOrRequeueBulkWorkItem(workItem);
+			return;
+		}
+		if (!entry.error.isEmpty()) {
+			LOG_ERROR("ERROR:       Manifest line " +
+				  QString::number(entry.line) + ", " + entry.error);
+			workItem->Report(entry, "invalid", entry.error);
+			workItem->IncNumFailedObjects();
+			continue;
+		}
+
+		if (workItem->GetObjMapSize() >= BULK_PAGE_LIMIT ||
+		    (!prevBucket.isEmpty() && prevBucket != entry.bucket) ||
+		    workItem->PageHasObject(entry.object)) {
+			workItem->PutBack(entry);
+			break;
+		}
+
+		if (entry.destination.isEmpty()) {
+			entry.destination = entry.object;
+		}
+		QString filePath = QDir::cleanPath(destination.absoluteFilePath(entry.destination));
+		entry.destination = filePath;
+		if (entry.object.endsWith("/")) {
+			workItem->AppendDirsToCreate(filePath);
+		} else if (QFile(filePath).exists()) {
+			LOG_ERROR("ERROR:       "+filePath+" already exists. Skipping");
+			workItem->Report(entry, "skipped", "Already exists");
+			workItem->IncNumFailedObjects();
+			continue;
+		} else {
+			workItem->InsertObjMap(entry.object, filePath);
+		}
+		workItem->SetBucketName(entry.bucket);
+		workItem->AddPageEntry(entry);
+		prevBucket = entry.bucket;
+	}
+
+	if (workItem->GetObjMapSize() > 0) {
+		run(this, &Client::DoBulk, workItem);
+	} else {
+		CreateBulkGetDirs(workItem);
+		DeleteOrRequeueBulkWorkItem(workItem);
+	}
+}
+
+void
+Client::PrepareBulkPuts(BulkPutWorkItem* workItem)
+{
+	if (workItem->IsMigration()) {
+		PrepareMigration(static_cast<MigrationWorkItem*>(workItem));
+		return;
+	}
+	if (workItem->IsStream()) {
+		DoStreamPut(static_cast<StreamPutWorkItem*>(workItem));
+		return;
+	}
+
+	LOG_DEBUG("PREPARE BULK PUTS");
+
+	workItem->SetState(Job::PREPARING);
+	Job job = workItem->ToJob();
+	emit JobProgressUpdate(job);
+
+	// Split off by SubmitLargeObjects.  Its objects have already been
+	// gathered.
+	if (workItem->IsPrePlanned()) {
+		run(this, &Client::DoBulk, workItem);
+		return;
+	}
+
+	QSettings settings;
+	bool splitBySize = IsSplitBySizeEnabled();
+	uint64_t largeThreshold = settings.value("transfers/largeObjectThreshold",
+						 (qulonglong)LARGE_OBJECT_THRESHOLD).toULongLong();
+	bool expandZips = settings.value("transfers/expandZips", false).toBool();
+	const TransferFilter& filter = workItem->GetFilter();
+	QHash<QString, QString> largeObjects;
+	bool splitOff = false;
+
+	workItem->ClearObjMap();
+	workItem->ClearZipMembers();
+	QString normPrefix = workItem->GetPrefix();
+	if (!normPrefix.isEmpty()) {
+		normPrefix.replace(QRegularExpression("/$"), "");
+		normPrefix += "/";
+	}
+
+	for (QList<QUrl>::const_iterator& ui(workItem->GetUrlsIterator());
+	     ui != workItem->GetUrlsConstEnd();
+	     ui++) {
+		if (workItem->WasCanceled()) {
+			DeleteOrRequeueBulkWorkItem(workItem);
+			return;
+		}
+		QUrl url(*ui);
+
+		QUrl lastUrl = workItem->GetLastProcessedUrl();
+		if (!lastUrl.isEmpty()) {
+			QString lastUrlS = lastUrl.toString();
+			lastUrlS.replace(QRegularExpression("/$"), "");
+			lastUrlS += "/";
+			if (url.toString().startsWith(lastUrlS)) {
+				// This URL is either the same as or a
+				// descendant of the previously processed URL.
+				// Since we would have already prepared to
+				// transfer all descendents of the previously
+				// processed URL, this one can be skipped.
+				continue;
+			}
+		}
+
+		if (workItem->GetObjMapSize() >= BULK_PAGE_LIMIT) {
+			SubmitLargeObjects(workItem, largeObjects);
+			run(this, &Client::DoBulk, workItem);
+			return;
+		}
+		QString filePath = url.toLocalFile();
+		// filePath could be either /foo or /foo/ if it's a directory.
+		// Run it through QDir to normalize it to the former.
+		filePath = QDir(filePath).path();
+		QFileInfo fileInfo(filePath);
+		QString fileName = fileInfo.fileName();
+		QString objName = normPrefix + fileName;
+		bool isZip = expandZips && !fileInfo.isDir() &&
+			     fileInfo.suffix().compare("zip", Qt::CaseInsensitive) == 0;
+		if (fileInfo.isDir()) {
+			objName += "/";
+
+			// An existing DirIterator must have been caused by
+			// a previous BulkPut "page" that returned early while
+			// iterating over files under this URL.  Thus, take
+			// over where it left off.
+			QDirIterator* di = workItem->GetDirIterator();
+			if (di == NULL) {
+				di = workItem->GetDirIterator(filePath);
+			}
+			while (di->hasNext()) {
+				if (workItem->WasCanceled()) {
+					DeleteOrRequeueBulkWorkItem(workItem);
+					return;
+				}
+				if (workItem->GetObjMapSize() >= BULK_PAGE_LIMIT) {
+					SubmitLargeObjects(workItem, largeObjects);
+					run(this, &Client::DoBulk, workItem);
+					return;
+				}
+				QString subFilePath = di->next();
+				QFileInfo subFileInfo = di->fileInfo();
+				QString subFileName = subFilePath;
+				subFileName.replace(QRegularExpression("^" + filePath + "/"), "");
+				QString subObjName = objName + subFileName;
+				if (!filter.IsEmpty() &&
+				    !(subFileInfo.isDir() ?
+				      filter.AcceptsFolder(subFileName) :
+				      filter.Accepts(subFileName, subFileInfo.size(),
+						     subFileInfo.lastModified()))) {
+					continue;
+				}
+				if (subFileInfo.isDir()) {
+					subObjName += "/";
+				} else if (splitBySize &&
+					   (uint64_t)GetFileSize(subFilePath) >= largeThreshold) {
+					splitOff |= InsertLargeObject(workItem, largeObjects,
+								      subObjName, subFilePath);
+					continue;
+				}
+				workItem->InsertObjMap(subObjName, subFilePath);
+			}
+			workItem->DeleteDirIterator();
+		} else if (isZip) {
+			// The archive is uploaded like a directory named after
+			// it, e.g. foo.zip's bar.txt becomes foo/bar.txt, with
+			// each member's size taken from the central directory.
+			objName = normPrefix + fileInfo.completeBaseName() + "/";
+			QuaZip* zip = workItem->GetZip();
+			if (zip == NULL) {
+				zip = workItem->GetZip(filePath);
+			}
+			if (zip == NULL) {
+				LOG_ERROR("ERROR:       BULK PUT failed, unable to open zip archive "+filePath);
+				workItem->IncNumFailedObjects();
+				workItem->SetLastProcessedUrl(*ui);
+				continue;
+			}
+			while (zip->hasCurrentFile()) {
+				if (workItem->WasCanceled()) {
+					DeleteOrRequeueBulkWorkItem(workItem);
+					return;
+				}
+				if (workItem->GetObjMapSize() >= BULK_PAGE_LIMIT) {
+					SubmitLargeObjects(workItem, largeObjects);
+					run(this, &Client::DoBulk, workItem);
+					return;
+				}
+				QuaZipFileInfo64 info;
+				bool gotInfo = zip->getCurrentFileInfo(&info);
+				zip->goToNextFile();
+				if (!gotInfo) {
+					LOG_ERROR("ERROR:       BULK PUT failed, unable to read a member of zip archive "+filePath);
+					workItem->IncNumFailedObjects();
+					continue;
+				}
+				QString memberObjName = objName + info.name;
+				QString memberPath = filePath + "/" + info.name;
+				bool isMemberDir = info.name.endsWith("/");
+				uint64_t size = isMemberDir ? 0 : info.uncompressedSize;
+				if (!filter.IsEmpty() &&
+				    !(isMemberDir ? filter.AcceptsFolder(info.name) :
+				      filter.Accepts(info.name, size, info.dateTime))) {
+					continue;
+				}
+				workItem->InsertZipMember(memberObjName, filePath, info.name);
+				workItem->SetObjSize(memberObjName, size);
+				if (splitBySize && !isMemberDir && size >= largeThreshold) {
+					splitOff |= InsertLargeObject(workItem, largeObjects,
+								      memberObjName, memberPath);
+					continue;
+				}
+				workItem->InsertObjMap(memberObjName, memberPath);
+			}
+			workItem->DeleteZip();
+			workItem->InsertZipMember(objName, filePath, "");
+			workItem->SetObjSize(objName, 0);
+		}
+		if (splitBySize && !fileInfo.isDir() && !isZip &&
+		    (uint64_t)GetFileSize(filePath) >= largeThreshold) {
+			splitOff |= InsertLargeObject(workItem, largeObjects,
+						      objName, filePath);
+		} else {
+			workItem->InsertObjMap(objName, filePath);
+		}
+		workItem->SetLastProcessedUrl(*ui);
+	}
+
+	splitOff |= !largeObjects.isEmpty();
+	SubmitLargeObjects(workItem, largeObjects);
+	if (workItem->GetObjMapSize() > 0) {
+		run(this, &Client::DoBulk, workItem);
+	} else if (splitOff) {
+		// Everything in the last page was moved to the large object job
+		DeleteOrRequeueBulkWorkItem(workItem);
+	}
+}
+
+// Gather the next page of objects to migrate from the source.  Target
+// object names are built the same way as a BulkGet's file paths with the
+// target prefix in place of the destination directory.
+void
+Client::PrepareMigration(MigrationWorkItem* workItem)
+{
+	LOG_DEBUG("PREPARE MIGRATION");
+
+	workItem->SetState(Job::PREPARING);
+	Job job = workItem->ToJob();
+	emit JobProgressUpdate(job);
+
+	workItem->ClearObjMap();
+	workItem->SetSourceResponse(NULL);
+
+	Client* source = workItem->GetSource();
+	QString prevBucket;
+	QString normPrefix = workItem->GetPrefix();
+	if (!normPrefix.isEmpty()) {
+		normPrefix.replace(QRegularExpression("/$"), "");
+		normPrefix += "/";
+	}
+
+	for (QList<QUrl>::const_iterator& ui(workItem->GetUrlsIterator());
+	     ui != workItem->GetUrlsConstEnd();
+	     ui++) {
+		if (workItem->WasCanceled()) {
+			DeleteOrRequeueBulkWorkItem(workItem);
+			return;
+		}
+
+		DS3URL url(*ui);
+
+		QUrl lastUrl = workItem->GetLastProcessedUrl();
+		if (!lastUrl.isEmpty()) {
+			QString lastUrlS = lastUrl.toString();
+			lastUrlS.replace(QRegularExpression("/$"), "");
+			lastUrlS += "/";
+			if (url.toString().startsWith(lastUrlS)) {
+				// Already migrated along with an ancestor
+				continue;
+			}
+		}
+
+		QString bucket = url.GetBucketName();
+		if (workItem->GetObjMapSize() >= BULK_PAGE_LIMIT ||
+		    (!prevBucket.isEmpty() && prevBucket != bucket)) {
+			run(this, &Client::DoBulk, workItem);
+			return;
+		}
+		workItem->SetSourceBucketName(bucket);
+
+		QString fullObjName = url.GetObjectName();
+		QString objName = normPrefix + url.GetLastPathPart();
+		if (url.IsBucketOrFolder()) {
+			QString prefix = fullObjName;
+			ds3_get_bucket_response* getBucketRes;
+			getBucketRes = workItem->GetGetBucketResponse();
+			size_t i = workItem->GetGetBucketResponseIterator();
+			do {
+				if (workItem->WasCanceled()) {
+					DeleteOrRequeueBulkWorkItem(workItem);
+					return;
+				}
+				if (getBucketRes == NULL || i >= getBucketRes->num_objects) {
+					QString marker;
+					if (getBucketRes != NULL) {
+						marker = QString::fromUtf8(getBucketRes->next_marker->value);
+					}
+					try {
+						getBucketRes = source->DoGetBucket(bucket, prefix,
+										   "", marker);
+					}
+					catch (DS3Error& e) {
+						LOG_ERROR("ERROR:       MIGRATE failed to list " +
+							  bucket + "/" + prefix +
+							  " on the source, " + e.ToString());
+						workItem->IncNumFailedObjects();
+						workItem->SetState(Job::CANCELING);
+						DeleteOrRequeueBulkWorkItem(workItem);
+						return;
+					}
+					workItem->SetGetBucketResponse(getBucketRes);
+					i = 0;
+				}
+				for (; i < getBucketRes->num_objects; i++) {
+					if (workItem->GetObjMapSize() >= BULK_PAGE_LIMIT) {
+						workItem->SetGetBucketResponseIterator(i);
+						run(this, &Client::DoBulk, workItem);
+						return;
+					}
+					ds3_object rawObject = getBucketRes->objects[i];
+					QString subFullObjName = QString::fromUtf8(rawObject.name->value);
+					QString objNameMinusPrefix = subFullObjName;
+					objNameMinusPrefix.replace(QRegularExpression("^" + QRegularExpression::escape(prefix)), "");
+					QString subObjName = objName + "/" + objNameMinusPrefix;
+					workItem->InsertObjMap(subObjName, subFullObjName);
+					workItem->SetObjSize(subObjName, rawObject.size);
+				}
+			} while (getBucketRes->is_truncated);
+			workItem->SetGetBucketResponseIterator(0);
+			workItem->SetGetBucketResponse(NULL);
+		} else {
+			uint64_t size = 0;
+			if (source->GetObjectSize(bucket, fullObjName, &size)) {
+				workItem->InsertObjMap(objName, fullObjName);
+				workItem->SetObjSize(objName, size);
+			} else {
+				LOG_ERROR("ERROR:       Unable to find " + bucket + "/" +
+					  fullObjName + ". Skipping");
+				workItem->IncNumFailedObjects();
+			}
+		}
+
+		prevBucket = bucket;
+		workItem->SetLastProcessedUrl(*ui);
+	}
+
+	if (workItem->GetObjMapSize() > 0) {
+		run(this, &Client::DoBulk, workItem);
+	} else {
+		DeleteOrRequeueBulkWorkItem(workItem);
+	}
+}
+
+// Called on the migration's source Client.  Start the source bulk GET job
+// of the work item's current page so the source stages the objects.
+bool
+Client::StartMigrationSource(MigrationWorkItem* workItem)
 {
-	LOG_DEBUG("PREPARE BULK PUTS");
+	uint64_t numObjects = workItem->GetObjMapSize();
+	ds3_bulk_object_list* bulkObjList = ds3_init_bulk_object_list(numObjects);
+	QHash<QString, QString>::const_iterator hi;
+	uint64_t i = 0;
+	for (hi = workItem->GetObjMapConstBegin();
+	     hi != workItem->GetObjMapConstEnd();
+	     hi++) {
+		bulkObjList->list[i++].name = ds3_str_init(hi.value().toUtf8().constData());
+	}
 
-	workItem->SetState(Job::PREPARING);
-	Job job = workItem->ToJob();
-	emit JobProgressUpdate(job);
+	const QString& bucketName = workItem->GetSourceBucketName();
+	ds3_request* request = ds3_init_get_bulk(bucketName.toUtf8().constData(),
+						 bulkObjList, NONE);
+	ds3_bulk_response* response = NULL;
+	ds3_error* ds3Error = ds3_bulk(m_client, request, &response);
+	ds3_free_request(request);
+	ds3_free_bulk_object_list(bulkObjList);
 
-	workItem->ClearObjMap();
-	QString normPrefix = workItem->GetPrefix();
-	if (!normPrefix.isEmpty()) {
-		normPrefix.replace(QRegularExpression("/$"), "");
-		normPrefix += "/";
+	if (ds3Error != NULL) {
+		DS3Error error(ds3Error);
+		ds3_free_error(ds3Error);
+		LOG_ERROR("ERROR:       Preparing objects on the migration " \
+			  "source, " + error.ToString() + ".  Canceling job.");
+		return false;
 	}
+	workItem->SetSourceResponse(response);
+	return true;
+}
 
-	for (QList<QUrl>::const_iterator& ui(workItem->GetUrlsIterator());
-	     ui != workItem->GetUrlsConstEnd();
-	     ui++) {
-		if (workItem->WasCanceled()) {
-			DeleteOrRequeueBulkWorkItem(workItem);
-			return;
-		}
-		QUrl url(*ui);
+// Large files are gathered a page at a time too so a folder full of them
+// doesn't become one unbounded job.  Returns true if a full page of them
+// was moved into a job of their own.
+bool
+Client::InsertLargeObject(BulkPutWorkItem* workItem,
+			  QHash<QString, QString>& largeObjects,
+			  const QString& objName, const QString& filePath)
+{
+	largeObjects.insert(objName, filePath);
+	if ((uint64_t)largeObjects.size() < BULK_PAGE_LIMIT) {
+		return false;
+	}
+	SubmitLargeObjects(workItem, largeObjects);
+	return true;
+}
 
-		QUrl lastUrl = workItem->GetLastProcessedUrl();
-		if (!lastUrl.isEmpty()) {
-			QString lastUrlS = lastUrl.toString();
-			lastUrlS.replace(QRegularExpression("/$"), "");
-			lastUrlS += "/";
-			if (url.toString().startsWith(lastUrlS)) {
-				// This URL is either the same as or a
-				// descendant of the previously processed URL.
-				// Since we would have already prepared to
-				// transfer all descendents of the previously
-				// processed URL, this one can be skipped.
-				continue;
-			}
-		}
+// Move the large files gathered while preparing a page into a job of their
+// own that's scheduled alongside the page's job.  The server can then give
+// the small files evenly sized chunks while the large files' blobs are
+// spread over the large job's own transfer streams.
+void
+Client::SubmitLargeObjects(BulkPutWorkItem* workItem,
+			   QHash<QString, QString>& largeObjects)
+{
+	if (largeObjects.isEmpty()) {
+		return;
+	}
 
-		if (workItem->GetObjMapSize() >= BULK_PAGE_LIMIT) {
-			run(this, &Client::DoBulk, workItem);
-			return;
+	QList<QUrl> urls;
+	QHash<QString, QString>::const_iterator hi;
+	for (hi = largeObjects.constBegin(); hi != largeObjects.constEnd(); hi++) {
+		urls << QUrl::fromLocalFile(hi.value());
+	}
+	BulkPutWorkItem* largeWorkItem = new BulkPutWorkItem(m_host, urls,
+							     workItem->GetBucketName(),
+							     workItem->GetPrefix());
+	for (hi = largeObjects.constBegin(); hi != largeObjects.constEnd(); hi++) {
+		largeWorkItem->InsertObjMap(hi.key(), hi.value());
+		QString zipPath;
+		QString memberName;
+		uint64_t size;
+		if (workItem->GetZipMember(hi.key(), &zipPath, &memberName)) {
+			largeWorkItem->InsertZipMember(hi.key(), zipPath, memberName);
 		}
-		QString filePath = url.toLocalFile();
-		// filePath could be either /foo or /foo/ if it's a directory.
-		// Run it through QDir to normalize it to the former.
-		filePath = QDir(filePath).path();
-		QFileInfo fileInfo(filePath);
-		QString fileName = fileInfo.fileName();
-		QString objName = normPrefix + fileName;
-		if (fileInfo.isDir()) {
-			objName += "/";
-
-			// An existing DirIterator must have been caused by
-			// a previous BulkPut "page" that returned early while
-			// iterating over files under this URL.  Thus, take
-			// over where it left off.
-			QDirIterator* di = workItem->GetDirIterator();
-			if (di == NULL) {
-				di = workItem->GetDirIterator(filePath);
-			}
-			while (di->hasNext()) {
-				if (workItem->WasCanceled()) {
-					DeleteOrRequeueBulkWorkItem(workItem);
-					return;
-				}
-				if (workItem->GetObjMapSize() >= BULK_PAGE_LIMIT) {
-					run(this, &Client::DoBulk, workItem);
-					return;
-				}
-				QString subFilePath = di->next();
-				QFileInfo subFileInfo = di->fileInfo();
-				QString subFileName = subFilePath;
-				subFileName.replace(QRegularExpression("^" + filePath + "/"), "");
-				QString subObjName = objName + subFileName;
-				if (subFileInfo.isDir()) {
-					subObjName += "/";
-				}
-				workItem->InsertObjMap(subObjName, subFilePath);
-			}
-			workItem->DeleteDirIterator();
+		if (workItem->GetObjSize(hi.key(), &size)) {
+			largeWorkItem->SetObjSize(hi.key(), size);
 		}
-		workItem->InsertObjMap(objName, filePath);
-		workItem->SetLastProcessedUrl(*ui);
 	}
+	largeWorkItem->SetPrePlanned();
+	largeWorkItem->SetSessionID(workItem->GetSessionID());
+	// Lets the small files' job, and other jobs, get ahead of the long
+	// running large one
+	largeWorkItem->SetPriority(TransferScheduler::LOW);
+	largeWorkItem->SetConcurrencyController(CreateConcurrencyController());
+	LOG_INFO("BULK PUT     SPLIT     " + QString::number(largeObjects.size()) +
+		 " large objects into job " + largeWorkItem->GetID().toString());
+	largeObjects.clear();
+	SubmitWorkItem(largeWorkItem);
+}
 
-	if (workItem->GetObjMapSize() > 0) {
-		run(this, &Client::DoBulk, workItem);
+// The server builds a job's chunks in the order its objects are listed.
+// Alternating between the largest and smallest remaining objects gives
+// every chunk a similar mix of bytes and object counts so a chunk full of
+// tiny files is spread over many transfer streams instead of one chunk
+// holding up the job.
+static QList<QString>
+InterleaveBySize(const QHash<QString, uint64_t>& sizes)
+{
+	QList<QPair<uint64_t, QString> > bySize;
+	QHash<QString, uint64_t>::const_iterator si;
+	for (si = sizes.constBegin(); si != sizes.constEnd(); si++) {
+		bySize << qMakePair(si.value(), si.key());
 	}
+	std::sort(bySize.begin(), bySize.end());
+
+	QList<QString> objNames;
+	int small = 0;
+	int large = bySize.size() - 1;
+	while (small <= large) {
+		objNames << bySize[large--].second;
+		if (small <= large) {
+			objNames << bySize[small++].second;
+		}
+	}
+	return objNames;
 }
 
 void
@@ -687,6 +2502,12 @@ Client::DoBulk(BulkWorkItem* workItem)
 {
 	LOG_DEBUG("DO BULK");
 
+	QHash<QString, uint64_t> fastPathSizes;
+	if (IsFastPathEligible(workItem, &fastPathSizes)) {
+		DoFastPath(workItem, fastPathSizes);
+		return;
+	}
+
 	workItem->SetState(Job::INPROGRESS);
 	workItem->SetTransferStartIfNull();
 	Job job = workItem->ToJob();
@@ -697,31 +2518,54 @@ Client::DoBulk(BulkWorkItem* workItem)
 
 	bool isGet = workItem->GetType() == Job::GET;
 
+	QHash<QString, uint64_t> fileSizes;
 	QHash<QString, QString>::const_iterator hi;
-	size_t i = 0;
 	for (hi = workItem->GetObjMapConstBegin();
 	     hi != workItem->GetObjMapConstEnd();
 	     hi++) {
+		uint64_t fileSize = 0;
+		if (!isGet && !workItem->GetObjSize(hi.key(), &fileSize) &&
+		    !QFileInfo(hi.value()).isDir()) {
+			fileSize = GetFileSize(hi.value());
+		}
+		fileSizes.insert(hi.key(), fileSize);
+	}
+
+	QList<QString> objNames;
+	if (!isGet && IsSplitBySizeEnabled()) {
+		objNames = InterleaveBySize(fileSizes);
+	} else {
+		objNames = fileSizes.keys();
+	}
+
+	for (int i = 0; i < objNames.size(); i++) {
 		ds3_bulk_object* bulkObj = &bulkObjList->list[i];
-		QString objName = hi.key();
-		QString filePath = hi.value();
-		QFileInfo fileInfo(filePath);
+		const QString& objName = objNames[i];
 		bulkObj->name = ds3_str_init(objName.toUtf8().constData());
 		if (!isGet) {
-			uint64_t fileSize = 0;
-			if (!fileInfo.isDir()) {
-				fileSize = GetFileSize(filePath);
-			}
-			bulkObj->length = fileSize;
+			bulkObj->length = fileSizes[objName];
 			bulkObj->offset = 0;
 		}
-		i++;
+	}
+
+	// A migration's source has to stage its objects before they can be
+	// streamed to this system
+	if (!isGet && static_cast<BulkPutWorkItem*>(workItem)->IsMigration()) {
+		MigrationWorkItem* migration = static_cast<MigrationWorkItem*>(workItem);
+		if (!migration->GetSource()->StartMigrationSource(migration)) {
+			ds3_free_bulk_object_list(bulkObjList);
+			workItem->IncNumFailedObjects(numFiles);
+			workItem->SetState(Job::CANCELING);
+			DeleteOrRequeueBulkWorkItem(workItem);
+			return;
+		}
 	}
 
 	const QString& bucketName = workItem->GetBucketName();
 	ds3_request* request;
 	if (isGet) {
-		request = ds3_init_get_bulk(bucketName.toUtf8().constData(), bulkObjList, NONE);
+		ds3_chunk_ordering ordering = static_cast<BulkGetWorkItem*>(workItem)->GetChunkOrdering();
+		request = ds3_init_get_bulk(bucketName.toUtf8().constData(), bulkObjList, ordering);
 	} else {
 		request = ds3_init_put_bulk(bucketName.toUtf8().constData(), bulkObjList);
 	}
@@ -736,8 +2580,19 @@ Client::DoBulk(BulkWorkItem* workItem)
 		DS3Error error(ds3Error);
 		ds3_free_error(ds3Error);
 		if (isGet) {
-			throw (error);
+			for (hi = workItem->GetObjMapConstBegin();
+			     hi != workItem->GetObjMapConstEnd();
+			     hi++) {
+				workItem->MarkObjectFailed(hi.key(), error.ToString());
+			}
+			LOG_ERROR("ERROR:       Downloading objects from server, " +
+				  error.ToString() + ".  Canceling job.");
+			workItem->SetResponse(NULL);
+			workItem->SetState(Job::CANCELING);
+			DeleteOrRequeueBulkWorkItem(workItem);
+			return;
 		} else {
+			workItem->IncNumFailedObjects(numFiles);
 			QString errorFileMsg = "ERROR:       Uploading objects to server, ";
 
 			if (error.GetStatusCode() == 409) {
@@ -780,6 +2635,15 @@ void
 Client::CreateBulkGetDirs(BulkGetWorkItem* workItem)
 {
 	for (int i = 0; i < workItem->GetDirsToCreateSize(); i++) {
+		if (workItem->HasArchive()) {
+			ArchiveGetWorkItem* archive = static_cast<ArchiveGetWorkItem*>(workItem);
+			QString entryName = archive->GetEntryName(workItem->GetDirsToCreateAt(i));
+			QString error;
+			if (!archive->AddDirectory(entryName, &error)) {
+				LOG_ERROR("ERROR:       " + error);
+			}
+			continue;
+		}
 		QDir dir(workItem->GetDirsToCreateAt(i));
 		if (!dir.exists()) {
 			dir.mkpath(".");
@@ -799,6 +2663,8 @@ Client::ProcessJobChunk(BulkWorkItem* workItem)
 	// wait and try again.
 	ds3_get_available_chunks_response* chunksResponse = NULL;
 	size_t numChunks = 0;
+	QElapsedTimer waitTimer;
+	waitTimer.start();
 	while (numChunks == 0) {
 		if (workItem->WasCanceled()) {
 			ds3_free_available_chunks_response(chunksResponse);
@@ -808,7 +2674,7 @@ Client::ProcessJobChunk(BulkWorkItem* workItem)
 		uint64_t retryAfter = 60;
 		QString errMsg;
 		try {
-			chunksResponse = GetAvailableJobChunks(workItem);
+			chunksResponse = GetAvailableJobChunks(workItem->GetJobID());
 			numChunks = chunksResponse->object_list->list_size;
 			retryAfter = chunksResponse->retry_after;
 		}
@@ -823,49 +2689,108 @@ Client::ProcessJobChunk(BulkWorkItem* workItem)
 			QThread::sleep(retryAfter);
 		}
 	}
-
-	QString bucketName = workItem->GetBucketName();
-	bool isGet = workItem->GetType() == Job::GET;
-	QString op = isGet ? "GET" : "PUT";
-	// TODO PUT multiple objects at once.  Start the next chunk as soon
-	//      as the number of objects left to put is less than the size
-	//      of the "put objects" thread pool.
+	// Each chunk that's just become available is counted as waiting from
+	// the first poll made for it, after the chunks before it were handed
+	// off, rather than from when the job was created
+	int waited = waitTimer.elapsed() / 1000;
+
+	// With IN_ORDER chunk ordering, the server stages chunks in order and
+	// can evict them from cache to make room for later ones.  Transfer
+	// them in the same order, finishing each one before starting the
+	// next, so the oldest staged chunk is always drained first.
+	bool inOrder = workItem->GetType() == Job::GET &&
+		       static_cast<BulkGetWorkItem*>(workItem)->GetChunkOrdering() == IN_ORDER;
 	ds3_bulk_response* bulkResponse = chunksResponse->object_list;
+	QList<QPair<uint64_t, ds3_bulk_object_list*> > chunks;
 	for (size_t chunk = 0; chunk < numChunks; chunk++) {
 		ds3_bulk_object_list* list = bulkResponse->list[chunk];
-		for (uint64_t i = 0; i < list->size;  i++) {
-			if (workItem->WasCanceled()) {
-				DeleteOrRequeueBulkWorkItem(workItem);
-				return;
+		chunks << qMakePair(list->chunk_number, list);
+	}
+	if (inOrder) {
+		std::sort(chunks.begin(), chunks.end());
+	}
+
+	// Objects are transferred in parallel on the transfer pool.  The
+	// work item's ConcurrencyController decides how many of this job's
+	// transfers can be in flight at once and TransferScheduler shares the
+	// application wide transfer slots between the jobs that want them.
+	// Folder objects don't have any data so each chunk's are sent off
+	// together, one after another in a single transfer pool task, without
+	// waiting for a slot.
+	ConcurrencyController* controller = workItem->GetConcurrencyController();
+	TransferScheduler* scheduler = TransferScheduler::Instance();
+	QList<QFuture<void> > transfers;
+	bool canceled = false;
+	for (int chunk = 0; chunk < chunks.size() && !canceled; chunk++) {
+		ds3_bulk_object_list* list = chunks[chunk].second;
+		workItem->AddChunkWait(waited);
+		if (waited > 0) {
+			LOG_INFO("BULK JOB     CHUNK     " +
+				 QString::number(list->chunk_number) +
+				 " waited " + QString::number(waited) +
+				 " seconds on the server");
+		}
+		if (inOrder) {
+			for (int i = 0; i < transfers.size(); i++) {
+				transfers[i].waitForFinished();
+			}
+			transfers.clear();
+		}
+		QStringList folderObjNames;
+		for (uint64_t i = 0; i < list->size; i++) {
+			QString objName = QString::fromUtf8(list->list[i].name->value);
+			if (objName.endsWith("/")) {
+				folderObjNames << objName;
 			}
+		}
+		if (!folderObjNames.isEmpty()) {
+			transfers << run(&m_transferPool, this,
+					 &Client::TransferFolderObjects, workItem,
+					 folderObjNames);
+		}
+		for (uint64_t i = 0; i < list->size && !canceled; i++) {
 			ds3_bulk_object* bulkObj = &(list->list[i]);
 			QString objName = QString::fromUtf8(bulkObj->name->value);
 			QString filePath = workItem->GetObjMapValue(objName);
-			uint64_t offset = bulkObj->offset;
-			try {
-				if (isGet) {
-					Client::GetObject(bucketName, objName,
-							  filePath, offset,
-							  static_cast<BulkGetWorkItem*>(workItem));
-					LOG_FILE(QString("     GET     OBJECT    ")+"/"+bucketName+"/"+objName+"->"+filePath);
-				} else {
-					uint64_t length = bulkObj->length;
-					Client::PutObject(bucketName, objName,
-							  filePath, offset,
-							  length,
-							  static_cast<BulkPutWorkItem*>(workItem));
-					LOG_FILE(QString("     PUT     OBJECT    ")+filePath+"->"+"/"+bucketName+"/"+objName);
-				}
+			if (objName.endsWith("/")) {
+				continue;
 			}
-			catch (DS3Error& e) {
-				LOG_ERROR("ERROR:       " + op + " OBJECT failed, "+objName+
-					  "\" - "+e.ToString());
+
+			bool acquired = false;
+			while (!acquired && !workItem->WasCanceled()) {
+				acquired = controller->Acquire(ACQUIRE_TIMEOUT_IN_MS);
+			}
+			if (!acquired) {
+				canceled = true;
+				break;
+			}
+			acquired = false;
+			while (!acquired && !workItem->WasCanceled()) {
+				acquired = scheduler->AcquireTransferSlot(this, workItem,
+									  ACQUIRE_TIMEOUT_IN_MS);
+			}
+			if (!acquired) {
+				controller->Abandon();
+				canceled = true;
+				break;
 			}
+			transfers << run(&m_transferPool, this,
+					 &Client::TransferObjectInSlot, workItem,
+					 objName, filePath,
+					 bulkObj->offset, bulkObj->length);
 		}
-		workItem->IncNumChunksProcessed();
+	}
+	for (int i = 0; i < transfers.size(); i++) {
+		transfers[i].waitForFinished();
 	}
 	ds3_free_available_chunks_response(chunksResponse);
 
+	if (canceled) {
+		DeleteOrRequeueBulkWorkItem(workItem);
+		return;
+	}
+	workItem->IncNumChunksProcessed(numChunks);
+
 	if (workItem->IsPageFinished()) {
 		DeleteOrRequeueBulkWorkItem(workItem);
 	} else {
@@ -873,11 +2798,260 @@ Client::ProcessJobChunk(BulkWorkItem* workItem)
 	}
 }
 
+// Runs on the transfer pool.  The caller must have acquired a slot from the
+// work item's ConcurrencyController, which is released here along with the
+// transfer's throughput, and a TransferScheduler transfer slot.
+void
+Client::TransferObjectInSlot(BulkWorkItem* workItem, const QString& objName,
+			     const QString& filePath, uint64_t offset,
+			     uint64_t length)
+{
+	QElapsedTimer timer;
+	timer.start();
+	bool failed = !TransferObject(workItem, objName, filePath,
+				      offset, length);
+	TransferScheduler::Instance()->ReleaseTransferSlot();
+
+	ConcurrencyController* controller = workItem->GetConcurrencyController();
+	int prevLimit = controller->GetLimit();
+	controller->Release(length, timer.elapsed(), failed);
+	int limit = controller->GetLimit();
+	if (limit != prevLimit) {
+		QString op = workItem->GetType() == Job::GET ? "GET" : "PUT";
+		LOG_DEBUG(op + " concurrency for job " + workItem->GetID().toString() +
+			  " changed from " + QString::number(prevLimit) +
+			  " to " + QString::number(limit));
+	}
+}
+
+// Runs on the transfer pool
+void
+Client::TransferFolderObjects(BulkWorkItem* workItem,
+			      const QStringList& objNames)
+{
+	for (int i = 0; i < objNames.size() && !workItem->WasCanceled(); i++) {
+		const QString& objName = objNames.at(i);
+		TransferObject(workItem, objName, workItem->GetObjMapValue(objName),
+			       0, 0);
+	}
+}
+
+// GET or PUT a single object (or part of one).  Returns false if it failed.
+bool
+Client::TransferObject(BulkWorkItem* workItem, const QString& objName,
+		       const QString& filePath, uint64_t offset,
+		       uint64_t length)
+{
+	QString bucketName = workItem->GetBucketName();
+	bool isGet = workItem->GetType() == Job::GET;
+	QString op = isGet ? "GET" : "PUT";
+	bool failed = false;
+	try {
+		if (isGet && static_cast<BulkGetWorkItem*>(workItem)->HasArchive()) {
+			ArchiveObject(static_cast<ArchiveGetWorkItem*>(workItem),
+				      objName, filePath, offset, length);
+			LOG_FILE(QString("     GET     OBJECT    ")+"/"+bucketName+"/"+objName+"->"+filePath);
+		} else if (isGet) {
+			Client::GetObject(bucketName, objName,
+					  filePath, offset,
+					  length,
+					  static_cast<BulkGetWorkItem*>(workItem));
+			LOG_FILE(QString("     GET     OBJECT    ")+"/"+bucketName+"/"+objName+"->"+filePath);
+		} else if (static_cast<BulkPutWorkItem*>(workItem)->IsMigration()) {
+			MigrationWorkItem* migration = static_cast<MigrationWorkItem*>(workItem);
+			MigrateObject(migration, objName, filePath, offset, length);
+			LOG_FILE(QString("     MIGRATE OBJECT    ")+"/"+migration->GetSourceBucketName()+"/"+filePath+"->"+"/"+bucketName+"/"+objName);
+		} else {
+			Client::PutObject(bucketName, objName,
+					  filePath, offset,
+					  length,
+					  static_cast<BulkPutWorkItem*>(workItem));
+			LOG_FILE(QString("     PUT     OBJECT    ")+filePath+"->"+"/"+bucketName+"/"+objName);
+		}
+	}
+	catch (DS3Error& e) {
+		failed = true;
+		// Aborting a canceled job's transfers isn't a failure
+		if (!workItem->WasCanceled()) {
+			workItem->MarkObjectFailed(objName, e.ToString());
+		}
+		LOG_ERROR("ERROR:       " + op + " OBJECT failed, "+objName+
+			  "\" - "+e.ToString());
+	}
+	return !failed;
+}
+
+// Whether a drop is sure to be small enough for the fast path from its URLs
+// alone, so it can skip coalescing and the TransferScheduler's queue.  Only
+// files, and objects whose sizes came with the drop, qualify since a folder
+// could hold any number of objects.  IsFastPathEligible still decides once
+// the work item has been prepared.
+bool
+Client::IsFastPathDrop(const QList<QUrl>& urls, bool isGet)
+{
+	QSettings settings;
+	uint64_t maxObjects = settings.value("transfers/fastPathMaxObjects",
+					     FAST_PATH_MAX_OBJECTS).toULongLong();
+	uint64_t maxBytes = settings.value("transfers/fastPathMaxBytes",
+					   (qulonglong)FAST_PATH_MAX_BYTES).toULongLong();
+	bool expandZips = settings.value("transfers/expandZips", false).toBool();
+	if (urls.isEmpty() || (uint64_t)urls.size() > maxObjects) {
+		return false;
+	}
+
+	uint64_t totalSize = 0;
+	for (int i = 0; i < urls.size(); i++) {
+		uint64_t size = 0;
+		if (isGet) {
+			DS3URL url(urls.at(i));
+			if (url.IsBucketOrFolder() || !url.GetObjectSize(&size)) {
+				return false;
+			}
+		} else {
+			QFileInfo fileInfo(urls.at(i).toLocalFile());
+			if (!fileInfo.isFile() ||
+			    (expandZips &&
+			     fileInfo.suffix().compare("zip", Qt::CaseInsensitive) == 0)) {
+				return false;
+			}
+			size = GetFileSize(fileInfo.filePath());
+		}
+		totalSize += size;
+		if (totalSize > maxBytes) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Whether the entire work item is small enough to skip the DS3 bulk job
+// (bulk request, chunk allocation polling, etc) and use plain object
+// GETs/PUTs instead.  If so, sizes is filled with every object's size.
+bool
+Client::IsFastPathEligible(BulkWorkItem* workItem,
+			   QHash<QString, uint64_t>* sizes)
+{
+	// Only if the whole drop fit in the first page
+	if (workItem->GetResponse() != NULL || !workItem->IsFinished()) {
+		return false;
+	}
+	// Migrated objects always have to be staged by a source bulk job
+	bool isGet = workItem->GetType() == Job::GET;
+	if (!isGet && static_cast<BulkPutWorkItem*>(workItem)->IsMigration()) {
+		return false;
+	}
+
+	QSettings settings;
+	uint64_t maxObjects = settings.value("transfers/fastPathMaxObjects",
+					     FAST_PATH_MAX_OBJECTS).toULongLong();
+	uint64_t maxBytes = settings.value("transfers/fastPathMaxBytes",
+					   (qulonglong)FAST_PATH_MAX_BYTES).toULongLong();
+	uint64_t numObjects = workItem->GetObjMapSize();
+	if (numObjects == 0 || numObjects > maxObjects) {
+		return false;
+	}
+
+	uint64_t totalSize = 0;
+	QHash<QString, QString>::const_iterator hi;
+	for (hi = workItem->GetObjMapConstBegin();
+	     hi != workItem->GetObjMapConstEnd();
+	     hi++) {
+		const QString& objName = hi.key();
+		uint64_t size = 0;
+		if (objName.endsWith("/")) {
+			// Folder objects don't have any data
+		} else if (!isGet) {
+			if (!workItem->GetObjSize(objName, &size)) {
+				size = GetFileSize(hi.value());
+			}
+		} else if (!workItem->GetObjSize(objName, &size)) {
+			// Looking the size up would cost as much as the bulk
+			// job's round trips that the fast path is meant to
+			// save
+			return false;
+		}
+		totalSize += size;
+		if (totalSize > maxBytes) {
+			return false;
+		}
+		sizes->insert(objName, size);
+	}
+	return true;
+}
+
+// Look up an individually selected object's size, which isn't known from
+// PrepareBulkGets.  Returns false if it can't be determined.
+bool
+Client::GetObjectSize(const QString& bucketName, const QString& objName,
+		      uint64_t* size)
+{
+	ds3_get_bucket_response* response = NULL;
+	try {
+		response = DoGetBucket(bucketName, objName, "", "", true);
+	}
+	catch (DS3Error& e) {
+		LOG_DEBUG("Unable to get the size of " + objName + ", " + e.ToString());
+		return false;
+	}
+
+	bool found = false;
+	for (size_t i = 0; i < response->num_objects; i++) {
+		ds3_object rawObject = response->objects[i];
+		if (QString::fromUtf8(rawObject.name->value) == objName) {
+			*size = rawObject.size;
+			found = true;
+			break;
+		}
+	}
+	ds3_free_bucket_response(response);
+	return found;
+}
+
+void
+Client::DoFastPath(BulkWorkItem* workItem,
+		   const QHash<QString, uint64_t>& sizes)
+{
+	bool isGet = workItem->GetType() == Job::GET;
+	QString op = isGet ? "GET" : "PUT";
+	LOG_INFO("FAST " + op + "     OBJECTS   " +
+		 QString::number(sizes.size()) + " objects, no bulk job");
+
+	uint64_t totalSize = 0;
+	QHash<QString, uint64_t>::const_iterator si;
+	for (si = sizes.constBegin(); si != sizes.constEnd(); si++) {
+		totalSize += si.value();
+	}
+	workItem->SetPlannedSize(totalSize);
+	workItem->SetState(Job::INPROGRESS);
+	workItem->SetTransferStartIfNull();
+	Job job = workItem->ToJob();
+	emit JobProgressUpdate(job);
+
+	if (isGet) {
+		CreateBulkGetDirs(static_cast<BulkGetWorkItem*>(workItem));
+	}
+
+	// Everything, folder objects included, is sent at once.  There are
+	// few enough objects that no ConcurrencyController is needed.
+	QList<QFuture<bool> > transfers;
+	for (si = sizes.constBegin(); si != sizes.constEnd(); si++) {
+		const QString& objName = si.key();
+		transfers << run(&m_transferPool, this,
+				 &Client::TransferObject, workItem,
+				 objName, workItem->GetObjMapValue(objName),
+				 (uint64_t)0, si.value());
+	}
+	for (int i = 0; i < transfers.size(); i++) {
+		transfers[i].waitForFinished();
+	}
+
+	DeleteOrRequeueBulkWorkItem(workItem);
+}
+
 ds3_get_available_chunks_response*
-Client::GetAvailableJobChunks(BulkWorkItem* workItem)
+Client::GetAvailableJobChunks(const QString& jobID)
 {
-	ds3_bulk_response *response = workItem->GetResponse();
-	ds3_request* request = ds3_init_get_available_chunks(response->job_id->value);
+	ds3_request* request = ds3_init_get_available_chunks(jobID.toUtf8().constData());
 	ds3_get_available_chunks_response* chunkResponse;
 	ds3_error* ds3Error = ds3_get_available_chunks(m_client, request, &chunkResponse);
 	ds3_free_request(request);
@@ -894,15 +3068,40 @@ Client::GetAvailableJobChunks(BulkWorkItem* workItem)
 void
 Client::DeleteOrRequeueBulkWorkItem(BulkWorkItem* workItem)
 {
+	ManifestGetWorkItem* manifestWorkItem = NULL;
+	ArchiveGetWorkItem* archiveWorkItem = NULL;
+	if (workItem->GetType() == Job::GET &&
+	    static_cast<BulkGetWorkItem*>(workItem)->HasManifest()) {
+		manifestWorkItem = static_cast<ManifestGetWorkItem*>(workItem);
+	} else if (workItem->GetType() == Job::GET &&
+		   static_cast<BulkGetWorkItem*>(workItem)->HasArchive()) {
+		archiveWorkItem = static_cast<ArchiveGetWorkItem*>(workItem);
+	}
+
+	QString error;
 	if (workItem->WasCanceled()) {
+		if (manifestWorkItem != NULL) {
+			manifestWorkItem->FinishPage();
+		}
+		// What was transferred is kept as a valid archive
+		if (archiveWorkItem != NULL && !archiveWorkItem->Close(&error)) {
+			LOG_ERROR("ERROR:       " + error);
+		}
 		LOG_INFO("BULK GET     JOB       Canceled");
 		workItem->SetState(Job::CANCELED);
 		Job job = workItem->ToJob();
 		emit JobProgressUpdate(job);
 		DeleteBulkWorkItem(workItem);
 	} else if (workItem->IsPageFinished()) {
+		if (manifestWorkItem != NULL) {
+			manifestWorkItem->FinishPage();
+		}
 		if (workItem->IsFinished()) {
 			LOG_DEBUG("Finished with bulk work item.  Deleting it.");
+			if (archiveWorkItem != NULL && !archiveWorkItem->Close(&error)) {
+				LOG_ERROR("ERROR:       " + error);
+				workItem->IncNumFailedObjects();
+			}
 			workItem->SetState(Job::FINISHED);
 			Job job = workItem->ToJob();
 			emit JobProgressUpdate(job);
@@ -928,6 +3127,7 @@ Client::DeleteOrRequeueBulkWorkItem(BulkWorkItem* workItem)
 void
 Client::DeleteBulkWorkItem(BulkWorkItem* workItem)
 {
+	TransferScheduler::Instance()->Release(workItem);
 	m_bulkWorkItemsLock.lock();
 	m_bulkWorkItems.remove(workItem->GetID());
 	delete workItem;
@@ -977,12 +3177,7 @@ Client::ReadFile(ObjectWorkItem* workItem, char* buffer,
 		return DS3_READFUNC_ABORT;
 	}
 
-	size_t bytesRead = workItem->ReadFile(buffer, size, count);
-	if (bulkWorkItem != NULL && bulkWorkItem->IsJobUpdateReady()) {
-		Job job = bulkWorkItem->ToJob();
-		emit JobProgressUpdate(job);
-	}
-	return bytesRead;
+	return workItem->ReadFile(buffer, size, count);
 }
 
 static size_t
@@ -1003,10 +3198,39 @@ Client::WriteFile(ObjectWorkItem* workItem, char* buffer,
 		return 0;
 	}
 
-	size_t bytesWritten = workItem->WriteFile(buffer, size, count);
-	if (bulkWorkItem != NULL && bulkWorkItem->IsJobUpdateReady()) {
-		Job job = bulkWorkItem->ToJob();
-		emit JobProgressUpdate(job);
+	return workItem->WriteFile(buffer, size, count);
+}
+
+static size_t
+read_from_ring_buffer(void* buffer, size_t size, size_t count, void* user_data)
+{
+	MigrationStream* stream = static_cast<MigrationStream*>(user_data);
+	if (stream->workItem->WasCanceled()) {
+		return DS3_READFUNC_ABORT;
+	}
+	qint64 bytesRead = stream->buffer->read((char*)buffer, size * count);
+	if (bytesRead < 0) {
+		return stream->buffer->WasAborted() ? DS3_READFUNC_ABORT : 0;
+	}
+	stream->workItem->UpdateBytesTransferred(bytesRead);
+	return bytesRead;
+}
+
+static size_t
+write_to_ring_buffer(void* buffer, size_t size, size_t count, void* user_data)
+{
+	MigrationStream* stream = static_cast<MigrationStream*>(user_data);
+	if (stream->workItem->WasCanceled()) {
+		return 0;
+	}
+	uint64_t total = size * count;
+	uint64_t skip = qMin(total, stream->skip);
+	uint64_t toWrite = qMin(total - skip, stream->remaining);
+	stream->skip -= skip;
+	if (toWrite > 0 &&
+	    stream->buffer->write((char*)buffer + skip, toWrite) != (qint64)toWrite) {
+		return 0;
 	}
-	return bytesWritten;
+	stream->remaining -= toWrite;
+	return total;
 }
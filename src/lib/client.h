@@ -17,25 +17,46 @@
 #ifndef CLIENT_H
 #define CLIENT_H
 
+#include <QElapsedTimer>
 #include <QFuture>
 #include <QHash>
+#include <QIODevice>
 #include <QList>
 #include <QMutex>
 #include <QObject>
+#include <QSemaphore>
+#include <QSet>
 #include <QString>
+#include <QThreadPool>
+#include <QTimer>
 #include <QUuid>
 #include <QUrl>
 
 #include <ds3.h>
 
 #include "lib/errors/ds3_error.h"
+#include "lib/transfer_filter.h"
+#include "lib/transfer_scheduler.h"
 #include "models/job.h"
+#include "models/listing.h"
+#include "models/session.h"
 
+class ArchiveGetWorkItem;
 class BulkWorkItem;
 class BulkGetWorkItem;
 class BulkPutWorkItem;
+class ConcurrencyController;
+class DeleteWorkItem;
+class ListingCache;
+class QLocalSocket;
+class ManifestGetWorkItem;
+class MigrationWorkItem;
 class ObjectWorkItem;
-class Session;
+class RequestEngine;
+class RingBuffer;
+class StreamGetWorkItem;
+class StreamPutWorkItem;
+class TransferChannel;
 
 class Client : public QObject
 {
@@ -45,40 +66,136 @@ public:
 	static const QString DELIMITER;
 	static const uint64_t BULK_PAGE_LIMIT;
 	static const uint32_t MAX_KEYS;
+	static const int ACQUIRE_TIMEOUT_IN_MS;
+	static const int COALESCE_WINDOW_IN_MS;
+	static const int PROGRESS_INTERVAL_IN_MS;
+	static const QString DAEMON_NAME;
+	static const int DAEMON_CONNECT_TIMEOUT_IN_MS;
+	static const int FAST_PATH_MAX_OBJECTS;
+	static const uint64_t FAST_PATH_MAX_BYTES;
+	static const uint64_t LARGE_OBJECT_THRESHOLD;
+	static const uint64_t ARCHIVE_BUFFER_SIZE;
+	static const uint64_t STREAM_PART_SIZE;
+	static const uint64_t MAX_STREAM_PART_SIZE;
+	static const int STREAM_PARTS_IN_FLIGHT;
+	static const int DELETE_REQUESTS_IN_FLIGHT;
 
 	Client(const Session* session);
 	~Client();
 
+	static QString BuildEndpoint(const Session* session, const QString& host);
+	// The Client, if any, whose endpoint a DS3 URL is from
+	static Client* FindClient(const QUrl& url);
+
 	QString GetEndpoint() const;
 
+	// Only counts jobs run by this process, not the transfer daemon
 	int GetNumActiveJobs() const;
 	void CancelActiveJobs();
 
-	QFuture<ds3_get_service_response*> GetService();
-	QFuture<ds3_get_bucket_response*> GetBucket(const QString& bucketName,
-						    const QString& prefix,
-						    const QString& marker,
-						    bool silent = false,
-						    const QString& delimiter = "/");
-	QFuture<ds3_get_objects_response*> GetObjects(const QString& bucketName,
-						      const QString& id, const QString& name,
-		 				      object_type type, const QString& version);
+	// Hand BulkGet/BulkPut jobs off to the transfer daemon, starting it
+	// if it isn't running, so they survive the GUI exiting.  Connects in
+	// the background.  Jobs keep running in this process until it's
+	// connected, or for good if the daemon can't be reached.
+	void AttachToDaemon();
+
+	// The metadata requests used by the GUI are sent through the
+	// asynchronous RequestEngine rather than the C SDK.
+	QFuture<ServiceListing> GetService();
+	// maxKeys is the page size, which defaults to MAX_KEYS
+	QFuture<BucketListing> GetBucket(const QString& bucketName,
+					 const QString& prefix,
+					 const QString& marker,
+					 bool silent = false,
+					 const QString& delimiter = "/",
+					 uint32_t maxKeys = MAX_KEYS);
+	QFuture<BucketListing> GetObjects(const QString& bucketName,
+					  const QString& id, const QString& name,
+					  object_type type, const QString& version);
+	// The on-disk cache of this endpoint's listings.  It's created the
+	// first time it's asked for since only the GUI uses it.  Only
+	// accessed from the GUI thread.
+	ListingCache* GetListingCache();
 
 	void CreateBucket(const QString& name);
 	void DeleteBucket(const QString& name);
 	void DeleteObjects(const QString& bucketName, const QStringList& objectNames);
 	void DeleteFolders(const QString& bucketName, const QStringList& folderNames);
+	// Delete objects, and everything under any names ending in "/", in
+	// the background (see DeleteWorkItem).  No objectNames means the
+	// whole bucket.  If deleteBucket is set, the bucket itself is deleted
+	// last.  Like ManifestGet, deletes always run in this process.
+	// Returns the job's ID.
+	QUuid BulkDelete(const QString& bucketName,
+			 const QStringList& objectNames,
+			 bool deleteBucket = false);
 	
-	void BulkGet(const QList<QUrl> urls, const QString& destination);
+	// Objects found under any selected folders that filter rejects
+	// aren't transferred.  Jobs are only coalesced with ones that have
+	// the same filter.  The transfer daemon passes the sessionID of the
+	// GUI session that submitted the job (see Job::GetSessionID).
+	void BulkGet(const QList<QUrl> urls, const QString& destination,
+		     const TransferFilter& filter = TransferFilter(),
+		     const QUuid& sessionID = QUuid());
+
+	// Restore the objects listed in a manifest (see ManifestReader) to
+	// destination, writing the outcome of every entry to reportPath.
+	// Manifest jobs always run in this process, even when attached to
+	// the transfer daemon.  Returns the job's ID, or a null ID if either
+	// file can't be opened.
+	QUuid ManifestGet(const QString& manifestPath,
+			  const QString& destination,
+			  const QString& reportPath);
+
+	// GET objects in to a single zip or tar archive (see ArchiveWriter)
+	// instead of individual files.  Like ManifestGet, archive jobs always
+	// run in this process.  Returns the job's ID, or a null ID if the
+	// archive can't be created.
+	QUuid ArchiveGet(const QList<QUrl> urls, const QString& archivePath);
 
+	// Like BulkGet, files under selected folders are checked against
+	// filter.  Jobs are only coalesced with ones of the same priority.
 	void BulkPut(const QString& bucketName,
 		     const QString& prefix,
-		     const QList<QUrl> urls);
+		     const QList<QUrl> urls,
+		     const TransferFilter& filter = TransferFilter(),
+		     TransferScheduler::Priority priority = TransferScheduler::NORMAL,
+		     const QUuid& sessionID = QUuid());
+
+	// Copy objects from another DS3 system (the source Client's) to this
+	// one without staging them on disk.  urls are source DS3 URLs.  Like
+	// ManifestGet, migrations always run in this process.
+	void Migrate(Client* source,
+		     const QList<QUrl> urls,
+		     const QString& bucketName,
+		     const QString& prefix);
+
+	// Upload everything read from input, until it ends, as a streamed
+	// object (see StreamPutWorkItem) named objName.  Only
+	// STREAM_PARTS_IN_FLIGHT parts of partSize bytes are held in memory at
+	// once.  A partSize over MAX_STREAM_PART_SIZE is clamped to it.  Like
+	// ManifestGet, streamed jobs always run in this process.  Returns the
+	// job's ID.
+	QUuid StreamPut(QIODevice* input,
+			const QString& bucketName,
+			const QString& objName,
+			uint64_t partSize = STREAM_PART_SIZE);
+	// Write a streamed object's data to output.  destination describes
+	// output in the job's progress.
+	QUuid StreamGet(const QString& bucketName,
+			const QString& objName,
+			QIODevice* output,
+			const QString& destination);
+
+	// Called by TransferScheduler once a queued BulkGet/BulkPut job has
+	// been admitted
+	void StartBulkWorkItem(BulkWorkItem* workItem);
 
 	void GetObject(const QString& bucket,
 		       const QString& object,
 		       const QString& fileName,
 		       uint64_t offset,
+		       uint64_t length,
 		       BulkGetWorkItem* bulkGetWorkItem);
 	void PutObject(const QString& bucket,
 		       const QString& object,
@@ -94,23 +211,112 @@ public slots:
 signals:
 	void JobProgressUpdate(const Job job);
 
+private slots:
+	void SubmitCoalescedWorkItems();
+	void EmitJobProgress();
+	void ConnectToDaemon();
+	void HandleDaemonConnected();
+	void HandleDaemonConnectError();
+	void HandleDaemonJobUpdate(const Job& job);
+	void DetachFromDaemon();
+
 private:
-	ds3_get_service_response* DoGetService();
+	// A new work item that's waiting out the coalescing window before
+	// being submitted to the TransferScheduler.
+	struct CoalescingWorkItem
+	{
+		BulkWorkItem* workItem;
+		QElapsedTimer age;
+	};
+
+	// DataPath, one of the server's data interfaces that object GETs and
+	// PUTs can be sent to.  The primary endpoint is always the first.
+	struct DataPath
+	{
+		QString endpoint;
+		ds3_client* client;
+		// Bytes of the GETs/PUTs currently sent through this path
+		uint64_t outstandingBytes;
+	};
+
+	ds3_client* CreateDS3Client(const QString& endpoint,
+				    const QString& proxy);
+	ConcurrencyController* CreateConcurrencyController() const;
+	bool IsSplitBySizeEnabled() const;
+	int AcquireDataPath(uint64_t length);
+	void ReleaseDataPath(int index, uint64_t length);
+
 	ds3_get_bucket_response* DoGetBucket(const QString& bucketName,
 					     const QString& prefix,
 					     const QString& delimiter,
 					     const QString& marker,
 					     bool silent = false);
-	ds3_get_objects_response* DoGetObjects(const QString& bucketName,
-					       const QString& id, const QString& name,
-		  			       object_type type, const QString& version);
 	void PrepareBulkGets(BulkGetWorkItem* workItem);
+	void PrepareManifestGets(ManifestGetWorkItem* workItem);
 	void PrepareBulkPuts(BulkPutWorkItem* workItem);
+	void PrepareMigration(MigrationWorkItem* workItem);
+	bool StartMigrationSource(MigrationWorkItem* workItem);
+	void SubmitLargeObjects(BulkPutWorkItem* workItem,
+				QHash<QString, QString>& largeObjects);
+	bool InsertLargeObject(BulkPutWorkItem* workItem,
+			       QHash<QString, QString>& largeObjects,
+			       const QString& objName, const QString& filePath);
 	void DoBulk(BulkWorkItem* workItem);
 
 	void CreateBulkGetDirs(BulkGetWorkItem* workItem);
 	void ProcessJobChunk(BulkWorkItem* workItem);
-	ds3_get_available_chunks_response* GetAvailableJobChunks(BulkWorkItem* workItem);
+	void TransferObjectInSlot(BulkWorkItem* workItem, const QString& objName,
+				  const QString& filePath, uint64_t offset,
+				  uint64_t length);
+	void TransferFolderObjects(BulkWorkItem* workItem,
+				   const QStringList& objNames);
+	bool TransferObject(BulkWorkItem* workItem, const QString& objName,
+			    const QString& filePath, uint64_t offset,
+			    uint64_t length);
+	bool IsFastPathDrop(const QList<QUrl>& urls, bool isGet);
+	bool IsFastPathEligible(BulkWorkItem* workItem,
+				QHash<QString, uint64_t>* sizes);
+	bool GetObjectSize(const QString& bucketName, const QString& objName,
+			   uint64_t* size);
+	void DoFastPath(BulkWorkItem* workItem,
+			const QHash<QString, uint64_t>& sizes);
+	void GetObjectData(const QString& bucket, const QString& object,
+			   QIODevice* device, uint64_t offset, uint64_t length,
+			   BulkGetWorkItem* bulkGetWorkItem);
+	void ArchiveObject(ArchiveGetWorkItem* workItem, const QString& objName,
+			   const QString& filePath, uint64_t offset,
+			   uint64_t length);
+	void MigrateObject(MigrationWorkItem* workItem, const QString& objName,
+			   const QString& sourceObjName, uint64_t offset,
+			   uint64_t length);
+	void DoBulkDelete(DeleteWorkItem* workItem);
+	bool DeleteObjectBatch(DeleteWorkItem* workItem, QStringList objectNames,
+			       uint64_t size, QSemaphore* inFlight);
+	void DoStreamPut(StreamPutWorkItem* workItem);
+	bool PutStreamPart(StreamPutWorkItem* workItem, QString partName,
+			   QByteArray data, QSemaphore* inFlight);
+	void DoStreamGet(StreamGetWorkItem* workItem);
+	bool GetStreamPart(StreamGetWorkItem* workItem, int index,
+			   QByteArray* data);
+	void PutObjectData(const QString& bucket, const QString& object,
+			   QIODevice* device, uint64_t length,
+			   BulkPutWorkItem* bulkPutWorkItem);
+	QString StreamSourceRange(MigrationWorkItem* workItem,
+				  const QString& sourceObjName,
+				  uint64_t offset, uint64_t length,
+				  RingBuffer* buffer);
+	bool WaitForSourceRange(MigrationWorkItem* workItem,
+				const QString& sourceObjName,
+				uint64_t offset, uint64_t length);
+	bool WaitForSourceChunk(MigrationWorkItem* workItem,
+				uint64_t chunkNumber);
+	ds3_get_available_chunks_response* GetAvailableJobChunks(const QString& jobID);
+
+	QUuid RegisterWorkItem(BulkWorkItem* workItem);
+	QUuid SubmitWorkItem(BulkWorkItem* workItem);
+	void ApplyChunkOrdering(BulkGetWorkItem* workItem);
+	void StartCoalescing(const QString& key, BulkWorkItem* workItem);
+	BulkWorkItem* TakeCoalescingWorkItem(const QUuid& workItemID);
 
 	void DeleteOrRequeueBulkWorkItem(BulkWorkItem* workItem);
 	void DeleteBulkWorkItem(BulkWorkItem* workItem);
@@ -120,9 +326,35 @@ private:
 	QString m_host;
 	QString m_endpoint;
 	ds3_creds* m_creds;
+	// Used for all job and metadata requests
 	ds3_client* m_client;
+	RequestEngine* m_requestEngine;
+	ListingCache* m_listingCache;
+	QList<DataPath> m_dataPaths;
+	QMutex m_dataPathsLock;
+	// Runs the individual object GETs/PUTs of all jobs
+	QThreadPool m_transferPool;
 	QHash<QUuid, BulkWorkItem*> m_bulkWorkItems;
 	mutable QMutex m_bulkWorkItemsLock;
+	// Only accessed from the thread the Client lives on (the GUI thread)
+	QHash<QString, CoalescingWorkItem> m_coalescing;
+	QTimer* m_coalesceTimer;
+	QTimer* m_progressTimer;
+	// What EmitJobProgress last reported for each job in progress.  Only
+	// accessed from the GUI thread.
+	QHash<QUuid, Job> m_lastProgress;
+
+	Session m_session;
+	TransferChannel* m_daemon;
+	// Tags the jobs this Client submits to the daemon so other Clients
+	// for the same host don't show or cancel them
+	QUuid m_sessionID;
+	// Only set while AttachToDaemon is still connecting
+	QLocalSocket* m_daemonSocket;
+	QElapsedTimer m_daemonConnectTimer;
+	bool m_daemonStarted;
+	// Unfinished jobs this Client submitted to the daemon
+	QSet<QUuid> m_daemonJobs;
 
 public:
 	// Meant to be private but called from the C SDK callback function
@@ -0,0 +1,123 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QtGlobal>
+
+#include "lib/concurrency_controller.h"
+
+const int ConcurrencyController::DEFAULT_MIN = 1;
+const int ConcurrencyController::DEFAULT_MAX = 16;
+const int ConcurrencyController::MAX_LIMIT = 64;
+const double ConcurrencyController::DROP_TOLERANCE = 0.10;
+const double ConcurrencyController::DECREASE_FACTOR = 0.75;
+
+ConcurrencyController::ConcurrencyController(int min, int max)
+	: m_inFlight(0),
+	  m_roundCompletions(0),
+	  m_roundBytes(0),
+	  m_roundElapsed(0),
+	  m_roundFailed(false),
+	  m_prevThroughput(0)
+{
+	m_min = qBound(1, min, MAX_LIMIT);
+	m_max = qBound(m_min, max, MAX_LIMIT);
+	// Start low and let additive increase find the right level
+	m_limit = m_min;
+}
+
+int
+ConcurrencyController::GetLimit() const
+{
+	m_lock.lock();
+	int limit = m_limit;
+	m_lock.unlock();
+	return limit;
+}
+
+bool
+ConcurrencyController::Acquire(int timeoutInMs)
+{
+	m_lock.lock();
+	if (m_inFlight >= m_limit) {
+		m_slotFreed.wait(&m_lock, timeoutInMs);
+	}
+	bool acquired = false;
+	if (m_inFlight < m_limit) {
+		m_inFlight++;
+		acquired = true;
+	}
+	m_lock.unlock();
+	return acquired;
+}
+
+void
+ConcurrencyController::Release(uint64_t bytes, qint64 elapsedInMs, bool failed)
+{
+	ReportCompletion(bytes, elapsedInMs, failed);
+	m_lock.lock();
+	m_inFlight--;
+	m_lock.unlock();
+	m_slotFreed.wakeAll();
+}
+
+void
+ConcurrencyController::Abandon()
+{
+	m_lock.lock();
+	m_inFlight--;
+	m_lock.unlock();
+	m_slotFreed.wakeAll();
+}
+
+void
+ConcurrencyController::ReportCompletion(uint64_t bytes, qint64 elapsedInMs,
+					bool failed)
+{
+	m_lock.lock();
+	m_roundCompletions++;
+	m_roundBytes += bytes;
+	m_roundElapsed += qMax(elapsedInMs, (qint64)1);
+	m_roundFailed |= failed;
+	if (m_roundCompletions >= m_limit) {
+		EndRound();
+	}
+	m_lock.unlock();
+}
+
+// m_lock must be held
+void
+ConcurrencyController::EndRound()
+{
+	// Transfers in a round ran m_limit at a time so the wall clock time
+	// of the round is roughly the sum of their times divided by that.
+	double throughput = (double)m_roundBytes * m_limit / m_roundElapsed;
+
+	if (m_roundFailed) {
+		m_limit = m_limit / 2;
+	} else if (m_prevThroughput > 0 &&
+		   throughput < m_prevThroughput * (1.0 - DROP_TOLERANCE)) {
+		m_limit = (int)(m_limit * DECREASE_FACTOR);
+	} else {
+		m_limit++;
+	}
+	m_limit = qBound(m_min, m_limit, m_max);
+
+	m_prevThroughput = m_roundFailed ? 0 : throughput;
+	m_roundCompletions = 0;
+	m_roundBytes = 0;
+	m_roundElapsed = 0;
+	m_roundFailed = false;
+}
@@ -0,0 +1,99 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef CONCURRENCY_CONTROLLER_H
+#define CONCURRENCY_CONTROLLER_H
+
+#include <stdint.h>
+#include <QMutex>
+#include <QWaitCondition>
+
+// ConcurrencyController, decides how many object GETs/PUTs a job should have
+// in flight at once.  Each completed transfer reports its size and how long
+// it took.  Once a full "round" of transfers (one per allowed slot) has
+// completed, the round's aggregate throughput is compared to the previous
+// round's:
+//
+//   - any failed transfer halves the limit
+//   - throughput that dropped by more than DROP_TOLERANCE shrinks the limit
+//     by DECREASE_FACTOR since the server cache or local disk is saturated
+//   - otherwise the limit grows by one
+//
+// The limit always stays within [min, max].  The controller also acts as a
+// semaphore whose size is the current limit.
+class ConcurrencyController
+{
+public:
+	static const int DEFAULT_MIN;
+	static const int DEFAULT_MAX;
+	// Upper bound for the max a user can configure
+	static const int MAX_LIMIT;
+	static const double DROP_TOLERANCE;
+	static const double DECREASE_FACTOR;
+
+	ConcurrencyController(int min, int max);
+
+	int GetLimit() const;
+	int GetMin() const;
+	int GetMax() const;
+
+	// Wait up to timeoutInMs for an open slot.  Returns true if a slot
+	// was taken, in which case Release must be called once the transfer
+	// is done.
+	bool Acquire(int timeoutInMs);
+	void Release(uint64_t bytes, qint64 elapsedInMs, bool failed);
+	// Give back a slot that was never used for a transfer, without
+	// feeding anything to the AIMD algorithm
+	void Abandon();
+
+	// Feed a transfer's result to the AIMD algorithm without touching
+	// the semaphore.  Release calls this.
+	void ReportCompletion(uint64_t bytes, qint64 elapsedInMs, bool failed);
+
+private:
+	void EndRound();
+
+	int m_min;
+	int m_max;
+	int m_limit;
+	int m_inFlight;
+
+	// Current round
+	int m_roundCompletions;
+	uint64_t m_roundBytes;
+	qint64 m_roundElapsed;
+	bool m_roundFailed;
+	// Previous round's aggregate throughput in bytes/ms or 0 if
+	// there hasn't been one
+	double m_prevThroughput;
+
+	mutable QMutex m_lock;
+	QWaitCondition m_slotFreed;
+};
+
+inline int
+ConcurrencyController::GetMin() const
+{
+	return m_min;
+}
+
+inline int
+ConcurrencyController::GetMax() const
+{
+	return m_max;
+}
+
+#endif
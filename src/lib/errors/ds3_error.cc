@@ -41,6 +41,24 @@ DS3Error::DS3Error(ds3_error* error)
 	}
 }
 
+DS3Error::DS3Error(uint64_t statusCode, const QString& statusMessage,
+		   const QString& errorBody)
+	: QException(),
+	  m_code(DS3_ERROR_BAD_STATUS_CODE),
+	  m_statusCode(statusCode),
+	  m_statusMessage(statusMessage),
+	  m_errorBody(errorBody)
+{
+}
+
+DS3Error::DS3Error(const QString& message)
+	: QException(),
+	  m_code(DS3_ERROR_REQUEST_FAILED),
+	  m_message(message),
+	  m_statusCode(0)
+{
+}
+
 QString
 DS3Error::ToString() const
 {
@@ -22,14 +22,19 @@
 
 #include <ds3.h>
 
-// DS3Error, an error class used for any C SDK request that results in an
-// error.  It's a QException class so that it can be transferred across
+// DS3Error, an error class used for any C SDK or RequestEngine request that
+// results in an error.  It's a QException class so that it can be transferred across
 // threads (e.g. thrown from a "QtConcurrent::run" thread and caught from
 // the thread making a call to QFutureWatcher::result()).
 class DS3Error : public QException
 {
 public:
 	DS3Error(ds3_error* error);
+	// A request that made it to the server but got back a bad status code
+	DS3Error(uint64_t statusCode, const QString& statusMessage,
+		 const QString& errorBody);
+	// A request that failed before or while talking to the server
+	DS3Error(const QString& message);
 	virtual ~DS3Error() throw() {};
 
 	uint64_t GetStatusCode() const;
@@ -0,0 +1,284 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QDir>
+#include <QFileInfo>
+
+#ifdef Q_OS_LINUX
+#include <errno.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#include "lib/folder_watcher.h"
+#include "lib/logger.h"
+
+// Files are checked this often and are complete once they're the same in
+// two checks in a row
+const int FolderWatcher::DEFAULT_STABLE_CHECK_INTERVAL_IN_MS = 2000;
+
+// A batch is uploaded this long after its first file was added or as soon
+// as it reaches either limit.  The file limit keeps a single job's object
+// list, and thus the server's job planning, manageable.
+const int FolderWatcher::DEFAULT_BATCH_WINDOW_IN_MS = 30000;
+const uint64_t FolderWatcher::DEFAULT_BATCH_MAX_BYTES = 100ULL * 1024 * 1024 * 1024;
+const int FolderWatcher::DEFAULT_BATCH_MAX_FILES = 100000;
+
+// How long the directory has to be quiet before it's rescanned when
+// QFileSystemWatcher is used
+static const int RESCAN_DELAY_IN_MS = 500;
+
+FolderWatcher::FolderWatcher(const QString& path,
+			     const QString& bucketName,
+			     const QString& prefix,
+			     QObject* parent)
+	: QObject(parent),
+	  m_path(QDir(path).absolutePath()),
+	  m_bucketName(bucketName),
+	  m_prefix(prefix),
+	  m_stableCheckInterval(DEFAULT_STABLE_CHECK_INTERVAL_IN_MS),
+	  m_batchWindow(DEFAULT_BATCH_WINDOW_IN_MS),
+	  m_batchMaxBytes(DEFAULT_BATCH_MAX_BYTES),
+	  m_batchMaxFiles(DEFAULT_BATCH_MAX_FILES),
+	  m_inotifyFd(-1),
+	  m_notifier(NULL),
+	  m_watcher(NULL),
+	  m_batchBytes(0)
+{
+	m_rescanTimer = new QTimer(this);
+	m_rescanTimer->setSingleShot(true);
+	m_rescanTimer->setInterval(RESCAN_DELAY_IN_MS);
+	connect(m_rescanTimer, SIGNAL(timeout()), this, SLOT(Rescan()));
+
+	m_stableTimer = new QTimer(this);
+	connect(m_stableTimer, SIGNAL(timeout()), this, SLOT(CheckPending()));
+
+	m_batchTimer = new QTimer(this);
+	m_batchTimer->setSingleShot(true);
+	connect(m_batchTimer, SIGNAL(timeout()), this, SLOT(FlushBatch()));
+}
+
+FolderWatcher::~FolderWatcher()
+{
+	// Files that were complete are still uploaded
+	FlushBatch();
+#ifdef Q_OS_LINUX
+	if (m_inotifyFd >= 0) {
+		close(m_inotifyFd);
+	}
+#endif
+}
+
+bool
+FolderWatcher::Start(QString* error)
+{
+	QFileInfo dirInfo(m_path);
+	if (!dirInfo.isDir() || !dirInfo.isReadable()) {
+		*error = m_path + " isn't a readable directory";
+		return false;
+	}
+
+#ifdef Q_OS_LINUX
+	m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_inotifyFd < 0 ||
+	    inotify_add_watch(m_inotifyFd, QFile::encodeName(m_path).constData(),
+			      IN_CREATE | IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+		*error = "Unable to watch " + m_path + ", " +
+			 QString::fromLocal8Bit(strerror(errno));
+		if (m_inotifyFd >= 0) {
+			close(m_inotifyFd);
+			m_inotifyFd = -1;
+		}
+		return false;
+	}
+	m_notifier = new QSocketNotifier(m_inotifyFd, QSocketNotifier::Read, this);
+	connect(m_notifier, SIGNAL(activated(int)), this, SLOT(ReadEvents()));
+#else
+	m_watcher = new QFileSystemWatcher(this);
+	if (!m_watcher->addPath(m_path)) {
+		*error = "Unable to watch " + m_path;
+		return false;
+	}
+	connect(m_watcher, SIGNAL(directoryChanged(const QString&)),
+		this, SLOT(ScheduleRescan()));
+#endif
+
+	// Only changes from here on are uploaded
+	ScanFiles(true);
+	m_stableTimer->start(m_stableCheckInterval);
+	m_batchTimer->setInterval(m_batchWindow);
+	LOG_INFO("WATCH FOLDER " + m_path + " -> " + m_bucketName + "/" + m_prefix);
+	return true;
+}
+
+void
+FolderWatcher::ReadEvents()
+{
+#ifdef Q_OS_LINUX
+	// inotify_event is variable length with the name at the end
+	char buffer[64 * 1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+	bool overflowed = false;
+	ssize_t length;
+	while ((length = read(m_inotifyFd, buffer, sizeof(buffer))) > 0) {
+		char* p = buffer;
+		while (p < buffer + length) {
+			struct inotify_event* event = (struct inotify_event*)p;
+			if (event->mask & IN_Q_OVERFLOW) {
+				overflowed = true;
+			} else if (!(event->mask & IN_ISDIR) && event->len > 0) {
+				AddPending(m_path + "/" + QFile::decodeName(event->name));
+			}
+			p += sizeof(struct inotify_event) + event->len;
+		}
+	}
+	// A large enough burst overflows the kernel's event queue, in which
+	// case the directory has to be scanned for what was missed
+	if (overflowed) {
+		LOG_INFO("WATCH FOLDER " + m_path + " events overflowed, rescanning");
+		Rescan();
+	}
+#endif
+}
+
+void
+FolderWatcher::ScheduleRescan()
+{
+	// QFileSystemWatcher reports every change in a burst so wait for
+	// it to settle instead of rescanning for each one
+	m_rescanTimer->start();
+}
+
+void
+FolderWatcher::Rescan()
+{
+	ScanFiles(false);
+}
+
+void
+FolderWatcher::ScanFiles(bool baseline)
+{
+	QDir dir(m_path);
+	QFileInfoList files = dir.entryInfoList(QDir::Files | QDir::Hidden |
+						QDir::System);
+	for (int i = 0; i < files.size(); i++) {
+		const QFileInfo& fileInfo = files[i];
+		QString filePath = fileInfo.absoluteFilePath();
+		if (baseline) {
+			FileState state;
+			state.size = fileInfo.size();
+			state.modified = fileInfo.lastModified();
+			m_batched.insert(filePath, state);
+			continue;
+		}
+		QHash<QString, FileState>::const_iterator bi = m_batched.constFind(filePath);
+		if (bi == m_batched.constEnd() ||
+		    bi.value().size != fileInfo.size() ||
+		    bi.value().modified != fileInfo.lastModified()) {
+			AddPending(filePath);
+		}
+	}
+}
+
+void
+FolderWatcher::AddPending(const QString& filePath)
+{
+	// The next check decides whether it's still being written
+	QFileInfo fileInfo(filePath);
+	FileState state;
+	state.size = fileInfo.size();
+	state.modified = fileInfo.lastModified();
+	m_pending.insert(filePath, state);
+}
+
+void
+FolderWatcher::CheckPending()
+{
+	QMutableHashIterator<QString, FileState> pi(m_pending);
+	while (pi.hasNext()) {
+		pi.next();
+		QFileInfo fileInfo(pi.key());
+		if (!fileInfo.isFile()) {
+			// Deleted or moved away before it was complete
+			pi.remove();
+			continue;
+		}
+		FileState& state = pi.value();
+		if (state.size != fileInfo.size() ||
+		    state.modified != fileInfo.lastModified()) {
+			state.size = fileInfo.size();
+			state.modified = fileInfo.lastModified();
+			continue;
+		}
+		QHash<QString, FileState>::const_iterator bi = m_batched.constFind(pi.key());
+		if (bi == m_batched.constEnd() || bi.value().size != state.size ||
+		    bi.value().modified != state.modified) {
+			if (m_uploaded.contains(pi.key())) {
+				LOG_ERROR("ERROR:       WATCH FOLDER " + pi.key() +
+					  " was rewritten after it was uploaded.  " \
+					  "Objects can't be overwritten so it's " \
+					  "skipped.");
+				// Only reported again if it changes again
+				m_batched.insert(pi.key(), state);
+				emit FileRewritten(pi.key());
+			} else {
+				AddToBatch(pi.key(), state);
+			}
+		}
+		pi.remove();
+	}
+}
+
+void
+FolderWatcher::AddToBatch(const QString& filePath, const FileState& state)
+{
+	m_batched.insert(filePath, state);
+	m_uploaded.insert(filePath);
+	m_batch << QUrl::fromLocalFile(filePath);
+	m_batchBytes += state.size;
+	if (m_batchBytes >= m_batchMaxBytes || m_batch.size() >= m_batchMaxFiles) {
+		FlushBatch();
+	} else if (!m_batchTimer->isActive()) {
+		m_batchTimer->start();
+	}
+}
+
+void
+FolderWatcher::DiscardBatch()
+{
+	m_batchTimer->stop();
+	if (!m_batch.isEmpty()) {
+		LOG_WARNING("WATCH FOLDER " + m_path + " " +
+			    QString::number(m_batch.size()) +
+			    " files weren't uploaded");
+	}
+	m_batch.clear();
+	m_batchBytes = 0;
+}
+
+void
+FolderWatcher::FlushBatch()
+{
+	m_batchTimer->stop();
+	if (m_batch.isEmpty()) {
+		return;
+	}
+	LOG_INFO("WATCH FOLDER " + m_path + " uploading " +
+		 QString::number(m_batch.size()) + " files");
+	emit BatchReady(m_bucketName, m_prefix, m_batch);
+	m_batch.clear();
+	m_batchBytes = 0;
+}
@@ -0,0 +1,167 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef FOLDER_WATCHER_H
+#define FOLDER_WATCHER_H
+
+#include <QDateTime>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QSocketNotifier>
+#include <QString>
+#include <QTimer>
+#include <QUrl>
+
+// FolderWatcher, a "hot folder" that turns files dropped in to a local
+// directory in to batches of uploads.  New and changed files are noticed
+// with inotify on Linux, or by rescanning the directory whenever
+// QFileSystemWatcher reports it changed elsewhere.  A file is only
+// considered complete once its size and modification time stop changing
+// between two stability checks.  Complete files are then batched until the
+// batch window passes, or the batch grows past its size or file limit, so
+// a burst of files becomes a single bulk PUT instead of one job per file.
+//
+// Only files directly in the directory are watched and files that are
+// already in it when watching starts are left alone.  DS3 objects can't be
+// overwritten so a file that's rewritten after it was uploaded isn't
+// uploaded again, which would fail its whole batch.  It's reported with
+// FileRewritten instead.
+class FolderWatcher : public QObject
+{
+	Q_OBJECT
+
+public:
+	static const int DEFAULT_STABLE_CHECK_INTERVAL_IN_MS;
+	static const int DEFAULT_BATCH_WINDOW_IN_MS;
+	static const uint64_t DEFAULT_BATCH_MAX_BYTES;
+	static const int DEFAULT_BATCH_MAX_FILES;
+
+	// Batches are uploaded to bucketName/prefix
+	FolderWatcher(const QString& path,
+		      const QString& bucketName,
+		      const QString& prefix,
+		      QObject* parent = 0);
+	~FolderWatcher();
+
+	// Returns false, with a reason in error, if the directory can't be
+	// watched
+	bool Start(QString* error);
+
+	const QString& GetPath() const;
+	const QString& GetBucketName() const;
+	const QString& GetPrefix() const;
+
+	// Only take effect if called before Start
+	void SetStableCheckInterval(int ms);
+	void SetBatchWindow(int ms);
+	void SetBatchLimits(uint64_t maxBytes, int maxFiles);
+
+	// Drop the files waiting for the batch window instead of uploading
+	// them when the watcher is deleted
+	void DiscardBatch();
+
+signals:
+	void BatchReady(const QString& bucketName, const QString& prefix,
+			const QList<QUrl>& urls);
+	void FileRewritten(const QString& filePath);
+
+private slots:
+	void ReadEvents();
+	void ScheduleRescan();
+	void Rescan();
+	void CheckPending();
+	void FlushBatch();
+
+private:
+	struct FileState
+	{
+		qint64 size;
+		QDateTime modified;
+	};
+
+	void ScanFiles(bool baseline);
+	void AddPending(const QString& filePath);
+	void AddToBatch(const QString& filePath, const FileState& state);
+
+	QString m_path;
+	QString m_bucketName;
+	QString m_prefix;
+	int m_stableCheckInterval;
+	int m_batchWindow;
+	uint64_t m_batchMaxBytes;
+	int m_batchMaxFiles;
+
+	// inotify's file descriptor, or -1 if QFileSystemWatcher is used
+	int m_inotifyFd;
+	QSocketNotifier* m_notifier;
+	QFileSystemWatcher* m_watcher;
+	QTimer* m_rescanTimer;
+	QTimer* m_stableTimer;
+	QTimer* m_batchTimer;
+
+	// Files that are still being written, as of the last check
+	QHash<QString, FileState> m_pending;
+	// What every file was when it was last batched (or when watching
+	// started) so unchanged files aren't uploaded again
+	QHash<QString, FileState> m_batched;
+	// Files that have been batched, as opposed to only seen when watching
+	// started
+	QSet<QString> m_uploaded;
+	QList<QUrl> m_batch;
+	uint64_t m_batchBytes;
+};
+
+inline const QString&
+FolderWatcher::GetPath() const
+{
+	return m_path;
+}
+
+inline const QString&
+FolderWatcher::GetBucketName() const
+{
+	return m_bucketName;
+}
+
+inline const QString&
+FolderWatcher::GetPrefix() const
+{
+	return m_prefix;
+}
+
+inline void
+FolderWatcher::SetStableCheckInterval(int ms)
+{
+	m_stableCheckInterval = ms;
+}
+
+inline void
+FolderWatcher::SetBatchWindow(int ms)
+{
+	m_batchWindow = ms;
+}
+
+inline void
+FolderWatcher::SetBatchLimits(uint64_t maxBytes, int maxFiles)
+{
+	m_batchMaxBytes = maxBytes;
+	m_batchMaxFiles = maxFiles;
+}
+
+#endif
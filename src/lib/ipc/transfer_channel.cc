@@ -0,0 +1,175 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QDataStream>
+
+#include "lib/ipc/transfer_channel.h"
+#include "lib/logger.h"
+
+const QString TransferChannel::SERVER_NAME = "deep_storage_transfer_daemon";
+
+// Messages are never anywhere near this large.  Anything bigger means the
+// stream is out of sync or the peer isn't a TransferChannel.
+static const quint32 MAX_MESSAGE_SIZE = 64 * 1024 * 1024;
+
+TransferChannel::TransferChannel(QLocalSocket* socket, QObject* parent)
+	: QObject(parent),
+	  m_socket(socket)
+{
+	m_socket->setParent(this);
+	connect(m_socket, SIGNAL(readyRead()), this, SLOT(ReadMessages()));
+	connect(m_socket, SIGNAL(disconnected()), this, SIGNAL(Disconnected()));
+}
+
+void
+TransferChannel::Attach(const QUuid& sessionID, const Session& session)
+{
+	m_sessionID = sessionID;
+	QByteArray message;
+	QDataStream out(&message, QIODevice::WriteOnly);
+	out << (qint32)ATTACH << sessionID << session;
+	Send(message);
+}
+
+void
+TransferChannel::SubmitGet(const Session& session, const QList<QUrl>& urls,
+			   const QString& destination, const TransferFilter& filter)
+{
+	QByteArray message;
+	QDataStream out(&message, QIODevice::WriteOnly);
+	out << (qint32)SUBMIT_GET << session << urls << destination << filter;
+	Send(message);
+}
+
+void
+TransferChannel::SubmitPut(const Session& session, const QString& bucketName,
+			   const QString& prefix, const QList<QUrl>& urls,
+			   const TransferFilter& filter,
+			   TransferScheduler::Priority priority)
+{
+	QByteArray message;
+	QDataStream out(&message, QIODevice::WriteOnly);
+	out << (qint32)SUBMIT_PUT << session << bucketName << prefix << urls
+	    << filter << (qint32)priority;
+	Send(message);
+}
+
+void
+TransferChannel::CancelJob(const QUuid& jobID)
+{
+	QByteArray message;
+	QDataStream out(&message, QIODevice::WriteOnly);
+	out << (qint32)CANCEL_JOB << jobID;
+	Send(message);
+}
+
+void
+TransferChannel::SendJobUpdate(const Job& job)
+{
+	QByteArray message;
+	QDataStream out(&message, QIODevice::WriteOnly);
+	out << (qint32)JOB_UPDATE << job;
+	Send(message);
+}
+
+void
+TransferChannel::Send(const QByteArray& message)
+{
+	if (!IsConnected()) {
+		return;
+	}
+	QByteArray frame;
+	QDataStream out(&frame, QIODevice::WriteOnly);
+	out << message;
+	m_socket->write(frame);
+}
+
+void
+TransferChannel::ReadMessages()
+{
+	m_buffer.append(m_socket->readAll());
+	// QDataStream writes a QByteArray as a quint32 size then the data
+	while (m_buffer.size() >= (int)sizeof(quint32)) {
+		QDataStream sizeIn(m_buffer);
+		quint32 size;
+		sizeIn >> size;
+		if (size > MAX_MESSAGE_SIZE) {
+			LOG_ERROR("ERROR:       Invalid transfer daemon message");
+			m_socket->abort();
+			m_buffer.clear();
+			return;
+		}
+		int frameSize = sizeof(quint32) + size;
+		if (m_buffer.size() < frameSize) {
+			return;
+		}
+		HandleMessage(m_buffer.mid(sizeof(quint32), size));
+		m_buffer.remove(0, frameSize);
+	}
+}
+
+void
+TransferChannel::HandleMessage(const QByteArray& message)
+{
+	QDataStream in(message);
+	qint32 type;
+	in >> type;
+	switch (type) {
+	case SUBMIT_GET: {
+		Session session;
+		QList<QUrl> urls;
+		QString destination;
+		TransferFilter filter;
+		in >> session >> urls >> destination >> filter;
+		emit GetSubmitted(session, urls, destination, filter);
+		break;
+	}
+	case SUBMIT_PUT: {
+		Session session;
+		QString bucketName;
+		QString prefix;
+		QList<QUrl> urls;
+		TransferFilter filter;
+		qint32 priority;
+		in >> session >> bucketName >> prefix >> urls >> filter
+		   >> priority;
+		emit PutSubmitted(session, bucketName, prefix, urls, filter,
+				  static_cast<TransferScheduler::Priority>(priority));
+		break;
+	}
+	case CANCEL_JOB: {
+		QUuid jobID;
+		in >> jobID;
+		emit CancelRequested(jobID);
+		break;
+	}
+	case JOB_UPDATE: {
+		Job job;
+		in >> job;
+		emit JobUpdated(job);
+		break;
+	}
+	case ATTACH: {
+		Session session;
+		in >> m_sessionID >> session;
+		emit Attached(m_sessionID, session);
+		break;
+	}
+	default:
+		LOG_WARNING("Unknown transfer daemon message " +
+			    QString::number(type));
+	}
+}
@@ -0,0 +1,108 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef TRANSFER_CHANNEL_H
+#define TRANSFER_CHANNEL_H
+
+#include <QByteArray>
+#include <QList>
+#include <QLocalSocket>
+#include <QObject>
+#include <QString>
+#include <QUrl>
+#include <QUuid>
+
+#include "lib/transfer_filter.h"
+#include "lib/transfer_scheduler.h"
+#include "models/job.h"
+#include "models/session.h"
+
+// TransferChannel, one end of the local socket connection between a GUI
+// session (one Client) and the transfer daemon.  The session attaches with
+// its ID, then submits and cancels jobs, and the daemon sends back updates
+// of that session's jobs only.  Updates carry the whole Job when it's
+// first reported or changes state and otherwise only its changed progress
+// (see Job::HasURLs).  Each message is a QDataStream serialized
+// MessageType and its arguments preceded by its size.
+class TransferChannel : public QObject
+{
+	Q_OBJECT
+
+public:
+	enum MessageType { SUBMIT_GET, SUBMIT_PUT, CANCEL_JOB, JOB_UPDATE,
+			   ATTACH };
+
+	// The QLocalServer name the daemon listens on
+	static const QString SERVER_NAME;
+
+	// Takes ownership of the socket
+	TransferChannel(QLocalSocket* socket, QObject* parent = 0);
+
+	bool IsConnected() const;
+	// The ID of the GUI session on the other end, once it's attached
+	const QUuid& GetSessionID() const;
+
+	// GUI -> daemon
+	void Attach(const QUuid& sessionID, const Session& session);
+	void SubmitGet(const Session& session, const QList<QUrl>& urls,
+		       const QString& destination, const TransferFilter& filter);
+	void SubmitPut(const Session& session, const QString& bucketName,
+		       const QString& prefix, const QList<QUrl>& urls,
+		       const TransferFilter& filter,
+		       TransferScheduler::Priority priority);
+	void CancelJob(const QUuid& jobID);
+
+	// Daemon -> GUI
+	void SendJobUpdate(const Job& job);
+
+signals:
+	void Attached(const QUuid& sessionID, const Session& session);
+	void GetSubmitted(const Session& session, const QList<QUrl>& urls,
+			  const QString& destination,
+			  const TransferFilter& filter);
+	void PutSubmitted(const Session& session, const QString& bucketName,
+			  const QString& prefix, const QList<QUrl>& urls,
+			  const TransferFilter& filter,
+			  TransferScheduler::Priority priority);
+	void CancelRequested(const QUuid& jobID);
+	void JobUpdated(const Job& job);
+	void Disconnected();
+
+private slots:
+	void ReadMessages();
+
+private:
+	void Send(const QByteArray& message);
+	void HandleMessage(const QByteArray& message);
+
+	QLocalSocket* m_socket;
+	QByteArray m_buffer;
+	QUuid m_sessionID;
+};
+
+inline bool
+TransferChannel::IsConnected() const
+{
+	return m_socket->state() == QLocalSocket::ConnectedState;
+}
+
+inline const QUuid&
+TransferChannel::GetSessionID() const
+{
+	return m_sessionID;
+}
+
+#endif
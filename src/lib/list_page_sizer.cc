@@ -0,0 +1,61 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QtGlobal>
+
+#include "lib/list_page_sizer.h"
+
+const uint32_t ListPageSizer::MIN_PAGE_SIZE = 100;
+const uint32_t ListPageSizer::MAX_PAGE_SIZE = 10000;
+const uint32_t ListPageSizer::INITIAL_PAGE_SIZE = 1000;
+const int ListPageSizer::TARGET_LATENCY_IN_MS = 500;
+
+ListPageSizer::ListPageSizer()
+	: m_pageSize(INITIAL_PAGE_SIZE)
+{
+}
+
+uint32_t
+ListPageSizer::GetPageSize() const
+{
+	m_lock.lock();
+	uint32_t pageSize = m_pageSize;
+	m_lock.unlock();
+	return pageSize;
+}
+
+void
+ListPageSizer::ReportListing(uint32_t numKeys, qint64 elapsedInMs)
+{
+	if (numKeys == 0) {
+		// An empty listing says nothing about the rate
+		return;
+	}
+
+	double elapsed = static_cast<double>(qMax(elapsedInMs, (qint64)1));
+	double ideal = numKeys * (TARGET_LATENCY_IN_MS / elapsed);
+
+	m_lock.lock();
+	double lower = qMax(m_pageSize / 2.0, static_cast<double>(MIN_PAGE_SIZE));
+	double upper = qMin(m_pageSize * 2.0, static_cast<double>(MAX_PAGE_SIZE));
+	// The time of a short page, the end of a folder, is mostly the
+	// round trip so it's only trusted to grow the page size
+	if (numKeys < m_pageSize && ideal < m_pageSize) {
+		ideal = m_pageSize;
+	}
+	m_pageSize = static_cast<uint32_t>(qBound(lower, ideal, upper));
+	m_lock.unlock();
+}
@@ -0,0 +1,54 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef LIST_PAGE_SIZER_H
+#define LIST_PAGE_SIZER_H
+
+#include <stdint.h>
+#include <QMutex>
+
+// ListPageSizer, picks the max-keys of the GET bucket requests the browser
+// pages through folders with.  Each listing reports how many keys it
+// returned and how long it took.  The next page is sized so that, at the
+// observed rate, it would take TARGET_LATENCY_IN_MS:
+//
+//   - a server that answers quickly gets bigger pages so fewer round trips
+//     are needed to reach the end of a large folder
+//   - a slow server gets smaller pages so rows keep showing up while the
+//     user scrolls
+//
+// A page never grows or shrinks by more than a factor of two at a time and
+// always stays within [MIN_PAGE_SIZE, MAX_PAGE_SIZE].
+class ListPageSizer
+{
+public:
+	static const uint32_t MIN_PAGE_SIZE;
+	static const uint32_t MAX_PAGE_SIZE;
+	// The DS3 server's own default
+	static const uint32_t INITIAL_PAGE_SIZE;
+	static const int TARGET_LATENCY_IN_MS;
+
+	ListPageSizer();
+
+	uint32_t GetPageSize() const;
+	void ReportListing(uint32_t numKeys, qint64 elapsedInMs);
+
+private:
+	uint32_t m_pageSize;
+	mutable QMutex m_lock;
+};
+
+#endif
@@ -0,0 +1,355 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent>
+
+#include "lib/listing_cache.h"
+#include "lib/logger.h"
+
+using QtConcurrent::run;
+
+const int ListingCache::DEFAULT_TTL_IN_SECS = 7 * 24 * 60 * 60;
+const qint64 ListingCache::DEFAULT_MAX_SIZE = 64 * 1024 * 1024;
+
+static const quint32 MAGIC = 0x44334c43;
+static const quint16 VERSION = 1;
+static const QString SERVICE_KEY = "service";
+
+static QString
+BucketKey(const QString& bucketName, const QString& prefix)
+{
+	return "bucket\n" + bucketName + "\n" + prefix;
+}
+
+static QByteArray
+Header(const QString& key, qint64 storedAt)
+{
+	QByteArray header;
+	QDataStream out(&header, QIODevice::WriteOnly);
+	out.setVersion(QDataStream::Qt_5_0);
+	out << MAGIC << VERSION << key << storedAt;
+	return header;
+}
+
+static QByteArray
+SerializeService(const ServiceListing& listing)
+{
+	QByteArray payload;
+	QDataStream out(&payload, QIODevice::WriteOnly);
+	out.setVersion(QDataStream::Qt_5_0);
+	const QList<ListedBucket>& buckets = listing.GetBuckets();
+	out << listing.GetOwner() << (quint32)buckets.size();
+	for (int i = 0; i < buckets.size(); i++) {
+		out << buckets.at(i).GetName() << buckets.at(i).GetCreationDate();
+	}
+	return payload;
+}
+
+static bool
+DeserializeService(const QByteArray& payload, ServiceListing* listing)
+{
+	QDataStream in(payload);
+	in.setVersion(QDataStream::Qt_5_0);
+	QString owner;
+	quint32 numBuckets = 0;
+	in >> owner >> numBuckets;
+	listing->SetOwner(owner);
+	for (quint32 i = 0; i < numBuckets && in.status() == QDataStream::Ok; i++) {
+		QString name;
+		QString creationDate;
+		in >> name >> creationDate;
+		ListedBucket bucket;
+		bucket.SetName(name);
+		bucket.SetCreationDate(creationDate);
+		listing->AppendBucket(bucket);
+	}
+	return in.status() == QDataStream::Ok;
+}
+
+static QByteArray
+SerializeBucket(const BucketListing& listing)
+{
+	QByteArray payload;
+	QDataStream out(&payload, QIODevice::WriteOnly);
+	out.setVersion(QDataStream::Qt_5_0);
+	const QList<ListedObject>& objects = listing.GetObjects();
+	out << (quint32)objects.size();
+	for (int i = 0; i < objects.size(); i++) {
+		const ListedObject& object = objects.at(i);
+		out << object.GetName() << object.GetOwner()
+		    << (quint64)object.GetSize() << object.GetLastModified();
+	}
+	out << listing.GetCommonPrefixes() << listing.GetNextMarker()
+	    << listing.IsTruncated();
+	return payload;
+}
+
+static bool
+DeserializeBucket(const QByteArray& payload, BucketListing* listing)
+{
+	QDataStream in(payload);
+	in.setVersion(QDataStream::Qt_5_0);
+	quint32 numObjects = 0;
+	in >> numObjects;
+	for (quint32 i = 0; i < numObjects && in.status() == QDataStream::Ok; i++) {
+		QString name;
+		QString owner;
+		quint64 size;
+		QString lastModified;
+		in >> name >> owner >> size >> lastModified;
+		ListedObject object;
+		object.SetName(name);
+		object.SetOwner(owner);
+		object.SetSize(size);
+		object.SetLastModified(lastModified);
+		listing->AppendObject(object);
+	}
+	QStringList commonPrefixes;
+	QString nextMarker;
+	bool truncated = false;
+	in >> commonPrefixes >> nextMarker >> truncated;
+	for (int i = 0; i < commonPrefixes.size(); i++) {
+		listing->AppendCommonPrefix(commonPrefixes.at(i));
+	}
+	listing->SetNextMarker(nextMarker);
+	listing->SetTruncated(truncated);
+	return in.status() == QDataStream::Ok;
+}
+
+ListingCache::ListingCache(const QString& dir, int ttlInSecs, qint64 maxSize)
+	: m_dir(dir),
+	  m_ttlInSecs(ttlInSecs),
+	  m_maxSize(maxSize),
+	  m_size(0)
+{
+	m_writePool.setMaxThreadCount(1);
+	QDir().mkpath(m_dir);
+	QFileInfoList entries = QDir(m_dir).entryInfoList(QDir::Files);
+	for (int i = 0; i < entries.size(); i++) {
+		m_size += entries.at(i).size();
+	}
+}
+
+ListingCache::~ListingCache()
+{
+	WaitForWrites();
+}
+
+QString
+ListingCache::GetDefaultDir(const QString& endpoint, const QString& accessId)
+{
+	QString base = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+	QByteArray hash = QCryptographicHash::hash((endpoint + "\n" + accessId).toUtf8(),
+						   QCryptographicHash::Sha1);
+	return base + "/listings/" + QString::fromLatin1(hash.toHex());
+}
+
+qint64
+ListingCache::GetSize() const
+{
+	m_lock.lock();
+	qint64 size = m_size;
+	m_lock.unlock();
+	return size;
+}
+
+bool
+ListingCache::GetService(ServiceListing* listing) const
+{
+	QByteArray payload;
+	return Read(SERVICE_KEY, &payload) &&
+	       DeserializeService(payload, listing);
+}
+
+bool
+ListingCache::GetBucket(const QString& bucketName, const QString& prefix,
+			BucketListing* listing) const
+{
+	QByteArray payload;
+	return Read(BucketKey(bucketName, prefix), &payload) &&
+	       DeserializeBucket(payload, listing);
+}
+
+bool
+ListingCache::PutService(const ServiceListing& listing)
+{
+	return Put(SERVICE_KEY, SerializeService(listing));
+}
+
+bool
+ListingCache::PutBucket(const QString& bucketName, const QString& prefix,
+			const BucketListing& listing)
+{
+	return Put(BucketKey(bucketName, prefix), SerializeBucket(listing));
+}
+
+void
+ListingCache::WaitForWrites()
+{
+	m_writePool.waitForDone();
+}
+
+void
+ListingCache::Clear()
+{
+	WaitForWrites();
+	m_lock.lock();
+	QDir dir(m_dir);
+	QStringList entries = dir.entryList(QDir::Files);
+	for (int i = 0; i < entries.size(); i++) {
+		dir.remove(entries.at(i));
+	}
+	m_size = 0;
+	m_lock.unlock();
+	m_readPayloadsLock.lock();
+	m_readPayloads.clear();
+	m_readPayloadsLock.unlock();
+}
+
+// Map the entry's file and copy out its payload.  The listings are small
+// relative to the page cache so a copy of the mapped bytes is cheaper than
+// a buffered read through QFile.
+bool
+ListingCache::Read(const QString& key, QByteArray* payload) const
+{
+	QFile file(GetPath(key));
+	if (!file.open(QIODevice::ReadOnly)) {
+		return false;
+	}
+	qint64 size = file.size();
+	uchar* data = size > 0 ? file.map(0, size) : NULL;
+	if (data == NULL) {
+		return false;
+	}
+
+	QByteArray raw = QByteArray::fromRawData(reinterpret_cast<const char*>(data),
+						 static_cast<int>(size));
+	QDataStream in(raw);
+	in.setVersion(QDataStream::Qt_5_0);
+	quint32 magic = 0;
+	quint16 version = 0;
+	QString storedKey;
+	qint64 storedAt = 0;
+	in >> magic >> version >> storedKey >> storedAt;
+	bool valid = (in.status() == QDataStream::Ok && magic == MAGIC &&
+		      version == VERSION && storedKey == key);
+	qint64 age = QDateTime::currentMSecsSinceEpoch() - storedAt;
+	bool expired = age > m_ttlInSecs * 1000LL;
+	if (valid && !expired) {
+		int headerSize = static_cast<int>(in.device()->pos());
+		*payload = QByteArray(raw.constData() + headerSize,
+				      raw.size() - headerSize);
+	}
+	file.unmap(data);
+	file.close();
+
+	if (valid && !expired) {
+		m_readPayloadsLock.lock();
+		m_readPayloads.insert(key, *payload);
+		m_readPayloadsLock.unlock();
+	}
+	if (!valid || expired) {
+		m_lock.lock();
+		if (QFile::remove(GetPath(key))) {
+			m_size -= size;
+		}
+		m_lock.unlock();
+		return false;
+	}
+	return true;
+}
+
+// Compare the listing with the copy last read, rather than the one on
+// disk, and queue the write so the caller only pays for serializing it
+bool
+ListingCache::Put(const QString& key, const QByteArray& payload)
+{
+	m_readPayloadsLock.lock();
+	QHash<QString, QByteArray>::iterator read = m_readPayloads.find(key);
+	bool changed = true;
+	if (read != m_readPayloads.end()) {
+		changed = read.value() != payload;
+		m_readPayloads.erase(read);
+	}
+	m_readPayloadsLock.unlock();
+
+	run(&m_writePool, this, &ListingCache::Write, key, payload,
+	    QDateTime::currentMSecsSinceEpoch());
+	return changed;
+}
+
+// Runs on the write pool
+void
+ListingCache::Write(const QString& key, const QByteArray& payload,
+		    qint64 storedAt)
+{
+	QString path = GetPath(key);
+	QByteArray header = Header(key, storedAt);
+	QFileInfo existing(path);
+	qint64 oldSize = existing.exists() ? existing.size() : 0;
+
+	QSaveFile file(path);
+	if (!file.open(QIODevice::WriteOnly) ||
+	    file.write(header) != header.size() ||
+	    file.write(payload) != payload.size() ||
+	    !file.commit()) {
+		LOG_DEBUG("Failed to write listing cache entry " + path);
+		return;
+	}
+
+	m_lock.lock();
+	m_size += header.size() + payload.size() - oldSize;
+	if (m_size > m_maxSize) {
+		Trim(path);
+	}
+	m_lock.unlock();
+}
+
+QString
+ListingCache::GetPath(const QString& key) const
+{
+	QByteArray hash = QCryptographicHash::hash(key.toUtf8(),
+						   QCryptographicHash::Sha1);
+	return m_dir + "/" + QString::fromLatin1(hash.toHex());
+}
+
+// Remove the least recently written entries, other than the one that was
+// just written, until the cache is down to three quarters of its cap so
+// every write doesn't have to trim.  Must be called with m_lock held.
+void
+ListingCache::Trim(const QString& keepPath)
+{
+	QDir dir(m_dir);
+	QFileInfoList entries = dir.entryInfoList(QDir::Files, QDir::Time);
+	QString keep = QFileInfo(keepPath).absoluteFilePath();
+	qint64 target = m_maxSize / 4 * 3;
+	for (int i = entries.size() - 1; i >= 0 && m_size > target; i--) {
+		if (entries.at(i).absoluteFilePath() == keep) {
+			continue;
+		}
+		if (dir.remove(entries.at(i).fileName())) {
+			m_size -= entries.at(i).size();
+		}
+	}
+}
@@ -0,0 +1,102 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef LISTING_CACHE_H
+#define LISTING_CACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QThreadPool>
+
+#include "models/listing.h"
+
+// ListingCache, an on-disk cache of one DS3 endpoint's bucket list and the
+// first page of each folder listing.  The browser shows a cached listing
+// as soon as a folder is opened and revalidates it with a real request in
+// the background, so reopening a session over a slow link shows the
+// last-known tree right away.
+//
+// Each listing is a file, named after a hash of its bucket and prefix,
+// holding a small header and the QDataStream serialized listing.  Files are
+// memory mapped when read.  Entries older than the TTL are ignored and
+// removed, and the least recently written entries are removed once the
+// cache grows past its size cap.  Entries are written, and the cache
+// trimmed, by a thread of the cache's own so storing a listing never
+// blocks the GUI on the disk.
+class ListingCache
+{
+public:
+	static const int DEFAULT_TTL_IN_SECS;
+	static const qint64 DEFAULT_MAX_SIZE;
+
+	ListingCache(const QString& dir,
+		     int ttlInSecs = DEFAULT_TTL_IN_SECS,
+		     qint64 maxSize = DEFAULT_MAX_SIZE);
+	~ListingCache();
+
+	// The cache directory of an endpoint, as seen by one user, under the
+	// user's cache location.  Users with different access IDs can see
+	// different buckets so they never share a cache.
+	static QString GetDefaultDir(const QString& endpoint,
+				     const QString& accessId);
+
+	const QString& GetDir() const;
+	qint64 GetSize() const;
+
+	bool GetService(ServiceListing* listing) const;
+	bool GetBucket(const QString& bucketName, const QString& prefix,
+		       BucketListing* listing) const;
+	// Queue a listing to be stored.  Returns false if it's the same as
+	// the listing last read from the cache, which means the cached copy
+	// that may have been displayed was still valid.
+	bool PutService(const ServiceListing& listing);
+	bool PutBucket(const QString& bucketName, const QString& prefix,
+		       const BucketListing& listing);
+	// Block until every queued listing has been written
+	void WaitForWrites();
+	void Clear();
+
+private:
+	bool Read(const QString& key, QByteArray* payload) const;
+	bool Put(const QString& key, const QByteArray& payload);
+	void Write(const QString& key, const QByteArray& payload,
+		   qint64 storedAt);
+	QString GetPath(const QString& key) const;
+	void Trim(const QString& keepPath);
+
+	const QString m_dir;
+	const int m_ttlInSecs;
+	const qint64 m_maxSize;
+	mutable qint64 m_size;
+	mutable QMutex m_lock;
+	// The payloads read but not yet replaced by a Put, for Put to
+	// compare against without going to the disk.  They have a lock of
+	// their own so a Put never waits on a write trimming the cache.
+	mutable QHash<QString, QByteArray> m_readPayloads;
+	mutable QMutex m_readPayloadsLock;
+	// Only one thread so entries are written in the order they were put
+	QThreadPool m_writePool;
+};
+
+inline const QString&
+ListingCache::GetDir() const
+{
+	return m_dir;
+}
+
+#endif
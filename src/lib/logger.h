@@ -17,13 +17,21 @@
 #ifndef LOGGER_H
 #define LOGGER_H
 
+// Headless builds log to stderr instead of the Console widget.  Both have
+// the same Instance/Log interface and levels.
+#ifdef HEADLESS
+#include "cli/cli_logger.h"
+typedef CliLogger LogSink;
+#else
 #include "views/console.h"
+typedef Console LogSink;
+#endif
 
-#define LOG_DEBUG(msg)   LOG(Console::DEBUG,   msg)
-#define LOG_INFO(msg)    LOG(Console::INFO,    msg)
-#define LOG_WARNING(msg) LOG(Console::WARNING, msg)
-#define LOG_ERROR(msg)   LOG(Console::ERR,     msg)
-#define LOG_FILE(msg)    LOG(Console::FILE,    msg)
-#define LOG(level, msg)  Console::Instance()->Log(level, msg)
+#define LOG_DEBUG(msg)   LOG(LogSink::DEBUG,   msg)
+#define LOG_INFO(msg)    LOG(LogSink::INFO,    msg)
+#define LOG_WARNING(msg) LOG(LogSink::WARNING, msg)
+#define LOG_ERROR(msg)   LOG(LogSink::ERR,     msg)
+#define LOG_FILE(msg)    LOG(LogSink::FILE,    msg)
+#define LOG(level, msg)  LogSink::Instance()->Log(level, msg)
 
 #endif
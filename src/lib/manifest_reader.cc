@@ -0,0 +1,146 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QStringList>
+
+#include "lib/manifest_reader.h"
+
+ManifestReader::Format
+ManifestReader::FormatFromFileName(const QString& fileName)
+{
+	if (fileName.endsWith(".csv", Qt::CaseInsensitive)) {
+		return CSV;
+	}
+	return LINES;
+}
+
+bool
+ManifestReader::ParseLine(const QString& line, Format format,
+			  ManifestEntry* entry)
+{
+	entry->bucket.clear();
+	entry->object.clear();
+	entry->destination.clear();
+	entry->error.clear();
+
+	if (format == CSV) {
+		QStringList fields;
+		if (!SplitCSV(line, &fields)) {
+			entry->error = "Unterminated quoted field";
+			return false;
+		}
+		if (fields.size() < 2 || fields.size() > 3) {
+			entry->error = "Expected bucket,object[,destination]";
+			return false;
+		}
+		entry->bucket = fields[0].trimmed();
+		entry->object = fields[1];
+		if (fields.size() == 3) {
+			entry->destination = fields[2].trimmed();
+		}
+	} else {
+		QString path = line.trimmed();
+		if (path.startsWith("/")) {
+			path.remove(0, 1);
+		}
+		entry->bucket = path.section("/", 0, 0);
+		entry->object = path.section("/", 1);
+	}
+
+	if (entry->bucket.isEmpty() || entry->object.isEmpty()) {
+		entry->error = "Missing bucket or object name";
+		return false;
+	}
+	return true;
+}
+
+QString
+ManifestReader::QuoteCSV(const QString& field)
+{
+	if (!field.contains(',') && !field.contains('"') &&
+	    !field.contains('\n')) {
+		return field;
+	}
+	QString quoted = field;
+	quoted.replace("\"", "\"\"");
+	return "\"" + quoted + "\"";
+}
+
+// Split a CSV line into its fields.  Quoted fields may contain commas and
+// "" for a literal quote.  Returns false if a quote isn't terminated.
+bool
+ManifestReader::SplitCSV(const QString& line, QStringList* fields)
+{
+	QString field;
+	bool quoted = false;
+	for (int i = 0; i < line.size(); i++) {
+		QChar c = line[i];
+		if (quoted) {
+			if (c != '"') {
+				field += c;
+			} else if (i + 1 < line.size() && line[i + 1] == '"') {
+				field += c;
+				i++;
+			} else {
+				quoted = false;
+			}
+		} else if (c == '"') {
+			quoted = true;
+		} else if (c == ',') {
+			*fields << field;
+			field.clear();
+		} else {
+			field += c;
+		}
+	}
+	*fields << field;
+	return !quoted;
+}
+
+ManifestReader::ManifestReader(QIODevice* device, Format format)
+	: m_in(device),
+	  m_format(format),
+	  m_line(0)
+{
+	m_in.setCodec("UTF-8");
+}
+
+bool
+ManifestReader::ReadEntry(ManifestEntry* entry)
+{
+	while (!m_in.atEnd()) {
+		QString line = m_in.readLine();
+		m_line++;
+		QString trimmed = line.trimmed();
+		if (trimmed.isEmpty() || trimmed.startsWith("#")) {
+			continue;
+		}
+		if (m_format == CSV && m_line == 1 &&
+		    trimmed.startsWith("bucket,object", Qt::CaseInsensitive)) {
+			continue;
+		}
+		entry->line = m_line;
+		ParseLine(line, m_format, entry);
+		return true;
+	}
+	return false;
+}
+
+bool
+ManifestReader::AtEnd() const
+{
+	return m_in.atEnd();
+}
@@ -0,0 +1,79 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef MANIFEST_READER_H
+#define MANIFEST_READER_H
+
+#include <QIODevice>
+#include <QString>
+#include <QTextStream>
+
+// ManifestEntry, one object to restore as listed on a manifest line
+struct ManifestEntry
+{
+	ManifestEntry() : line(0) {}
+
+	// 1 based line number in the manifest
+	qint64 line;
+	QString bucket;
+	QString object;
+	// Optional.  Empty means the object's name under the job's destination.
+	QString destination;
+	// Set instead of the above when the line couldn't be parsed
+	QString error;
+};
+
+// ManifestReader, reads a restore manifest one line at a time so a manifest
+// listing millions of objects never has to be held in memory.  Two formats
+// are supported:
+//
+//   LINES  bucket/object per line
+//   CSV    bucket,object[,destination] per line with RFC 4180 quoting
+//
+// Blank lines and lines starting with # are skipped in both.  A CSV
+// manifest may start with a bucket,object[,destination] header line.
+class ManifestReader
+{
+public:
+	enum Format { LINES, CSV };
+
+	// .csv manifests are CSV, anything else is LINES
+	static Format FormatFromFileName(const QString& fileName);
+
+	// Parse a single, non-blank manifest line.  Returns false and sets
+	// entry's error if it's invalid.
+	static bool ParseLine(const QString& line, Format format,
+			      ManifestEntry* entry);
+	// Quote a field for a CSV line written by us (e.g. a report)
+	static QString QuoteCSV(const QString& field);
+
+	// device must already be open and outlive the reader
+	ManifestReader(QIODevice* device, Format format);
+
+	// Read the next entry, valid or not.  Returns false at the end of the
+	// manifest.
+	bool ReadEntry(ManifestEntry* entry);
+	bool AtEnd() const;
+
+private:
+	static bool SplitCSV(const QString& line, QStringList* fields);
+
+	QTextStream m_in;
+	Format m_format;
+	qint64 m_line;
+};
+
+#endif
@@ -0,0 +1,171 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QXmlStreamReader>
+
+#include "lib/requests/listing_parser.h"
+
+static QString
+ReadOwner(QXmlStreamReader& xml)
+{
+	QString owner;
+	while (xml.readNextStartElement()) {
+		if (xml.name() == "DisplayName") {
+			owner = xml.readElementText();
+		} else {
+			xml.skipCurrentElement();
+		}
+	}
+	return owner;
+}
+
+// Reads either a get bucket "Contents" element or a get objects "S3Object"
+// element.  The reader must be positioned on the element's start tag.
+static ListedObject
+ReadObject(QXmlStreamReader& xml)
+{
+	ListedObject object;
+	QString creationDate;
+	while (xml.readNextStartElement()) {
+		QStringRef name = xml.name();
+		if (name == "Key" || name == "Name") {
+			object.SetName(xml.readElementText());
+		} else if (name == "Size") {
+			object.SetSize(xml.readElementText().toULongLong());
+		} else if (name == "LastModified") {
+			object.SetLastModified(xml.readElementText());
+		} else if (name == "CreationDate") {
+			creationDate = xml.readElementText();
+		} else if (name == "Owner") {
+			object.SetOwner(ReadOwner(xml));
+		} else {
+			xml.skipCurrentElement();
+		}
+	}
+	// Get objects responses only include a creation date
+	if (object.GetLastModified().isEmpty()) {
+		object.SetLastModified(creationDate);
+	}
+	return object;
+}
+
+static ListedBucket
+ReadBucket(QXmlStreamReader& xml)
+{
+	ListedBucket bucket;
+	while (xml.readNextStartElement()) {
+		QStringRef name = xml.name();
+		if (name == "Name") {
+			bucket.SetName(xml.readElementText());
+		} else if (name == "CreationDate") {
+			bucket.SetCreationDate(xml.readElementText());
+		} else {
+			xml.skipCurrentElement();
+		}
+	}
+	return bucket;
+}
+
+static bool
+Finish(const QXmlStreamReader& xml, const QByteArray& body, QString* error)
+{
+	// An empty body is simply an empty listing
+	if (xml.hasError() && !body.trimmed().isEmpty()) {
+		*error = "Invalid XML response, " + xml.errorString();
+		return false;
+	}
+	return true;
+}
+
+bool
+ListingParser::ParseService(const QByteArray& body,
+			    ServiceListing* listing,
+			    QString* error)
+{
+	QXmlStreamReader xml(body);
+	// ListAllMyBucketsResult
+	if (xml.readNextStartElement()) {
+		while (xml.readNextStartElement()) {
+			QStringRef name = xml.name();
+			if (name == "Owner") {
+				listing->SetOwner(ReadOwner(xml));
+			} else if (name == "Buckets") {
+				while (xml.readNextStartElement()) {
+					if (xml.name() == "Bucket") {
+						listing->AppendBucket(ReadBucket(xml));
+					} else {
+						xml.skipCurrentElement();
+					}
+				}
+			} else {
+				xml.skipCurrentElement();
+			}
+		}
+	}
+	return Finish(xml, body, error);
+}
+
+bool
+ListingParser::ParseBucket(const QByteArray& body,
+			   BucketListing* listing,
+			   QString* error)
+{
+	QXmlStreamReader xml(body);
+	// ListBucketResult
+	if (xml.readNextStartElement()) {
+		while (xml.readNextStartElement()) {
+			QStringRef name = xml.name();
+			if (name == "Contents") {
+				listing->AppendObject(ReadObject(xml));
+			} else if (name == "CommonPrefixes") {
+				while (xml.readNextStartElement()) {
+					if (xml.name() == "Prefix") {
+						listing->AppendCommonPrefix(xml.readElementText());
+					} else {
+						xml.skipCurrentElement();
+					}
+				}
+			} else if (name == "NextMarker") {
+				listing->SetNextMarker(xml.readElementText());
+			} else if (name == "IsTruncated") {
+				QString truncated = xml.readElementText();
+				listing->SetTruncated(truncated == "true");
+			} else {
+				xml.skipCurrentElement();
+			}
+		}
+	}
+	return Finish(xml, body, error);
+}
+
+bool
+ListingParser::ParseObjects(const QByteArray& body,
+			    BucketListing* listing,
+			    QString* error)
+{
+	QXmlStreamReader xml(body);
+	// Data
+	if (xml.readNextStartElement()) {
+		while (xml.readNextStartElement()) {
+			if (xml.name() == "S3Object") {
+				listing->AppendObject(ReadObject(xml));
+			} else {
+				xml.skipCurrentElement();
+			}
+		}
+	}
+	return Finish(xml, body, error);
+}
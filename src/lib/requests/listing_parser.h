@@ -0,0 +1,42 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef LISTING_PARSER_H
+#define LISTING_PARSER_H
+
+#include <QByteArray>
+#include <QString>
+
+#include "models/listing.h"
+
+// ListingParser, turns the XML bodies of DS3 get service, get bucket and
+// get objects responses into their Listing equivalents.  Each method
+// returns false, and sets error, if the body isn't well-formed XML.
+class ListingParser
+{
+public:
+	static bool ParseService(const QByteArray& body,
+				 ServiceListing* listing,
+				 QString* error);
+	static bool ParseBucket(const QByteArray& body,
+				BucketListing* listing,
+				QString* error);
+	static bool ParseObjects(const QByteArray& body,
+				 BucketListing* listing,
+				 QString* error);
+};
+
+#endif
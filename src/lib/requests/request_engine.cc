@@ -0,0 +1,563 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QDateTime>
+#include <QLocale>
+#include <QMessageAuthenticationCode>
+#include <QStringList>
+#include <QUrl>
+
+#include "lib/logger.h"
+#include "lib/requests/listing_parser.h"
+#include "lib/requests/request_engine.h"
+#include "models/session.h"
+
+static int socket_callback(CURL* easy, curl_socket_t socket, int what,
+			   void* userp, void* socketp);
+static int timer_callback(CURLM* multi, long timeoutInMs, void* userp);
+static size_t body_callback(char* data, size_t size, size_t count,
+			    void* userData);
+static size_t header_callback(char* data, size_t size, size_t count,
+			      void* userData);
+static int progress_callback(void* userData,
+			     curl_off_t downloadTotal, curl_off_t downloadNow,
+			     curl_off_t uploadTotal, curl_off_t uploadNow);
+
+// curl_global_init and curl_global_cleanup aren't thread safe and libcurl's
+// global state is shared with the C SDK's transfers, so they're called once
+// for the whole process, before main starts and after it returns.
+class CurlGlobal
+{
+public:
+	CurlGlobal()
+	{
+		curl_global_init(CURL_GLOBAL_ALL);
+	}
+
+	~CurlGlobal()
+	{
+		curl_global_cleanup();
+	}
+};
+
+static CurlGlobal curlGlobal;
+
+//
+// MetadataRequest
+//
+
+MetadataRequest::MetadataRequest(const QString& resource,
+				 const QueryParams& query)
+	: m_resource(resource),
+	  m_query(query),
+	  m_handle(NULL),
+	  m_headers(NULL)
+{
+}
+
+MetadataRequest::~MetadataRequest()
+{
+	if (m_handle != NULL) {
+		curl_easy_cleanup(m_handle);
+	}
+	if (m_headers != NULL) {
+		curl_slist_free_all(m_headers);
+	}
+}
+
+QString
+MetadataRequest::GetQueryString() const
+{
+	QStringList params;
+	for (int i = 0; i < m_query.size(); i++) {
+		const QPair<QString, QString>& param = m_query.at(i);
+		params << QUrl::toPercentEncoding(param.first) + "=" +
+			  QUrl::toPercentEncoding(param.second);
+	}
+	QString query;
+	if (!params.isEmpty()) {
+		query = "?" + params.join("&");
+	}
+	return query;
+}
+
+void
+MetadataRequest::SetHandle(CURL* handle, struct curl_slist* headers)
+{
+	m_handle = handle;
+	m_headers = headers;
+}
+
+void
+MetadataRequest::SetStatusLine(const QByteArray& line)
+{
+	// e.g. "HTTP/1.1 404 Not Found".  Redirects and 100 Continue
+	// responses mean there can be more than one of these; the last one
+	// wins.
+	QList<QByteArray> parts = line.trimmed().split(' ');
+	if (parts.size() >= 3) {
+		parts.removeFirst();
+		parts.removeFirst();
+		m_statusMessage = QString::fromUtf8(parts.join(' '));
+	} else {
+		m_statusMessage = QString();
+	}
+}
+
+void
+MetadataRequest::Finish(CURLcode result, long statusCode)
+{
+	if (result == CURLE_ABORTED_BY_CALLBACK || IsCanceled()) {
+		Cancel();
+	} else if (result != CURLE_OK) {
+		Fail(DS3Error("Request failed: " +
+			      QString::fromUtf8(curl_easy_strerror(result))));
+	} else if (statusCode < 200 || statusCode >= 300) {
+		Fail(DS3Error(statusCode, m_statusMessage,
+			      QString::fromUtf8(m_body)));
+	} else {
+		Succeed();
+	}
+}
+
+//
+// RequestEngineWorker
+//
+
+const long RequestEngineWorker::CONNECT_TIMEOUT_IN_SECS = 30;
+const long RequestEngineWorker::LOW_SPEED_TIME_IN_SECS = 120;
+
+RequestEngineWorker::RequestEngineWorker(const QString& endpoint,
+					 const Session* session)
+	: QObject(),
+	  m_endpoint(endpoint),
+	  m_accessId(session->GetAccessId().toUtf8()),
+	  m_secretKey(session->GetSecretKey().toUtf8()),
+	  m_proxy(session->GetProxy().toUtf8()),
+	  m_withCertificateVerification(session->GetWithCertificateVerification())
+{
+	m_timer = new QTimer(this);
+	m_timer->setSingleShot(true);
+	connect(m_timer, SIGNAL(timeout()), this, SLOT(HandleTimeout()));
+
+	m_multi = curl_multi_init();
+	curl_multi_setopt(m_multi, CURLMOPT_SOCKETFUNCTION, socket_callback);
+	curl_multi_setopt(m_multi, CURLMOPT_SOCKETDATA, this);
+	curl_multi_setopt(m_multi, CURLMOPT_TIMERFUNCTION, timer_callback);
+	curl_multi_setopt(m_multi, CURLMOPT_TIMERDATA, this);
+}
+
+RequestEngineWorker::~RequestEngineWorker()
+{
+	if (m_multi != NULL) {
+		curl_multi_cleanup(m_multi);
+	}
+}
+
+void
+RequestEngineWorker::Enqueue(MetadataRequest* request)
+{
+	m_pendingLock.lock();
+	m_pending << request;
+	m_pendingLock.unlock();
+}
+
+void
+RequestEngineWorker::ProcessPending()
+{
+	m_pendingLock.lock();
+	QList<MetadataRequest*> pending = m_pending;
+	m_pending.clear();
+	m_pendingLock.unlock();
+
+	for (int i = 0; i < pending.size(); i++) {
+		MetadataRequest* request = pending.at(i);
+		if (request->IsCanceled() || m_multi == NULL) {
+			request->Cancel();
+			delete request;
+		} else {
+			Start(request);
+		}
+	}
+}
+
+// Abort everything that's still in flight.  This must be done on the
+// worker's thread since that's where all the socket notifiers live.
+void
+RequestEngineWorker::Shutdown()
+{
+	m_pendingLock.lock();
+	QList<MetadataRequest*> pending = m_pending;
+	m_pending.clear();
+	m_pendingLock.unlock();
+
+	for (int i = 0; i < pending.size(); i++) {
+		pending.at(i)->Cancel();
+		delete pending.at(i);
+	}
+
+	for (int i = 0; i < m_active.size(); i++) {
+		MetadataRequest* request = m_active.at(i);
+		curl_multi_remove_handle(m_multi, request->GetHandle());
+		request->Cancel();
+		delete request;
+	}
+	m_active.clear();
+
+	m_timer->stop();
+	qDeleteAll(m_readNotifiers);
+	m_readNotifiers.clear();
+	qDeleteAll(m_writeNotifiers);
+	m_writeNotifiers.clear();
+
+	curl_multi_cleanup(m_multi);
+	m_multi = NULL;
+}
+
+void
+RequestEngineWorker::Start(MetadataRequest* request)
+{
+	QString resource = request->GetResource();
+	QByteArray url = (m_endpoint + resource +
+			  request->GetQueryString()).toUtf8();
+
+	// RFC 1123 dates must always be in English
+	QDateTime now = QDateTime::currentDateTimeUtc();
+	QByteArray date = QLocale::c().toString(now, "ddd, dd MMM yyyy hh:mm:ss").toLatin1() + " GMT";
+
+	struct curl_slist* headers = NULL;
+	headers = curl_slist_append(headers, ("Date: " + date).constData());
+	QByteArray auth = "Authorization: AWS " + m_accessId + ":" +
+			  Sign(date, resource);
+	headers = curl_slist_append(headers, auth.constData());
+
+	CURL* handle = curl_easy_init();
+	request->SetHandle(handle, headers);
+	curl_easy_setopt(handle, CURLOPT_URL, url.constData());
+	curl_easy_setopt(handle, CURLOPT_HTTPHEADER, headers);
+	curl_easy_setopt(handle, CURLOPT_NOSIGNAL, 1L);
+	curl_easy_setopt(handle, CURLOPT_PRIVATE, request);
+	curl_easy_setopt(handle, CURLOPT_WRITEFUNCTION, body_callback);
+	curl_easy_setopt(handle, CURLOPT_WRITEDATA, request);
+	curl_easy_setopt(handle, CURLOPT_HEADERFUNCTION, header_callback);
+	curl_easy_setopt(handle, CURLOPT_HEADERDATA, request);
+	curl_easy_setopt(handle, CURLOPT_NOPROGRESS, 0L);
+	curl_easy_setopt(handle, CURLOPT_XFERINFOFUNCTION, progress_callback);
+	curl_easy_setopt(handle, CURLOPT_XFERINFODATA, request);
+	curl_easy_setopt(handle, CURLOPT_CONNECTTIMEOUT, CONNECT_TIMEOUT_IN_SECS);
+	curl_easy_setopt(handle, CURLOPT_LOW_SPEED_LIMIT, 1L);
+	curl_easy_setopt(handle, CURLOPT_LOW_SPEED_TIME, LOW_SPEED_TIME_IN_SECS);
+	if (!m_proxy.isEmpty()) {
+		curl_easy_setopt(handle, CURLOPT_PROXY, m_proxy.constData());
+	}
+	if (!m_withCertificateVerification) {
+		curl_easy_setopt(handle, CURLOPT_SSL_VERIFYPEER, 0L);
+		curl_easy_setopt(handle, CURLOPT_SSL_VERIFYHOST, 0L);
+	}
+
+	request->ConnectCanceled(this, SLOT(HandleCanceled()));
+	m_active << request;
+	curl_multi_add_handle(m_multi, handle);
+}
+
+QByteArray
+RequestEngineWorker::Sign(const QByteArray& date, const QString& resource) const
+{
+	// AWS (v2) signature.  None of the metadata requests have a body,
+	// content type or x-amz headers.
+	QByteArray stringToSign = "GET\n\n\n" + date + "\n" + resource.toUtf8();
+	return QMessageAuthenticationCode::hash(stringToSign, m_secretKey,
+						QCryptographicHash::Sha1).toBase64();
+}
+
+void
+RequestEngineWorker::UpdateSocket(curl_socket_t socket, int what)
+{
+	if (what == CURL_POLL_REMOVE) {
+		// Curl calls this from within SocketAction, which could have
+		// been triggered by one of these very notifiers.
+		QSocketNotifier* notifier = m_readNotifiers.take(socket);
+		if (notifier != NULL) {
+			notifier->setEnabled(false);
+			notifier->deleteLater();
+		}
+		notifier = m_writeNotifiers.take(socket);
+		if (notifier != NULL) {
+			notifier->setEnabled(false);
+			notifier->deleteLater();
+		}
+		return;
+	}
+
+	bool read = (what == CURL_POLL_IN || what == CURL_POLL_INOUT);
+	bool write = (what == CURL_POLL_OUT || what == CURL_POLL_INOUT);
+	SetNotifier(m_readNotifiers, socket, QSocketNotifier::Read, read);
+	SetNotifier(m_writeNotifiers, socket, QSocketNotifier::Write, write);
+}
+
+void
+RequestEngineWorker::SetNotifier(QHash<curl_socket_t, QSocketNotifier*>& notifiers,
+				 curl_socket_t socket,
+				 QSocketNotifier::Type type,
+				 bool enabled)
+{
+	QSocketNotifier* notifier = notifiers.value(socket);
+	if (notifier == NULL) {
+		if (!enabled) {
+			return;
+		}
+		notifier = new QSocketNotifier(socket, type, this);
+		if (type == QSocketNotifier::Read) {
+			connect(notifier, SIGNAL(activated(int)),
+				this, SLOT(HandleSocketRead(int)));
+		} else {
+			connect(notifier, SIGNAL(activated(int)),
+				this, SLOT(HandleSocketWrite(int)));
+		}
+		notifiers.insert(socket, notifier);
+	}
+	notifier->setEnabled(enabled);
+}
+
+void
+RequestEngineWorker::UpdateTimer(long timeoutInMs)
+{
+	// curl_multi_socket_action can't be called from within this
+	// callback so even a 0ms timeout goes through the event loop.
+	if (timeoutInMs < 0) {
+		m_timer->stop();
+	} else {
+		m_timer->start(static_cast<int>(timeoutInMs));
+	}
+}
+
+void
+RequestEngineWorker::HandleSocketRead(int socket)
+{
+	SocketAction(static_cast<curl_socket_t>(socket), CURL_CSELECT_IN);
+}
+
+void
+RequestEngineWorker::HandleSocketWrite(int socket)
+{
+	SocketAction(static_cast<curl_socket_t>(socket), CURL_CSELECT_OUT);
+}
+
+void
+RequestEngineWorker::HandleTimeout()
+{
+	SocketAction(CURL_SOCKET_TIMEOUT, 0);
+}
+
+// Called through the event loop, rather than from within a curl callback,
+// so canceled requests can be pulled out of the multi handle right away
+// instead of waiting for curl's next progress callback on them.
+void
+RequestEngineWorker::HandleCanceled()
+{
+	for (int i = m_active.size() - 1; i >= 0; i--) {
+		MetadataRequest* request = m_active.at(i);
+		if (!request->IsCanceled()) {
+			continue;
+		}
+		curl_multi_remove_handle(m_multi, request->GetHandle());
+		m_active.removeAt(i);
+		request->Cancel();
+		delete request;
+	}
+}
+
+void
+RequestEngineWorker::SocketAction(curl_socket_t socket, int mask)
+{
+	if (m_multi == NULL) {
+		return;
+	}
+	int running = 0;
+	curl_multi_socket_action(m_multi, socket, mask, &running);
+	CheckCompleted();
+}
+
+void
+RequestEngineWorker::CheckCompleted()
+{
+	CURLMsg* msg;
+	int msgsLeft = 0;
+	while ((msg = curl_multi_info_read(m_multi, &msgsLeft)) != NULL) {
+		if (msg->msg != CURLMSG_DONE) {
+			continue;
+		}
+		// msg is invalid once the handle is removed
+		CURL* handle = msg->easy_handle;
+		CURLcode result = msg->data.result;
+
+		char* privateData = NULL;
+		curl_easy_getinfo(handle, CURLINFO_PRIVATE, &privateData);
+		MetadataRequest* request = reinterpret_cast<MetadataRequest*>(privateData);
+		long statusCode = 0;
+		curl_easy_getinfo(handle, CURLINFO_RESPONSE_CODE, &statusCode);
+		curl_multi_remove_handle(m_multi, handle);
+
+		m_active.removeOne(request);
+		request->Finish(result, statusCode);
+		delete request;
+	}
+}
+
+//
+// RequestEngine
+//
+
+RequestEngine::RequestEngine(const QString& endpoint, const Session* session)
+{
+	m_worker = new RequestEngineWorker(endpoint, session);
+	m_worker->moveToThread(&m_thread);
+	m_thread.start();
+}
+
+RequestEngine::~RequestEngine()
+{
+	QMetaObject::invokeMethod(m_worker, "Shutdown",
+				  Qt::BlockingQueuedConnection);
+	m_thread.quit();
+	m_thread.wait();
+	delete m_worker;
+}
+
+QFuture<ServiceListing>
+RequestEngine::GetService()
+{
+	TypedMetadataRequest<ServiceListing>* request;
+	request = new TypedMetadataRequest<ServiceListing>("/", QueryParams(),
+							   ListingParser::ParseService);
+	QFuture<ServiceListing> future = request->GetFuture();
+	Submit(request);
+	return future;
+}
+
+QFuture<BucketListing>
+RequestEngine::GetBucket(const QString& bucketName, const QString& prefix,
+			 const QString& delimiter, const QString& marker,
+			 uint32_t maxKeys)
+{
+	QueryParams query;
+	if (!delimiter.isEmpty()) {
+		query << qMakePair(QString("delimiter"), delimiter);
+	}
+	if (!marker.isEmpty()) {
+		query << qMakePair(QString("marker"), marker);
+	}
+	if (maxKeys > 0) {
+		query << qMakePair(QString("max-keys"), QString::number(maxKeys));
+	}
+	if (!prefix.isEmpty()) {
+		query << qMakePair(QString("prefix"), prefix);
+	}
+
+	QString resource = "/" + QString::fromUtf8(QUrl::toPercentEncoding(bucketName)) + "/";
+	TypedMetadataRequest<BucketListing>* request;
+	request = new TypedMetadataRequest<BucketListing>(resource, query,
+							  ListingParser::ParseBucket);
+	QFuture<BucketListing> future = request->GetFuture();
+	Submit(request);
+	return future;
+}
+
+QFuture<BucketListing>
+RequestEngine::GetObjects(const QString& bucketName, const QString& id,
+			  const QString& name, object_type type,
+			  const QString& version)
+{
+	QueryParams query;
+	query << qMakePair(QString("bucketId"), bucketName);
+	if (!id.isEmpty()) {
+		query << qMakePair(QString("id"), id);
+	}
+	if (!name.isEmpty()) {
+		query << qMakePair(QString("name"), name);
+	}
+	if (type == DATA) {
+		query << qMakePair(QString("type"), QString("DATA"));
+	}
+	if (!version.isEmpty()) {
+		query << qMakePair(QString("version"), version);
+	}
+
+	TypedMetadataRequest<BucketListing>* request;
+	request = new TypedMetadataRequest<BucketListing>("/_rest_/object", query,
+							  ListingParser::ParseObjects);
+	QFuture<BucketListing> future = request->GetFuture();
+	Submit(request);
+	return future;
+}
+
+void
+RequestEngine::Submit(MetadataRequest* request)
+{
+	m_worker->Enqueue(request);
+	QMetaObject::invokeMethod(m_worker, "ProcessPending",
+				  Qt::QueuedConnection);
+}
+
+//
+// libcurl callbacks
+//
+
+static int
+socket_callback(CURL* /*easy*/, curl_socket_t socket, int what,
+		void* userp, void* /*socketp*/)
+{
+	RequestEngineWorker* worker = static_cast<RequestEngineWorker*>(userp);
+	worker->UpdateSocket(socket, what);
+	return 0;
+}
+
+static int
+timer_callback(CURLM* /*multi*/, long timeoutInMs, void* userp)
+{
+	RequestEngineWorker* worker = static_cast<RequestEngineWorker*>(userp);
+	worker->UpdateTimer(timeoutInMs);
+	return 0;
+}
+
+static size_t
+body_callback(char* data, size_t size, size_t count, void* userData)
+{
+	MetadataRequest* request = static_cast<MetadataRequest*>(userData);
+	request->AppendBody(data, size * count);
+	return size * count;
+}
+
+static size_t
+header_callback(char* data, size_t size, size_t count, void* userData)
+{
+	MetadataRequest* request = static_cast<MetadataRequest*>(userData);
+	QByteArray line(data, static_cast<int>(size * count));
+	if (line.startsWith("HTTP/")) {
+		request->SetStatusLine(line);
+	}
+	return size * count;
+}
+
+static int
+progress_callback(void* userData,
+		  curl_off_t /*downloadTotal*/, curl_off_t /*downloadNow*/,
+		  curl_off_t /*uploadTotal*/, curl_off_t /*uploadNow*/)
+{
+	MetadataRequest* request = static_cast<MetadataRequest*>(userData);
+	// Non-zero aborts the transfer
+	return request->IsCanceled() ? 1 : 0;
+}
@@ -0,0 +1,305 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef REQUEST_ENGINE_H
+#define REQUEST_ENGINE_H
+
+#include <stdint.h>
+#include <QByteArray>
+#include <QFuture>
+#include <QFutureInterface>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QPair>
+#include <QSocketNotifier>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+
+#include <curl/curl.h>
+#include <ds3.h>
+
+#include "lib/errors/ds3_error.h"
+#include "models/listing.h"
+
+class Session;
+
+typedef QList<QPair<QString, QString> > QueryParams;
+
+// MetadataRequest, a single signed DS3 GET request driven by RequestEngine.
+// The engine owns it from the moment it's submitted until it completes,
+// fails or is canceled.
+class MetadataRequest
+{
+public:
+	MetadataRequest(const QString& resource, const QueryParams& query);
+	virtual ~MetadataRequest();
+
+	const QString& GetResource() const;
+	QString GetQueryString() const;
+	CURL* GetHandle() const;
+	const QByteArray& GetBody() const;
+
+	void SetHandle(CURL* handle, struct curl_slist* headers);
+	void AppendBody(const char* data, size_t size);
+	void SetStatusLine(const QByteArray& line);
+
+	// Whoever is waiting on the request's future asked to cancel it
+	virtual bool IsCanceled() const = 0;
+	// Have receiver's slot called as soon as the request's future is
+	// canceled.  Must be called from the thread receiver lives on.
+	virtual void ConnectCanceled(QObject* receiver, const char* slot) = 0;
+
+	void Finish(CURLcode result, long statusCode);
+	virtual void Cancel() = 0;
+
+protected:
+	virtual void Succeed() = 0;
+	virtual void Fail(const DS3Error& error) = 0;
+
+private:
+	QString m_resource;
+	QueryParams m_query;
+	CURL* m_handle;
+	struct curl_slist* m_headers;
+	QByteArray m_body;
+	QString m_statusMessage;
+};
+
+// TypedMetadataRequest, a MetadataRequest that parses its response body
+// into T and reports it through a QFuture<T>, which means the usual
+// QFutureWatcher classes can be used to wait on it.
+template <class T>
+class TypedMetadataRequest : public MetadataRequest
+{
+public:
+	typedef bool (*Parser)(const QByteArray& body, T* result, QString* error);
+
+	TypedMetadataRequest(const QString& resource,
+			     const QueryParams& query,
+			     Parser parser);
+	~TypedMetadataRequest();
+
+	QFuture<T> GetFuture();
+	bool IsCanceled() const;
+	void ConnectCanceled(QObject* receiver, const char* slot);
+	void Cancel();
+
+protected:
+	void Succeed();
+	void Fail(const DS3Error& error);
+
+private:
+	Parser m_parser;
+	QFutureInterface<T> m_future;
+	QFutureWatcher<T>* m_canceledWatcher;
+};
+
+// RequestEngineWorker, lives on RequestEngine's thread and drives all of its
+// requests through a single libcurl multi handle.  Curl's sockets are
+// watched with QSocketNotifiers and its timeouts with a QTimer so the
+// thread's event loop is the only thing waiting on the network.
+class RequestEngineWorker : public QObject
+{
+	Q_OBJECT
+
+public:
+	static const long CONNECT_TIMEOUT_IN_SECS;
+	// A request that receives nothing for this long is failed
+	static const long LOW_SPEED_TIME_IN_SECS;
+
+	RequestEngineWorker(const QString& endpoint, const Session* session);
+	~RequestEngineWorker();
+
+	// Thread safe.  The request is started the next time the worker's
+	// thread gets to ProcessPending.
+	void Enqueue(MetadataRequest* request);
+
+	// Meant to be private but called from the libcurl callback functions
+	void UpdateSocket(curl_socket_t socket, int what);
+	void UpdateTimer(long timeoutInMs);
+
+public slots:
+	void ProcessPending();
+	void Shutdown();
+
+private slots:
+	void HandleSocketRead(int socket);
+	void HandleSocketWrite(int socket);
+	void HandleTimeout();
+	void HandleCanceled();
+
+private:
+	void Start(MetadataRequest* request);
+	void SocketAction(curl_socket_t socket, int mask);
+	void CheckCompleted();
+	void SetNotifier(QHash<curl_socket_t, QSocketNotifier*>& notifiers,
+			 curl_socket_t socket,
+			 QSocketNotifier::Type type,
+			 bool enabled);
+	QByteArray Sign(const QByteArray& date, const QString& resource) const;
+
+	QString m_endpoint;
+	QByteArray m_accessId;
+	QByteArray m_secretKey;
+	QByteArray m_proxy;
+	bool m_withCertificateVerification;
+
+	CURLM* m_multi;
+	QTimer* m_timer;
+	QHash<curl_socket_t, QSocketNotifier*> m_readNotifiers;
+	QHash<curl_socket_t, QSocketNotifier*> m_writeNotifiers;
+	QList<MetadataRequest*> m_active;
+	QList<MetadataRequest*> m_pending;
+	QMutex m_pendingLock;
+};
+
+// RequestEngine, an asynchronous alternative to the C SDK for the DS3
+// metadata requests the GUI makes (listing buckets, objects and searching).
+// Any number of requests can be in flight at once without tying up a
+// thread pool thread per request; they're all multiplexed on one thread.
+// Canceling a returned future aborts its request right away.
+class RequestEngine
+{
+public:
+	RequestEngine(const QString& endpoint, const Session* session);
+	~RequestEngine();
+
+	QFuture<ServiceListing> GetService();
+	QFuture<BucketListing> GetBucket(const QString& bucketName,
+					 const QString& prefix,
+					 const QString& delimiter,
+					 const QString& marker,
+					 uint32_t maxKeys);
+	QFuture<BucketListing> GetObjects(const QString& bucketName,
+					  const QString& id,
+					  const QString& name,
+					  object_type type,
+					  const QString& version);
+
+private:
+	void Submit(MetadataRequest* request);
+
+	QThread m_thread;
+	RequestEngineWorker* m_worker;
+};
+
+//
+// MetadataRequest
+//
+
+inline const QString&
+MetadataRequest::GetResource() const
+{
+	return m_resource;
+}
+
+inline CURL*
+MetadataRequest::GetHandle() const
+{
+	return m_handle;
+}
+
+inline const QByteArray&
+MetadataRequest::GetBody() const
+{
+	return m_body;
+}
+
+inline void
+MetadataRequest::AppendBody(const char* data, size_t size)
+{
+	m_body.append(data, static_cast<int>(size));
+}
+
+//
+// TypedMetadataRequest
+//
+
+template <class T>
+TypedMetadataRequest<T>::TypedMetadataRequest(const QString& resource,
+					      const QueryParams& query,
+					      Parser parser)
+	: MetadataRequest(resource, query),
+	  m_parser(parser),
+	  m_canceledWatcher(NULL)
+{
+	m_future.reportStarted();
+}
+
+template <class T>
+TypedMetadataRequest<T>::~TypedMetadataRequest()
+{
+	delete m_canceledWatcher;
+}
+
+template <class T>
+QFuture<T>
+TypedMetadataRequest<T>::GetFuture()
+{
+	return m_future.future();
+}
+
+template <class T>
+bool
+TypedMetadataRequest<T>::IsCanceled() const
+{
+	return m_future.isCanceled();
+}
+
+template <class T>
+void
+TypedMetadataRequest<T>::ConnectCanceled(QObject* receiver, const char* slot)
+{
+	m_canceledWatcher = new QFutureWatcher<T>();
+	QObject::connect(m_canceledWatcher, SIGNAL(canceled()), receiver, slot);
+	m_canceledWatcher->setFuture(m_future.future());
+}
+
+template <class T>
+void
+TypedMetadataRequest<T>::Cancel()
+{
+	m_future.cancel();
+	m_future.reportFinished();
+}
+
+template <class T>
+void
+TypedMetadataRequest<T>::Succeed()
+{
+	T result;
+	QString error;
+	if (!m_parser(GetBody(), &result, &error)) {
+		Fail(DS3Error(error));
+		return;
+	}
+	m_future.reportResult(result);
+	m_future.reportFinished();
+}
+
+template <class T>
+void
+TypedMetadataRequest<T>::Fail(const DS3Error& error)
+{
+	m_future.reportException(error);
+	m_future.reportFinished();
+}
+
+#endif
@@ -0,0 +1,121 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <string.h>
+#include <QMutexLocker>
+
+#include "lib/ring_buffer.h"
+
+const qint64 RingBuffer::DEFAULT_CAPACITY = 8 * 1024 * 1024;
+
+RingBuffer::RingBuffer(qint64 capacity, QObject* parent)
+	: QIODevice(parent),
+	  m_buffer(capacity, 0),
+	  m_head(0),
+	  m_size(0),
+	  m_writeClosed(false),
+	  m_aborted(false)
+{
+	// Unbuffered so QIODevice doesn't keep its own copy of the data
+	open(QIODevice::ReadWrite | QIODevice::Unbuffered);
+}
+
+qint64
+RingBuffer::bytesAvailable() const
+{
+	QMutexLocker locker(&m_lock);
+	return m_size + QIODevice::bytesAvailable();
+}
+
+bool
+RingBuffer::atEnd() const
+{
+	QMutexLocker locker(&m_lock);
+	return m_aborted || (m_writeClosed && m_size == 0);
+}
+
+void
+RingBuffer::CloseWrite()
+{
+	QMutexLocker locker(&m_lock);
+	m_writeClosed = true;
+	m_notEmpty.wakeAll();
+}
+
+void
+RingBuffer::Abort()
+{
+	QMutexLocker locker(&m_lock);
+	m_aborted = true;
+	m_notEmpty.wakeAll();
+	m_notFull.wakeAll();
+}
+
+bool
+RingBuffer::WasAborted() const
+{
+	QMutexLocker locker(&m_lock);
+	return m_aborted;
+}
+
+qint64
+RingBuffer::readData(char* data, qint64 maxSize)
+{
+	QMutexLocker locker(&m_lock);
+	while (m_size == 0 && !m_writeClosed && !m_aborted) {
+		m_notEmpty.wait(&m_lock);
+	}
+	if (m_aborted || m_size == 0) {
+		return -1;
+	}
+
+	// At most two copies, the end of the buffer and then its start
+	qint64 capacity = m_buffer.size();
+	qint64 toRead = qMin(maxSize, m_size);
+	qint64 first = qMin(toRead, capacity - m_head);
+	memcpy(data, m_buffer.constData() + m_head, first);
+	memcpy(data + first, m_buffer.constData(), toRead - first);
+	m_head = (m_head + toRead) % capacity;
+	m_size -= toRead;
+	m_notFull.wakeAll();
+	return toRead;
+}
+
+qint64
+RingBuffer::writeData(const char* data, qint64 maxSize)
+{
+	QMutexLocker locker(&m_lock);
+	qint64 capacity = m_buffer.size();
+	qint64 written = 0;
+	while (written < maxSize) {
+		while (m_size == capacity && !m_aborted) {
+			m_notFull.wait(&m_lock);
+		}
+		if (m_aborted || m_writeClosed) {
+			return -1;
+		}
+
+		qint64 tail = (m_head + m_size) % capacity;
+		qint64 toWrite = qMin(maxSize - written, capacity - m_size);
+		qint64 first = qMin(toWrite, capacity - tail);
+		memcpy(m_buffer.data() + tail, data + written, first);
+		memcpy(m_buffer.data(), data + written + first, toWrite - first);
+		m_size += toWrite;
+		written += toWrite;
+		m_notEmpty.wakeAll();
+	}
+	return written;
+}
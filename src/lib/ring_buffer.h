@@ -0,0 +1,70 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <QMutex>
+#include <QWaitCondition>
+
+// RingBuffer, a bounded, in-memory pipe between one writer thread and one
+// reader thread.  Writes block while the buffer is full and reads block
+// while it's empty so the amount of memory used stays constant no matter
+// how much data passes through it.  It's opened for ReadWrite when
+// created.
+class RingBuffer : public QIODevice
+{
+public:
+	static const qint64 DEFAULT_CAPACITY;
+
+	RingBuffer(qint64 capacity = DEFAULT_CAPACITY, QObject* parent = 0);
+
+	bool isSequential() const;
+	qint64 bytesAvailable() const;
+	bool atEnd() const;
+
+	// The writer is done.  Reads return the remaining data and then -1.
+	void CloseWrite();
+	// Give up on the transfer.  Blocked and future reads and writes
+	// return -1.
+	void Abort();
+	bool WasAborted() const;
+
+protected:
+	qint64 readData(char* data, qint64 maxSize);
+	qint64 writeData(const char* data, qint64 maxSize);
+
+private:
+	QByteArray m_buffer;
+	// Where the next read starts and how many bytes are buffered
+	qint64 m_head;
+	qint64 m_size;
+	bool m_writeClosed;
+	bool m_aborted;
+	mutable QMutex m_lock;
+	QWaitCondition m_notEmpty;
+	QWaitCondition m_notFull;
+};
+
+inline bool
+RingBuffer::isSequential() const
+{
+	return true;
+}
+
+#endif
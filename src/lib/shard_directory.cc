@@ -0,0 +1,243 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QDateTime>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+
+#include "lib/manifest_reader.h"
+#include "lib/shard_directory.h"
+
+const int ShardDirectory::DEFAULT_LEASE_TIME_IN_MS = 5 * 60 * 1000;
+
+static const QString PENDING_DIR = "pending";
+static const QString LEASED_DIR = "leased";
+static const QString DONE_DIR = "done";
+static const QString REPORTS_DIR = "reports";
+static const QString LEASE_SUFFIX = ".lease";
+
+int
+ShardDirectory::CreateShards(const QString& manifestPath, const QString& path,
+			     int shardSize, QString* error)
+{
+	QFile manifest(manifestPath);
+	if (!manifest.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		*error = "Unable to read " + manifestPath + ", " +
+			 manifest.errorString();
+		return -1;
+	}
+	QDir dir(path);
+	QStringList subdirs;
+	subdirs << PENDING_DIR << LEASED_DIR << DONE_DIR << REPORTS_DIR;
+	for (int i = 0; i < subdirs.size(); i++) {
+		if (!dir.mkpath(subdirs[i])) {
+			*error = "Unable to create " + dir.filePath(subdirs[i]);
+			return -1;
+		}
+	}
+	if (!dir.entryList(QDir::Files, QDir::NoSort).isEmpty() ||
+	    !QDir(dir.filePath(PENDING_DIR)).entryList(QDir::Files).isEmpty()) {
+		*error = path + " already contains shards";
+		return -1;
+	}
+
+	// Shards keep the manifest's format (and thus suffix).  Lines are
+	// copied as is, minus blank lines and comments, so a shard report's
+	// line numbers are relative to the shard.
+	ManifestReader::Format format = ManifestReader::FormatFromFileName(manifestPath);
+	QString suffix = format == ManifestReader::CSV ? ".csv" : ".txt";
+	QTextStream in(&manifest);
+	in.setCodec("UTF-8");
+	QFile shard;
+	QTextStream out;
+	out.setCodec("UTF-8");
+	int numShards = 0;
+	int numLines = 0;
+	qint64 lineNumber = 0;
+	while (!in.atEnd()) {
+		QString line = in.readLine();
+		lineNumber++;
+		QString trimmed = line.trimmed();
+		if (trimmed.isEmpty() || trimmed.startsWith("#") ||
+		    (format == ManifestReader::CSV && lineNumber == 1 &&
+		     trimmed.startsWith("bucket,object", Qt::CaseInsensitive))) {
+			continue;
+		}
+		if (numLines == 0 || numLines >= shardSize) {
+			out.flush();
+			shard.close();
+			// Written under a temporary name so workers can't lease
+			// a partial shard
+			if (numShards > 0 &&
+			    !shard.rename(dir.filePath(PENDING_DIR + "/" +
+						       FormatShardName(numShards, suffix)))) {
+				*error = "Unable to move " + shard.fileName();
+				return -1;
+			}
+			numShards++;
+			numLines = 0;
+			shard.setFileName(dir.filePath(FormatShardName(numShards, suffix)));
+			if (!shard.open(QIODevice::WriteOnly | QIODevice::Text)) {
+				*error = "Unable to write " + shard.fileName() +
+					 ", " + shard.errorString();
+				return -1;
+			}
+			out.setDevice(&shard);
+		}
+		out << line << "\n";
+		numLines++;
+	}
+	out.flush();
+	shard.close();
+	if (numShards > 0 &&
+	    !shard.rename(dir.filePath(PENDING_DIR + "/" +
+				       FormatShardName(numShards, suffix)))) {
+		*error = "Unable to move " + shard.fileName();
+		return -1;
+	}
+	return numShards;
+}
+
+QString
+ShardDirectory::FormatShardName(int shard, const QString& suffix)
+{
+	return QString("%1").arg(shard, 6, 10, QChar('0')) + suffix;
+}
+
+ShardDirectory::ShardDirectory(const QString& path, const QString& workerID)
+	: m_dir(path),
+	  m_workerID(workerID),
+	  m_leaseTime(DEFAULT_LEASE_TIME_IN_MS)
+{
+	m_dir.mkpath(LEASED_DIR + "/" + m_workerID);
+}
+
+bool
+ShardDirectory::Lease(QString* shardPath)
+{
+	for (int attempt = 0; attempt < 2; attempt++) {
+		if (attempt > 0 && ReclaimExpired() == 0) {
+			break;
+		}
+		QDir pending(m_dir.filePath(PENDING_DIR));
+		QStringList shards = pending.entryList(QDir::Files, QDir::Name);
+		for (int i = 0; i < shards.size(); i++) {
+			QString leased = m_dir.filePath(LEASED_DIR + "/" + m_workerID +
+							"/" + shards[i]);
+			// Heartbeat first so a reclaimer never sees the shard
+			// without one
+			WriteHeartbeat(leased);
+			if (QFile::rename(pending.filePath(shards[i]), leased)) {
+				*shardPath = leased;
+				return true;
+			}
+			// Another worker won it
+			QFile::remove(leased + LEASE_SUFFIX);
+		}
+	}
+	return false;
+}
+
+bool
+ShardDirectory::Renew(const QString& shardPath)
+{
+	if (!QFile::exists(shardPath)) {
+		return false;
+	}
+	WriteHeartbeat(shardPath);
+	return true;
+}
+
+void
+ShardDirectory::WriteHeartbeat(const QString& shardPath)
+{
+	QFile lease(shardPath + LEASE_SUFFIX);
+	if (lease.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+		lease.write(QDateTime::currentDateTimeUtc().toString(Qt::ISODate).toUtf8());
+	}
+}
+
+bool
+ShardDirectory::Complete(const QString& shardPath)
+{
+	QString name = QFileInfo(shardPath).fileName();
+	bool completed = QFile::rename(shardPath,
+				       m_dir.filePath(DONE_DIR + "/" + name));
+	QFile::remove(shardPath + LEASE_SUFFIX);
+	return completed;
+}
+
+bool
+ShardDirectory::Release(const QString& shardPath)
+{
+	QString name = QFileInfo(shardPath).fileName();
+	bool released = QFile::rename(shardPath,
+				      m_dir.filePath(PENDING_DIR + "/" + name));
+	QFile::remove(shardPath + LEASE_SUFFIX);
+	return released;
+}
+
+int
+ShardDirectory::ReclaimExpired()
+{
+	int numReclaimed = 0;
+	QDateTime expired = QDateTime::currentDateTimeUtc().addMSecs(-m_leaseTime);
+	QDirIterator it(m_dir.filePath(LEASED_DIR), QDir::Files,
+			QDirIterator::Subdirectories);
+	while (it.hasNext()) {
+		QString path = it.next();
+		if (path.endsWith(LEASE_SUFFIX)) {
+			continue;
+		}
+		QFileInfo lease(path + LEASE_SUFFIX);
+		if (lease.exists() && lease.lastModified().toUTC() > expired) {
+			continue;
+		}
+		QString pending = m_dir.filePath(PENDING_DIR + "/" +
+						 QFileInfo(path).fileName());
+		if (QFile::rename(path, pending)) {
+			QFile::remove(lease.filePath());
+			numReclaimed++;
+		}
+	}
+	return numReclaimed;
+}
+
+bool
+ShardDirectory::IsFinished() const
+{
+	if (!QDir(m_dir.filePath(PENDING_DIR)).entryList(QDir::Files).isEmpty()) {
+		return false;
+	}
+	QDirIterator it(m_dir.filePath(LEASED_DIR), QDir::Files,
+			QDirIterator::Subdirectories);
+	while (it.hasNext()) {
+		if (!it.next().endsWith(LEASE_SUFFIX)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+QString
+ShardDirectory::GetReportPath(const QString& shardPath) const
+{
+	// Per worker since a reclaimed shard may still be running elsewhere
+	return m_dir.filePath(REPORTS_DIR + "/" + QFileInfo(shardPath).fileName() +
+			      "." + m_workerID + ".report.csv");
+}
@@ -0,0 +1,86 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef SHARD_DIRECTORY_H
+#define SHARD_DIRECTORY_H
+
+#include <QDir>
+#include <QString>
+
+// ShardDirectory, lets several engine processes, possibly on different
+// hosts, cooperate on one restore manifest through a shared directory:
+//
+//   pending/<shard>             shards no one is working on
+//   leased/<worker>/<shard>     shards a worker has leased
+//   leased/<worker>/<shard>.lease  the lease's heartbeat
+//   done/<shard>                finished shards
+//   reports/<shard>.<worker>.report.csv  ManifestGetWorkItem reports
+//
+// Every state change is a rename so only one worker can win a shard.  A
+// worker must renew its leases more often than the lease time.  Leases
+// that haven't been renewed within it are considered abandoned (e.g. the
+// worker crashed) and any worker may move them back to pending.  Since the
+// heartbeats' modification times are compared against the local clock, the
+// lease time should be well above the clock skew between hosts.
+class ShardDirectory
+{
+public:
+	static const int DEFAULT_LEASE_TIME_IN_MS;
+
+	// Split a restore manifest into shards of up to shardSize entries.
+	// Returns the number of shards, or -1 and sets error on failure.
+	// The manifest is streamed so it can be any size.
+	static int CreateShards(const QString& manifestPath, const QString& path,
+				int shardSize, QString* error);
+
+	ShardDirectory(const QString& path, const QString& workerID);
+
+	// Lease a pending shard, first reclaiming abandoned leases if there
+	// aren't any.  Returns false if there's nothing to lease right now.
+	bool Lease(QString* shardPath);
+	// Returns false if the lease was lost
+	bool Renew(const QString& shardPath);
+	// Returns false if the lease was lost (reclaimed by another worker),
+	// in which case the shard will be or has been run again.
+	bool Complete(const QString& shardPath);
+	// Give a leased shard back to pending without finishing it (e.g. its
+	// job was canceled) so any worker can lease it again.  Returns false
+	// if the lease was lost.
+	bool Release(const QString& shardPath);
+	// Move abandoned leases back to pending.  Returns how many were.
+	int ReclaimExpired();
+	// Whether there are no pending or leased shards left
+	bool IsFinished() const;
+
+	QString GetReportPath(const QString& shardPath) const;
+	void SetLeaseTime(int ms);
+
+private:
+	static QString FormatShardName(int shard, const QString& suffix);
+	void WriteHeartbeat(const QString& shardPath);
+
+	QDir m_dir;
+	QString m_workerID;
+	int m_leaseTime;
+};
+
+inline void
+ShardDirectory::SetLeaseTime(int ms)
+{
+	m_leaseTime = ms;
+}
+
+#endif
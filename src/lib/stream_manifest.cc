@@ -0,0 +1,71 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include "lib/stream_manifest.h"
+
+const QByteArray StreamManifest::MAGIC = "ds3-stream-manifest 1";
+
+QString
+StreamManifest::GetPartName(const QString& objName, int index)
+{
+	return objName + ".parts/" + QString("%1").arg(index, 8, 10, QChar('0'));
+}
+
+uint64_t
+StreamManifest::GetSize() const
+{
+	uint64_t size = 0;
+	for (int i = 0; i < m_partSizes.size(); i++) {
+		size += m_partSizes[i];
+	}
+	return size;
+}
+
+QByteArray
+StreamManifest::ToByteArray() const
+{
+	QByteArray data = MAGIC + "\n";
+	for (int i = 0; i < m_partSizes.size(); i++) {
+		data += QByteArray::number((qulonglong)m_partSizes[i]) + "\n";
+	}
+	return data;
+}
+
+bool
+StreamManifest::Parse(const QByteArray& data, QString* error)
+{
+	m_partSizes.clear();
+	QList<QByteArray> lines = data.split('\n');
+	if (lines.isEmpty() || lines[0].trimmed() != MAGIC) {
+		*error = "Not a stream manifest";
+		return false;
+	}
+	for (int i = 1; i < lines.size(); i++) {
+		QByteArray line = lines[i].trimmed();
+		if (line.isEmpty()) {
+			continue;
+		}
+		bool ok = false;
+		uint64_t size = line.toULongLong(&ok);
+		if (!ok) {
+			*error = "Invalid part size on line " + QString::number(i + 1);
+			m_partSizes.clear();
+			return false;
+		}
+		m_partSizes << size;
+	}
+	return true;
+}
@@ -0,0 +1,73 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef STREAM_MANIFEST_H
+#define STREAM_MANIFEST_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+// StreamManifest, the body of the object that a streamed upload (see
+// Client::StreamPut) is stored as.  Data whose length isn't known up front
+// (e.g. read from a pipe) is uploaded as fixed size part objects named
+// "<object>.parts/<index>" and the manifest, written once every part has
+// been uploaded, lists the parts' sizes in order:
+//
+//   ds3-stream-manifest 1
+//   67108864
+//   67108864
+//   1234
+class StreamManifest
+{
+public:
+	static const QByteArray MAGIC;
+
+	static QString GetPartName(const QString& objName, int index);
+
+	int GetNumParts() const;
+	uint64_t GetPartSize(int index) const;
+	// The size of the original data
+	uint64_t GetSize() const;
+	void AppendPart(uint64_t size);
+
+	QByteArray ToByteArray() const;
+	// Returns false, with a reason in error, if data isn't a manifest
+	bool Parse(const QByteArray& data, QString* error);
+
+private:
+	QList<uint64_t> m_partSizes;
+};
+
+inline int
+StreamManifest::GetNumParts() const
+{
+	return m_partSizes.size();
+}
+
+inline uint64_t
+StreamManifest::GetPartSize(int index) const
+{
+	return m_partSizes[index];
+}
+
+inline void
+StreamManifest::AppendPart(uint64_t size)
+{
+	m_partSizes << size;
+}
+
+#endif
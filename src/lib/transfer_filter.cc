@@ -0,0 +1,297 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QSettings>
+
+#include "lib/transfer_filter.h"
+
+TransferFilter::TransferFilter()
+	: m_minSize(0),
+	  m_maxSize(UINT64_MAX)
+{
+}
+
+TransferFilter
+TransferFilter::FromSettings()
+{
+	QSettings settings;
+	QStringList includes = settings.value("transfers/filterInclude").toString()
+					.split(' ', QString::SkipEmptyParts);
+	QStringList excludes = settings.value("transfers/filterExclude").toString()
+					.split(' ', QString::SkipEmptyParts);
+	TransferFilter filter;
+	for (int i = 0; i < includes.size(); i++) {
+		filter.AddInclude(includes[i]);
+	}
+	for (int i = 0; i < excludes.size(); i++) {
+		filter.AddExclude(excludes[i]);
+	}
+	return filter;
+}
+
+void
+TransferFilter::AddInclude(const QString& glob)
+{
+	AddRule(CreateRule(glob, true), true);
+}
+
+void
+TransferFilter::AddExclude(const QString& glob)
+{
+	AddRule(CreateRule(glob, true), false);
+}
+
+bool
+TransferFilter::AddIncludeRegex(const QString& pattern, QString* error)
+{
+	Rule rule = CreateRule(pattern, false);
+	if (!rule.regex.isValid()) {
+		*error = "invalid regular expression \"" + pattern + "\", " +
+			 rule.regex.errorString();
+		return false;
+	}
+	AddRule(rule, true);
+	return true;
+}
+
+bool
+TransferFilter::AddExcludeRegex(const QString& pattern, QString* error)
+{
+	Rule rule = CreateRule(pattern, false);
+	if (!rule.regex.isValid()) {
+		*error = "invalid regular expression \"" + pattern + "\", " +
+			 rule.regex.errorString();
+		return false;
+	}
+	AddRule(rule, false);
+	return true;
+}
+
+bool
+TransferFilter::Accepts(const QString& relativeName, uint64_t size,
+			const QDateTime& modified) const
+{
+	if (size < m_minSize || size > m_maxSize) {
+		return false;
+	}
+	if (modified.isValid()) {
+		if (m_modifiedAfter.isValid() && modified < m_modifiedAfter) {
+			return false;
+		}
+		if (m_modifiedBefore.isValid() && modified >= m_modifiedBefore) {
+			return false;
+		}
+	}
+	if (IsExcluded(relativeName)) {
+		return false;
+	}
+	if (m_includes.isEmpty()) {
+		return true;
+	}
+	for (int i = 0; i < m_includes.size(); i++) {
+		if (Matches(m_includes[i], relativeName)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool
+TransferFilter::AcceptsFolder(const QString& relativeName) const
+{
+	return !HasFileRules() && !IsExcluded(relativeName);
+}
+
+QString
+TransferFilter::ToString() const
+{
+	QStringList rules;
+	for (int i = 0; i < m_includes.size(); i++) {
+		const Rule& rule = m_includes[i];
+		rules << (rule.isGlob ? "include " : "include regex ") + rule.source;
+	}
+	for (int i = 0; i < m_excludes.size(); i++) {
+		const Rule& rule = m_excludes[i];
+		rules << (rule.isGlob ? "exclude " : "exclude regex ") + rule.source;
+	}
+	if (m_minSize > 0) {
+		rules << "size >= " + QString::number(m_minSize);
+	}
+	if (m_maxSize < UINT64_MAX) {
+		rules << "size <= " + QString::number(m_maxSize);
+	}
+	if (m_modifiedAfter.isValid()) {
+		rules << "modified after " +
+			 m_modifiedAfter.toUTC().toString(Qt::ISODate);
+	}
+	if (m_modifiedBefore.isValid()) {
+		rules << "modified before " +
+			 m_modifiedBefore.toUTC().toString(Qt::ISODate);
+	}
+	return rules.join("; ");
+}
+
+QString
+TransferFilter::GlobToRegex(const QString& glob)
+{
+	QString regex = "^";
+	for (int i = 0; i < glob.size(); i++) {
+		QChar c = glob[i];
+		if (c == '*') {
+			regex += "[^/]*";
+		} else if (c == '?') {
+			regex += "[^/]";
+		} else if (c == '[') {
+			// A character class.  A '[' that isn't closed is
+			// taken literally.
+			int j = i + 1;
+			if (j < glob.size() && (glob[j] == '!' || glob[j] == '^')) {
+				j++;
+			}
+			if (j < glob.size() && glob[j] == ']') {
+				j++;
+			}
+			while (j < glob.size() && glob[j] != ']') {
+				j++;
+			}
+			if (j >= glob.size()) {
+				regex += "\\[";
+				continue;
+			}
+			QString set = glob.mid(i + 1, j - i - 1);
+			set.replace("\\", "\\\\");
+			if (set.startsWith('!')) {
+				set[0] = '^';
+			}
+			regex += "[" + set + "]";
+			i = j;
+		} else {
+			regex += QRegularExpression::escape(QString(c));
+		}
+	}
+	return regex + "$";
+}
+
+TransferFilter::Rule
+TransferFilter::CreateRule(const QString& pattern, bool isGlob)
+{
+	Rule rule;
+	rule.source = pattern;
+	rule.isGlob = isGlob;
+	if (isGlob) {
+		QString glob = pattern;
+		// "foo/" is meant as a folder, which is what exclude rules
+		// already match by name
+		while (glob.endsWith('/')) {
+			glob.chop(1);
+		}
+		rule.matchesName = !glob.contains('/');
+		rule.regex.setPattern(GlobToRegex(glob));
+	} else {
+		rule.matchesName = false;
+		rule.regex.setPattern(pattern);
+	}
+	rule.regex.optimize();
+	return rule;
+}
+
+bool
+TransferFilter::Matches(const Rule& rule, const QString& relativeName)
+{
+	if (rule.matchesName) {
+		QString name = relativeName;
+		while (name.endsWith('/')) {
+			name.chop(1);
+		}
+		return rule.regex.match(name.section('/', -1)).hasMatch();
+	}
+	return rule.regex.match(relativeName).hasMatch();
+}
+
+// An exclude glob matches if the entry or any folder above it matches
+bool
+TransferFilter::IsExcluded(const QString& relativeName) const
+{
+	if (m_excludes.isEmpty()) {
+		return false;
+	}
+	QStringList parts = relativeName.split('/', QString::SkipEmptyParts);
+	QString path;
+	for (int i = 0; i < parts.size(); i++) {
+		path += (i == 0 ? "" : "/") + parts[i];
+		for (int r = 0; r < m_excludes.size(); r++) {
+			const Rule& rule = m_excludes[r];
+			if (!rule.isGlob) {
+				continue;
+			}
+			const QString& subject = rule.matchesName ? parts[i] : path;
+			if (rule.regex.match(subject).hasMatch()) {
+				return true;
+			}
+		}
+	}
+	for (int r = 0; r < m_excludes.size(); r++) {
+		const Rule& rule = m_excludes[r];
+		if (!rule.isGlob && rule.regex.match(relativeName).hasMatch()) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void
+TransferFilter::AddRule(const Rule& rule, bool include)
+{
+	if (include) {
+		m_includes << rule;
+	} else {
+		m_excludes << rule;
+	}
+}
+
+QDataStream&
+operator<<(QDataStream& out, const TransferFilter& filter)
+{
+	QList<TransferFilter::Rule> rules = filter.m_includes + filter.m_excludes;
+	out << (qint32)filter.m_includes.size() << (qint32)rules.size();
+	for (int i = 0; i < rules.size(); i++) {
+		out << rules[i].source << rules[i].isGlob;
+	}
+	out << (quint64)filter.m_minSize << (quint64)filter.m_maxSize
+	    << filter.m_modifiedAfter << filter.m_modifiedBefore;
+	return out;
+}
+
+QDataStream&
+operator>>(QDataStream& in, TransferFilter& filter)
+{
+	qint32 numIncludes, numRules;
+	in >> numIncludes >> numRules;
+	filter = TransferFilter();
+	for (qint32 i = 0; i < numRules && in.status() == QDataStream::Ok; i++) {
+		QString source;
+		bool isGlob;
+		in >> source >> isGlob;
+		filter.AddRule(TransferFilter::CreateRule(source, isGlob),
+			       i < numIncludes);
+	}
+	quint64 minSize, maxSize;
+	in >> minSize >> maxSize >> filter.m_modifiedAfter
+	   >> filter.m_modifiedBefore;
+	filter.m_minSize = minSize;
+	filter.m_maxSize = maxSize;
+	return in;
+}
@@ -0,0 +1,153 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef TRANSFER_FILTER_H
+#define TRANSFER_FILTER_H
+
+#include <stdint.h>
+#include <QDataStream>
+#include <QDateTime>
+#include <QList>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+
+// TransferFilter, the include/exclude rules of a BulkGet/BulkPut job.
+// They're checked against every object or file found while enumerating a
+// folder, so rejected entries never become part of the job.  Entries that
+// were selected directly are always transferred.
+//
+// Patterns are matched against an entry's path relative to the folder
+// being transferred.  Globs without a '/' (e.g. "*.dpx") are matched
+// against the entry's name and those with one against the whole relative
+// path, while regular expressions are searched for anywhere in the
+// relative path.  An exclude rule also rejects everything under a folder
+// it matches, e.g. ".git" skips every file in a .git folder.  If there are
+// include rules, files must match at least one of them.  Every pattern is
+// compiled once, when it's added, rather than for every entry.
+class TransferFilter
+{
+public:
+	TransferFilter();
+
+	// The filter for jobs started from the GUI, made up of the space
+	// separated globs in the transfers/filterInclude and
+	// transfers/filterExclude settings
+	static TransferFilter FromSettings();
+
+	bool IsEmpty() const;
+	// Whether any rule other than exclude patterns is set.  Folders
+	// themselves are only transferred if there are no such rules since
+	// there's no way to know whether they'd end up with any files.
+	bool HasFileRules() const;
+
+	void AddInclude(const QString& glob);
+	void AddExclude(const QString& glob);
+	// Returns false, with a reason in error, if pattern is invalid
+	bool AddIncludeRegex(const QString& pattern, QString* error);
+	bool AddExcludeRegex(const QString& pattern, QString* error);
+	void SetMinSize(uint64_t size);
+	void SetMaxSize(uint64_t size);
+	void SetModifiedAfter(const QDateTime& time);
+	void SetModifiedBefore(const QDateTime& time);
+
+	// Whether a file should be transferred.  modified is ignored if it's
+	// invalid, e.g. when the server didn't report it.
+	bool Accepts(const QString& relativeName, uint64_t size,
+		     const QDateTime& modified) const;
+	// Whether a folder, whose relative name may end in a '/', should be
+	// transferred
+	bool AcceptsFolder(const QString& relativeName) const;
+
+	// A description of the rules for logs.  Two filters with the same
+	// rules have the same description.
+	QString ToString() const;
+
+	// The regular expression, anchored at both ends, that's equivalent to
+	// a glob.  '*' and '?' don't match '/'.
+	static QString GlobToRegex(const QString& glob);
+
+private:
+	// A compiled pattern along with what it was compiled from
+	struct Rule
+	{
+		QString source;
+		bool isGlob;
+		bool matchesName;
+		QRegularExpression regex;
+	};
+
+	static Rule CreateRule(const QString& pattern, bool isGlob);
+	static bool Matches(const Rule& rule, const QString& relativeName);
+	bool IsExcluded(const QString& relativeName) const;
+	void AddRule(const Rule& rule, bool include);
+
+	QList<Rule> m_includes;
+	QList<Rule> m_excludes;
+	uint64_t m_minSize;
+	uint64_t m_maxSize;
+	QDateTime m_modifiedAfter;
+	QDateTime m_modifiedBefore;
+
+	friend QDataStream& operator<<(QDataStream& out,
+				       const TransferFilter& filter);
+	friend QDataStream& operator>>(QDataStream& in,
+				       TransferFilter& filter);
+};
+
+// Used to send filters to the transfer daemon
+QDataStream& operator<<(QDataStream& out, const TransferFilter& filter);
+QDataStream& operator>>(QDataStream& in, TransferFilter& filter);
+
+inline bool
+TransferFilter::IsEmpty() const
+{
+	return m_excludes.isEmpty() && !HasFileRules();
+}
+
+inline bool
+TransferFilter::HasFileRules() const
+{
+	return !m_includes.isEmpty() || m_minSize > 0 ||
+	       m_maxSize < UINT64_MAX ||
+	       m_modifiedAfter.isValid() || m_modifiedBefore.isValid();
+}
+
+inline void
+TransferFilter::SetMinSize(uint64_t size)
+{
+	m_minSize = size;
+}
+
+inline void
+TransferFilter::SetMaxSize(uint64_t size)
+{
+	m_maxSize = size;
+}
+
+inline void
+TransferFilter::SetModifiedAfter(const QDateTime& time)
+{
+	m_modifiedAfter = time;
+}
+
+inline void
+TransferFilter::SetModifiedBefore(const QDateTime& time)
+{
+	m_modifiedBefore = time;
+}
+
+#endif
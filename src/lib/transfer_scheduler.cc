@@ -0,0 +1,346 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QElapsedTimer>
+#include <QSettings>
+
+#include "lib/client.h"
+#include "lib/logger.h"
+#include "lib/transfer_scheduler.h"
+#include "lib/work_items/bulk_work_item.h"
+
+const int TransferScheduler::PRIORITY_WEIGHTS[] = { 1, 2, 4 };
+
+const int TransferScheduler::DEFAULT_MAX_ACTIVE_JOBS = 4;
+const int TransferScheduler::DEFAULT_MAX_ACTIVE_JOBS_PER_HOST = 2;
+const int TransferScheduler::DEFAULT_MAX_TRANSFER_SLOTS = 32;
+
+TransferScheduler* TransferScheduler::s_instance = 0;
+
+TransferScheduler*
+TransferScheduler::Instance()
+{
+	if (!s_instance) {
+		s_instance = new TransferScheduler();
+	}
+	return s_instance;
+}
+
+TransferScheduler::TransferScheduler()
+	: m_maxActiveJobs(DEFAULT_MAX_ACTIVE_JOBS),
+	  m_maxActiveJobsPerHost(DEFAULT_MAX_ACTIVE_JOBS_PER_HOST),
+	  m_virtualTime(0),
+	  m_maxTransferSlots(DEFAULT_MAX_TRANSFER_SLOTS),
+	  m_transferSlotsInUse(0),
+	  m_slotVirtualTime(0)
+{
+	QSettings settings;
+	m_maxActiveJobs = qMax(1, settings.value("transfers/maxActiveJobs",
+						 DEFAULT_MAX_ACTIVE_JOBS).toInt());
+	m_maxActiveJobsPerHost = qMax(1, settings.value("transfers/maxActiveJobsPerHost",
+							DEFAULT_MAX_ACTIVE_JOBS_PER_HOST).toInt());
+	m_maxTransferSlots = qMax(1, settings.value("transfers/maxTransferSlots",
+						    DEFAULT_MAX_TRANSFER_SLOTS).toInt());
+}
+
+TransferScheduler::~TransferScheduler()
+{
+}
+
+void
+TransferScheduler::Submit(Client* client, BulkWorkItem* workItem)
+{
+	m_lock.lock();
+	QueuedJob job;
+	job.client = client;
+	job.workItem = workItem;
+	job.host = workItem->GetHost();
+	double start = qMax(m_virtualTime, m_flowFinishTags.value(client, 0));
+	job.finishTag = start + 1.0 / PRIORITY_WEIGHTS[workItem->GetPriority()];
+	m_flowFinishTags[client] = job.finishTag;
+	m_queue << job;
+	QList<QueuedJob> admitted = Admit();
+	m_lock.unlock();
+
+	StartAdmitted(admitted);
+}
+
+bool
+TransferScheduler::Dequeue(BulkWorkItem* workItem)
+{
+	bool dequeued = false;
+	m_lock.lock();
+	for (int i = 0; i < m_queue.size(); i++) {
+		if (m_queue.at(i).workItem == workItem) {
+			m_queue.removeAt(i);
+			dequeued = true;
+			break;
+		}
+	}
+	m_lock.unlock();
+	return dequeued;
+}
+
+void
+TransferScheduler::Release(BulkWorkItem* workItem)
+{
+	if (Dequeue(workItem)) {
+		return;
+	}
+
+	m_lock.lock();
+	if (m_active.contains(workItem)) {
+		QString host = m_active.take(workItem).host;
+		m_activePerHost[host]--;
+		if (m_activePerHost[host] <= 0) {
+			m_activePerHost.remove(host);
+		}
+	}
+	QList<QueuedJob> admitted = Admit();
+	m_lock.unlock();
+
+	StartAdmitted(admitted);
+}
+
+void
+TransferScheduler::RemoveClient(Client* client)
+{
+	m_lock.lock();
+	for (int i = m_queue.size() - 1; i >= 0; i--) {
+		if (m_queue.at(i).client == client) {
+			m_queue.removeAt(i);
+		}
+	}
+	QMutableHashIterator<BulkWorkItem*, QueuedJob> ai(m_active);
+	while (ai.hasNext()) {
+		ai.next();
+		if (ai.value().client != client) {
+			continue;
+		}
+		QString host = ai.value().host;
+		m_activePerHost[host]--;
+		if (m_activePerHost[host] <= 0) {
+			m_activePerHost.remove(host);
+		}
+		ai.remove();
+	}
+	m_flowFinishTags.remove(client);
+	m_slotFinishTags.remove(client);
+	QList<QueuedJob> admitted = Admit();
+	m_lock.unlock();
+
+	StartAdmitted(admitted);
+}
+
+bool
+TransferScheduler::AcquireTransferSlot(Client* client, BulkWorkItem* workItem,
+				       int timeoutInMs)
+{
+	QElapsedTimer timer;
+	timer.start();
+	m_lock.lock();
+	SlotRequest request;
+	request.client = client;
+	request.weight = PRIORITY_WEIGHTS[workItem->GetPriority()];
+	m_slotRequests << &request;
+
+	bool acquired = false;
+	while (true) {
+		if (m_transferSlotsInUse < m_maxTransferSlots &&
+		    IsNextSlotRequest(&request)) {
+			acquired = true;
+			break;
+		}
+		qint64 remaining = timeoutInMs - timer.elapsed();
+		if (remaining <= 0) {
+			break;
+		}
+		m_slotFreed.wait(&m_lock, remaining);
+	}
+
+	m_slotRequests.removeOne(&request);
+	if (acquired) {
+		m_transferSlotsInUse++;
+		// Virtual time follows the start tags of the granted slots so
+		// a Client that just started asking isn't put ahead of ones
+		// that have been waiting
+		m_slotVirtualTime = qMax(m_slotVirtualTime,
+					 GetSlotStartTag(&request));
+		m_slotFinishTags[client] = GetSlotFinishTag(&request);
+	}
+	m_lock.unlock();
+	// The next request in line may be able to take another free slot,
+	// or may be next now that this one gave up
+	m_slotFreed.wakeAll();
+	return acquired;
+}
+
+void
+TransferScheduler::ReleaseTransferSlot()
+{
+	m_lock.lock();
+	m_transferSlotsInUse--;
+	m_lock.unlock();
+	m_slotFreed.wakeAll();
+}
+
+int
+TransferScheduler::GetNumQueued() const
+{
+	m_lock.lock();
+	int num = m_queue.size();
+	m_lock.unlock();
+	return num;
+}
+
+int
+TransferScheduler::GetNumActive() const
+{
+	m_lock.lock();
+	int num = m_active.size();
+	m_lock.unlock();
+	return num;
+}
+
+int
+TransferScheduler::GetNumTransferSlotsInUse() const
+{
+	m_lock.lock();
+	int num = m_transferSlotsInUse;
+	m_lock.unlock();
+	return num;
+}
+
+int
+TransferScheduler::GetNumWaitingForTransferSlots() const
+{
+	m_lock.lock();
+	int num = m_slotRequests.size();
+	m_lock.unlock();
+	return num;
+}
+
+void
+TransferScheduler::ReadSettings()
+{
+	QSettings settings;
+	SetLimits(settings.value("transfers/maxActiveJobs",
+				 DEFAULT_MAX_ACTIVE_JOBS).toInt(),
+		  settings.value("transfers/maxActiveJobsPerHost",
+				 DEFAULT_MAX_ACTIVE_JOBS_PER_HOST).toInt());
+	SetMaxTransferSlots(settings.value("transfers/maxTransferSlots",
+					   DEFAULT_MAX_TRANSFER_SLOTS).toInt());
+}
+
+void
+TransferScheduler::SetLimits(int maxActiveJobs, int maxActiveJobsPerHost)
+{
+	m_lock.lock();
+	m_maxActiveJobs = qMax(1, maxActiveJobs);
+	m_maxActiveJobsPerHost = qMax(1, maxActiveJobsPerHost);
+	QList<QueuedJob> admitted = Admit();
+	m_lock.unlock();
+
+	StartAdmitted(admitted);
+}
+
+void
+TransferScheduler::SetMaxTransferSlots(int maxTransferSlots)
+{
+	m_lock.lock();
+	m_maxTransferSlots = qMax(1, maxTransferSlots);
+	m_lock.unlock();
+	m_slotFreed.wakeAll();
+}
+
+QList<TransferScheduler::QueuedJob>
+TransferScheduler::Admit()
+{
+	QList<QueuedJob> admitted;
+	while (m_active.size() < m_maxActiveJobs) {
+		// Lowest finish tag whose host still has a free slot
+		int next = -1;
+		for (int i = 0; i < m_queue.size(); i++) {
+			const QueuedJob& job = m_queue.at(i);
+			if (m_activePerHost.value(job.host, 0) >= m_maxActiveJobsPerHost) {
+				continue;
+			}
+			if (next == -1 || job.finishTag < m_queue.at(next).finishTag) {
+				next = i;
+			}
+		}
+		if (next == -1) {
+			break;
+		}
+		QueuedJob job = m_queue.takeAt(next);
+		// A flow's first job can be tagged below a job that was
+		// admitted earlier, so never let virtual time run backwards
+		m_virtualTime = qMax(m_virtualTime, job.finishTag);
+		m_active.insert(job.workItem, job);
+		m_activePerHost[job.host]++;
+		admitted << job;
+	}
+	return admitted;
+}
+
+void
+TransferScheduler::StartAdmitted(const QList<QueuedJob>& admitted)
+{
+	for (int i = 0; i < admitted.size(); i++) {
+		const QueuedJob& job = admitted.at(i);
+		LOG_DEBUG("SCHEDULER    ADMIT     " + job.workItem->GetID().toString());
+		StartJob(job.client, job.workItem);
+	}
+}
+
+double
+TransferScheduler::GetSlotStartTag(const SlotRequest* request) const
+{
+	return qMax(m_slotVirtualTime, m_slotFinishTags.value(request->client, 0));
+}
+
+double
+TransferScheduler::GetSlotFinishTag(const SlotRequest* request) const
+{
+	return GetSlotStartTag(request) + 1.0 / request->weight;
+}
+
+bool
+TransferScheduler::IsNextSlotRequest(const SlotRequest* request) const
+{
+	// Ties go to the request that's been waiting longest
+	double finishTag = GetSlotFinishTag(request);
+	bool waitedLonger = true;
+	for (int i = 0; i < m_slotRequests.size(); i++) {
+		const SlotRequest* other = m_slotRequests.at(i);
+		if (other == request) {
+			waitedLonger = false;
+			continue;
+		}
+		double otherFinishTag = GetSlotFinishTag(other);
+		if (otherFinishTag < finishTag ||
+		    (waitedLonger && otherFinishTag == finishTag)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void
+TransferScheduler::StartJob(Client* client, BulkWorkItem* workItem)
+{
+	client->StartBulkWorkItem(workItem);
+}
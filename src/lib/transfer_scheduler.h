@@ -0,0 +1,152 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef TRANSFER_SCHEDULER_H
+#define TRANSFER_SCHEDULER_H
+
+#include <stdint.h>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+class BulkWorkItem;
+class Client;
+
+// TransferScheduler, an application wide queue of bulk GET/PUT jobs.  Every
+// Client (i.e. every session) submits its jobs here instead of starting them
+// right away.  A job is admitted, and its Client told to start it, once
+// there's both a free global slot and a free slot for the job's host.
+//
+// Which queued job gets the next slot is decided with weighted fair
+// queuing.  Each Client is a separate flow and every admission costs one
+// slot divided by the job's priority weight.  Thus, sessions share slots
+// evenly regardless of how many jobs each one queues up, and HIGH priority
+// jobs get admitted four times as often as LOW priority ones.  A job's
+// priority is set on its BulkWorkItem before it's submitted.
+//
+// Admitted jobs then share a fixed number of transfer slots, one per object
+// GET/PUT in flight, the same way.  Each slot granted costs the job's Client
+// one slot divided by the job's weight, so a Client with one huge admitted
+// job can't take every slot from the others' jobs.  A job's own
+// ConcurrencyController still decides how many slots it asks for.
+class TransferScheduler
+{
+public:
+	enum Priority { LOW, NORMAL, HIGH };
+	static const int PRIORITY_WEIGHTS[];
+
+	static const int DEFAULT_MAX_ACTIVE_JOBS;
+	static const int DEFAULT_MAX_ACTIVE_JOBS_PER_HOST;
+	static const int DEFAULT_MAX_TRANSFER_SLOTS;
+
+	static TransferScheduler* Instance();
+
+	virtual ~TransferScheduler();
+
+	// Queue a job at workItem->GetPriority().  client->StartBulkWorkItem
+	// will be called once it's admitted, possibly before this returns.
+	void Submit(Client* client, BulkWorkItem* workItem);
+	// Remove a job that's still queued.  Returns false if the job
+	// isn't queued (it was already admitted or never submitted).
+	bool Dequeue(BulkWorkItem* workItem);
+	// Must be called once an admitted job is finished or canceled so its
+	// slot can be given to the next job.  Queued jobs are dequeued.
+	void Release(BulkWorkItem* workItem);
+	// Forget all of a Client's queued jobs and give up the slots of its
+	// admitted ones.  Called when it's destroyed.
+	void RemoveClient(Client* client);
+
+	// Wait up to timeoutInMs for a transfer slot for one of workItem's
+	// objects.  Returns true if a slot was taken, in which case
+	// ReleaseTransferSlot must be called once the transfer is done.
+	bool AcquireTransferSlot(Client* client, BulkWorkItem* workItem,
+				 int timeoutInMs);
+	void ReleaseTransferSlot();
+
+	int GetNumQueued() const;
+	int GetNumActive() const;
+	int GetNumTransferSlotsInUse() const;
+	int GetNumWaitingForTransferSlots() const;
+
+	// Re-read the limits from the settings and admit any jobs that
+	// now fit
+	void ReadSettings();
+	void SetLimits(int maxActiveJobs, int maxActiveJobsPerHost);
+	void SetMaxTransferSlots(int maxTransferSlots);
+
+protected:
+	TransferScheduler();
+
+	// Tell the job's Client to start it.  Called without m_lock held.
+	virtual void StartJob(Client* client, BulkWorkItem* workItem);
+
+private:
+	struct QueuedJob
+	{
+		Client* client;
+		BulkWorkItem* workItem;
+		QString host;
+		// Virtual finish time, jobs with the lowest are admitted
+		// first
+		double finishTag;
+	};
+
+	// A thread waiting in AcquireTransferSlot.  Requests are only tagged
+	// when a slot is free, since a request that times out and is made
+	// again mustn't lose its place or charge its Client twice.
+	struct SlotRequest
+	{
+		Client* client;
+		int weight;
+	};
+
+	// m_lock must be held.  Returns the jobs that were admitted so their
+	// Clients can be told to start them after m_lock is released.
+	QList<QueuedJob> Admit();
+	void StartAdmitted(const QList<QueuedJob>& admitted);
+	// The virtual start and finish times a transfer slot granted to
+	// request would get.  m_lock must be held.
+	double GetSlotStartTag(const SlotRequest* request) const;
+	double GetSlotFinishTag(const SlotRequest* request) const;
+	// Whether request has the lowest finish tag of the waiting requests.
+	// m_lock must be held.
+	bool IsNextSlotRequest(const SlotRequest* request) const;
+
+	static TransferScheduler* s_instance;
+
+	int m_maxActiveJobs;
+	int m_maxActiveJobsPerHost;
+	QList<QueuedJob> m_queue;
+	QHash<BulkWorkItem*, QueuedJob> m_active;
+	QHash<QString, int> m_activePerHost;
+	// Last finish tag handed out to each Client
+	QHash<Client*, double> m_flowFinishTags;
+	double m_virtualTime;
+
+	int m_maxTransferSlots;
+	int m_transferSlotsInUse;
+	// In the order they started waiting, which breaks finish tag ties
+	QList<SlotRequest*> m_slotRequests;
+	QHash<Client*, double> m_slotFinishTags;
+	double m_slotVirtualTime;
+	QWaitCondition m_slotFreed;
+
+	mutable QMutex m_lock;
+};
+
+#endif
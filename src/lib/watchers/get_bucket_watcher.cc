@@ -20,9 +20,10 @@ GetBucketWatcher::GetBucketWatcher(const QModelIndex& parentModelIndex,
 				   const QString& bucketName,
 				   const QString& prefix,
 				   QObject* parent)
-	: QFutureWatcher<ds3_get_bucket_response*>(parent),
+	: QFutureWatcher<BucketListing>(parent),
 	  m_parentModelIndex(parentModelIndex),
 	  m_bucketName(bucketName),
 	  m_prefix(prefix)
 {
+	m_timer.start();
 }
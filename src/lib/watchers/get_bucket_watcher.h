@@ -17,14 +17,15 @@
 #ifndef GET_BUCKET_WATCHER_H
 #define GET_BUCKET_WATCHER_H
 
+#include <QElapsedTimer>
 #include <QFuture>
 #include <QFutureWatcher>
 #include <QModelIndex>
 #include <QString>
 
-#include <ds3.h>
+#include "models/listing.h"
 
-class GetBucketWatcher : public QFutureWatcher<ds3_get_bucket_response*>
+class GetBucketWatcher : public QFutureWatcher<BucketListing>
 {
 public:
 	GetBucketWatcher(const QModelIndex& parentModelIndex,
@@ -35,11 +36,15 @@ public:
 	const QModelIndex& GetParentModelIndex() const;
 	const QString& GetBucketName() const;
 	const QString& GetPrefix() const;
+	// Time since the watcher was created, which is just before the
+	// request is sent
+	qint64 GetElapsedInMs() const;
 
 private:
 	const QModelIndex m_parentModelIndex;
 	const QString m_bucketName;
 	const QString m_prefix;
+	QElapsedTimer m_timer;
 };
 
 inline const QModelIndex&
@@ -60,4 +65,10 @@ GetBucketWatcher::GetPrefix() const
 	return m_prefix;
 }
 
+inline qint64
+GetBucketWatcher::GetElapsedInMs() const
+{
+	return m_timer.elapsed();
+}
+
 #endif
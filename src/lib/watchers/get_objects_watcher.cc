@@ -20,7 +20,7 @@ GetObjectsWatcher::GetObjectsWatcher(const QModelIndex& parentModelIndex,
 				   const QString& bucketName,
 				   const QString& prefix,
 				   QObject* parent)
-	: QFutureWatcher<ds3_get_objects_response*>(parent),
+	: QFutureWatcher<BucketListing>(parent),
 	  m_parentModelIndex(parentModelIndex),
 	  m_bucketName(bucketName),
 	  m_prefix(prefix)
@@ -22,9 +22,9 @@
 #include <QModelIndex>
 #include <QString>
 
-#include <ds3.h>
+#include "models/listing.h"
 
-class GetObjectsWatcher : public QFutureWatcher<ds3_get_objects_response*>
+class GetObjectsWatcher : public QFutureWatcher<BucketListing>
 {
 public:
 	GetObjectsWatcher(const QModelIndex& parentModelIndex,
@@ -18,7 +18,7 @@
 
 GetServiceWatcher::GetServiceWatcher(const QModelIndex& parentModelIndex,
 				     QObject* parent)
-	: QFutureWatcher<ds3_get_service_response*>(parent),
+	: QFutureWatcher<ServiceListing>(parent),
 	  m_parentModelIndex(parentModelIndex)
 {
 }
@@ -21,9 +21,9 @@
 #include <QFutureWatcher>
 #include <QModelIndex>
 
-#include <ds3.h>
+#include "models/listing.h"
 
-class GetServiceWatcher : public QFutureWatcher<ds3_get_service_response*>
+class GetServiceWatcher : public QFutureWatcher<ServiceListing>
 {
 public:
 	GetServiceWatcher(const QModelIndex& parentModelIndex,
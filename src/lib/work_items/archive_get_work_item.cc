@@ -0,0 +1,98 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QMutexLocker>
+
+#include "lib/work_items/archive_get_work_item.h"
+
+ArchiveGetWorkItem::ArchiveGetWorkItem(const QString& host,
+				       const QList<QUrl> urls,
+				       const QString& archivePath)
+	: BulkGetWorkItem(host, urls, archivePath),
+	  m_writer(archivePath)
+{
+}
+
+bool
+ArchiveGetWorkItem::Open(QString* error)
+{
+	return m_writer.Open(error);
+}
+
+bool
+ArchiveGetWorkItem::Close(QString* error)
+{
+	QMutexLocker locker(&m_writerLock);
+	return m_writer.Close(error);
+}
+
+QString
+ArchiveGetWorkItem::GetEntryName(const QString& filePath) const
+{
+	QString entryName = filePath;
+	entryName.remove(0, GetDestination().size() + 1);
+	return entryName;
+}
+
+bool
+ArchiveGetWorkItem::AddDirectory(const QString& entryName, QString* error)
+{
+	QMutexLocker locker(&m_writerLock);
+	return m_writer.AddDirectory(entryName, error);
+}
+
+bool
+ArchiveGetWorkItem::ReserveEntry(const QString& entryName, uint64_t size,
+				 qint64* dataOffset, QString* error)
+{
+	QMutexLocker locker(&m_writerLock);
+	QHash<QString, ReservedEntry>::const_iterator ri;
+	ri = m_reservedEntries.constFind(entryName);
+	if (ri != m_reservedEntries.constEnd()) {
+		*dataOffset = ri.value().dataOffset;
+		return true;
+	}
+
+	ReservedEntry entry;
+	if (!m_writer.ReserveEntry(entryName, size, &entry.dataOffset, error)) {
+		return false;
+	}
+	entry.size = size;
+	entry.remaining = size;
+	m_reservedEntries.insert(entryName, entry);
+	*dataOffset = entry.dataOffset;
+	return true;
+}
+
+bool
+ArchiveGetWorkItem::AddReservedBytes(const QString& entryName, uint64_t length,
+				     QString* error)
+{
+	QMutexLocker locker(&m_writerLock);
+	QHash<QString, ReservedEntry>::iterator ri;
+	ri = m_reservedEntries.find(entryName);
+	if (ri == m_reservedEntries.end()) {
+		return true;
+	}
+	ri.value().remaining -= qMin(length, ri.value().remaining);
+	if (ri.value().remaining > 0) {
+		return true;
+	}
+	ReservedEntry entry = ri.value();
+	m_reservedEntries.erase(ri);
+	return m_writer.FinishReservedEntry(entryName, entry.dataOffset,
+					    entry.size, error);
+}
@@ -0,0 +1,97 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef ARCHIVE_GET_WORK_ITEM_H
+#define ARCHIVE_GET_WORK_ITEM_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+#include "lib/archive_writer.h"
+#include "lib/work_items/bulk_get_work_item.h"
+
+// ArchiveGetWorkItem, a bulk GET that writes its objects as the entries of a
+// single zip or tar archive (see ArchiveWriter) rather than as individual
+// files.  Its destination is the archive.  PrepareBulkGets builds file paths
+// under it as if it were a directory and those paths, relative to the
+// archive, are the entry names.
+//
+// An entry's space is reserved when the first blob of its object arrives
+// so its blobs can be written in any order.  Objects that aren't split in to
+// blobs are added to a zip archive all at once instead.
+class ArchiveGetWorkItem : public BulkGetWorkItem
+{
+public:
+	ArchiveGetWorkItem(const QString& host,
+			   const QList<QUrl> urls,
+			   const QString& archivePath);
+
+	// Create the archive.  Returns false and sets error if it can't be.
+	bool Open(QString* error);
+	// Finish the archive once the job is done
+	bool Close(QString* error);
+
+	bool HasArchive() const;
+	ArchiveWriter* GetWriter();
+	// Held while adding entries to the archive
+	QMutex* GetWriterLock();
+
+	QString GetEntryName(const QString& filePath) const;
+	bool AddDirectory(const QString& entryName, QString* error);
+
+	// The data offset of an entry, which is reserved the first time one
+	// of its object's blobs is transferred
+	bool ReserveEntry(const QString& entryName, uint64_t size,
+			  qint64* dataOffset, QString* error);
+	// Record that length bytes of a reserved entry have been written.  It's
+	// finished (see ArchiveWriter::FinishReservedEntry) once all of them
+	// have been.  Returns false and sets error if it can't be.
+	bool AddReservedBytes(const QString& entryName, uint64_t length,
+			      QString* error);
+
+private:
+	struct ReservedEntry
+	{
+		qint64 dataOffset;
+		uint64_t size;
+		uint64_t remaining;
+	};
+
+	ArchiveWriter m_writer;
+	QMutex m_writerLock;
+	QHash<QString, ReservedEntry> m_reservedEntries;
+};
+
+inline bool
+ArchiveGetWorkItem::HasArchive() const
+{
+	return true;
+}
+
+inline ArchiveWriter*
+ArchiveGetWorkItem::GetWriter()
+{
+	return &m_writer;
+}
+
+inline QMutex*
+ArchiveGetWorkItem::GetWriterLock()
+{
+	return &m_writerLock;
+}
+
+#endif
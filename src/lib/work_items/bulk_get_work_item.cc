@@ -22,7 +22,8 @@ BulkGetWorkItem::BulkGetWorkItem(const QString& host,
 	: BulkWorkItem(host, urls),
 	  m_destination(destination),
 	  m_getBucketResponse(NULL),
-	  m_getBucketResponseIterator(0)
+	  m_getBucketResponseIterator(0),
+	  m_chunkOrdering(NONE)
 {
 }
 
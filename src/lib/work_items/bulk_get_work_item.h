@@ -37,6 +37,15 @@ public:
 
 	const QString GetDestination() const;
 	Job::Type GetType() const;
+	// Whether the objects come from a restore manifest instead of URLs.
+	// If so, this is a ManifestGetWorkItem.
+	virtual bool HasManifest() const;
+	// Whether the objects are written to a single archive instead of
+	// files.  If so, this is an ArchiveGetWorkItem.
+	virtual bool HasArchive() const;
+	// Whether a streamed upload's parts are reassembled in to a single
+	// device.  If so, this is a StreamGetWorkItem.
+	virtual bool HasStream() const;
 
 	ds3_get_bucket_response* GetGetBucketResponse() const;
 	size_t GetGetBucketResponseIterator() const;
@@ -44,6 +53,10 @@ public:
 	void SetGetBucketResponse(ds3_get_bucket_response* response);
 	void SetGetBucketResponseIterator(size_t i);
 
+	// The order the server stages chunks in and Client transfers them in
+	ds3_chunk_ordering GetChunkOrdering() const;
+	void SetChunkOrdering(ds3_chunk_ordering ordering);
+
 	void AppendDirsToCreate(const QString& dir);
 	int GetDirsToCreateSize() const;
 	const QString& GetDirsToCreateAt(int i) const;
@@ -66,6 +79,8 @@ private:
 	// populated during PrepareBulkGets so dir creation can be delayed
 	// until we know the actual bulk get request was successful.
 	QList<QString> m_dirsToCreate;
+
+	ds3_chunk_ordering m_chunkOrdering;
 };
 
 inline const QString
@@ -80,6 +95,24 @@ BulkGetWorkItem::GetType() const
 	return Job::GET;
 }
 
+inline bool
+BulkGetWorkItem::HasManifest() const
+{
+	return false;
+}
+
+inline bool
+BulkGetWorkItem::HasArchive() const
+{
+	return false;
+}
+
+inline bool
+BulkGetWorkItem::HasStream() const
+{
+	return false;
+}
+
 inline ds3_get_bucket_response*
 BulkGetWorkItem::GetGetBucketResponse() const
 {
@@ -98,6 +131,18 @@ BulkGetWorkItem::SetGetBucketResponseIterator(size_t i)
 	m_getBucketResponseIterator = i;
 }
 
+inline ds3_chunk_ordering
+BulkGetWorkItem::GetChunkOrdering() const
+{
+	return m_chunkOrdering;
+}
+
+inline void
+BulkGetWorkItem::SetChunkOrdering(ds3_chunk_ordering ordering)
+{
+	m_chunkOrdering = ordering;
+}
+
 inline void
 BulkGetWorkItem::AppendDirsToCreate(const QString& dir)
 {
@@ -14,15 +14,21 @@
  * *****************************************************************************
  */
 
+#include <QElapsedTimer>
+
 #include "lib/work_items/bulk_put_work_item.h"
 
+const int BulkPutWorkItem::ZIP_READER_WAIT_IN_MS = 10000;
+
 BulkPutWorkItem::BulkPutWorkItem(const QString& host,
 				 const QList<QUrl> urls,
 				 const QString& bucketName,
 				 const QString& prefix)
 	: BulkWorkItem(host, urls),
 	  m_prefix(prefix),
-	  m_dirIterator(NULL)
+	  m_dirIterator(NULL),
+	  m_zip(NULL),
+	  m_prePlanned(false)
 {
 	  m_bucketName = bucketName;
 }
@@ -30,6 +36,12 @@ BulkPutWorkItem::BulkPutWorkItem(const QString& host,
 BulkPutWorkItem::~BulkPutWorkItem()
 {
 	DeleteDirIterator();
+	DeleteZip();
+	QHash<QString, ZipReader*>::iterator ri;
+	for (ri = m_zipReaders.begin(); ri != m_zipReaders.end(); ri++) {
+		delete ri.value()->member;
+		delete ri.value();
+	}
 }
 
 void
@@ -41,8 +53,139 @@ BulkPutWorkItem::DeleteDirIterator()
 	}
 }
 
+QuaZip*
+BulkPutWorkItem::GetZip(const QString& filePath)
+{
+	DeleteZip();
+	m_zip = new QuaZip(filePath);
+	if (!m_zip->open(QuaZip::mdUnzip)) {
+		DeleteZip();
+		return NULL;
+	}
+	m_zip->goToFirstFile();
+	return m_zip;
+}
+
+void
+BulkPutWorkItem::DeleteZip()
+{
+	if (m_zip != NULL) {
+		m_zip->close();
+		delete m_zip;
+		m_zip = NULL;
+	}
+}
+
+bool
+BulkPutWorkItem::GetZipMember(const QString& objName, QString* zipPath,
+			      QString* memberName) const
+{
+	QHash<QString, QPair<QString, QString> >::const_iterator i;
+	i = m_zipMembers.constFind(objName);
+	if (i == m_zipMembers.constEnd()) {
+		return false;
+	}
+	*zipPath = i.value().first;
+	*memberName = i.value().second;
+	return true;
+}
+
+QuaZipFile*
+BulkPutWorkItem::AcquireZipReader(const QString& objName, uint64_t offset,
+				  QString* error)
+{
+	m_zipReadersLock.lock();
+	ZipReader* reader = m_zipReaders.value(objName);
+	if (reader == NULL) {
+		reader = new ZipReader;
+		reader->member = NULL;
+		reader->position = 0;
+		reader->busy = false;
+		m_zipReaders.insert(objName, reader);
+	}
+	// Give the blobs before this one a chance to be read first so the
+	// member doesn't have to be decompressed again for them
+	QElapsedTimer timer;
+	timer.start();
+	while (reader->busy ||
+	       (reader->position < offset &&
+		timer.elapsed() < ZIP_READER_WAIT_IN_MS)) {
+		if (reader->busy) {
+			m_zipReaderReleased.wait(&m_zipReadersLock);
+		} else {
+			m_zipReaderReleased.wait(&m_zipReadersLock,
+						 (unsigned long)(ZIP_READER_WAIT_IN_MS -
+								 timer.elapsed()));
+		}
+	}
+	reader->busy = true;
+	m_zipReadersLock.unlock();
+
+	QString zipPath;
+	QString memberName;
+	GetZipMember(objName, &zipPath, &memberName);
+	if (reader->member != NULL && reader->position > offset) {
+		delete reader->member;
+		reader->member = NULL;
+	}
+	if (reader->member == NULL) {
+		QuaZipFile* member = new QuaZipFile(zipPath, memberName,
+						    QuaZip::csSensitive);
+		if (!member->open(QIODevice::ReadOnly)) {
+			*error = "unable to read " + memberName +
+				 " from zip archive " + zipPath;
+			delete member;
+			ReleaseZipReader(objName, 0);
+			return NULL;
+		}
+		reader->member = member;
+		reader->position = 0;
+	}
+	char buffer[64 * 1024];
+	while (reader->position < offset) {
+		qint64 bytesRead = reader->member->read(buffer,
+							qMin((uint64_t)sizeof(buffer),
+							     offset - reader->position));
+		if (bytesRead <= 0) {
+			*error = "unable to decompress " + memberName +
+				 " from zip archive " + zipPath;
+			delete reader->member;
+			reader->member = NULL;
+			ReleaseZipReader(objName, 0);
+			return NULL;
+		}
+		reader->position += bytesRead;
+	}
+	return reader->member;
+}
+
+void
+BulkPutWorkItem::ReleaseZipReader(const QString& objName, uint64_t size)
+{
+	m_zipReadersLock.lock();
+	ZipReader* reader = m_zipReaders.value(objName);
+	if (reader->member != NULL) {
+		reader->position = (uint64_t)reader->member->pos();
+		if (reader->position >= size) {
+			delete reader->member;
+			reader->member = NULL;
+		}
+	}
+	reader->busy = false;
+	m_zipReaderReleased.wakeAll();
+	m_zipReadersLock.unlock();
+}
+
+void
+BulkPutWorkItem::SetPrePlanned()
+{
+	m_prePlanned = true;
+	m_urlsIterator = m_urls.constEnd();
+}
+
 bool
 BulkPutWorkItem::IsFinished() const
 {
-	return (BulkWorkItem::IsFinished() && m_dirIterator == NULL);
+	return (BulkWorkItem::IsFinished() && m_dirIterator == NULL &&
+		m_zip == NULL);
 }
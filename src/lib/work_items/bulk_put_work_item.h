@@ -22,10 +22,14 @@
 #include <QHash>
 #include <QList>
 #include <QMutex>
+#include <QPair>
 #include <QString>
 #include <QUrl>
+#include <QWaitCondition>
 
 #include "lib/work_items/bulk_work_item.h"
+#include "quazip/quazip.h"
+#include "quazip/quazipfile.h"
 
 // BulkPutWorkItem, a container class that stores all data necessary to perform
 // a DS3 bulk put operation.
@@ -47,11 +51,73 @@ public:
 	QDirIterator* GetDirIterator(const QString& filePath);
 	void DeleteDirIterator();
 
+	// Zip archives can be uploaded as if they were directories.  Like
+	// the DirIterator, the open archive is kept between pages, positioned
+	// at the next member to gather.  Returns NULL if the archive can't be
+	// opened.
+	QuaZip* GetZip() const;
+	QuaZip* GetZip(const QString& filePath);
+	void DeleteZip();
+
+	// The archive and member name an object is read from if it's a zip
+	// member rather than a file
+	bool GetZipMember(const QString& objName, QString* zipPath,
+			  QString* memberName) const;
+	void InsertZipMember(const QString& objName, const QString& zipPath,
+			     const QString& memberName);
+	void ClearZipMembers();
+
+	// How long a blob of a zip member waits for the member's earlier
+	// blobs to be read before it skips ahead to its own offset
+	static const int ZIP_READER_WAIT_IN_MS;
+
+	// A zip member split into more than one blob can't be seeked so its
+	// blobs are all read, one at a time and in offset order, from a
+	// single decompressor.  Returns the decompressor positioned at offset,
+	// which the caller has to itself until ReleaseZipReader, or NULL, with
+	// error set, if the member can't be read.  A blob that's sent again,
+	// or one that got ahead of the earlier blobs, reopens the member.
+	QuaZipFile* AcquireZipReader(const QString& objName, uint64_t offset,
+				     QString* error);
+	// The member is closed once all size bytes of it have been read
+	void ReleaseZipReader(const QString& objName, uint64_t size);
+
 	bool IsFinished() const;
 
+	// Whether the objects come from another DS3 system instead of local
+	// files.  If so, this is a MigrationWorkItem.
+	virtual bool IsMigration() const;
+	// Whether the data is read from a stream and uploaded as part
+	// objects.  If so, this is a StreamPutWorkItem.
+	virtual bool IsStream() const;
+
+	// A pre-planned work item's objects were all gathered before it was
+	// started so PrepareBulkPuts doesn't need to walk its URLs
+	bool IsPrePlanned() const;
+	void SetPrePlanned();
+
 private:
+	struct ZipReader
+	{
+		// NULL until a blob is read, after the member is finished and
+		// after it couldn't be read
+		QuaZipFile* member;
+		// How far into the member the last blob got
+		uint64_t position;
+		// Whether a blob is being read
+		bool busy;
+	};
+
 	QString m_prefix;
 	QDirIterator* m_dirIterator;
+	QuaZip* m_zip;
+	QHash<QString, QPair<QString, QString> > m_zipMembers;
+	// Never removed before the work item is deleted so blobs waiting
+	// for a reader can't be left with a dangling pointer
+	QHash<QString, ZipReader*> m_zipReaders;
+	QMutex m_zipReadersLock;
+	QWaitCondition m_zipReaderReleased;
+	bool m_prePlanned;
 };
 
 inline Job::Type
@@ -72,6 +138,24 @@ BulkPutWorkItem::GetPrefix() const
 	return m_prefix;
 }
 
+inline bool
+BulkPutWorkItem::IsMigration() const
+{
+	return false;
+}
+
+inline bool
+BulkPutWorkItem::IsStream() const
+{
+	return false;
+}
+
+inline bool
+BulkPutWorkItem::IsPrePlanned() const
+{
+	return m_prePlanned;
+}
+
 inline QDirIterator*
 BulkPutWorkItem::GetDirIterator() const
 {
@@ -90,4 +174,24 @@ BulkPutWorkItem::GetDirIterator(const QString& filePath)
 	return m_dirIterator;
 }
 
+inline QuaZip*
+BulkPutWorkItem::GetZip() const
+{
+	return m_zip;
+}
+
+inline void
+BulkPutWorkItem::InsertZipMember(const QString& objName,
+				 const QString& zipPath,
+				 const QString& memberName)
+{
+	m_zipMembers.insert(objName, qMakePair(zipPath, memberName));
+}
+
+inline void
+BulkPutWorkItem::ClearZipMembers()
+{
+	m_zipMembers.clear();
+}
+
 #endif
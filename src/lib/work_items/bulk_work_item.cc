@@ -17,10 +17,9 @@
 #include <QMap>
 
 #include "lib/work_items/bulk_work_item.h"
+#include "lib/concurrency_controller.h"
 #include "models/job.h"
 
-const uint64_t BulkWorkItem::UPDATE_THRESHOLD = 100 * 1024;
-
 BulkWorkItem::BulkWorkItem(const QString& host, const QList<QUrl> urls)
 	: WorkItem(),
 	  m_state(Job::INITIALIZING),
@@ -28,9 +27,12 @@ BulkWorkItem::BulkWorkItem(const QString& host, const QList<QUrl> urls)
 	  m_urls(urls),
 	  m_urlsIterator(m_urls.constBegin()),
 	  m_bytesTransferred(0),
-	  m_bytesTransferredSinceLastJobUpdate(0),
+	  m_numFailedObjects(0),
+	  m_plannedSize(0),
 	  m_response(NULL),
-	  m_numChunksProcessed(0)
+	  m_numChunksProcessed(0),
+	  m_concurrencyController(NULL),
+	  m_priority(TransferScheduler::NORMAL)
 {
 	SortURLsByBucket();
 }
@@ -40,60 +42,40 @@ BulkWorkItem::~BulkWorkItem()
 	if (m_response != NULL) {
 		ds3_free_bulk_response(m_response);
 	}
-}
-
-uint64_t
-BulkWorkItem::GetBytesTransferred() const
-{
-	m_bytesTransferredLock.lock();
-	uint64_t bytesTransferred = m_bytesTransferred;
-	m_bytesTransferredLock.unlock();
-	return bytesTransferred;
+	delete m_concurrencyController;
 }
 
 void
-BulkWorkItem::UpdateBytesTransferred(size_t bytes)
+BulkWorkItem::SetConcurrencyController(ConcurrencyController* controller)
 {
-	m_bytesTransferredLock.lock();
-	m_bytesTransferred += bytes;
-	m_bytesTransferredSinceLastJobUpdate += bytes;
-	m_bytesTransferredLock.unlock();
+	delete m_concurrencyController;
+	m_concurrencyController = controller;
 }
 
 const QString
 BulkWorkItem::GetJobID() const
 {
 	QString jobID;
+	m_responseLock.lock();
 	if (m_response != NULL) {
 		jobID = QString(m_response->job_id->value);
 	}
+	m_responseLock.unlock();
 	return jobID;
 }
 
 uint64_t
 BulkWorkItem::GetSize() const
 {
-	uint64_t size = 0;
+	uint64_t size = m_plannedSize;
+	m_responseLock.lock();
 	if (m_response != NULL) {
 		size = m_response->original_size_in_bytes;
 	}
+	m_responseLock.unlock();
 	return size;
 }
 
-bool
-BulkWorkItem::IsJobUpdateReady()
-{
-	bool ready = false;
-	m_bytesTransferredLock.lock();
-	if (m_bytesTransferredSinceLastJobUpdate > UPDATE_THRESHOLD) {
-		ready = true;
-		m_bytesTransferredSinceLastJobUpdate = 0;
-	}
-	m_bytesTransferredLock.unlock();
-	return ready;
-}
-
-
 bool
 BulkWorkItem::IsPageFinished() const
 {
@@ -115,22 +97,44 @@ BulkWorkItem::IsFinished() const
 
 const Job
 BulkWorkItem::ToJob() const
+{
+	Job job = ToProgressJob();
+	job.SetURLs(GetURLs());
+	return job;
+}
+
+const Job
+BulkWorkItem::ToProgressJob() const
 {
 	Job job;
 	job.SetID(GetID());
+	job.SetSessionID(GetSessionID());
 	job.SetType(GetType());
 	job.SetStart(GetStart());
 	job.SetTransferStart(GetTransferStart());
 	job.SetState(GetState());
 	job.SetHost(GetHost());
-	job.SetURLs(GetURLs());
 	job.SetDestination(GetDestination());
 	job.SetSize(GetSize());
 	job.SetBytesTransferred(GetBytesTransferred());
+	job.SetNumFailedObjects(GetNumFailedObjects());
+	if (m_concurrencyController != NULL) {
+		job.SetConcurrency(m_concurrencyController->GetLimit());
+	}
+	m_chunkWaitsLock.lock();
+	job.SetChunkWaits(m_chunkWaits);
+	m_chunkWaitsLock.unlock();
 	return job;
 }
 
 
+void
+BulkWorkItem::AppendURLs(const QList<QUrl>& urls)
+{
+	m_urls << urls;
+	SortURLsByBucket();
+}
+
 // Sort the URLs alphabetically so it's easier to determine if one URL is a
 // descendant of another.  Plus, a DS3 bulk get request can only be for a
 // single bucket, however, urls could contain objects from different buckets.
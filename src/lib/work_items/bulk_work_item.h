@@ -18,21 +18,25 @@
 #define BULK_WORK_ITEM_H
 
 #include <stdlib.h>
+#include <QAtomicInteger>
 #include <QList>
 #include <QString>
 #include <QMutex>
 #include <QUrl>
+#include <QUuid>
 
 #include <ds3.h>
 
+#include "lib/transfer_filter.h"
+#include "lib/transfer_scheduler.h"
 #include "lib/work_items/work_item.h"
 #include "models/job.h"
 
+class ConcurrencyController;
+
 class BulkWorkItem : public WorkItem
 {
 public:
-	static const uint64_t UPDATE_THRESHOLD;
-
 	BulkWorkItem(const QString& host, const QList<QUrl> urls);
 	virtual ~BulkWorkItem();
 
@@ -44,20 +48,24 @@ public:
 	const QString& GetHost() const;
 	const QString& GetBucketName() const;
 	const QList<QUrl> GetURLs() const;
+	// Only valid before the work item has started being prepared
+	void AppendURLs(const QList<QUrl>& urls);
 	QList<QUrl>::const_iterator& GetUrlsIterator();
 	const QList<QUrl>::const_iterator GetUrlsConstEnd() const;
 	const QUrl& GetLastProcessedUrl() const;
 	virtual const QString GetDestination() const = 0;
 	uint64_t GetSize() const;
 	uint64_t GetBytesTransferred() const;
+	// Called for every buffer curl reads or writes so it's lock-free.
+	// Client periodically snapshots the progress for the GUI rather than
+	// the transfer threads reporting it.
 	void UpdateBytesTransferred(size_t bytes);
 	size_t GetNumChunksProcessed() const;
-
-	// Used to throttle the number of job updates Client emits to prevent
-	// the main GUI thread from getting flooded with job update requests.
-	// This is probably only necessary during the Client::{Read,Write}File
-	// methods.
-	bool IsJobUpdateReady();
+	uint64_t GetNumFailedObjects() const;
+	void IncNumFailedObjects(uint64_t num = 1);
+	// Record that an object, or part of one, failed to transfer
+	virtual void MarkObjectFailed(const QString& objName,
+				      const QString& reason);
 
 	bool WasCanceled() const;
 	// A large drag/drop operation might have to be split up amonst
@@ -69,7 +77,7 @@ public:
 	bool IsPageFinished() const;
 	// Signifies whether or not the entire work item as a whole is finished.
 	// In other words, if an entire drag/drop operation is complete.
-	bool IsFinished() const;
+	virtual bool IsFinished() const;
 
 	void SetBucketName(const QString& bucketName);
 	void SetLastProcessedUrl(const QUrl& url);
@@ -82,33 +90,69 @@ public:
 	uint64_t GetObjMapSize() const;
 	const QString GetObjMapValue(const QString& objName) const;
 	void InsertObjMap(const QString& objName, const QString& filePath);
+	// Object sizes that are known before the bulk request is made (e.g.
+	// from a get bucket listing)
+	bool GetObjSize(const QString& objName, uint64_t* size) const;
+	void SetObjSize(const QString& objName, uint64_t size);
+
+	// The include/exclude rules that objects or files found under a
+	// selected folder are checked against
+	const TransferFilter& GetFilter() const;
+	void SetFilter(const TransferFilter& filter);
+
+	// The size reported by GetSize when the work item bypasses DS3
+	// bulk jobs and thus has no bulk response to take the size from
+	void SetPlannedSize(uint64_t size);
 
 	ds3_bulk_response* GetResponse() const;
 	void SetResponse(ds3_bulk_response* response);
 
+	// The work item takes ownership of the controller
+	ConcurrencyController* GetConcurrencyController() const;
+	void SetConcurrencyController(ConcurrencyController* controller);
+
 	void SetState(Job::State state);
 
+	// See Job::GetSessionID
+	const QUuid& GetSessionID() const;
+	void SetSessionID(const QUuid& sessionID);
+
+	// How TransferScheduler weighs the job against the others queued.
+	// Only takes effect if set before the job is submitted.
+	TransferScheduler::Priority GetPriority() const;
+	void SetPriority(TransferScheduler::Priority priority);
+
+	// Record how long a chunk waited on the server
+	void AddChunkWait(int seconds);
+
 	const Job ToJob() const;
+	// ToJob without the URLs, for the periodic progress updates of a job
+	// that's already been reported
+	const Job ToProgressJob() const;
 
 protected:
 	void SortURLsByBucket();
 
-	Job::State m_state;
-	mutable QMutex m_stateLock;
+	QAtomicInt m_state;
 	QString m_host;
 	QString m_bucketName;
 	QList<QUrl> m_urls;
 	QUrl m_lastProcessedUrl;
 	QList<QUrl>::const_iterator m_urlsIterator;
-	uint64_t m_bytesTransferred;
-	mutable QMutex m_bytesTransferredLock;
-	// Used to throttle the number of job updates Client emits to prevent
-	// the main GUI thread from getting flooded with job update requests.
-	uint64_t m_bytesTransferredSinceLastJobUpdate;
+	QAtomicInteger<quint64> m_bytesTransferred;
+	QAtomicInteger<quint64> m_numFailedObjects;
 	QHash<QString, QString> m_objMap;
+	QHash<QString, uint64_t> m_objSizes;
+	uint64_t m_plannedSize;
+	TransferFilter m_filter;
 	ds3_bulk_response* m_response;
 	mutable QMutex m_responseLock;
 	size_t m_numChunksProcessed;
+	ConcurrencyController* m_concurrencyController;
+	TransferScheduler::Priority m_priority;
+	QUuid m_sessionID;
+	Job::ChunkWaits m_chunkWaits;
+	mutable QMutex m_chunkWaitsLock;
 };
 
 inline const QString&
@@ -196,6 +240,7 @@ inline void
 BulkWorkItem::ClearObjMap()
 {
 	m_objMap.clear();
+	m_objSizes.clear();
 }
 
 inline QHash<QString,QString>::const_iterator
@@ -228,13 +273,96 @@ BulkWorkItem::InsertObjMap(const QString& objName, const QString& filePath)
 	m_objMap.insert(objName, filePath);
 }
 
+inline bool
+BulkWorkItem::GetObjSize(const QString& objName, uint64_t* size) const
+{
+	QHash<QString, uint64_t>::const_iterator i = m_objSizes.constFind(objName);
+	if (i == m_objSizes.constEnd()) {
+		return false;
+	}
+	*size = i.value();
+	return true;
+}
+
+inline void
+BulkWorkItem::SetObjSize(const QString& objName, uint64_t size)
+{
+	m_objSizes.insert(objName, size);
+}
+
+inline const TransferFilter&
+BulkWorkItem::GetFilter() const
+{
+	return m_filter;
+}
+
+inline void
+BulkWorkItem::SetFilter(const TransferFilter& filter)
+{
+	m_filter = filter;
+}
+
+inline void
+BulkWorkItem::SetPlannedSize(uint64_t size)
+{
+	m_plannedSize = size;
+}
+
 inline Job::State
 BulkWorkItem::GetState() const
 {
-	m_stateLock.lock();
-	Job::State state = m_state;
-	m_stateLock.unlock();
-	return state;
+	return static_cast<Job::State>(m_state.loadAcquire());
+}
+
+inline uint64_t
+BulkWorkItem::GetBytesTransferred() const
+{
+	return m_bytesTransferred.loadAcquire();
+}
+
+inline void
+BulkWorkItem::UpdateBytesTransferred(size_t bytes)
+{
+	m_bytesTransferred.fetchAndAddRelaxed(bytes);
+}
+
+inline uint64_t
+BulkWorkItem::GetNumFailedObjects() const
+{
+	return m_numFailedObjects.loadAcquire();
+}
+
+inline void
+BulkWorkItem::IncNumFailedObjects(uint64_t num)
+{
+	m_numFailedObjects.fetchAndAddRelaxed(num);
+}
+
+inline void
+BulkWorkItem::MarkObjectFailed(const QString& /*objName*/,
+			       const QString& /*reason*/)
+{
+	IncNumFailedObjects();
+}
+
+inline const QUuid&
+BulkWorkItem::GetSessionID() const
+{
+	return m_sessionID;
+}
+
+inline void
+BulkWorkItem::SetSessionID(const QUuid& sessionID)
+{
+	m_sessionID = sessionID;
+}
+
+inline void
+BulkWorkItem::AddChunkWait(int seconds)
+{
+	m_chunkWaitsLock.lock();
+	m_chunkWaits.Add(seconds);
+	m_chunkWaitsLock.unlock();
 }
 
 inline ds3_bulk_response*
@@ -254,12 +382,28 @@ BulkWorkItem::SetResponse(ds3_bulk_response* response)
 	m_responseLock.unlock();
 }
 
+inline ConcurrencyController*
+BulkWorkItem::GetConcurrencyController() const
+{
+	return m_concurrencyController;
+}
+
 inline void
 BulkWorkItem::SetState(Job::State state)
 {
-	m_stateLock.lock();
-	m_state = state;
-	m_stateLock.unlock();
+	m_state.storeRelease(state);
+}
+
+inline TransferScheduler::Priority
+BulkWorkItem::GetPriority() const
+{
+	return m_priority;
+}
+
+inline void
+BulkWorkItem::SetPriority(TransferScheduler::Priority priority)
+{
+	m_priority = priority;
 }
 
 #endif
@@ -0,0 +1,61 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include "lib/work_items/delete_work_item.h"
+
+// The most keys a DS3 delete objects request accepts
+const int DeleteWorkItem::BATCH_SIZE = 1000;
+
+DeleteWorkItem::DeleteWorkItem(const QString& host,
+			       const QList<QUrl> urls,
+			       bool deleteBucket)
+	: BulkWorkItem(host, urls),
+	  m_deleteBucket(deleteBucket),
+	  m_listingFailed(false),
+	  m_batchSize(0)
+{
+}
+
+void
+DeleteWorkItem::AddListedSize(uint64_t size)
+{
+	SetPlannedSize(GetSize() + size);
+}
+
+void
+DeleteWorkItem::MarkListingFailed()
+{
+	m_listingFailed = true;
+	IncNumFailedObjects();
+}
+
+bool
+DeleteWorkItem::AddToBatch(const QString& objName, uint64_t size)
+{
+	m_batch << objName;
+	m_batchSize += size;
+	return m_batch.size() >= BATCH_SIZE;
+}
+
+QStringList
+DeleteWorkItem::TakeBatch(uint64_t* size)
+{
+	QStringList batch = m_batch;
+	*size = m_batchSize;
+	m_batch.clear();
+	m_batchSize = 0;
+	return batch;
+}
@@ -0,0 +1,91 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef DELETE_WORK_ITEM_H
+#define DELETE_WORK_ITEM_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+
+#include "lib/work_items/bulk_work_item.h"
+
+// DeleteWorkItem, deletes every object under a bucket or folders, and any
+// individual objects, in the background.  The listing is read a page at a
+// time and the objects deleted in DS3 delete objects requests of up to
+// BATCH_SIZE objects, several of which are sent at once.  The job's size is
+// the size of the objects listed so far.  A folder that can't be listed
+// fails the job, rather than canceling it, and keeps the bucket from being
+// deleted.
+class DeleteWorkItem : public BulkWorkItem
+{
+public:
+	// urls must all be in the same bucket.  If deleteBucket is set, the
+	// bucket is deleted once everything in it has been.
+	DeleteWorkItem(const QString& host,
+		       const QList<QUrl> urls,
+		       bool deleteBucket);
+
+	static const int BATCH_SIZE;
+
+	const QString GetDestination() const;
+	Job::Type GetType() const;
+	bool ShouldDeleteBucket() const;
+
+	// Only called by the thread reading the listing
+	void AddListedSize(uint64_t size);
+	void MarkListingFailed();
+	// Add an object to the batch being built.  Returns true once the
+	// batch is full and should be taken.
+	bool AddToBatch(const QString& objName, uint64_t size);
+	bool IsBatchEmpty() const;
+	// Hand over the batch, and the total size of its objects, and start
+	// a new one
+	QStringList TakeBatch(uint64_t* size);
+
+private:
+	bool m_deleteBucket;
+	bool m_listingFailed;
+	QStringList m_batch;
+	uint64_t m_batchSize;
+};
+
+inline const QString
+DeleteWorkItem::GetDestination() const
+{
+	return QString();
+}
+
+inline Job::Type
+DeleteWorkItem::GetType() const
+{
+	return Job::DELETE_OBJECTS;
+}
+
+inline bool
+DeleteWorkItem::ShouldDeleteBucket() const
+{
+	return m_deleteBucket && !m_listingFailed;
+}
+
+inline bool
+DeleteWorkItem::IsBatchEmpty() const
+{
+	return m_batch.isEmpty();
+}
+
+#endif
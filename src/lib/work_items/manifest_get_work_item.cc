@@ -0,0 +1,120 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include "lib/work_items/manifest_get_work_item.h"
+
+ManifestGetWorkItem::ManifestGetWorkItem(const QString& host,
+					 const QString& manifestPath,
+					 const QString& destination,
+					 const QString& reportPath)
+	: BulkGetWorkItem(host, QList<QUrl>(), destination),
+	  m_manifestPath(manifestPath),
+	  m_reportPath(reportPath),
+	  m_manifestFile(manifestPath),
+	  m_reader(NULL),
+	  m_hasPutBack(false),
+	  m_reportFile(reportPath)
+{
+}
+
+ManifestGetWorkItem::~ManifestGetWorkItem()
+{
+	delete m_reader;
+	m_report.flush();
+}
+
+bool
+ManifestGetWorkItem::Open(QString* error)
+{
+	if (!m_manifestFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
+		*error = "Unable to read " + m_manifestPath + ", " +
+			 m_manifestFile.errorString();
+		return false;
+	}
+	if (!m_reportFile.open(QIODevice::WriteOnly | QIODevice::Truncate |
+			       QIODevice::Text)) {
+		*error = "Unable to write " + m_reportPath + ", " +
+			 m_reportFile.errorString();
+		return false;
+	}
+	m_reader = new ManifestReader(&m_manifestFile,
+				      ManifestReader::FormatFromFileName(m_manifestPath));
+	m_report.setDevice(&m_reportFile);
+	m_report.setCodec("UTF-8");
+	m_report << "line,status,bucket,object,destination,message" << endl;
+	return true;
+}
+
+bool
+ManifestGetWorkItem::IsFinished() const
+{
+	return (IsPageFinished() && !m_hasPutBack && m_reader->AtEnd());
+}
+
+bool
+ManifestGetWorkItem::ReadEntry(ManifestEntry* entry)
+{
+	if (m_hasPutBack) {
+		*entry = m_putBack;
+		m_hasPutBack = false;
+		return true;
+	}
+	return m_reader->ReadEntry(entry);
+}
+
+void
+ManifestGetWorkItem::MarkObjectFailed(const QString& objName,
+				      const QString& reason)
+{
+	BulkGetWorkItem::MarkObjectFailed(objName, reason);
+	m_pageFailuresLock.lock();
+	m_pageFailures.insert(objName, reason);
+	m_pageFailuresLock.unlock();
+}
+
+void
+ManifestGetWorkItem::FinishPage()
+{
+	QString unfailedStatus = WasCanceled() ? "canceled" : "ok";
+	m_pageFailuresLock.lock();
+	QHash<QString, ManifestEntry>::const_iterator ei;
+	for (ei = m_pageEntries.constBegin(); ei != m_pageEntries.constEnd(); ei++) {
+		QHash<QString, QString>::const_iterator fi;
+		fi = m_pageFailures.constFind(ei.key());
+		if (fi != m_pageFailures.constEnd()) {
+			Report(ei.value(), "failed", fi.value());
+		} else {
+			Report(ei.value(), unfailedStatus);
+		}
+	}
+	m_pageFailures.clear();
+	m_pageFailuresLock.unlock();
+	m_pageEntries.clear();
+	// Flushed once per page so the report can be followed while the
+	// job is running
+	m_report.flush();
+}
+
+void
+ManifestGetWorkItem::Report(const ManifestEntry& entry, const QString& status,
+			    const QString& message)
+{
+	m_report << entry.line << "," << status << ","
+		 << ManifestReader::QuoteCSV(entry.bucket) << ","
+		 << ManifestReader::QuoteCSV(entry.object) << ","
+		 << ManifestReader::QuoteCSV(entry.destination) << ","
+		 << ManifestReader::QuoteCSV(message) << "\n";
+}
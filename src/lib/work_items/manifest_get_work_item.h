@@ -0,0 +1,115 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef MANIFEST_GET_WORK_ITEM_H
+#define MANIFEST_GET_WORK_ITEM_H
+
+#include <QFile>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QTextStream>
+
+#include "lib/manifest_reader.h"
+#include "lib/work_items/bulk_get_work_item.h"
+
+// ManifestGetWorkItem, a bulk GET of the objects listed in a restore
+// manifest rather than of dragged DS3URLs.  The manifest is read one
+// page at a time as the job progresses and the outcome of every entry is
+// appended to a CSV report:
+//
+//   line,status,bucket,object,destination,message
+//
+// where status is one of ok, failed, skipped, invalid or canceled.  Entries
+// are reported as their page finishes so the report's lines aren't in
+// manifest order.  Entries that were never read because the job was
+// canceled aren't reported.
+class ManifestGetWorkItem : public BulkGetWorkItem
+{
+public:
+	ManifestGetWorkItem(const QString& host,
+			    const QString& manifestPath,
+			    const QString& destination,
+			    const QString& reportPath);
+	~ManifestGetWorkItem();
+
+	// Open the manifest and create the report.  Returns false and sets
+	// error if either can't be.
+	bool Open(QString* error);
+
+	bool HasManifest() const;
+	bool IsFinished() const;
+
+	// The next manifest entry, including one that was put back
+	bool ReadEntry(ManifestEntry* entry);
+	// Save an entry that didn't fit in the current page for the next one
+	void PutBack(const ManifestEntry& entry);
+
+	// Entries in the page currently being prepared/transferred, keyed by
+	// object name since a bulk GET can only include an object once
+	void AddPageEntry(const ManifestEntry& entry);
+	bool PageHasObject(const QString& objName) const;
+	void MarkObjectFailed(const QString& objName, const QString& reason);
+	// Report every entry of the current page and start a new one
+	void FinishPage();
+
+	void Report(const ManifestEntry& entry, const QString& status,
+		    const QString& message = QString());
+
+private:
+	QString m_manifestPath;
+	QString m_reportPath;
+	QFile m_manifestFile;
+	ManifestReader* m_reader;
+	ManifestEntry m_putBack;
+	bool m_hasPutBack;
+
+	QFile m_reportFile;
+	QTextStream m_report;
+
+	QHash<QString, ManifestEntry> m_pageEntries;
+	// Objects that failed in the current page and why.  Written to from
+	// the transfer threads.
+	QHash<QString, QString> m_pageFailures;
+	QMutex m_pageFailuresLock;
+};
+
+inline bool
+ManifestGetWorkItem::HasManifest() const
+{
+	return true;
+}
+
+inline void
+ManifestGetWorkItem::PutBack(const ManifestEntry& entry)
+{
+	m_putBack = entry;
+	m_hasPutBack = true;
+}
+
+inline void
+ManifestGetWorkItem::AddPageEntry(const ManifestEntry& entry)
+{
+	m_pageEntries.insert(entry.object, entry);
+}
+
+inline bool
+ManifestGetWorkItem::PageHasObject(const QString& objName) const
+{
+	return m_pageEntries.contains(objName);
+}
+
+#endif
@@ -0,0 +1,109 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include "lib/work_items/migration_work_item.h"
+
+MigrationWorkItem::MigrationWorkItem(const QString& host,
+				     Client* source,
+				     const QList<QUrl> urls,
+				     const QString& bucketName,
+				     const QString& prefix)
+	: BulkPutWorkItem(host, urls, bucketName, prefix),
+	  m_source(source),
+	  m_getBucketResponse(NULL),
+	  m_getBucketResponseIterator(0),
+	  m_sourceResponse(NULL),
+	  m_nextSourcePoll(0)
+{
+}
+
+MigrationWorkItem::~MigrationWorkItem()
+{
+	if (m_getBucketResponse != NULL) {
+		ds3_free_bucket_response(m_getBucketResponse);
+	}
+	if (m_sourceResponse != NULL) {
+		ds3_free_bulk_response(m_sourceResponse);
+	}
+}
+
+void
+MigrationWorkItem::SetGetBucketResponse(ds3_get_bucket_response* response)
+{
+	if (m_getBucketResponse != response && m_getBucketResponse != NULL) {
+		ds3_free_bucket_response(m_getBucketResponse);
+	}
+	m_getBucketResponse = response;
+}
+
+const QString
+MigrationWorkItem::GetSourceJobID() const
+{
+	QString jobID;
+	if (m_sourceResponse != NULL) {
+		jobID = QString(m_sourceResponse->job_id->value);
+	}
+	return jobID;
+}
+
+// Index the new page's source blobs by object so the blobs that hold a
+// range of the object can be found without searching every chunk
+void
+MigrationWorkItem::SetSourceResponse(ds3_bulk_response* response)
+{
+	if (m_sourceResponse != NULL) {
+		ds3_free_bulk_response(m_sourceResponse);
+	}
+	m_sourceResponse = response;
+	m_sourceBlobs.clear();
+	m_sourceChunksLock.lock();
+	m_sourceChunksAvailable.clear();
+	m_sourceChunksLock.unlock();
+	m_sourcePollLock.lock();
+	m_nextSourcePoll = 0;
+	m_sourcePollLock.unlock();
+	if (response == NULL) {
+		return;
+	}
+
+	for (size_t chunk = 0; chunk < response->list_size; chunk++) {
+		ds3_bulk_object_list* list = response->list[chunk];
+		for (uint64_t i = 0; i < list->size; i++) {
+			ds3_bulk_object* bulkObj = &(list->list[i]);
+			SourceBlob blob;
+			blob.offset = bulkObj->offset;
+			blob.length = bulkObj->length;
+			blob.chunkNumber = list->chunk_number;
+			m_sourceBlobs[QString::fromUtf8(bulkObj->name->value)] << blob;
+		}
+	}
+}
+
+int
+MigrationWorkItem::AddSourceChunksAvailable(const ds3_bulk_response* chunks)
+{
+	int numAdded = 0;
+	m_sourceChunksLock.lock();
+	for (size_t chunk = 0; chunk < chunks->list_size; chunk++) {
+		uint64_t chunkNumber = chunks->list[chunk]->chunk_number;
+		if (!m_sourceChunksAvailable.contains(chunkNumber)) {
+			m_sourceChunksAvailable.insert(chunkNumber);
+			numAdded++;
+		}
+	}
+	m_sourceChunksLock.unlock();
+	return numAdded;
+}
@@ -0,0 +1,176 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef MIGRATION_WORK_ITEM_H
+#define MIGRATION_WORK_ITEM_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QUrl>
+
+#include <ds3.h>
+
+#include "lib/work_items/bulk_put_work_item.h"
+
+class Client;
+
+// MigrationWorkItem, a bulk PUT whose data comes from objects on another
+// DS3 system (the source) instead of local files.  Each page is both a
+// DS3 bulk GET job on the source and a bulk PUT job on this work item's
+// system (the target).  Object data is streamed from the source's GETs
+// straight into the target's PUTs.
+//
+// The object map is keyed by target object name like any BulkPutWorkItem
+// but its values are the source object names.
+class MigrationWorkItem : public BulkPutWorkItem
+{
+public:
+	// A blob of a source object as allocated by the source's bulk GET
+	struct SourceBlob
+	{
+		uint64_t offset;
+		uint64_t length;
+		uint64_t chunkNumber;
+	};
+
+	MigrationWorkItem(const QString& host,
+			  Client* source,
+			  const QList<QUrl> urls,
+			  const QString& bucketName,
+			  const QString& prefix);
+	~MigrationWorkItem();
+
+	bool IsMigration() const;
+	Client* GetSource() const;
+	const QString& GetSourceBucketName() const;
+	void SetSourceBucketName(const QString& bucketName);
+
+	// See BulkGetWorkItem
+	ds3_get_bucket_response* GetGetBucketResponse() const;
+	size_t GetGetBucketResponseIterator() const;
+	void SetGetBucketResponse(ds3_get_bucket_response* response);
+	void SetGetBucketResponseIterator(size_t i);
+
+	// The source bulk GET job of the current page.  The work item takes
+	// ownership of the response.
+	const QString GetSourceJobID() const;
+	void SetSourceResponse(ds3_bulk_response* response);
+	const QList<SourceBlob> GetSourceBlobs(const QString& objName) const;
+
+	// Source chunks that the source has staged and that can thus be
+	// GETed.  Only one thread at a time should ask the source for more
+	// by holding the poll lock, and not before the next poll time (in
+	// msecs since the epoch), which is also guarded by the poll lock.
+	// The lock isn't meant to be held while waiting for that time.
+	bool IsSourceChunkAvailable(uint64_t chunkNumber) const;
+	int AddSourceChunksAvailable(const ds3_bulk_response* chunks);
+	QMutex* GetSourcePollLock();
+	qint64 GetNextSourcePoll() const;
+	void SetNextSourcePoll(qint64 msecsSinceEpoch);
+
+private:
+	Client* m_source;
+	QString m_sourceBucketName;
+	ds3_get_bucket_response* m_getBucketResponse;
+	size_t m_getBucketResponseIterator;
+
+	ds3_bulk_response* m_sourceResponse;
+	QHash<QString, QList<SourceBlob> > m_sourceBlobs;
+	QSet<uint64_t> m_sourceChunksAvailable;
+	mutable QMutex m_sourceChunksLock;
+	QMutex m_sourcePollLock;
+	qint64 m_nextSourcePoll;
+};
+
+inline bool
+MigrationWorkItem::IsMigration() const
+{
+	return true;
+}
+
+inline Client*
+MigrationWorkItem::GetSource() const
+{
+	return m_source;
+}
+
+inline const QString&
+MigrationWorkItem::GetSourceBucketName() const
+{
+	return m_sourceBucketName;
+}
+
+inline void
+MigrationWorkItem::SetSourceBucketName(const QString& bucketName)
+{
+	m_sourceBucketName = bucketName;
+}
+
+inline ds3_get_bucket_response*
+MigrationWorkItem::GetGetBucketResponse() const
+{
+	return m_getBucketResponse;
+}
+
+inline size_t
+MigrationWorkItem::GetGetBucketResponseIterator() const
+{
+	return m_getBucketResponseIterator;
+}
+
+inline void
+MigrationWorkItem::SetGetBucketResponseIterator(size_t i)
+{
+	m_getBucketResponseIterator = i;
+}
+
+inline const QList<MigrationWorkItem::SourceBlob>
+MigrationWorkItem::GetSourceBlobs(const QString& objName) const
+{
+	return m_sourceBlobs.value(objName);
+}
+
+inline bool
+MigrationWorkItem::IsSourceChunkAvailable(uint64_t chunkNumber) const
+{
+	m_sourceChunksLock.lock();
+	bool available = m_sourceChunksAvailable.contains(chunkNumber);
+	m_sourceChunksLock.unlock();
+	return available;
+}
+
+inline QMutex*
+MigrationWorkItem::GetSourcePollLock()
+{
+	return &m_sourcePollLock;
+}
+
+inline qint64
+MigrationWorkItem::GetNextSourcePoll() const
+{
+	return m_nextSourcePoll;
+}
+
+inline void
+MigrationWorkItem::SetNextSourcePoll(qint64 msecsSinceEpoch)
+{
+	m_nextSourcePoll = msecsSinceEpoch;
+}
+
+#endif
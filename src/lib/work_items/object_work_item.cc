@@ -25,6 +25,19 @@ ObjectWorkItem::ObjectWorkItem(const QString& bucketName,
 	  m_bucketName(bucketName),
 	  m_objectName(objectName),
 	  m_file(fileName),
+	  m_device(&m_file),
+	  m_bulkWorkItem(bulkWorkItem)
+{
+}
+
+ObjectWorkItem::ObjectWorkItem(const QString& bucketName,
+			       const QString& objectName,
+			       QIODevice* device,
+			       BulkWorkItem* bulkWorkItem)
+	: WorkItem(),
+	  m_bucketName(bucketName),
+	  m_objectName(objectName),
+	  m_device(device),
 	  m_bulkWorkItem(bulkWorkItem)
 {
 }
@@ -37,7 +50,7 @@ ObjectWorkItem::~ObjectWorkItem()
 size_t
 ObjectWorkItem::ReadFile(char* data, size_t size, size_t count)
 {
-	size_t bytesRead = m_file.read(data, size * count);
+	size_t bytesRead = m_device->read(data, size * count);
 	if (m_bulkWorkItem != NULL) {
 		m_bulkWorkItem->UpdateBytesTransferred(bytesRead);
 	}
@@ -47,7 +60,7 @@ ObjectWorkItem::ReadFile(char* data, size_t size, size_t count)
 size_t
 ObjectWorkItem::WriteFile(char* data, size_t size, size_t count)
 {
-	size_t bytesWritten = m_file.write(data, size * count);
+	size_t bytesWritten = m_device->write(data, size * count);
 	if (m_bulkWorkItem != NULL) {
 		m_bulkWorkItem->UpdateBytesTransferred(bytesWritten);
 	}
@@ -28,7 +28,8 @@ class BulkWorkItem;
 // ObjectWorkItem, a container class used to pass information about a
 // GET/PUT object request to the methods that actually read/write the
 // files.  This allows those file read/write callback functions to do things
-// like send out progress updates.
+// like send out progress updates.  The data can also be read from/written
+// to any other QIODevice (e.g. an archive entry).
 class ObjectWorkItem : public WorkItem
 {
 public:
@@ -36,11 +37,17 @@ public:
 		       const QString& objectName,
 		       const QString& fileName,
 		       BulkWorkItem* bulkWorkItem = NULL);
+	// device must already be open, positioned and outlive the work item
+	ObjectWorkItem(const QString& bucketName,
+		       const QString& objectName,
+		       QIODevice* device,
+		       BulkWorkItem* bulkWorkItem = NULL);
 	~ObjectWorkItem();
 
 	const QString& GetBucketName() const;
 	const QString& GetObjectName() const;
 	QFile* GetFile();
+	QIODevice* GetDevice();
 	BulkWorkItem* GetBulkWorkItem() const;
 
 	bool OpenFile(QIODevice::OpenMode mode);
@@ -52,6 +59,8 @@ private:
 	QString m_bucketName;
 	QString m_objectName;
 	QFile m_file;
+	// m_file unless another device was given
+	QIODevice* m_device;
 	BulkWorkItem* m_bulkWorkItem;
 };
 
@@ -73,6 +82,12 @@ ObjectWorkItem::GetFile()
 	return &m_file;
 }
 
+inline QIODevice*
+ObjectWorkItem::GetDevice()
+{
+	return m_device;
+}
+
 inline BulkWorkItem*
 ObjectWorkItem::GetBulkWorkItem() const
 {
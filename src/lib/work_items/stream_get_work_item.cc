@@ -0,0 +1,36 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include "lib/work_items/stream_get_work_item.h"
+
+StreamGetWorkItem::StreamGetWorkItem(const QString& host,
+				     const QString& bucketName,
+				     const QString& objName,
+				     QIODevice* output,
+				     const QString& destination)
+	: BulkGetWorkItem(host, QList<QUrl>(), destination),
+	  m_output(output),
+	  m_objName(objName)
+{
+	m_bucketName = bucketName;
+}
+
+void
+StreamGetWorkItem::SetManifest(const StreamManifest& manifest)
+{
+	m_manifest = manifest;
+	SetPlannedSize(manifest.GetSize());
+}
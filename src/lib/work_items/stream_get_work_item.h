@@ -0,0 +1,79 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef STREAM_GET_WORK_ITEM_H
+#define STREAM_GET_WORK_ITEM_H
+
+#include <QIODevice>
+#include <QString>
+
+#include "lib/stream_manifest.h"
+#include "lib/work_items/bulk_get_work_item.h"
+
+// StreamGetWorkItem, a GET of an object uploaded by a StreamPutWorkItem.
+// The parts listed in its manifest are written to the output device in
+// order.
+class StreamGetWorkItem : public BulkGetWorkItem
+{
+public:
+	// output must already be open and outlive the work item.
+	// destination only describes it (e.g. a file name).
+	StreamGetWorkItem(const QString& host,
+			  const QString& bucketName,
+			  const QString& objName,
+			  QIODevice* output,
+			  const QString& destination);
+
+	bool HasStream() const;
+	QIODevice* GetOutput() const;
+	// The name of the manifest object
+	const QString& GetObjectName() const;
+
+	// Only valid once the manifest object has been read
+	const StreamManifest& GetManifest() const;
+	void SetManifest(const StreamManifest& manifest);
+
+private:
+	QIODevice* m_output;
+	QString m_objName;
+	StreamManifest m_manifest;
+};
+
+inline bool
+StreamGetWorkItem::HasStream() const
+{
+	return true;
+}
+
+inline QIODevice*
+StreamGetWorkItem::GetOutput() const
+{
+	return m_output;
+}
+
+inline const QString&
+StreamGetWorkItem::GetObjectName() const
+{
+	return m_objName;
+}
+
+inline const StreamManifest&
+StreamGetWorkItem::GetManifest() const
+{
+	return m_manifest;
+}
+
+#endif
@@ -0,0 +1,37 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include "lib/work_items/stream_put_work_item.h"
+
+StreamPutWorkItem::StreamPutWorkItem(const QString& host,
+				     QIODevice* input,
+				     const QString& bucketName,
+				     const QString& objName,
+				     uint64_t partSize)
+	: BulkPutWorkItem(host, QList<QUrl>(), bucketName, objName),
+	  m_input(input),
+	  m_objName(objName),
+	  m_partSize(partSize)
+{
+}
+
+void
+StreamPutWorkItem::AppendPart(uint64_t size)
+{
+	m_manifest.AppendPart(size);
+	// The job's size grows as the input is read
+	SetPlannedSize(m_manifest.GetSize());
+}
@@ -0,0 +1,87 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef STREAM_PUT_WORK_ITEM_H
+#define STREAM_PUT_WORK_ITEM_H
+
+#include <QIODevice>
+#include <QString>
+
+#include "lib/stream_manifest.h"
+#include "lib/work_items/bulk_put_work_item.h"
+
+// StreamPutWorkItem, a PUT of data read from a device, such as stdin, whose
+// length isn't known until it ends.  Since a DS3 bulk PUT needs every
+// object's length up front, the data is cut in to parts that are PUT as
+// individual objects followed by a StreamManifest object.
+class StreamPutWorkItem : public BulkPutWorkItem
+{
+public:
+	// input must already be open and outlive the work item
+	StreamPutWorkItem(const QString& host,
+			  QIODevice* input,
+			  const QString& bucketName,
+			  const QString& objName,
+			  uint64_t partSize);
+
+	bool IsStream() const;
+	QIODevice* GetInput() const;
+	// The name of the manifest object
+	const QString& GetObjectName() const;
+	uint64_t GetPartSize() const;
+
+	// Only accessed by the thread reading the input
+	const StreamManifest& GetManifest() const;
+	void AppendPart(uint64_t size);
+
+private:
+	QIODevice* m_input;
+	QString m_objName;
+	uint64_t m_partSize;
+	StreamManifest m_manifest;
+};
+
+inline bool
+StreamPutWorkItem::IsStream() const
+{
+	return true;
+}
+
+inline QIODevice*
+StreamPutWorkItem::GetInput() const
+{
+	return m_input;
+}
+
+inline const QString&
+StreamPutWorkItem::GetObjectName() const
+{
+	return m_objName;
+}
+
+inline uint64_t
+StreamPutWorkItem::GetPartSize() const
+{
+	return m_partSize;
+}
+
+inline const StreamManifest&
+StreamPutWorkItem::GetManifest() const
+{
+	return m_manifest;
+}
+
+#endif
@@ -20,10 +20,14 @@
 #include <QMessageBox>
 #include <QMenuBar>
 #include <QSettings>
+#include <QTabBar>
 #include <QThreadPool>
 
 #include "global.h"
+#include "lib/client.h"
+#include "lib/concurrency_controller.h"
 #include "lib/logger.h"
+#include "lib/transfer_scheduler.h"
 #include "main_window.h"
 #include "models/session.h"
 #include "views/console.h"
@@ -41,6 +45,9 @@ MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags flags)
 	setWindowTitle(SL_APP_NAME);
 
 	setCentralWidget(m_sessionTabs);
+	// Hovering a drag over a session's tab switches to it so objects can
+	// be dropped on another session's DS3 browser to migrate them
+	m_sessionTabs->tabBar()->setChangeCurrentOnDrag(true);
 
 	m_jobsDock = new QDockWidget("Jobs", this);
 	m_jobsDock->setObjectName("jobs dock");
@@ -181,6 +188,8 @@ MainWindow::Settings()
 	CreateLoggingPage();
 	const QString& logName = "Logging";
 	m_tabs->addTab(m_logging, logName);
+	CreateTransfersPage();
+	m_tabs->addTab(m_transfers, "Transfers");
 	m_tabs->setWindowModality(Qt::WindowModal);
 	m_tabs->setFixedHeight(m_tabs->sizeHint().height());
 	m_tabs->setFixedWidth(m_tabs->sizeHint().width()+100);
@@ -265,6 +274,137 @@ MainWindow::CreateLoggingPage()
 	ChangedEnabled(loggingEnabled);
 }
 
+void
+MainWindow::CreateTransfersPage()
+{
+	QSettings settings;
+	int minConcurrency = settings.value("transfers/minConcurrency",
+					    ConcurrencyController::DEFAULT_MIN).toInt();
+	int maxConcurrency = settings.value("transfers/maxConcurrency",
+					    ConcurrencyController::DEFAULT_MAX).toInt();
+	int maxActiveJobs = settings.value("transfers/maxActiveJobs",
+					   TransferScheduler::DEFAULT_MAX_ACTIVE_JOBS).toInt();
+	int maxActiveJobsPerHost = settings.value("transfers/maxActiveJobsPerHost",
+						  TransferScheduler::DEFAULT_MAX_ACTIVE_JOBS_PER_HOST).toInt();
+	bool splitBySize = settings.value("transfers/splitBySize", false).toBool();
+	uint64_t largeObjectThreshold = settings.value("transfers/largeObjectThreshold",
+						       (qulonglong)Client::LARGE_OBJECT_THRESHOLD).toULongLong();
+	QString chunkOrdering = settings.value("transfers/chunkOrdering", "none").toString();
+	QString filterInclude = settings.value("transfers/filterInclude").toString();
+	QString filterExclude = settings.value("transfers/filterExclude").toString();
+	bool expandZips = settings.value("transfers/expandZips", false).toBool();
+	bool useDaemon = settings.value("transfers/useDaemon", false).toBool();
+
+	m_transfers = new QWidget;
+	m_minConcurrencyInput = new QSpinBox;
+	m_maxConcurrencyInput = new QSpinBox;
+	m_maxActiveJobsInput = new QSpinBox;
+	m_maxActiveJobsPerHostInput = new QSpinBox;
+	m_splitBySizeBox = new QCheckBox;
+	m_largeObjectThresholdInput = new QSpinBox;
+	m_chunkOrderingInput = new QComboBox;
+	m_filterIncludeInput = new QLineEdit;
+	m_filterExcludeInput = new QLineEdit;
+	m_expandZipsBox = new QCheckBox;
+	m_useDaemonBox = new QCheckBox;
+	QPushButton* apply = new QPushButton;
+	QDialogButtonBox* buttons = new QDialogButtonBox;
+	QGridLayout* layout = new QGridLayout(m_transfers);
+
+	QString tip = "The number of objects a job transfers at once is " \
+		      "adjusted automatically, based on the measured " \
+		      "throughput, within these limits";
+	m_minConcurrencyInput->setRange(1, ConcurrencyController::MAX_LIMIT);
+	m_minConcurrencyInput->setValue(minConcurrency);
+	m_minConcurrencyInput->setToolTip(tip);
+	m_maxConcurrencyInput->setRange(1, ConcurrencyController::MAX_LIMIT);
+	m_maxConcurrencyInput->setValue(maxConcurrency);
+	m_maxConcurrencyInput->setToolTip(tip);
+
+	tip = "Jobs beyond these limits wait in the queue until a " \
+	      "running job finishes";
+	m_maxActiveJobsInput->setRange(1, 100);
+	m_maxActiveJobsInput->setValue(maxActiveJobs);
+	m_maxActiveJobsInput->setToolTip(tip);
+	m_maxActiveJobsPerHostInput->setRange(1, 100);
+	m_maxActiveJobsPerHostInput->setValue(maxActiveJobsPerHost);
+	m_maxActiveJobsPerHostInput->setToolTip(tip);
+
+	tip = "Files at least this large are uploaded in a separate job " \
+	      "that runs alongside the job for the remaining files";
+	m_splitBySizeBox->setText("Upload Large Files in a Separate Job");
+	m_splitBySizeBox->setChecked(splitBySize);
+	m_splitBySizeBox->setToolTip(tip);
+	m_largeObjectThresholdInput->setRange(1, 1024 * 1024);
+	m_largeObjectThresholdInput->setSuffix(" MiB");
+	m_largeObjectThresholdInput->setValue((int)(largeObjectThreshold / (1024 * 1024)));
+	m_largeObjectThresholdInput->setToolTip(tip);
+
+	m_chunkOrderingInput->addItem("None", "none");
+	m_chunkOrderingInput->addItem("In Order", "inOrder");
+	m_chunkOrderingInput->setCurrentIndex(m_chunkOrderingInput->findData(chunkOrdering));
+	m_chunkOrderingInput->setToolTip("In Order has the server stage a " \
+					 "download's chunks, and the " \
+					 "chunks transferred, in the same " \
+					 "order, which suits large " \
+					 "restores from tape");
+
+	tip = "Space separated patterns, e.g. *.dpx, that files found in " \
+	      "a dragged folder must match to be transferred";
+	m_filterIncludeInput->setText(filterInclude);
+	m_filterIncludeInput->setPlaceholderText("All Files");
+	m_filterIncludeInput->setToolTip(tip);
+	tip = "Space separated patterns, e.g. *.tmp .DS_Store, of files and " \
+	      "folders in a dragged folder that aren't transferred";
+	m_filterExcludeInput->setText(filterExclude);
+	m_filterExcludeInput->setToolTip(tip);
+
+	m_expandZipsBox->setText("Upload the Files in Zip Archives");
+	m_expandZipsBox->setChecked(expandZips);
+	m_expandZipsBox->setToolTip("Each file in an uploaded zip archive " \
+				    "becomes an object under a folder " \
+				    "named after the archive, without " \
+				    "extracting it to disk first");
+
+	m_useDaemonBox->setText("Keep Transfers Running After Quitting");
+	m_useDaemonBox->setChecked(useDaemon);
+	m_useDaemonBox->setToolTip("Jobs are run by a background transfer " \
+				   "service instead of this application.  " \
+				   "Takes effect for new sessions.");
+
+	apply->setText("Apply");
+	buttons->addButton("Cancel", QDialogButtonBox::RejectRole);
+	buttons->addButton(apply, QDialogButtonBox::ApplyRole);
+	connect(buttons, SIGNAL(rejected()), this, SLOT(ClosePreferences()));
+	connect(apply, SIGNAL(clicked(bool)), this, SLOT(ApplyChanges()));
+
+	layout->setContentsMargins (6, 6, 6, 6);
+	layout->setHorizontalSpacing(6);
+	layout->setVerticalSpacing(6);
+	layout->addWidget(new QLabel("Minimum Parallel Transfers:"), 1, 1, 1, 1, Qt::AlignRight);
+	layout->addWidget(m_minConcurrencyInput, 1, 2, 1, 1, Qt::AlignLeft);
+	layout->addWidget(new QLabel("Maximum Parallel Transfers:"), 2, 1, 1, 1, Qt::AlignRight);
+	layout->addWidget(m_maxConcurrencyInput, 2, 2, 1, 1, Qt::AlignLeft);
+	layout->addWidget(new QLabel("Maximum Active Jobs:"), 3, 1, 1, 1, Qt::AlignRight);
+	layout->addWidget(m_maxActiveJobsInput, 3, 2, 1, 1, Qt::AlignLeft);
+	layout->addWidget(new QLabel("Maximum Active Jobs per Host:"), 4, 1, 1, 1, Qt::AlignRight);
+	layout->addWidget(m_maxActiveJobsPerHostInput, 4, 2, 1, 1, Qt::AlignLeft);
+	layout->addWidget(m_splitBySizeBox, 5, 2, 1, 1, Qt::AlignLeft);
+	layout->addWidget(new QLabel("Large File Size:"), 6, 1, 1, 1, Qt::AlignRight);
+	layout->addWidget(m_largeObjectThresholdInput, 6, 2, 1, 1, Qt::AlignLeft);
+	layout->addWidget(new QLabel("Download Chunk Order:"), 7, 1, 1, 1, Qt::AlignRight);
+	layout->addWidget(m_chunkOrderingInput, 7, 2, 1, 1, Qt::AlignLeft);
+	layout->addWidget(new QLabel("Only Transfer Files Matching:"), 8, 1, 1, 1, Qt::AlignRight);
+	layout->addWidget(m_filterIncludeInput, 8, 2, 1, 1);
+	layout->addWidget(new QLabel("Skip Files Matching:"), 9, 1, 1, 1, Qt::AlignRight);
+	layout->addWidget(m_filterExcludeInput, 9, 2, 1, 1);
+	layout->addWidget(m_expandZipsBox, 10, 2, 1, 1, Qt::AlignLeft);
+	layout->addWidget(m_useDaemonBox, 11, 2, 1, 1, Qt::AlignLeft);
+	layout->setRowStretch(12, 1);
+	layout->addWidget(buttons, 13, 2, 1, 2, Qt::AlignRight);
+	m_transfers->setLayout(layout);
+}
+
 void
 MainWindow::ChooseLogFile()
 {
@@ -308,6 +448,24 @@ MainWindow::ApplyChanges()
 	if(m_logNumberLimit > 0) {
 		settings.setValue("mainWindow/logNumberLimit", m_logNumberLimit);
 	}
+	int minConcurrency = m_minConcurrencyInput->value();
+	int maxConcurrency = qMax(minConcurrency, m_maxConcurrencyInput->value());
+	settings.setValue("transfers/minConcurrency", minConcurrency);
+	settings.setValue("transfers/maxConcurrency", maxConcurrency);
+	settings.setValue("transfers/maxActiveJobs", m_maxActiveJobsInput->value());
+	settings.setValue("transfers/maxActiveJobsPerHost", m_maxActiveJobsPerHostInput->value());
+	settings.setValue("transfers/splitBySize", m_splitBySizeBox->isChecked());
+	settings.setValue("transfers/largeObjectThreshold",
+			  (qulonglong)m_largeObjectThresholdInput->value() * 1024 * 1024);
+	settings.setValue("transfers/chunkOrdering",
+			  m_chunkOrderingInput->currentData().toString());
+	settings.setValue("transfers/filterInclude",
+			  m_filterIncludeInput->text().simplified());
+	settings.setValue("transfers/filterExclude",
+			  m_filterExcludeInput->text().simplified());
+	settings.setValue("transfers/expandZips", m_expandZipsBox->isChecked());
+	settings.setValue("transfers/useDaemon", m_useDaemonBox->isChecked());
+	TransferScheduler::Instance()->ReadSettings();
 	ClosePreferences();
 }
 
@@ -28,6 +28,7 @@
 #include <QPushButton>
 #include <QTabWidget>
 #include <QScrollArea>
+#include <QSpinBox>
 
 #include <math.h>
 
@@ -62,6 +63,7 @@ private:
 	QString FormatFileSize();
 	double DeFormatFileSize();
 	void CreateLoggingPage();
+	void CreateTransfersPage();
 
 	QMenu* m_editMenu;
 	QMenu* m_helpMenu;
@@ -95,6 +97,18 @@ private:
 	double m_logFileSize;
 	QString m_logFileSizeSuffix;
 	int m_logNumberLimit;
+	QWidget* m_transfers;
+	QSpinBox* m_minConcurrencyInput;
+	QSpinBox* m_maxConcurrencyInput;
+	QSpinBox* m_maxActiveJobsInput;
+	QSpinBox* m_maxActiveJobsPerHostInput;
+	QCheckBox* m_splitBySizeBox;
+	QSpinBox* m_largeObjectThresholdInput;
+	QComboBox* m_chunkOrderingInput;
+	QLineEdit* m_filterIncludeInput;
+	QLineEdit* m_filterExcludeInput;
+	QCheckBox* m_expandZipsBox;
+	QCheckBox* m_useDaemonBox;
 
 private slots:
 	void About();
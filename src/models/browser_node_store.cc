@@ -0,0 +1,200 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include "models/browser_node_store.h"
+
+const BrowserNodeStore::ID BrowserNodeStore::ROOT = 0;
+const BrowserNodeStore::ID BrowserNodeStore::INVALID = 0xffffffff;
+const uint64_t BrowserNodeStore::NO_SIZE = UINT64_MAX;
+const qint64 BrowserNodeStore::NO_TIME = INT64_MIN;
+
+BrowserNodeStore::BrowserNodeStore()
+{
+	// String ID 0 is always the empty string
+	Intern(QString());
+	Allocate();
+	m_kinds[ROOT] = ROOT_NODE;
+	m_parents[ROOT] = INVALID;
+}
+
+BrowserNodeStore::ID
+BrowserNodeStore::Append(ID parent, Kind kind, const QString& name,
+			 const QString& bucketName, const QString& prefix,
+			 const QString& owner, uint64_t size, qint64 created)
+{
+	return Insert(parent, m_children[parent].size(), kind, name,
+		      bucketName, prefix, owner, size, created);
+}
+
+BrowserNodeStore::ID
+BrowserNodeStore::Insert(ID parent, int row, Kind kind, const QString& name,
+			 const QString& bucketName, const QString& prefix,
+			 const QString& owner, uint64_t size, qint64 created)
+{
+	ID node = Create(kind, name, bucketName, prefix, owner, size, created);
+	InsertChildren(parent, row, QVector<ID>(1, node));
+	return node;
+}
+
+BrowserNodeStore::ID
+BrowserNodeStore::Create(Kind kind, const QString& name,
+			 const QString& bucketName, const QString& prefix,
+			 const QString& owner, uint64_t size, qint64 created)
+{
+	ID node = Allocate();
+	m_parents[node] = INVALID;
+	m_kinds[node] = kind;
+	m_names[node] = name;
+	m_bucketNames[node] = Intern(bucketName);
+	m_prefixes[node] = Intern(prefix);
+	m_owners[node] = Intern(owner);
+	m_sizes[node] = size;
+	m_created[node] = created;
+	return node;
+}
+
+void
+BrowserNodeStore::InsertChildren(ID parent, int row, const QVector<ID>& nodes)
+{
+	if (nodes.isEmpty()) {
+		return;
+	}
+
+	QVector<ID>& children = m_children[parent];
+	row = qBound(0, row, children.size());
+	children.insert(row, nodes.size(), INVALID);
+	for (int i = 0; i < nodes.size(); i++) {
+		m_parents[nodes[i]] = parent;
+		children[row + i] = nodes[i];
+	}
+	for (int i = row; i < children.size(); i++) {
+		m_rows[children[i]] = i;
+	}
+}
+
+bool
+BrowserNodeStore::Update(ID node, const QString& owner, uint64_t size,
+			 qint64 created)
+{
+	uint32_t ownerID = Intern(owner);
+	if (m_owners[node] == ownerID && m_sizes[node] == size &&
+	    m_created[node] == created) {
+		return false;
+	}
+	m_owners[node] = ownerID;
+	m_sizes[node] = size;
+	m_created[node] = created;
+	return true;
+}
+
+void
+BrowserNodeStore::Remove(ID parent, int row, int count)
+{
+	QVector<ID>& children = m_children[parent];
+	if (row < 0 || count <= 0 || row + count > children.size()) {
+		return;
+	}
+
+	for (int i = row; i < row + count; i++) {
+		Free(children[i]);
+	}
+	children.remove(row, count);
+	for (int i = row; i < children.size(); i++) {
+		m_rows[children[i]] = i;
+	}
+}
+
+void
+BrowserNodeStore::SetNextMarker(ID node, const QString& nextMarker)
+{
+	if (nextMarker.isEmpty()) {
+		m_nextMarkers.remove(node);
+	} else {
+		m_nextMarkers.insert(node, nextMarker);
+	}
+}
+
+BrowserNodeStore::ID
+BrowserNodeStore::Allocate()
+{
+	if (!m_freeIDs.isEmpty()) {
+		ID node = m_freeIDs.last();
+		m_freeIDs.removeLast();
+		m_flags[node] = CAN_FETCH_MORE;
+		return node;
+	}
+
+	ID node = m_parents.size();
+	m_parents.append(INVALID);
+	m_rows.append(0);
+	m_kinds.append(FREE);
+	m_flags.append(CAN_FETCH_MORE);
+	m_bucketNames.append(0);
+	m_prefixes.append(0);
+	m_owners.append(0);
+	m_names.append(QString());
+	m_sizes.append(NO_SIZE);
+	m_created.append(NO_TIME);
+	m_children.append(QVector<ID>());
+	return node;
+}
+
+void
+BrowserNodeStore::Free(ID node)
+{
+	FreeChildren(node);
+	m_parents[node] = INVALID;
+	m_kinds[node] = FREE;
+	m_flags[node] = 0;
+	m_names[node] = QString();
+	m_nextMarkers.remove(node);
+	m_freeIDs.append(node);
+}
+
+void
+BrowserNodeStore::FreeChildren(ID node)
+{
+	// Swap the children out first so their memory is released rather
+	// than just cleared
+	QVector<ID> children;
+	children.swap(m_children[node]);
+	for (int i = 0; i < children.size(); i++) {
+		Free(children[i]);
+	}
+}
+
+uint32_t
+BrowserNodeStore::Intern(const QString& str)
+{
+	QHash<QString, uint32_t>::const_iterator i = m_stringIDs.constFind(str);
+	if (i != m_stringIDs.constEnd()) {
+		return i.value();
+	}
+	uint32_t id = m_strings.size();
+	m_strings.append(str);
+	m_stringIDs.insert(str, id);
+	return id;
+}
+
+void
+BrowserNodeStore::SetFlag(ID node, Flag flag, bool on)
+{
+	if (on) {
+		m_flags[node] |= flag;
+	} else {
+		m_flags[node] &= ~flag;
+	}
+}
@@ -0,0 +1,289 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef BROWSER_NODE_STORE_H
+#define BROWSER_NODE_STORE_H
+
+#include <stdint.h>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// BrowserNodeStore holds the rows of a DS3BrowserModel.  Rather than a
+// tree of heap allocated items, each field is kept in its own array
+// indexed by node ID, which is also what the model stores as its
+// QModelIndex internal ID.  Every node caches its row within its parent so
+// parent() doesn't have to search the parent's children.  The bucket name,
+// prefix and owner are the same for every object in a folder listing so
+// they're interned and each node only stores a string ID.  Sizes and
+// timestamps are stored as numbers and only formatted when displayed.
+//
+// The IDs of removed nodes are reused by later appends.  Node ROOT always
+// exists and is the parent of the bucket nodes.
+
+class BrowserNodeStore
+{
+public:
+	typedef uint32_t ID;
+
+	enum Kind {
+		ROOT_NODE,
+		BUCKET,
+		FOLDER,
+		OBJECT,
+		PAGE_BREAK,
+		LOADING,
+		NO_RESULTS,
+		// A removed node that's waiting to be reused
+		FREE
+	};
+
+	static const ID ROOT;
+	static const ID INVALID;
+	// Size of buckets and folders, which is displayed as "--"
+	static const uint64_t NO_SIZE;
+	// Timestamp of nodes that don't have one
+	static const qint64 NO_TIME;
+
+	BrowserNodeStore();
+
+	// Append a node to the end of parent's children and return its ID
+	ID Append(ID parent, Kind kind, const QString& name,
+		  const QString& bucketName = QString(),
+		  const QString& prefix = QString(),
+		  const QString& owner = QString(),
+		  uint64_t size = NO_SIZE,
+		  qint64 created = NO_TIME);
+	// Insert a node in to parent's children at row.  The rows of the
+	// children after it are updated.
+	ID Insert(ID parent, int row, Kind kind, const QString& name,
+		  const QString& bucketName = QString(),
+		  const QString& prefix = QString(),
+		  const QString& owner = QString(),
+		  uint64_t size = NO_SIZE,
+		  qint64 created = NO_TIME);
+	// Create a node that isn't a child of any node yet, for
+	// InsertChildren
+	ID Create(Kind kind, const QString& name,
+		  const QString& bucketName = QString(),
+		  const QString& prefix = QString(),
+		  const QString& owner = QString(),
+		  uint64_t size = NO_SIZE,
+		  qint64 created = NO_TIME);
+	// Insert nodes made by Create in to parent's children, in order,
+	// starting at row.  The children after them are renumbered once for
+	// the whole run rather than once per node.
+	void InsertChildren(ID parent, int row, const QVector<ID>& nodes);
+	// Update the fields a relisting can change.  Returns true if any of
+	// them did.
+	bool Update(ID node, const QString& owner, uint64_t size,
+		    qint64 created);
+	// Remove count of parent's children, starting at row, along with all
+	// of their descendants.  The rows of the children after them are
+	// updated.
+	void Remove(ID parent, int row, int count = 1);
+
+	int GetChildCount(ID node) const;
+	// INVALID if row is out of range
+	ID GetChild(ID node, int row) const;
+	ID GetParent(ID node) const;
+	int GetRow(ID node) const;
+	Kind GetKind(ID node) const;
+	bool IsBucketOrFolder(ID node) const;
+	const QString& GetName(ID node) const;
+	const QString& GetBucketName(ID node) const;
+	// All parent folder object names, not including the bucket name
+	const QString& GetPrefix(ID node) const;
+	const QString& GetOwner(ID node) const;
+	uint64_t GetSize(ID node) const;
+	// Milliseconds since the epoch, UTC
+	qint64 GetCreated(ID node) const;
+
+	// Only represents what DS3BrowserModel should report for canFetchMore
+	// and not necessarily if the previous get children request was
+	// truncated or not
+	bool GetCanFetchMore(ID node) const;
+	bool IsFetching(ID node) const;
+	// Whether the node's children came from the listing cache and are
+	// waiting for the listing to be revalidated
+	bool IsFromCache(ID node) const;
+	QString GetNextMarker(ID node) const;
+	void SetCanFetchMore(ID node, bool canFetchMore);
+	void SetFetching(ID node, bool fetching);
+	void SetFromCache(ID node, bool fromCache);
+	void SetNextMarker(ID node, const QString& nextMarker);
+
+	// The number of nodes, including ROOT, that haven't been removed
+	int GetNumNodes() const;
+
+private:
+	enum Flag {
+		CAN_FETCH_MORE = 0x1,
+		FETCHING = 0x2,
+		FROM_CACHE = 0x4
+	};
+
+	ID Allocate();
+	void Free(ID node);
+	void FreeChildren(ID node);
+	uint32_t Intern(const QString& str);
+	void SetFlag(ID node, Flag flag, bool on);
+
+	QVector<ID> m_parents;
+	QVector<int> m_rows;
+	QVector<uint8_t> m_kinds;
+	QVector<uint8_t> m_flags;
+	QVector<uint32_t> m_bucketNames;
+	QVector<uint32_t> m_prefixes;
+	QVector<uint32_t> m_owners;
+	QVector<QString> m_names;
+	QVector<uint64_t> m_sizes;
+	QVector<qint64> m_created;
+	QVector<QVector<ID> > m_children;
+	// Only nodes whose listing was truncated have a next marker
+	QHash<ID, QString> m_nextMarkers;
+	QVector<ID> m_freeIDs;
+
+	QVector<QString> m_strings;
+	QHash<QString, uint32_t> m_stringIDs;
+};
+
+inline int
+BrowserNodeStore::GetChildCount(ID node) const
+{
+	return m_children[node].size();
+}
+
+inline BrowserNodeStore::ID
+BrowserNodeStore::GetChild(ID node, int row) const
+{
+	const QVector<ID>& children = m_children[node];
+	if (row < 0 || row >= children.size()) {
+		return INVALID;
+	}
+	return children[row];
+}
+
+inline BrowserNodeStore::ID
+BrowserNodeStore::GetParent(ID node) const
+{
+	return m_parents[node];
+}
+
+inline int
+BrowserNodeStore::GetRow(ID node) const
+{
+	return m_rows[node];
+}
+
+inline BrowserNodeStore::Kind
+BrowserNodeStore::GetKind(ID node) const
+{
+	return static_cast<Kind>(m_kinds[node]);
+}
+
+inline bool
+BrowserNodeStore::IsBucketOrFolder(ID node) const
+{
+	Kind kind = GetKind(node);
+	return (kind == BUCKET || kind == FOLDER);
+}
+
+inline const QString&
+BrowserNodeStore::GetName(ID node) const
+{
+	return m_names[node];
+}
+
+inline const QString&
+BrowserNodeStore::GetBucketName(ID node) const
+{
+	return m_strings[m_bucketNames[node]];
+}
+
+inline const QString&
+BrowserNodeStore::GetPrefix(ID node) const
+{
+	return m_strings[m_prefixes[node]];
+}
+
+inline const QString&
+BrowserNodeStore::GetOwner(ID node) const
+{
+	return m_strings[m_owners[node]];
+}
+
+inline uint64_t
+BrowserNodeStore::GetSize(ID node) const
+{
+	return m_sizes[node];
+}
+
+inline qint64
+BrowserNodeStore::GetCreated(ID node) const
+{
+	return m_created[node];
+}
+
+inline bool
+BrowserNodeStore::GetCanFetchMore(ID node) const
+{
+	return (m_flags[node] & CAN_FETCH_MORE) != 0;
+}
+
+inline bool
+BrowserNodeStore::IsFetching(ID node) const
+{
+	return (m_flags[node] & FETCHING) != 0;
+}
+
+inline bool
+BrowserNodeStore::IsFromCache(ID node) const
+{
+	return (m_flags[node] & FROM_CACHE) != 0;
+}
+
+inline QString
+BrowserNodeStore::GetNextMarker(ID node) const
+{
+	return m_nextMarkers.value(node);
+}
+
+inline void
+BrowserNodeStore::SetCanFetchMore(ID node, bool canFetchMore)
+{
+	SetFlag(node, CAN_FETCH_MORE, canFetchMore);
+}
+
+inline void
+BrowserNodeStore::SetFetching(ID node, bool fetching)
+{
+	SetFlag(node, FETCHING, fetching);
+}
+
+inline void
+BrowserNodeStore::SetFromCache(ID node, bool fromCache)
+{
+	SetFlag(node, FROM_CACHE, fromCache);
+}
+
+inline int
+BrowserNodeStore::GetNumNodes() const
+{
+	return m_parents.size() - m_freeIDs.size();
+}
+
+#endif
@@ -14,6 +14,7 @@
  * *****************************************************************************
  */
 
+#include <algorithm>
 #include <QDateTime>
 #include <QFuture>
 #include <QIcon>
@@ -22,7 +23,9 @@
 #include <QSet>
 
 #include "helpers/number_helper.h"
+#include "helpers/time_helper.h"
 #include "lib/client.h"
+#include "lib/listing_cache.h"
 #include "lib/logger.h"
 #include "lib/mime_data.h"
 #include "lib/errors/ds3_error.h"
@@ -31,394 +34,121 @@
 #include "models/ds3_browser_model.h"
 #include "models/ds3_url.h"
 
-// Must match m_rootItem->m_data;
 enum Column { NAME, OWNER, SIZE_COL, KIND, CREATED, COUNT };
 
-static const QString REST_TIMESTAMP_FORMAT = "yyyy-MM-ddThh:mm:ss.000Z";
 static const QString VIEW_TIMESTAMP_FORMAT = "MMMM d, yyyy h:mm AP";
 
 static const QString BUCKET = "Bucket";
 static const QString OBJECT = "Object";
 static const QString FOLDER = "Folder";
 
-//
-// DS3BrowserItem
-//
-
-class DS3BrowserItem
-{
-public:
-	DS3BrowserItem(const QList<QVariant>& data,
-		       QString bucketName = QString(),
-		       QString prefix = QString(),
-		       DS3BrowserItem* parent = 0);
-	virtual ~DS3BrowserItem();
-
-	void AppendChild(DS3BrowserItem* item);
-	bool GetCanFetchMore() const;
-	QString GetBucketName() const;
-	DS3BrowserItem* GetChild(int row) const;
-	void RemoveChild(int row);
-	int GetChildCount() const;
-	int GetColumnCount() const;
-	QVariant GetData(int column) const;
-	QString GetNextMarker() const;
-	QString GetPrefix() const;
-	int GetRow() const;
-	DS3BrowserItem* GetParent() const;
-	virtual bool IsLoadingItem() const;
-	virtual bool IsPageBreak() const;
-	virtual bool IsNoSearchResultsItem() const;
-	bool IsFetching() const;
-	void Reset();
-	QString GetFullName() const;
-	QString GetPath() const;
-
-	void SetCanFetchMore(bool canFetchMore);
-	void SetFetching(bool fetching);
-	void SetNextMarker(const QString nextMarker);
-
-protected:
-	// m_canFetchMore only represents what DS3BrowserModel should report
-	// for canFetchMore and not necessarily if the previous get
-	// children request was truncated or not.
-	bool m_canFetchMore;
-	bool m_fetching;
-	QList<DS3BrowserItem*> m_children;
-	// List of data to show in the table.  Each item in the list
-	// directly corresponds to a column.
-	QList<QVariant> m_data;
-	// So object items so they can easily keep track of what
-	// bucket they're in.  For bucket items, this is the same as
-	// m_data[0];
-	const QString m_bucketName;
-	QString m_nextMarker;
-	DS3BrowserItem* m_parent;
-	// All parent folder object names, not including the bucket name
-	const QString m_prefix;
-
-	QList<DS3BrowserItem*> GetChildren() const;
-};
-
-DS3BrowserItem::DS3BrowserItem(const QList<QVariant>& data,
-			       QString bucketName,
-			       QString prefix,
-			       DS3BrowserItem* parent)
-	: m_canFetchMore(true),
-	  m_fetching(false),
-	  m_data(data),
-	  m_bucketName(bucketName),
-	  m_parent(parent),
-	  m_prefix(prefix)
-{
-}
-
-DS3BrowserItem::~DS3BrowserItem()
-{
-	qDeleteAll(m_children);
-}
-
-void
-DS3BrowserItem::AppendChild(DS3BrowserItem* item)
-{
-	m_children << item;
-}
-
-inline QString
-DS3BrowserItem::GetBucketName() const
-{
-	return m_bucketName;
-}
-
-inline bool
-DS3BrowserItem::GetCanFetchMore() const
-{
-	return m_canFetchMore;
-}
-
-DS3BrowserItem*
-DS3BrowserItem::GetChild(int row) const
-{
-	return GetChildren().value(row);
-}
-
-void
-DS3BrowserItem::RemoveChild(int row)
-{
-	if (row < m_children.count()) {
-		DS3BrowserItem* item = m_children.at(row);
-		m_children.removeAt(row);
-		delete item;
-	}
-}
+static const QString PAGE_BREAK_TEXT = "Click to load more";
+static const QString LOADING_TEXT = "Loading ...";
+static const QString NO_RESULTS_TEXT = "There are currently no items to display";
 
-int
-DS3BrowserItem::GetChildCount() const
-{
-	return GetChildren().count();	
-}
+static const QString NO_VALUE = "--";
 
-inline QString
-DS3BrowserItem::GetNextMarker() const
+static qint64
+ParseTimestamp(const QString& timestamp)
 {
-	return m_nextMarker;
-}
-
-inline QString
-DS3BrowserItem::GetPrefix() const
-{
-	return m_prefix;
-}
-
-int
-DS3BrowserItem::GetRow() const
-{
-	if (m_parent) {
-		return m_parent->GetChildren().indexOf(const_cast<DS3BrowserItem*>(this));
+	qint64 msecs;
+	if (!TimeHelper::ParseRESTTimestamp(timestamp, &msecs)) {
+		return BrowserNodeStore::NO_TIME;
 	}
-
-	return 0;
-}
-
-int
-DS3BrowserItem::GetColumnCount() const
-{
-	return m_data.count();
-}
-
-QVariant
-DS3BrowserItem::GetData(int column) const
-{
-	QVariant data = m_data.value(column);
-	if (column == SIZE_COL && data != "Size" && data != "--") {
-		qulonglong size = data.toULongLong();
-		data = QVariant(NumberHelper::ToHumanSize(size));
-	}
-	return data;
-}
-
-inline DS3BrowserItem*
-DS3BrowserItem::GetParent() const
-{
-	return m_parent;
-}
-
-inline bool
-DS3BrowserItem::IsLoadingItem() const
-{
-	return false;
-}
-
-inline bool
-DS3BrowserItem::IsPageBreak() const
-{
-	return false;
-}
-
-inline bool
-DS3BrowserItem::IsNoSearchResultsItem() const
-{
-	return false;
-}
-
-inline bool
-DS3BrowserItem::IsFetching() const
-{
-	return m_fetching;
-}
-
-void
-DS3BrowserItem::Reset()
-{
-	qDeleteAll(m_children);
-	m_children.clear();
-	m_canFetchMore = true;
-	m_nextMarker = QString();
-}
-
-QString
-DS3BrowserItem::GetFullName() const
-{
-	return (m_prefix + GetData(NAME).toString());
-}
-
-QString
-DS3BrowserItem::GetPath() const
-{
-	QString path = "/" + m_bucketName;
-	if (GetData(KIND) == BUCKET) {
-		return path;
-	}
-
-	if (m_prefix.isEmpty()) {
-		path += "/";
-	} else {
-		path += "/" + m_prefix;
-	}
-	path += GetData(NAME).toString();
-	return path;
-}
-
-QList<DS3BrowserItem*>
-DS3BrowserItem::GetChildren() const
-{
-	return m_children;
-}
-
-inline void
-DS3BrowserItem::SetCanFetchMore(bool canFetchMore)
-{
-	m_canFetchMore = canFetchMore;
-}
-
-inline void
-DS3BrowserItem::SetFetching(bool fetching)
-{
-	m_fetching = fetching;
-}
-
-inline void
-DS3BrowserItem::SetNextMarker(const QString nextMarker)
-{
-	m_nextMarker = nextMarker;
-}
-
-class PageBreakItem : public DS3BrowserItem
-{
-public:
-	PageBreakItem(DS3BrowserItem* parent = 0);
-
-	bool IsPageBreak() const;
-};
-
-PageBreakItem::PageBreakItem(DS3BrowserItem* parent)
-	: DS3BrowserItem(QList<QVariant>(), "", "", parent)
-{
-	m_data << "Click to load more";
-}
-
-inline bool
-PageBreakItem::IsPageBreak() const
-{
-	return true;
-}
-
-class LoadingItem : public DS3BrowserItem
-{
-public:
-	LoadingItem(DS3BrowserItem* parent = 0);
-
-	bool IsLoadingItem() const;
-};
-
-LoadingItem::LoadingItem(DS3BrowserItem* parent)
-	: DS3BrowserItem(QList<QVariant>(), "", "", parent)
-{
-	m_data << "Loading ...";
-}
-
-inline bool
-LoadingItem::IsLoadingItem() const
-{
-	return true;
-}
-
-class NoSearchResultsItem : public DS3BrowserItem
-{
-public:
-	NoSearchResultsItem(DS3BrowserItem* parent = 0);
-
-	bool IsNoSearchResultsItem() const;
-};
-
-NoSearchResultsItem::NoSearchResultsItem(DS3BrowserItem* parent)
-	: DS3BrowserItem(QList<QVariant>(), "", "", parent)
-{
-	m_data << "There are currently no items to display";
-}
-
-inline bool
-NoSearchResultsItem::IsNoSearchResultsItem() const
-{
-	return true;
+	return msecs;
 }
 
 //
 // DS3BrowserModel
 //
 
+const int DS3BrowserModel::FORMAT_CACHE_SIZE = 512;
+
 DS3BrowserModel::DS3BrowserModel(Client* client, QObject* parent)
 	: QAbstractItemModel(parent),
-	  m_client(client)
+	  m_client(client),
+	  m_formatCache(FORMAT_CACHE_SIZE),
+	  m_bucketIcon(":/resources/icons/bucket.png"),
+	  m_folderIcon(":/resources/icons/files.png"),
+	  m_objectIcon(":/resources/icons/file.png")
 {
-	// Headers must match DS3BrowserModel::Column
-	QList<QVariant> column_names;
-	column_names << "Name" << "Owner" << "Size" << "Kind" << "Created";
-	m_rootItem = new DS3BrowserItem(column_names);
+	ClearFormatCache();
 }
 
 DS3BrowserModel::~DS3BrowserModel()
 {
-	delete m_rootItem;
 }
 
 bool
 DS3BrowserModel::canFetchMore(const QModelIndex& parent) const
 {
-	DS3BrowserItem* parentItem;
-	if (parent.isValid()) {
-		parentItem = IndexToItem(parent);
-	} else {
-		parentItem = m_rootItem;
-	}
-	return parentItem->GetCanFetchMore();
+	return m_nodes.GetCanFetchMore(IndexToNode(parent));
 }
 
 int
-DS3BrowserModel::columnCount(const QModelIndex& parent) const
+DS3BrowserModel::columnCount(const QModelIndex& /*parent*/) const
 {
-	DS3BrowserItem* item;
-	if (parent.isValid()) {
-		item = IndexToItem(parent);
-	} else {
-		item = m_rootItem;
-	}
-	return item->GetColumnCount();
+	return COUNT;
 }
 
 QVariant
 DS3BrowserModel::data(const QModelIndex &index, int role) const
 {
-	DS3BrowserItem* item;
 	QVariant data;
 
 	if (!index.isValid()) {
 		return data;
 	}
 
-	item = IndexToItem(index);
+	BrowserNodeStore::ID node = IndexToNode(index);
+	BrowserNodeStore::Kind kind = m_nodes.GetKind(node);
 	int column = index.column();
 
 	switch (role)
 	{
 	case Qt::DisplayRole:
-		data = item->GetData(column);
-		if (column == 0 &&
-		    (item->IsPageBreak() ||
-		     item->IsLoadingItem() ||
-		     item->IsNoSearchResultsItem())) {
-			m_view->setFirstColumnSpanned(index.row(), index.parent(), true);
+		if (kind == BrowserNodeStore::PAGE_BREAK ||
+		    kind == BrowserNodeStore::LOADING ||
+		    kind == BrowserNodeStore::NO_RESULTS) {
+			if (column == 0) {
+				data = m_nodes.GetName(node);
+				m_view->setFirstColumnSpanned(index.row(), index.parent(), true);
+			}
+			break;
+		}
+		switch (column)
+		{
+		case NAME:
+			data = m_nodes.GetName(node);
+			break;
+		case OWNER:
+			data = m_nodes.GetOwner(node);
+			break;
+		case SIZE_COL:
+			data = GetFormattedRow(node).size;
+			break;
+		case KIND:
+			if (kind == BrowserNodeStore::BUCKET) {
+				data = BUCKET;
+			} else if (kind == BrowserNodeStore::FOLDER) {
+				data = FOLDER;
+			} else if (kind == BrowserNodeStore::OBJECT) {
+				data = OBJECT;
+			}
+			break;
+		case CREATED:
+			data = GetFormattedRow(node).created;
+			break;
 		}
 		break;
 	case Qt::DecorationRole:
 		if (column == NAME) {
-			QVariant kind = item->GetData(KIND);
-			if (kind == BUCKET) {
-				data = QIcon(":/resources/icons/bucket.png");
-			} else if (kind == FOLDER) {
-				data = QIcon(":/resources/icons/files.png");
-			} else if (kind == OBJECT) {
-				data = QIcon(":/resources/icons/file.png");
+			if (kind == BrowserNodeStore::BUCKET) {
+				data = m_bucketIcon;
+			} else if (kind == BrowserNodeStore::FOLDER) {
+				data = m_folderIcon;
+			} else if (kind == BrowserNodeStore::OBJECT) {
+				data = m_objectIcon;
 			}
 		}
 		break;
@@ -432,20 +162,31 @@ DS3BrowserModel::dropMimeData(const QMimeData* data,
 			      int row, int column,
 			      const QModelIndex& parentIndex)
 {
-	if (!data->hasUrls()) {
+	const MimeData* mimeData = qobject_cast<const MimeData*>(data);
+	bool hasDS3URLs = mimeData != NULL && mimeData->HasDS3URLs();
+	if (!data->hasUrls() && !hasDS3URLs) {
 		return QAbstractItemModel::dropMimeData(data, action, row,
 							column, parentIndex);
 	}
 
-	DS3BrowserItem* parent = IndexToItem(parentIndex);
-	QString bucketName = parent->GetBucketName();
-	QString prefix = parent->GetPrefix();
-	if (parent->GetData(KIND) != BUCKET) {
-		prefix += parent->GetData(NAME).toString();
+	QString bucketName;
+	QString prefix;
+	GetDropDestination(parentIndex, &bucketName, &prefix);
+
+	if (hasDS3URLs) {
+		// Objects dragged from another session's DS3 system are
+		// migrated straight from that system to this one
+		QList<QUrl> urls = mimeData->GetDS3URLs();
+		Client* source = Client::FindClient(urls.first());
+		if (source == NULL || source == m_client) {
+			return false;
+		}
+		m_client->Migrate(source, urls, bucketName, prefix);
+		return true;
 	}
-	prefix.replace(QRegularExpression("^/"), "");
+
 	QList<QUrl> urls = data->urls();
-	m_client->BulkPut(bucketName, prefix, urls);
+	m_client->BulkPut(bucketName, prefix, urls, TransferFilter::FromSettings());
 	return true;
 }
 
@@ -454,10 +195,8 @@ DS3BrowserModel::flags(const QModelIndex& index) const
 {
 	Qt::ItemFlags flags = QAbstractItemModel::flags(index);
 	if (index.isValid()) {
-		DS3BrowserItem* item = IndexToItem(index);
-		QVariant kind = item->GetData(KIND);
 		flags |= Qt::ItemIsDragEnabled;
-		if (kind == BUCKET || kind == FOLDER) {
+		if (m_nodes.IsBucketOrFolder(IndexToNode(index))) {
 			flags |= Qt::ItemIsDropEnabled;
 		}
 	}
@@ -468,37 +207,30 @@ void
 DS3BrowserModel::fetchMore(const QModelIndex& parent)
 {
 	bool parentIsValid = parent.isValid();
-	DS3BrowserItem* parentItem;
-	if (parent.isValid()) {
-		parentItem = IndexToItem(parent);
-	} else {
-		parentItem = m_rootItem;
-	}
+	BrowserNodeStore::ID parentNode = IndexToNode(parent);
 
-	int lastRow = parentItem->GetChildCount() - 1;
+	int lastRow = m_nodes.GetChildCount(parentNode) - 1;
 
-	DS3BrowserItem* loadingItem = new LoadingItem(parentItem);
-	int loadingItemRow = lastRow >= 0 ? lastRow : 0;
-	beginInsertRows(parent, loadingItemRow, loadingItemRow);
-	parentItem->AppendChild(loadingItem);
+	int loadingRow = lastRow + 1;
+	beginInsertRows(parent, loadingRow, loadingRow);
+	m_nodes.Append(parentNode, BrowserNodeStore::LOADING, LOADING_TEXT);
 	endInsertRows();
 
 	if (lastRow >= 0) {
-		DS3BrowserItem* lastChildItem = parentItem->GetChild(lastRow);
-		if (lastChildItem->IsPageBreak()) {
+		BrowserNodeStore::ID lastChild = m_nodes.GetChild(parentNode, lastRow);
+		if (m_nodes.GetKind(lastChild) == BrowserNodeStore::PAGE_BREAK) {
 			removeRow(lastRow, parent);
 		}
 	}
 
-
-	parentItem->SetFetching(true);
+	m_nodes.SetFetching(parentNode, true);
 	parentIsValid ? FetchMoreObjects(parent) : FetchMoreBuckets(parent);
 
 	// Always set CanFetchMore to false so the view doesn't automatically
 	// come right back around and ask to fetchMore when this model
 	// emits the rowsInserted signal (which is the way
 	// QAbstractItemView handles fetchMore).
-	parentItem->SetCanFetchMore(false);
+	m_nodes.SetCanFetchMore(parentNode, false);
 }
 
 // rowCount actually determines whether or not the bucket has any objects in
@@ -512,9 +244,7 @@ DS3BrowserModel::hasChildren(const QModelIndex& parent) const
 		return true;
 	}
 
-	DS3BrowserItem* item = IndexToItem(parent);
-	QVariant kind = item->GetData(KIND);
-	return (kind == BUCKET || kind == FOLDER);
+	return m_nodes.IsBucketOrFolder(IndexToNode(parent));
 }
 
 QVariant
@@ -522,8 +252,12 @@ DS3BrowserModel::headerData(int section,
 			    Qt::Orientation /*orientation*/,
 			    int role) const
 {
-	if (role == Qt::DisplayRole) {
-		return m_rootItem->GetData(section);
+	// Must match Column
+	static const char* headers[] = {
+		"Name", "Owner", "Size", "Kind", "Created"
+	};
+	if (role == Qt::DisplayRole && section >= 0 && section < COUNT) {
+		return QString(headers[section]);
 	}
 	return QVariant();
 }
@@ -535,17 +269,9 @@ DS3BrowserModel::index(int row, int column, const QModelIndex &parent) const
 		return QModelIndex();
 	}
 
-	DS3BrowserItem* parentItem;
-
-	if (parent.isValid()) {
-		parentItem = IndexToItem(parent);
-	} else {
-		parentItem = m_rootItem;
-	}
-
-	DS3BrowserItem* childItem = parentItem->GetChild(row);
-	if (childItem) {
-		return createIndex(row, column, childItem);
+	BrowserNodeStore::ID child = m_nodes.GetChild(IndexToNode(parent), row);
+	if (child != BrowserNodeStore::INVALID) {
+		return createIndex(row, column, (quintptr)child);
 	} else {
 		return QModelIndex();
 	}
@@ -563,13 +289,17 @@ DS3BrowserModel::mimeData(const QModelIndexList& indexes) const
 	for (int i = 0; i < indexes.size(); i++) {
 		QModelIndex index = indexes.at(i);
 		if (index.column() == 0) {
-			DS3BrowserItem* item = IndexToItem(index);
-			QString path = item->GetPath();
-			QVariant kind = item->GetData(KIND);
-			if (kind == FOLDER && !path.endsWith("/")) {
+			QString path = GetPath(index);
+			if (IsFolder(index) && !path.endsWith("/")) {
 				path += "/";
 			}
 			DS3URL url(endpoint, path);
+			// Saves small transfers from looking the size up
+			// again (see Client::IsFastPathEligible)
+			uint64_t size = m_nodes.GetSize(IndexToNode(index));
+			if (size != BrowserNodeStore::NO_SIZE) {
+				url.SetObjectSize(size);
+			}
 			urls << QUrl(url);
 		}
 	}
@@ -582,7 +312,7 @@ QStringList
 DS3BrowserModel::mimeTypes() const
 {
 	QStringList types;
-	types << "text/uri-list";
+	types << "text/uri-list" << MimeData::DS3_MIME_TYPE;
 	return types;
 }
 
@@ -593,14 +323,14 @@ DS3BrowserModel::parent(const QModelIndex& index) const
 		return QModelIndex();
 	}
 
-	DS3BrowserItem* childItem = IndexToItem(index);
-	DS3BrowserItem* parentItem = childItem->GetParent();
-
-	if (parentItem == m_rootItem) {
+	BrowserNodeStore::ID parentNode = m_nodes.GetParent(IndexToNode(index));
+	if (parentNode == BrowserNodeStore::ROOT ||
+	    parentNode == BrowserNodeStore::INVALID) {
 		return QModelIndex();
 	}
 
-	return createIndex(parentItem->GetRow(), 0, parentItem);
+	return createIndex(m_nodes.GetRow(parentNode), 0,
+			   (quintptr)parentNode);
 }
 
 bool
@@ -610,19 +340,9 @@ DS3BrowserModel::removeRows(int row, int count, const QModelIndex& parent)
 		return false;
 	}
 
-	DS3BrowserItem* parentItem;
-	if (parent.isValid()) {
-		parentItem = IndexToItem(parent);
-	} else {
-		parentItem = m_rootItem;
-	}
-
 	beginRemoveRows(parent, row, row + count - 1);
-
-	for (int i = 0; i < count; i++) {
-		parentItem->RemoveChild(row + i);
-	}
-
+	m_nodes.Remove(IndexToNode(parent), row, count);
+	ClearFormatCache();
 	endRemoveRows();
 
 	return true;
@@ -631,245 +351,652 @@ DS3BrowserModel::removeRows(int row, int count, const QModelIndex& parent)
 int
 DS3BrowserModel::rowCount(const QModelIndex &parent) const
 {
-	DS3BrowserItem* parentItem;
 	if (parent.column() > 0) {
 		return 0;
 	}
 
-	if (parent.isValid()) {
-		parentItem = IndexToItem(parent);
-	} else {
-		parentItem = m_rootItem;
-	}
-
-	return parentItem->GetChildCount();
+	return m_nodes.GetChildCount(IndexToNode(parent));
 }
 
 bool
 DS3BrowserModel::IsBucket(const QModelIndex& index) const
 {
-	DS3BrowserItem* item = IndexToItem(index);
-	QVariant kind = item->GetData(KIND);
-	return (kind == BUCKET);
+	return (m_nodes.GetKind(IndexToNode(index)) == BrowserNodeStore::BUCKET);
 }
 
 bool
 DS3BrowserModel::IsFolder(const QModelIndex& index) const
 {
-	DS3BrowserItem* item = IndexToItem(index);
-	QVariant kind = item->GetData(KIND);
-	return (kind == FOLDER);
+	return (m_nodes.GetKind(IndexToNode(index)) == BrowserNodeStore::FOLDER);
 }
 
 bool
 DS3BrowserModel::IsBucketOrFolder(const QModelIndex& index) const
 {
-	DS3BrowserItem* item = IndexToItem(index);
-	QVariant kind = item->GetData(KIND);
-	return (kind == BUCKET || kind == FOLDER);
+	return m_nodes.IsBucketOrFolder(IndexToNode(index));
 }
 
 bool
 DS3BrowserModel::IsPageBreak(const QModelIndex& index) const
 {
-	DS3BrowserItem* item = IndexToItem(index);
-	return item->IsPageBreak();
+	return (m_nodes.GetKind(IndexToNode(index)) == BrowserNodeStore::PAGE_BREAK);
 }
 
 bool
 DS3BrowserModel::IsFetching(const QModelIndex& parent) const
 {
-	DS3BrowserItem* parentItem;
-	if (parent.isValid()) {
-		parentItem = IndexToItem(parent);
-	} else {
-		parentItem = m_rootItem;
-	}
-	return parentItem->IsFetching();
+	return m_nodes.IsFetching(IndexToNode(parent));
 }
 
 QString
 DS3BrowserModel::GetBucketName(const QModelIndex& index) const
 {
-	QString name;
-	DS3BrowserItem* item = IndexToItem(index);
-	if (item != NULL) {
-		name = item->GetBucketName();
-	}
-	return name;
+	return m_nodes.GetBucketName(IndexToNode(index));
 }
 
 QString
 DS3BrowserModel::GetName(const QModelIndex& index) const
 {
-	QString name;
-	DS3BrowserItem* item = IndexToItem(index);
-	if (item != NULL) {
-		name = item->GetData(NAME).toString();
-	}
-	return name;
+	return m_nodes.GetName(IndexToNode(index));
 }
 
 QString
 DS3BrowserModel::GetFullName(const QModelIndex& index) const
 {
-	QString name;
-	DS3BrowserItem* item = IndexToItem(index);
-	if (item != NULL) {
-		name = item->GetFullName();
-	}
-	return name;
+	BrowserNodeStore::ID node = IndexToNode(index);
+	return (m_nodes.GetPrefix(node) + m_nodes.GetName(node));
 }
 
 QString
 DS3BrowserModel::GetPath(const QModelIndex& index) const
 {
-	QString path = "/";
-	DS3BrowserItem* item = IndexToItem(index);
-	if (item != NULL) {
-		path = item->GetPath();
+	BrowserNodeStore::ID node = IndexToNode(index);
+	if (node == BrowserNodeStore::ROOT) {
+		return "/";
+	}
+
+	QString path = "/" + m_nodes.GetBucketName(node);
+	if (m_nodes.GetKind(node) == BrowserNodeStore::BUCKET) {
+		return path;
+	}
+
+	const QString& prefix = m_nodes.GetPrefix(node);
+	if (prefix.isEmpty()) {
+		path += "/";
+	} else {
+		path += "/" + prefix;
 	}
+	path += m_nodes.GetName(node);
 	return path;
 }
 
+void
+DS3BrowserModel::GetDropDestination(const QModelIndex& parentIndex,
+				    QString* bucketName, QString* prefix) const
+{
+	BrowserNodeStore::ID parent = IndexToNode(parentIndex);
+	*bucketName = m_nodes.GetBucketName(parent);
+	*prefix = m_nodes.GetPrefix(parent);
+	if (m_nodes.GetKind(parent) != BrowserNodeStore::BUCKET) {
+		*prefix += m_nodes.GetName(parent);
+	}
+	prefix->replace(QRegularExpression("^/"), "");
+}
+
 void
 DS3BrowserModel::Refresh(const QModelIndex& index)
 {
-	DS3BrowserItem* item;
-	if (index.isValid()) {
-		item = IndexToItem(index);
+	BrowserNodeStore::ID node = IndexToNode(index);
+	// There's nothing to relist if the first page was never requested,
+	// and a node that's still being listed is left alone.
+	if (m_nodes.GetCanFetchMore(node) || m_nodes.IsFetching(node)) {
+		return;
+	}
+
+	RefreshState state;
+	state.parent = index;
+	state.isRoot = !index.isValid();
+	state.stopMarker = m_nodes.GetNextMarker(node);
+	for (int i = 0; i < m_nodes.GetChildCount(node); i++) {
+		BrowserNodeStore::ID child = m_nodes.GetChild(node, i);
+		BrowserNodeStore::Kind kind = m_nodes.GetKind(child);
+		if (kind == BrowserNodeStore::BUCKET ||
+		    kind == BrowserNodeStore::FOLDER ||
+		    kind == BrowserNodeStore::OBJECT) {
+			state.rows.insert(GetRowKey(kind, m_nodes.GetName(child)),
+					  child);
+		}
+	}
+
+	// Keeps the view from fetching more pages of the old listing
+	// until the refresh is done
+	m_nodes.SetFetching(node, true);
+
+	if (state.isRoot) {
+		GetServiceWatcher* watcher = new GetServiceWatcher(index);
+		connect(watcher, SIGNAL(finished()),
+			this, SLOT(HandleRefreshServiceResponse()));
+		m_refreshes.insert(watcher, state);
+		QFuture<ServiceListing> future = m_client->GetService();
+		watcher->setFuture(future);
+		return;
+	}
+
+	state.bucketName = m_nodes.GetBucketName(node);
+	state.prefix = GetListingPrefix(node);
+	RefreshPage(state);
+}
+
+const DS3BrowserModel::FormattedRow&
+DS3BrowserModel::GetFormattedRow(BrowserNodeStore::ID node) const
+{
+	FormattedRow& row = m_formatCache[node % FORMAT_CACHE_SIZE];
+	if (row.node == node) {
+		return row;
+	}
+
+	row.node = node;
+	uint64_t size = m_nodes.GetSize(node);
+	if (size == BrowserNodeStore::NO_SIZE) {
+		row.size = NO_VALUE;
 	} else {
-		item = m_rootItem;
+		row.size = NumberHelper::ToHumanSize(size);
+	}
+	qint64 created = m_nodes.GetCreated(node);
+	if (m_nodes.GetKind(node) == BrowserNodeStore::FOLDER) {
+		row.created = NO_VALUE;
+	} else if (created == BrowserNodeStore::NO_TIME) {
+		row.created = QString();
+	} else {
+		QDateTime dt = QDateTime::fromMSecsSinceEpoch(created, Qt::UTC);
+		row.created = dt.toString(VIEW_TIMESTAMP_FORMAT);
+	}
+	return row;
+}
+
+void
+DS3BrowserModel::ClearFormatCache()
+{
+	for (int i = 0; i < m_formatCache.size(); i++) {
+		m_formatCache[i].node = BrowserNodeStore::INVALID;
 	}
+}
 
-	beginResetModel();
-	item->Reset();
-	endResetModel();
+QList<DS3BrowserModel::ListedRow>
+DS3BrowserModel::GetServiceRows(const ServiceListing& listing)
+{
+	QList<ListedRow> rows;
+	const QList<ListedBucket>& buckets = listing.GetBuckets();
+	for (int i = 0; i < buckets.size(); i++) {
+		const ListedBucket& rawBucket = buckets.at(i);
+		ListedRow row = { BrowserNodeStore::BUCKET,
+				  rawBucket.GetName(),
+				  listing.GetOwner(),
+				  BrowserNodeStore::NO_SIZE,
+				  ParseTimestamp(rawBucket.GetCreationDate()) };
+		rows << row;
+	}
+	return rows;
+}
+
+QList<DS3BrowserModel::ListedRow>
+DS3BrowserModel::GetBucketRows(const QString& prefix, const QString& owner,
+			       const BucketListing& listing)
+{
+	QList<ListedRow> rows;
+	QRegularExpression prefixRegex("^" + QRegularExpression::escape(prefix));
+
+	const QStringList& commonPrefixes = listing.GetCommonPrefixes();
+	for (int i = 0; i < commonPrefixes.size(); i++) {
+		QString nextName = commonPrefixes.at(i);
+		nextName.replace(prefixRegex, "");
+		nextName.replace(QRegularExpression("/$"), "");
+		ListedRow row = { BrowserNodeStore::FOLDER, nextName, owner,
+				  BrowserNodeStore::NO_SIZE,
+				  BrowserNodeStore::NO_TIME };
+		rows << row;
+	}
+
+	const QList<ListedObject>& objects = listing.GetObjects();
+	for (int i = 0; i < objects.size(); i++) {
+		const ListedObject& rawObject = objects.at(i);
+		QString nextName = rawObject.GetName();
+		if (nextName == prefix) {
+			continue;
+		}
+		nextName.replace(prefixRegex, "");
+		ListedRow row = { BrowserNodeStore::OBJECT, nextName, owner,
+				  rawObject.GetSize(),
+				  ParseTimestamp(rawObject.GetLastModified()) };
+		rows << row;
+	}
+	return rows;
+}
+
+QString
+DS3BrowserModel::GetRowKey(BrowserNodeStore::Kind kind, const QString& name)
+{
+	return QString::number(kind) + ":" + name;
+}
+
+QString
+DS3BrowserModel::GetListingPrefix(BrowserNodeStore::ID node) const
+{
+	QString prefix = m_nodes.GetPrefix(node);
+	if (m_nodes.GetKind(node) != BrowserNodeStore::BUCKET) {
+		prefix += m_nodes.GetName(node) + "/";
+	}
+	return prefix;
 }
 
 void
 DS3BrowserModel::FetchMoreBuckets(const QModelIndex& parent)
 {
+	// Show the last known buckets right away.  They're revalidated once
+	// the request finishes.
+	ServiceListing cached;
+	if (m_client->GetListingCache()->GetService(&cached)) {
+		int startRow = rowCount(parent);
+		AppendServiceListing(parent, cached);
+		RemoveLoadingRow(parent, startRow - 1);
+		m_nodes.SetFromCache(IndexToNode(parent), true);
+	}
+
 	GetServiceWatcher* watcher = new GetServiceWatcher(parent);
 	connect(watcher, SIGNAL(finished()), this, SLOT(HandleGetServiceResponse()));
-	QFuture<ds3_get_service_response*> future = m_client->GetService();
+	QFuture<ServiceListing> future = m_client->GetService();
 	watcher->setFuture(future);
 }
 
 void
 DS3BrowserModel::FetchMoreObjects(const QModelIndex& parent)
 {
-	DS3BrowserItem* parentItem;
-	if (parent.isValid()) {
-		parentItem = IndexToItem(parent);
-	} else {
-		// Should never get here since we should never try to
-		// fetch objects at the root level.
-		parentItem = m_rootItem;
-	}
+	// parent should never be the root since we should never try to
+	// fetch objects at the root level.
+	BrowserNodeStore::ID parentNode = IndexToNode(parent);
 
-	QString bucketName = parentItem->GetBucketName();
-	QString prefix = parentItem->GetPrefix();
-	bool isBucket = parentItem->GetData(KIND) == BUCKET;
-	if (!isBucket) {
-		prefix += parentItem->GetData(NAME).toString() + "/";
+	QString bucketName = m_nodes.GetBucketName(parentNode);
+	QString prefix = GetListingPrefix(parentNode);
+	QString nextMarker = m_nodes.GetNextMarker(parentNode);
+
+	// Only a folder's first page is cached.  Its cached rows are shown
+	// right away and revalidated once the request finishes.
+	BucketListing cached;
+	if (nextMarker.isEmpty() &&
+	    m_client->GetListingCache()->GetBucket(bucketName, prefix, &cached)) {
+		int startRow = rowCount(parent);
+		AppendBucketListing(parent, bucketName, prefix, cached);
+		RemoveLoadingRow(parent, startRow - 1);
+		m_nodes.SetFromCache(parentNode, true);
 	}
-	QString nextMarker = parentItem->GetNextMarker();
 
 	GetBucketWatcher* watcher = new GetBucketWatcher(parent,
 							 bucketName,
 							 prefix);
 	connect(watcher, SIGNAL(finished()), this, SLOT(HandleGetBucketResponse()));
-	QFuture<ds3_get_bucket_response*> future = m_client->GetBucket(bucketName,
-								       prefix,
-								       nextMarker);
+	QFuture<BucketListing> future = m_client->GetBucket(bucketName,
+							    prefix,
+							    nextMarker,
+							    false,
+							    Client::DELIMITER,
+							    m_pageSizer.GetPageSize());
 	watcher->setFuture(future);
 }
 
 void
-DS3BrowserModel::HandleGetServiceResponse()
+DS3BrowserModel::AppendServiceListing(const QModelIndex& parent,
+				      const ServiceListing& listing)
 {
-	LOG_DEBUG("HandleGetServiceResponse");
+	BrowserNodeStore::ID parentNode = IndexToNode(parent);
+	const QList<ListedBucket>& buckets = listing.GetBuckets();
+	int numBuckets = buckets.size();
+	if (numBuckets == 0) {
+		return;
+	}
 
-	GetServiceWatcher* watcher = static_cast<GetServiceWatcher*>(sender());
-	const QModelIndex& parent = watcher->GetParentModelIndex();
+	int startRow = rowCount(parent);
+	beginInsertRows(parent, startRow, startRow + numBuckets - 1);
+	const QString& owner = listing.GetOwner();
+	for (int i = 0; i < numBuckets; i++) {
+		const ListedBucket& rawBucket = buckets.at(i);
+		const QString& name = rawBucket.GetName();
+		m_nodes.Append(parentNode, BrowserNodeStore::BUCKET,
+				name, name, QString(), owner,
+				BrowserNodeStore::NO_SIZE,
+				ParseTimestamp(rawBucket.GetCreationDate()));
+	}
+	endInsertRows();
+}
 
-	DS3BrowserItem* parentItem;
-	if (parent.isValid()) {
-		// Should never get here since we should never try to fetch
-		// buckets at the bucket level.
-		parentItem = IndexToItem(parent);
-	} else {
-		parentItem = m_rootItem;
+void
+DS3BrowserModel::AppendBucketListing(const QModelIndex& parent,
+				     const QString& bucketName,
+				     const QString& prefix,
+				     const BucketListing& listing)
+{
+	BrowserNodeStore::ID parentNode = IndexToNode(parent);
+	int startRow = rowCount(parent);
+
+	QSet<QString> currentCommonPrefixNames;
+	for (int i = 0; i < startRow; i++) {
+		BrowserNodeStore::ID child = m_nodes.GetChild(parentNode, i);
+		if (m_nodes.GetKind(child) == BrowserNodeStore::FOLDER) {
+			currentCommonPrefixNames << m_nodes.GetName(child);
+		}
 	}
 
-	ds3_get_service_response* response = 0;
-	try {
-		response = watcher->result();
+	QList<ListedRow> rows = GetBucketRows(prefix,
+					      m_nodes.GetOwner(parentNode),
+					      listing);
+	QList<ListedRow> newRows;
+	for (int i = 0; i < rows.size(); i++) {
+		const ListedRow& row = rows.at(i);
+		if (row.kind != BrowserNodeStore::FOLDER ||
+		    !currentCommonPrefixNames.contains(row.name)) {
+			newRows << row;
+		}
 	}
-	catch (DS3Error& e) {
-		LOG_ERROR("ERROR:       LIST BUCKETS failed, "+e.ToString());
+
+	bool truncated = listing.IsTruncated();
+	int numNewChildren = newRows.size() + (truncated ? 1 : 0);
+	if (numNewChildren > 0) {
+		beginInsertRows(parent, startRow, startRow + numNewChildren - 1);
 	}
 
-	int numBuckets = 0;
-	if (response) {
-		numBuckets = (int) response->num_buckets;
+	for (int i = 0; i < newRows.size(); i++) {
+		const ListedRow& row = newRows.at(i);
+		m_nodes.Append(parentNode, row.kind, row.name, bucketName,
+				prefix, row.owner, row.size, row.created);
 	}
-	int startRow = 0;
-	if (numBuckets > 0) {
-		startRow = rowCount(parent);
-		beginInsertRows(parent, startRow, startRow + numBuckets - 1);
+
+	m_nodes.SetNextMarker(parentNode,
+			      GetNextPageMarker(m_nodes.GetNextMarker(parentNode),
+						listing));
+
+	if (truncated) {
+		m_nodes.Append(parentNode, BrowserNodeStore::PAGE_BREAK,
+				PAGE_BREAK_TEXT);
 	}
 
-	if (response) {
-		QString owner = QString::fromUtf8(response->owner->name->value);
-		for (size_t i = 0; i < response->num_buckets; i++) {
-			QString name;
-			char* rawCreated;
-			QDateTime createdDT;
-			QString created;
-			// The order in which bucketData is filled must match
-			// Column
-			QList<QVariant> bucketData;
-			DS3BrowserItem* bucket;
-
-			ds3_bucket rawBucket = response->buckets[i];
-
-			name = QString::fromUtf8(rawBucket.name->value);
-			bucketData << name;
-			bucketData << owner;
-			bucketData << "--";
-			bucketData << BUCKET;
-
-			rawCreated = rawBucket.creation_date->value;
-			createdDT = QDateTime::fromString(QString::fromUtf8(rawCreated),
-							  REST_TIMESTAMP_FORMAT);
-			created = createdDT.toString(VIEW_TIMESTAMP_FORMAT);
-			bucketData << created;
-
-			bucket = new DS3BrowserItem(bucketData,
-						    name,
-						    QString(),
-						    parentItem);
-			parentItem->AppendChild(bucket);
+	if (numNewChildren > 0) {
+		endInsertRows();
+	}
+}
+
+void
+DS3BrowserModel::RemoveLoadingRow(const QModelIndex& parent, int row)
+{
+	BrowserNodeStore::ID loadingNode = m_nodes.GetChild(IndexToNode(parent), row);
+	if (loadingNode != BrowserNodeStore::INVALID &&
+	    m_nodes.GetKind(loadingNode) == BrowserNodeStore::LOADING) {
+		removeRow(row, parent);
+	}
+}
+
+void
+DS3BrowserModel::RemoveCachedRows(const QModelIndex& parent)
+{
+	int numRows = rowCount(parent);
+	if (numRows > 0) {
+		removeRows(0, numRows, parent);
+	}
+	m_nodes.SetNextMarker(IndexToNode(parent), QString());
+}
+
+void
+DS3BrowserModel::RefreshPage(const RefreshState& state)
+{
+	GetBucketWatcher* watcher = new GetBucketWatcher(state.parent,
+							 state.bucketName,
+							 state.prefix);
+	connect(watcher, SIGNAL(finished()),
+		this, SLOT(HandleRefreshBucketResponse()));
+	m_refreshes.insert(watcher, state);
+	QFuture<BucketListing> future = m_client->GetBucket(state.bucketName,
+							    state.prefix,
+							    state.marker,
+							    false,
+							    Client::DELIMITER,
+							    m_pageSizer.GetPageSize());
+	watcher->setFuture(future);
+}
+
+QString
+DS3BrowserModel::GetNextPageMarker(const QString& marker,
+				   const BucketListing& listing)
+{
+	if (!listing.IsTruncated()) {
+		return QString();
+	}
+	// A truncated page without a next marker leaves the previous one
+	if (listing.GetNextMarker().isEmpty()) {
+		return marker;
+	}
+	return listing.GetNextMarker();
+}
+
+bool
+DS3BrowserModel::ShouldRefreshNextPage(const QString& nextMarker,
+				       const QString& stopMarker)
+{
+	return !nextMarker.isEmpty() &&
+	       (stopMarker.isEmpty() || nextMarker < stopMarker);
+}
+
+void
+DS3BrowserModel::MergeRefreshedRows(RefreshState* state,
+				    const QList<ListedRow>& rows)
+{
+	QModelIndex parent = state->parent;
+	BrowserNodeStore::ID parentNode = IndexToNode(parent);
+	// The rows of each kind and the page break, as they were before any
+	// new rows are inserted.  Only gathered if there are new rows.
+	QHash<int, QVector<int> > kindRows;
+	int pageBreakRow = -1;
+	QList<int> newRows;
+	QVector<InsertRun> runs;
+	for (int i = 0; i < rows.size(); i++) {
+		const ListedRow& row = rows.at(i);
+		QString key = GetRowKey(row.kind, row.name);
+		BrowserNodeStore::ID node = state->rows.value(key,
+							      BrowserNodeStore::INVALID);
+		if (node != BrowserNodeStore::INVALID) {
+			state->seen.insert(node);
+			if (m_nodes.Update(node, row.owner, row.size, row.created)) {
+				m_formatCache[node % FORMAT_CACHE_SIZE].node = BrowserNodeStore::INVALID;
+				int nodeRow = m_nodes.GetRow(node);
+				emit dataChanged(index(nodeRow, 0, parent),
+						 index(nodeRow, COUNT - 1, parent));
+			}
+			continue;
+		}
+
+		if (pageBreakRow < 0) {
+			int numRows = m_nodes.GetChildCount(parentNode);
+			pageBreakRow = numRows;
+			for (int j = 0; j < numRows; j++) {
+				BrowserNodeStore::ID child = m_nodes.GetChild(parentNode, j);
+				BrowserNodeStore::Kind kind = m_nodes.GetKind(child);
+				if (kind == BrowserNodeStore::PAGE_BREAK) {
+					pageBreakRow = qMin(pageBreakRow, j);
+				} else {
+					kindRows[kind] << j;
+				}
+			}
+		}
+		int insertRow = GetInsertRow(parentNode, kindRows.value(row.kind),
+					     pageBreakRow, row.name);
+		// Rows of a kind arrive in name order, so the new rows that go
+		// in the same place are next to each other in the listing
+		if (!runs.isEmpty() && runs.last().row == insertRow) {
+			runs.last().count++;
+		} else {
+			InsertRun run = { insertRow, newRows.size(), 1 };
+			runs << run;
+		}
+		newRows << i;
+	}
+
+	// Insert the runs in row order, each shifted down by the runs
+	// before it
+	std::stable_sort(runs.begin(), runs.end());
+	int inserted = 0;
+	for (int i = 0; i < runs.size(); i++) {
+		const InsertRun& run = runs.at(i);
+		int insertRow = run.row + inserted;
+		QVector<BrowserNodeStore::ID> nodes;
+		nodes.reserve(run.count);
+		beginInsertRows(parent, insertRow, insertRow + run.count - 1);
+		for (int j = run.first; j < run.first + run.count; j++) {
+			const ListedRow& row = rows.at(newRows.at(j));
+			QString bucketName = state->bucketName;
+			if (row.kind == BrowserNodeStore::BUCKET) {
+				bucketName = row.name;
+			}
+			BrowserNodeStore::ID node = m_nodes.Create(row.kind, row.name,
+								   bucketName,
+								   state->prefix,
+								   row.owner,
+								   row.size,
+								   row.created);
+			nodes << node;
+			state->rows.insert(GetRowKey(row.kind, row.name), node);
+			state->seen.insert(node);
 		}
+		m_nodes.InsertChildren(parentNode, insertRow, nodes);
+		endInsertRows();
+		inserted += run.count;
 	}
+}
 
-	if (numBuckets > 0) {
+void
+DS3BrowserModel::FinishRefresh(const RefreshState& state,
+			       const QString& nextMarker)
+{
+	QModelIndex parent = state.parent;
+	BrowserNodeStore::ID parentNode = IndexToNode(parent);
+
+	int numRows = rowCount(parent);
+	QVector<bool> stale(numRows);
+	for (int i = 0; i < numRows; i++) {
+		BrowserNodeStore::ID child = m_nodes.GetChild(parentNode, i);
+		BrowserNodeStore::Kind kind = m_nodes.GetKind(child);
+		stale[i] = (kind == BrowserNodeStore::BUCKET ||
+			    kind == BrowserNodeStore::FOLDER ||
+			    kind == BrowserNodeStore::OBJECT) &&
+			   !state.seen.contains(child);
+	}
+	// Remove the stale rows a contiguous run at a time, starting from
+	// the end so the runs still to be removed don't move
+	int last = numRows - 1;
+	while (last >= 0) {
+		if (!stale[last]) {
+			last--;
+			continue;
+		}
+		int first = last;
+		while (first > 0 && stale[first - 1]) {
+			first--;
+		}
+		removeRows(first, last - first + 1, parent);
+		last = first - 1;
+	}
+
+	numRows = rowCount(parent);
+	BrowserNodeStore::ID lastChild = m_nodes.GetChild(parentNode, numRows - 1);
+	bool hasPageBreak = lastChild != BrowserNodeStore::INVALID &&
+			    m_nodes.GetKind(lastChild) == BrowserNodeStore::PAGE_BREAK;
+	if (nextMarker.isEmpty() && hasPageBreak) {
+		removeRow(numRows - 1, parent);
+	} else if (!nextMarker.isEmpty() && !hasPageBreak) {
+		beginInsertRows(parent, numRows, numRows);
+		m_nodes.Append(parentNode, BrowserNodeStore::PAGE_BREAK,
+				PAGE_BREAK_TEXT);
 		endInsertRows();
 	}
+	m_nodes.SetNextMarker(parentNode, nextMarker);
+
+	m_nodes.SetFetching(parentNode, false);
+	emit ListingFinished();
 
-	int loadingRow = startRow > 0 ? startRow - 1 : 0;
-	DS3BrowserItem* loadingItem = parentItem->GetChild(loadingRow);
-	if (loadingItem && loadingItem->IsLoadingItem()) {
-		removeRow(loadingRow, parent);
+	// Buckets and folders that were never expanded are listed when
+	// they are
+	for (int i = 0; i < rowCount(parent); i++) {
+		if (m_nodes.IsBucketOrFolder(m_nodes.GetChild(parentNode, i))) {
+			Refresh(index(i, 0, parent));
+		}
 	}
+}
 
-	if (response) {
-		ds3_free_service_response(response);
+int
+DS3BrowserModel::GetInsertRow(BrowserNodeStore::ID parentNode,
+			      const QVector<int>& sameKindRows,
+			      int pageBreakRow,
+			      const QString& name) const
+{
+	int low = 0;
+	int high = sameKindRows.size();
+	while (low < high) {
+		int mid = low + (high - low) / 2;
+		BrowserNodeStore::ID child = m_nodes.GetChild(parentNode,
+							      sameKindRows.at(mid));
+		if (name < m_nodes.GetName(child)) {
+			high = mid;
+		} else {
+			low = mid + 1;
+		}
+	}
+	if (low < sameKindRows.size()) {
+		return qMin(sameKindRows.at(low), pageBreakRow);
 	}
+	return pageBreakRow;
+}
+
+void
+DS3BrowserModel::HandleGetServiceResponse()
+{
+	LOG_DEBUG("HandleGetServiceResponse");
+
+	GetServiceWatcher* watcher = static_cast<GetServiceWatcher*>(sender());
+	const QModelIndex& parent = watcher->GetParentModelIndex();
+
+	// parent should always be the root since we should never try to
+	// fetch buckets at the bucket level.
+	BrowserNodeStore::ID parentNode = IndexToNode(parent);
+	bool fromCache = m_nodes.IsFromCache(parentNode);
+	m_nodes.SetFromCache(parentNode, false);
+
+	ServiceListing response;
+	bool hasResponse = false;
+	try {
+		if (!watcher->isCanceled()) {
+			response = watcher->result();
+			hasResponse = true;
+		}
+	}
+	catch (DS3Error& e) {
+		LOG_ERROR("ERROR:       LIST BUCKETS failed, "+e.ToString());
+	}
+
+	if (hasResponse) {
+		bool changed = m_client->GetListingCache()->PutService(response);
+		if (fromCache && changed) {
+			RemoveCachedRows(parent);
+		}
+		if (!fromCache || changed) {
+			int startRow = rowCount(parent);
+			AppendServiceListing(parent, response);
+			// The loading row fetchMore appended is always just
+			// before the new rows
+			RemoveLoadingRow(parent, startRow - 1);
+		}
+	} else {
+		RemoveLoadingRow(parent, rowCount(parent) - 1);
+	}
+
 	delete watcher;
-	parentItem->SetFetching(false);
+	m_nodes.SetFetching(parentNode, false);
+	emit ListingFinished();
 }
 
 void
@@ -878,10 +1005,15 @@ DS3BrowserModel::HandleGetBucketResponse()
 	LOG_DEBUG("HandleGetBucketResponse");
 
 	GetBucketWatcher* watcher = static_cast<GetBucketWatcher*>(sender());
-	ds3_get_bucket_response* response = NULL;
+	BucketListing response;
+	bool hasResponse = false;
 	const QString& bucketName = watcher->GetBucketName();
+	const QString& prefix = watcher->GetPrefix();
 	try {
-		response = watcher->result();
+		if (!watcher->isCanceled()) {
+			response = watcher->result();
+			hasResponse = true;
+		}
 	}
 	catch (DS3Error& e) {
 		QString msg;
@@ -893,125 +1025,149 @@ DS3BrowserModel::HandleGetBucketResponse()
 		LOG_ERROR("ERROR:       LIST OBJECTS failed, "+msg);
 	}
 
-	const QModelIndex& parent = watcher->GetParentModelIndex();
-	DS3BrowserItem* parentItem;
-	if (parent.isValid()) {
-		parentItem = IndexToItem(parent);
-	} else {
-		// Should never get here since we should never try to
-		// fetch objects at the root level.
-		parentItem = m_rootItem;
-	}
-
-	QList<DS3BrowserItem*> newChildren;
-	if (response != NULL) {
-		QSet<QString> currentCommonPrefixNames;
-		for (int i = 0; i < parentItem->GetChildCount(); i++) {
-			DS3BrowserItem* object = parentItem->GetChild(i);
-			if (object->GetData(KIND) == FOLDER) {
-				currentCommonPrefixNames << object->GetData(NAME).toString();
-			}
+	// parent should never be the root since we should never try to
+	// fetch objects at the root level.
+	BrowserNodeStore::ID parentNode = IndexToNode(watcher->GetParentModelIndex());
+	if (m_nodes.GetKind(parentNode) == BrowserNodeStore::FREE ||
+	    m_nodes.GetBucketName(parentNode) != bucketName ||
+	    GetListingPrefix(parentNode) != prefix) {
+		// The parent was removed by a refresh while its listing was
+		// outstanding, and its node may have been reused since
+		delete watcher;
+		return;
+	}
+	QModelIndex parent = NodeToIndex(parentNode);
+	bool fromCache = m_nodes.IsFromCache(parentNode);
+	m_nodes.SetFromCache(parentNode, false);
+	// The cached rows set the next marker so a revalidation is always
+	// of the first page
+	bool firstPage = fromCache || m_nodes.GetNextMarker(parentNode).isEmpty();
+
+	if (hasResponse) {
+		m_pageSizer.ReportListing(response.GetCommonPrefixes().size() +
+					  response.GetObjects().size(),
+					  watcher->GetElapsedInMs());
+
+		bool changed = true;
+		if (firstPage) {
+			changed = m_client->GetListingCache()->PutBucket(bucketName,
+									 prefix,
+									 response);
 		}
-
-		const QString& prefix = watcher->GetPrefix();
-		QVariant owner = parentItem->GetData(OWNER);
-
-		for (size_t i = 0; i < response->num_common_prefixes; i++) {
-			ds3_str* rawCommonPrefix = response->common_prefixes[i];
-			// The order in which bucketData is filled must match
-			// Column
-			QList<QVariant> objectData;
-			DS3BrowserItem* object;
-
-			QString nextName = QString::fromUtf8(rawCommonPrefix->value);
-			nextName.replace(QRegularExpression("^" + prefix), "");
-			nextName.replace(QRegularExpression("/$"), "");
-			if (!currentCommonPrefixNames.contains(nextName)) {
-				objectData << nextName;
-				objectData << owner;
-				objectData << "--";
-				objectData << FOLDER;
-				objectData << "--";
-				object = new DS3BrowserItem(objectData,
-							    bucketName,
-							    prefix,
-							    parentItem);
-				newChildren << object;
-			}
+		if (fromCache && changed) {
+			RemoveCachedRows(parent);
+		}
+		if (!fromCache || changed) {
+			int startRow = rowCount(parent);
+			AppendBucketListing(parent, bucketName, prefix, response);
+			// The loading row fetchMore appended is always just
+			// before the new rows
+			RemoveLoadingRow(parent, startRow - 1);
 		}
+	} else {
+		RemoveLoadingRow(parent, rowCount(parent) - 1);
+	}
 
-		for (size_t i = 0; i < response->num_objects; i++) {
-			QString nextName;
-			char* rawCreated;
-			QDateTime createdDT;
-			QString created;
-			// The order in which bucketData is filled must match
-			// Column
-			QList<QVariant> objectData;
-			DS3BrowserItem* object;
+	delete watcher;
+	m_nodes.SetFetching(parentNode, false);
+	emit ListingFinished();
+}
 
-			ds3_object rawObject = response->objects[i];
+void
+DS3BrowserModel::HandleRefreshServiceResponse()
+{
+	LOG_DEBUG("HandleRefreshServiceResponse");
 
-			nextName = QString::fromUtf8(rawObject.name->value);
-			if (nextName == prefix) {
-				continue;
-			}
-			nextName.replace(QRegularExpression("^" + prefix), "");
-			objectData << nextName;
+	GetServiceWatcher* watcher = static_cast<GetServiceWatcher*>(sender());
+	RefreshState state = m_refreshes.take(watcher);
 
-			objectData << owner;
+	ServiceListing response;
+	bool hasResponse = false;
+	try {
+		if (!watcher->isCanceled()) {
+			response = watcher->result();
+			hasResponse = true;
+		}
+	}
+	catch (DS3Error& e) {
+		LOG_ERROR("ERROR:       LIST BUCKETS failed, "+e.ToString());
+	}
+	delete watcher;
 
-			objectData << (quint64)rawObject.size;
+	if (!hasResponse) {
+		// Leave the rows as they were
+		m_nodes.SetFetching(BrowserNodeStore::ROOT, false);
+		emit ListingFinished();
+		return;
+	}
 
-			objectData << OBJECT;
+	m_client->GetListingCache()->PutService(response);
+	MergeRefreshedRows(&state, GetServiceRows(response));
+	FinishRefresh(state, QString());
+}
 
-			if (rawObject.last_modified) {
-				rawCreated = rawObject.last_modified->value;
-				createdDT = QDateTime::fromString(QString::fromUtf8(rawCreated),
-								  REST_TIMESTAMP_FORMAT);
-				created = createdDT.toString(VIEW_TIMESTAMP_FORMAT);
-			}
-			objectData << created;
+void
+DS3BrowserModel::HandleRefreshBucketResponse()
+{
+	LOG_DEBUG("HandleRefreshBucketResponse");
 
-			object = new DS3BrowserItem(objectData,
-						    bucketName,
-						    prefix,
-						    parentItem);
-			newChildren << object;
-		}
+	GetBucketWatcher* watcher = static_cast<GetBucketWatcher*>(sender());
+	RefreshState state = m_refreshes.take(watcher);
 
-		if (response->next_marker) {
-			parentItem->SetNextMarker(QString::fromUtf8(response->next_marker->value));
+	BucketListing response;
+	bool hasResponse = false;
+	try {
+		if (!watcher->isCanceled()) {
+			response = watcher->result();
+			hasResponse = true;
 		}
-
-		if (response->is_truncated) {
-			DS3BrowserItem* pageBreak = new PageBreakItem(parentItem);
-			newChildren << pageBreak;
+	}
+	catch (DS3Error& e) {
+		QString msg;
+		if (e.GetStatusCode() == 404) {
+			msg = "Bucket \"" + state.bucketName + "\" does not exist";
+		} else {
+			msg = e.ToString();
 		}
+		LOG_ERROR("ERROR:       LIST OBJECTS failed, "+msg);
 	}
+	qint64 elapsed = watcher->GetElapsedInMs();
+	delete watcher;
 
-	int numNewChildren = newChildren.count();
-	int startRow = 0;
-	if (numNewChildren > 0) {
-		startRow = rowCount(parent);
-		beginInsertRows(parent, startRow, startRow + numNewChildren - 1);
-		for (int i = 0; i < numNewChildren; i++) {
-			parentItem->AppendChild(newChildren.at(i));
-		}
-		endInsertRows();
+	if (!state.parent.isValid()) {
+		// The parent was removed while it was being refreshed
+		return;
 	}
+	BrowserNodeStore::ID parentNode = IndexToNode(state.parent);
 
-	int loadingRow = startRow > 0 ? startRow - 1 : 0;
-	DS3BrowserItem* loadingItem = parentItem->GetChild(loadingRow);
-	if (loadingItem && loadingItem->IsLoadingItem()) {
-		removeRow(loadingRow, parent);
+	if (!hasResponse) {
+		// Leave the rows as they were
+		m_nodes.SetFetching(parentNode, false);
+		emit ListingFinished();
+		return;
 	}
 
-	if (response != NULL) {
-		ds3_free_bucket_response(response);
+	m_pageSizer.ReportListing(response.GetCommonPrefixes().size() +
+				  response.GetObjects().size(),
+				  elapsed);
+	if (state.marker.isEmpty()) {
+		m_client->GetListingCache()->PutBucket(state.bucketName,
+						       state.prefix,
+						       response);
+	}
+	MergeRefreshedRows(&state, GetBucketRows(state.prefix,
+						 m_nodes.GetOwner(parentNode),
+						 response));
+
+	// Keep relisting until everything the previous listing had loaded
+	// has been covered
+	QString nextMarker = GetNextPageMarker(QString(), response);
+	if (ShouldRefreshNextPage(nextMarker, state.stopMarker)) {
+		state.marker = nextMarker;
+		RefreshPage(state);
+		return;
 	}
-	delete watcher;
-	parentItem->SetFetching(false);
+	FinishRefresh(state, nextMarker);
 }
 
 // Model for searches
@@ -1040,60 +1196,42 @@ DS3SearchModel::fetchMore(const QModelIndex& parent)
 }
 
 void
-DS3SearchModel::AppendDS3SearchObject(ds3_search_object* obj, QString bucketName) {
-	// Data to go into new item in model
-	QList<QVariant> data;
-
+DS3SearchModel::AppendDS3SearchObject(const ListedObject& obj, QString bucketName) {
 	// Checks search results, bucketName!="" means files were found
-	if (bucketName != QString("")) {
-		QString name;
-		if (obj->name != NULL) {
-			name = "/"+bucketName+QString("/")+QString::fromUtf8(obj->name->value);
-		} else {
-			name = QString("");
-		}
-		data << name;
-
-		if (obj->owner != NULL && obj->owner->name != NULL) {
-			data << QString::fromUtf8(obj->owner->name->value);
-		} else {
-			data << QString("");
-		}
-
-		QString type(OBJECT);
-		if (name == "/"+bucketName+"/") {
-			type = BUCKET;
-		} else if (name.endsWith("/")) {
-			type = FOLDER;
-		}
+	if (bucketName == QString("")) {
+		m_nodes.Append(BrowserNodeStore::ROOT,
+				BrowserNodeStore::NO_RESULTS, QString(""));
+		return;
+	}
 
-		qulonglong size = obj->size;
-		// Always report the size for objects when the GetObjects
-		// response includes sizes since empty objects are valid
-		// and we'd want to report them as 0 bytes.
-		// Probably want to do something like:
-		//   if (type == OBJECT || size > 0) {
-		if (size > 0) {
-			data << size;
-		} else {
-			data << QString("--");
-		}
+	QString name;
+	if (!obj.GetName().isEmpty()) {
+		name = "/"+bucketName+QString("/")+obj.GetName();
+	} else {
+		name = QString("");
+	}
 
-		data << type;
+	BrowserNodeStore::Kind kind = BrowserNodeStore::OBJECT;
+	if (name == "/"+bucketName+"/") {
+		kind = BrowserNodeStore::BUCKET;
+	} else if (name.endsWith("/")) {
+		kind = BrowserNodeStore::FOLDER;
+	}
 
-		if (obj->last_modified != NULL) {
-			data << QDateTime::fromString(QString::fromUtf8(obj->last_modified->value), REST_TIMESTAMP_FORMAT).toString(VIEW_TIMESTAMP_FORMAT);
-		} else {
-			data << QString("");
-		}
+	uint64_t size = obj.GetSize();
+	// Always report the size for objects when the GetObjects
+	// response includes sizes since empty objects are valid
+	// and we'd want to report them as 0 bytes.
+	// Probably want to do something like:
+	//   if (type == OBJECT || size > 0) {
+	if (size == 0) {
+		size = BrowserNodeStore::NO_SIZE;
 	}
-	// Create the new item
-	DS3BrowserItem* newItem = new DS3BrowserItem(data,
-						     QString(""),
-						     QString(""),
-						     m_rootItem);
+
 	// Append it to the root
-	m_rootItem->AppendChild(newItem);
+	m_nodes.Append(BrowserNodeStore::ROOT, kind, name, QString(""),
+			QString(""), obj.GetOwner(), size,
+			ParseTimestamp(obj.GetLastModified()));
 }
 
 void
@@ -1112,11 +1250,11 @@ DS3SearchModel::Search(const QModelIndex& index,
 								   prefix,
 								   NULL);
 		connect(watcher, SIGNAL(finished()), this, SLOT(HandleGetObjectsResponse()));
-		QFuture<ds3_get_objects_response*> future = m_client->GetObjects(bucket,
-									         "",
-									         search,
-									         NO_TYPE,
-									         "");
+		QFuture<BucketListing> future = m_client->GetObjects(bucket,
+								     "",
+								     search,
+								     NO_TYPE,
+								     "");
 		watcher->setFuture(future);
 	}
 }
@@ -1136,22 +1274,26 @@ DS3SearchModel::HandleGetServiceResponse(QString search,
 	// Set index to the root index of the searched tree
 	QModelIndex index = m_searchedTree->rootIndex();
 
-	ds3_get_service_response* response = 0;
+	ServiceListing response;
+	bool hasResponse = false;
 	try {
-		response = watcher->result();
+		if (!watcher->isCanceled()) {
+			response = watcher->result();
+			hasResponse = true;
+		}
 	}
 	catch (DS3Error& e) {
 		LOG_ERROR("Error listing buckets - " + e.ToString());
 	}
 	// Checks to make sure that there is a response and that the search
 	// isn't empty
-	if (response && search != "") {
+	if (hasResponse && search != "") {
 		// Iterate through buckets
-		for (size_t i = 0; i < response->num_buckets; i++) {
+		const QList<ListedBucket>& buckets = response.GetBuckets();
+		for (int i = 0; i < buckets.size(); i++) {
 			QString name;
-			ds3_bucket rawBucket = response->buckets[i];
 
-			name = QString::fromUtf8(rawBucket.name->value);
+			name = buckets.at(i).GetName();
 			if (m_searchedModel->GetPath(index) != QString("/") &&
 			    !m_searchedModel->GetPath(index).contains(name)) {
 				continue;
@@ -1167,9 +1309,6 @@ DS3SearchModel::HandleGetServiceResponse(QString search,
 			Search(index, name, prefix, QString("%"+search+"%"));
 		}
 	}
-	if (response) {
-		ds3_free_service_response(response);
-	}
 }
 
 void
@@ -1177,10 +1316,14 @@ DS3SearchModel::HandleGetObjectsResponse()
 {
 	// Get the watcher and response
 	GetObjectsWatcher* watcher = static_cast<GetObjectsWatcher*>(sender());
-	ds3_get_objects_response* response = NULL;
+	BucketListing response;
+	bool hasResponse = false;
 	const QString& bucketName = watcher->GetBucketName();
 	try {
-		response = watcher->result();
+		if (!watcher->isCanceled()) {
+			response = watcher->result();
+			hasResponse = true;
+		}
 	}
 	catch (DS3Error& e) {
 		QString msg;
@@ -1192,12 +1335,13 @@ DS3SearchModel::HandleGetObjectsResponse()
 		LOG_ERROR("Error listing objects - " + msg);
 	}
 	// Checks that response isn't empty
-	if (response != NULL) {
-		for (size_t i = 0; i < response->num_objects; i++) {
+	if (hasResponse) {
+		const QList<ListedObject>& objects = response.GetObjects();
+		for (int i = 0; i < objects.size(); i++) {
 			// Increment the found count and add the object to the
 			// search model
 			m_searchFoundCount++;
-			AppendDS3SearchObject(response->objects[i], bucketName);
+			AppendDS3SearchObject(objects.at(i), bucketName);
 		}
 	}
 	bool found = true;
@@ -1208,14 +1352,12 @@ DS3SearchModel::HandleGetObjectsResponse()
 		// this to the user
 		if (m_searchFoundCount == 0) {
 			found = false;
-			DS3BrowserItem* noResultsItem = new NoSearchResultsItem(m_rootItem);
-			m_rootItem->AppendChild(noResultsItem);
+			m_nodes.Append(BrowserNodeStore::ROOT,
+					BrowserNodeStore::NO_RESULTS,
+					NO_RESULTS_TEXT);
 		}
 		emit DoneSearching(found);
 	}
 
-	if (response) {
-		ds3_free_objects_response(response);
-	}
 	delete watcher;
 }
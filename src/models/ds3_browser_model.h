@@ -18,17 +18,24 @@
 #define DS3_BROWSER_MODEL_H
 
 #include <QAbstractItemModel>
+#include <QHash>
+#include <QIcon>
 #include <QList>
 #include <QModelIndexList>
+#include <QPersistentModelIndex>
+#include <QSet>
 #include <QStringList>
 #include <QTreeView>
+#include <QVector>
 #include <ds3.h>
 
 #include "lib/watchers/get_service_watcher.h"
+#include "lib/list_page_sizer.h"
 #include "lib/watchers/get_objects_watcher.h"
+#include "models/browser_node_store.h"
+#include "models/listing.h"
 
 class Client;
-class DS3BrowserItem;
 
 class DS3BrowserModel : public QAbstractItemModel
 {
@@ -75,23 +82,158 @@ public:
 	QString GetName(const QModelIndex& index) const;
 	QString GetFullName(const QModelIndex& index) const;
 	QString GetPath(const QModelIndex& index) const;
+	// The bucket and object name prefix that files dropped on a bucket
+	// or folder are PUT to
+	void GetDropDestination(const QModelIndex& parentIndex,
+				QString* bucketName, QString* prefix) const;
+	// Relist an already loaded bucket or folder, as many pages as were
+	// loaded before, and apply the differences to its existing rows.
+	// Rows are updated in place, so expanded folders, the selection and
+	// deeper pages are kept.  Loaded subfolders are refreshed in turn.
 	void Refresh(const QModelIndex& rootIndex = QModelIndex());
 	void SetView(QTreeView* view);
 
+	// The next marker a bucket or folder keeps once a page of its
+	// listing has been appended.  It's empty once the listing reached
+	// its end.
+	static QString GetNextPageMarker(const QString& marker,
+					 const BucketListing& listing);
+	// Whether a refresh, whose last relisted page ended at nextMarker,
+	// has yet to cover everything the previous listing loaded, which
+	// stopped at stopMarker
+	static bool ShouldRefreshNextPage(const QString& nextMarker,
+					  const QString& stopMarker);
+
+signals:
+	// A bucket or folder listing request finished and the parent is no
+	// longer fetching
+	void ListingFinished();
+
 public slots:
 	void HandleGetServiceResponse();
 	void HandleGetBucketResponse();
+	void HandleRefreshServiceResponse();
+	void HandleRefreshBucketResponse();
 
 protected:
 	Client* m_client;
-	DS3BrowserItem* m_rootItem;
-	DS3BrowserItem* IndexToItem(const QModelIndex& index) const;
+	BrowserNodeStore m_nodes;
+	// The invalid index maps to BrowserNodeStore::ROOT
+	BrowserNodeStore::ID IndexToNode(const QModelIndex& index) const;
+	// Rows can move while a listing is outstanding, so responses find
+	// their parent's index again from its node
+	QModelIndex NodeToIndex(BrowserNodeStore::ID node) const;
 
 private:
+	// The display strings of a node's size and created columns
+	struct FormattedRow
+	{
+		BrowserNodeStore::ID node;
+		QString size;
+		QString created;
+	};
+
+	// A bucket, folder or object row read from a listing
+	struct ListedRow
+	{
+		BrowserNodeStore::Kind kind;
+		QString name;
+		QString owner;
+		uint64_t size;
+		qint64 created;
+	};
+
+	// New rows of a relisted page that go in to the same place and so
+	// are inserted together.  row is where they go among the rows as
+	// they were before any of the page's rows were inserted.
+	struct InsertRun
+	{
+		int row;
+		int first;
+		int count;
+
+		bool operator<(const InsertRun& other) const
+		{
+			return row < other.row;
+		}
+	};
+
+	// A Refresh's relisting of one bucket, folder or the root
+	struct RefreshState
+	{
+		// Becomes invalid if the parent is removed mid refresh
+		QPersistentModelIndex parent;
+		bool isRoot;
+		QString bucketName;
+		QString prefix;
+		// The marker of the page being relisted
+		QString marker;
+		// Where the previous listing stopped paging, empty if it
+		// reached the end
+		QString stopMarker;
+		// The parent's rows keyed by kind and name
+		QHash<QString, BrowserNodeStore::ID> rows;
+		QSet<BrowserNodeStore::ID> seen;
+	};
+
+	static const int FORMAT_CACHE_SIZE;
+
+	static QList<ListedRow> GetServiceRows(const ServiceListing& listing);
+	static QList<ListedRow> GetBucketRows(const QString& prefix,
+					      const QString& owner,
+					      const BucketListing& listing);
+	static QString GetRowKey(BrowserNodeStore::Kind kind,
+				 const QString& name);
+
+	// The prefix a bucket or folder's objects are listed with
+	QString GetListingPrefix(BrowserNodeStore::ID node) const;
+
 	void FetchMoreBuckets(const QModelIndex& parent);
 	void FetchMoreObjects(const QModelIndex& parent);
+	void AppendServiceListing(const QModelIndex& parent,
+				  const ServiceListing& listing);
+	void AppendBucketListing(const QModelIndex& parent,
+				 const QString& bucketName,
+				 const QString& prefix,
+				 const BucketListing& listing);
+	// Remove the loading row fetchMore appended if it's at row
+	void RemoveLoadingRow(const QModelIndex& parent, int row);
+	// Remove the rows a cached listing added once the listing is found
+	// to be out of date
+	void RemoveCachedRows(const QModelIndex& parent);
+	void RefreshPage(const RefreshState& state);
+	// Update the rows of a relisted page that already exist and insert
+	// the ones that don't
+	void MergeRefreshedRows(RefreshState* state,
+				const QList<ListedRow>& rows);
+	// Remove the rows the relisting didn't see, fix up the page break
+	// and refresh the loaded buckets and folders below
+	void FinishRefresh(const RefreshState& state,
+			   const QString& nextMarker);
+	// Where a row that wasn't there before is inserted.  New rows go
+	// before the first row of the same kind that sorts after them, and
+	// never after the page break.  sameKindRows are the rows of the new
+	// row's kind, which are in name order, so they're binary searched.
+	int GetInsertRow(BrowserNodeStore::ID parentNode,
+			 const QVector<int>& sameKindRows,
+			 int pageBreakRow,
+			 const QString& name) const;
+	// Rows are only formatted the first time they're displayed.  The
+	// strings are kept in a small cache, indexed by node ID, so
+	// repainting or scrolling back over rows doesn't format them again.
+	const FormattedRow& GetFormattedRow(BrowserNodeStore::ID node) const;
+	// Must be called whenever nodes are removed since their IDs are
+	// reused
+	void ClearFormatCache();
 
 	QTreeView* m_view;
+	QHash<QObject*, RefreshState> m_refreshes;
+	ListPageSizer m_pageSizer;
+	mutable QVector<FormattedRow> m_formatCache;
+	// Shared by every row rather than loaded for each painted cell
+	const QIcon m_bucketIcon;
+	const QIcon m_folderIcon;
+	const QIcon m_objectIcon;
 };
 
 class DS3SearchModel : public DS3BrowserModel
@@ -115,7 +257,7 @@ private:
 	size_t m_searchFoundCount;
 	DS3BrowserModel* m_searchedModel;
 	QTreeView* m_searchedTree;
-	void AppendDS3SearchObject(ds3_search_object* obj, QString bucketName);
+	void AppendDS3SearchObject(const ListedObject& obj, QString bucketName);
 	void Search(const QModelIndex& index, QString bucket, QString prefix, QString search);
 };
 
@@ -125,10 +267,22 @@ DS3BrowserModel::SetView(QTreeView* view)
 	m_view = view;
 }
 
-inline DS3BrowserItem*
-DS3BrowserModel::IndexToItem(const QModelIndex& index) const
+inline BrowserNodeStore::ID
+DS3BrowserModel::IndexToNode(const QModelIndex& index) const
+{
+	if (!index.isValid()) {
+		return BrowserNodeStore::ROOT;
+	}
+	return static_cast<BrowserNodeStore::ID>(index.internalId());
+}
+
+inline QModelIndex
+DS3BrowserModel::NodeToIndex(BrowserNodeStore::ID node) const
 {
-	return static_cast<DS3BrowserItem*>(index.internalPointer());
+	if (node == BrowserNodeStore::ROOT) {
+		return QModelIndex();
+	}
+	return createIndex(m_nodes.GetRow(node), 0, (quintptr)node);
 }
 
 #endif
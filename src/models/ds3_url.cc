@@ -15,11 +15,14 @@
  */
 
 #include <QRegularExpression>
+#include <QUrlQuery>
 
 #include "models/ds3_url.h"
 
 const QString DS3URL::PATH_REGEX = "^/?([^/]+)/?(?:/(.*))?$";
 
+static const QString SIZE_QUERY_ITEM = "size";
+
 DS3URL::DS3URL()
 	: QUrl()
 {
@@ -85,3 +88,27 @@ DS3URL::IsBucketOrFolder() const
 	QString objName = GetObjectName();
 	return (objName.isEmpty() || path().endsWith("/"));
 }
+
+bool
+DS3URL::GetObjectSize(uint64_t* size) const
+{
+	QUrlQuery urlQuery(*this);
+	if (!urlQuery.hasQueryItem(SIZE_QUERY_ITEM)) {
+		return false;
+	}
+	bool ok = false;
+	qulonglong value = urlQuery.queryItemValue(SIZE_QUERY_ITEM).toULongLong(&ok);
+	if (ok) {
+		*size = value;
+	}
+	return ok;
+}
+
+void
+DS3URL::SetObjectSize(uint64_t size)
+{
+	QUrlQuery urlQuery(*this);
+	urlQuery.removeAllQueryItems(SIZE_QUERY_ITEM);
+	urlQuery.addQueryItem(SIZE_QUERY_ITEM, QString::number(size));
+	setQuery(urlQuery);
+}
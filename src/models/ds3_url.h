@@ -17,6 +17,7 @@
 #ifndef DS3_URL_H
 #define DS3_URL_H
 
+#include <stdint.h>
 #include <QString>
 #include <QUrl>
 
@@ -36,6 +37,11 @@ public:
 	QString GetLastPathPart() const;
 	bool IsBucket() const;
 	bool IsBucketOrFolder() const;
+	// The object's size, if it was already known when the URL was made
+	// (e.g. from the DS3 browser's listing).  It's carried in the query
+	// so it survives drag and drop and being sent to the daemon.
+	bool GetObjectSize(uint64_t* size) const;
+	void SetObjectSize(uint64_t size);
 };
 
 #endif
@@ -49,7 +49,7 @@ HostBrowserModel::dropMimeData(const QMimeData* data,
 
 	QList<QUrl> urls = mimeData->GetDS3URLs();
 	QString destination = filePath(parentIndex);
-	m_client->BulkGet(urls, destination);
+	m_client->BulkGet(urls, destination, TransferFilter::FromSettings());
 
 	return true;
 }
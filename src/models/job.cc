@@ -21,10 +21,73 @@
 Job::Job()
 	: m_state(INITIALIZING),
 	  m_size(0),
-	  m_bytesTransferred(0)
+	  m_bytesTransferred(0),
+	  m_concurrency(0),
+	  m_numFailedObjects(0)
 {
 }
 
+QDataStream&
+operator<<(QDataStream& out, const Job& job)
+{
+	out << job.m_id << job.m_sessionID << (qint32)job.m_type << job.m_start
+	    << job.m_transferStart << (qint32)job.m_state << job.m_host
+	    << job.m_urls << job.m_destination << (quint64)job.m_size
+	    << (quint64)job.m_bytesTransferred << (qint32)job.m_concurrency
+	    << (qint32)job.m_chunkWaits.count << (qint64)job.m_chunkWaits.total
+	    << (qint32)job.m_chunkWaits.longest << (qint32)job.m_chunkWaits.last
+	    << (quint64)job.m_numFailedObjects;
+	return out;
+}
+
+QDataStream&
+operator>>(QDataStream& in, Job& job)
+{
+	qint32 type, state, concurrency, numChunkWaits, longestChunkWait;
+	qint32 lastChunkWait;
+	qint64 totalChunkWait;
+	quint64 size, bytesTransferred, numFailedObjects;
+	in >> job.m_id >> job.m_sessionID >> type >> job.m_start >> job.m_transferStart >> state
+	   >> job.m_host >> job.m_urls >> job.m_destination >> size
+	   >> bytesTransferred >> concurrency >> numChunkWaits >> totalChunkWait
+	   >> longestChunkWait >> lastChunkWait >> numFailedObjects;
+	job.m_type = static_cast<Job::Type>(type);
+	job.m_state = static_cast<Job::State>(state);
+	job.m_size = size;
+	job.m_bytesTransferred = bytesTransferred;
+	job.m_concurrency = concurrency;
+	job.m_chunkWaits.count = numChunkWaits;
+	job.m_chunkWaits.total = totalChunkWait;
+	job.m_chunkWaits.longest = longestChunkWait;
+	job.m_chunkWaits.last = lastChunkWait;
+	job.m_numFailedObjects = numFailedObjects;
+	return in;
+}
+
+Job::ChunkWaits::ChunkWaits()
+	: count(0),
+	  total(0),
+	  longest(0),
+	  last(0)
+{
+}
+
+void
+Job::ChunkWaits::Add(int seconds)
+{
+	count++;
+	total += seconds;
+	longest = qMax(longest, seconds);
+	last = seconds;
+}
+
+bool
+Job::ChunkWaits::operator==(const ChunkWaits& other) const
+{
+	return (count == other.count && total == other.total &&
+		longest == other.longest && last == other.last);
+}
+
 const QString
 Job::GetURLs() const
 {
@@ -51,3 +114,25 @@ Job::GetProgress() const
 	return progress;
 }
 
+bool
+Job::HasSameProgress(const Job& other) const
+{
+	return (m_state == other.m_state &&
+		m_size == other.m_size &&
+		m_bytesTransferred == other.m_bytesTransferred &&
+		m_concurrency == other.m_concurrency &&
+		m_numFailedObjects == other.m_numFailedObjects &&
+		m_chunkWaits == other.m_chunkWaits);
+}
+
+void
+Job::UpdateProgress(const Job& progress)
+{
+	m_transferStart = progress.m_transferStart;
+	m_state = progress.m_state;
+	m_size = progress.m_size;
+	m_bytesTransferred = progress.m_bytesTransferred;
+	m_concurrency = progress.m_concurrency;
+	m_chunkWaits = progress.m_chunkWaits;
+	m_numFailedObjects = progress.m_numFailedObjects;
+}
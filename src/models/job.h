@@ -18,6 +18,7 @@
 #define JOB_H
 
 #include <stdint.h>
+#include <QDataStream>
 #include <QDateTime>
 #include <QList>
 #include <QMetaType>
@@ -50,23 +51,57 @@ public:
 		     CANCELED,
 		     FINISHED };
 
-	enum Type { GET, PUT };
+	// Not DELETE, which is a macro on Windows
+	enum Type { GET, PUT, DELETE_OBJECTS };
+
+	// How many seconds a job's chunks waited on the server (e.g. being
+	// staged from tape) before they could be transferred, summed up so
+	// it stays the same size however many chunks the job has
+	struct ChunkWaits
+	{
+		ChunkWaits();
+		void Add(int seconds);
+		bool operator==(const ChunkWaits& other) const;
+
+		int count;
+		qint64 total;
+		int longest;
+		int last;
+	};
 
 	const QUuid GetID() const;
+	// The GUI session that submitted the job to the transfer daemon, if
+	// any.  Jobs run by the GUI itself don't have one.
+	const QUuid& GetSessionID() const;
 	Type GetType() const;
 	const QDateTime& GetStart() const;
 	const QDateTime& GetTransferStart() const;
 	State GetState() const;
 	const QString& GetHost() const;
 	const QString GetURLs() const;
+	// Progress updates for a job that's already been reported leave out
+	// its URLs since they don't change
+	bool HasURLs() const;
 	const QString& GetDestination() const;
 	uint64_t GetSize() const;
 	uint64_t GetBytesTransferred() const;
+	// The number of object transfers the job currently allows in flight
+	// at once
+	int GetConcurrency() const;
+	const ChunkWaits& GetChunkWaits() const;
+	// The number of objects that couldn't be transferred
+	uint64_t GetNumFailedObjects() const;
 	int GetProgress() const;
 	bool IsFinished() const;
 	bool WasCanceled() const;
+	// Whether other reports the same state and progress as this job
+	bool HasSameProgress(const Job& other) const;
+	// Take the state and progress from a later update of this job,
+	// keeping everything else
+	void UpdateProgress(const Job& progress);
 
 	void SetID(const QUuid& id);
+	void SetSessionID(const QUuid& sessionID);
 	void SetType(Type type);
 	void SetStart(const QDateTime& start);
 	void SetTransferStart(const QDateTime& start);
@@ -76,9 +111,17 @@ public:
 	void SetDestination(const QString& destination);
 	void SetSize(uint64_t);
 	void SetBytesTransferred(uint64_t);
+	void SetConcurrency(int concurrency);
+	void SetChunkWaits(const ChunkWaits& chunkWaits);
+	void SetNumFailedObjects(uint64_t numFailedObjects);
+
+	// Used to send jobs between the GUI and the transfer daemon
+	friend QDataStream& operator<<(QDataStream& out, const Job& job);
+	friend QDataStream& operator>>(QDataStream& in, Job& job);
 
 private:
 	QUuid m_id;
+	QUuid m_sessionID;
 	Type m_type;
 	QDateTime m_start;
 	QDateTime m_transferStart;
@@ -88,6 +131,9 @@ private:
 	QString m_destination;
 	uint64_t m_size;
 	uint64_t m_bytesTransferred;
+	int m_concurrency;
+	ChunkWaits m_chunkWaits;
+	uint64_t m_numFailedObjects;
 };
 
 // Job is used as an argument in a signal/slot connection
@@ -99,6 +145,12 @@ Job::GetID() const
 	return m_id;
 }
 
+inline const QUuid&
+Job::GetSessionID() const
+{
+	return m_sessionID;
+}
+
 inline Job::Type
 Job::GetType() const
 {
@@ -129,6 +181,12 @@ Job::GetHost() const
 	return m_host;
 }
 
+inline bool
+Job::HasURLs() const
+{
+	return !m_urls.isEmpty();
+}
+
 inline const QString&
 Job::GetDestination() const
 {
@@ -147,6 +205,24 @@ Job::GetBytesTransferred() const
 	return m_bytesTransferred;
 }
 
+inline int
+Job::GetConcurrency() const
+{
+	return m_concurrency;
+}
+
+inline const Job::ChunkWaits&
+Job::GetChunkWaits() const
+{
+	return m_chunkWaits;
+}
+
+inline uint64_t
+Job::GetNumFailedObjects() const
+{
+	return m_numFailedObjects;
+}
+
 inline bool Job::IsFinished() const
 {
 	return m_state == FINISHED;
@@ -163,6 +239,12 @@ Job::SetID(const QUuid& id)
 	m_id = id;
 }
 
+inline void
+Job::SetSessionID(const QUuid& sessionID)
+{
+	m_sessionID = sessionID;
+}
+
 inline void
 Job::SetType(Type type)
 {
@@ -217,4 +299,22 @@ Job::SetBytesTransferred(uint64_t bytesTransferred)
 	m_bytesTransferred = bytesTransferred;
 }
 
+inline void
+Job::SetConcurrency(int concurrency)
+{
+	m_concurrency = concurrency;
+}
+
+inline void
+Job::SetChunkWaits(const ChunkWaits& chunkWaits)
+{
+	m_chunkWaits = chunkWaits;
+}
+
+inline void
+Job::SetNumFailedObjects(uint64_t numFailedObjects)
+{
+	m_numFailedObjects = numFailedObjects;
+}
+
 #endif
@@ -0,0 +1,286 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef LISTING_H
+#define LISTING_H
+
+#include <stdint.h>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+// ListedBucket, ListedObject, ServiceListing and BucketListing are value
+// versions of the C SDK's get service/bucket/objects responses.  They're
+// produced by RequestEngine and, unlike the C SDK structs, can be freely
+// copied across threads and never have to be explicitly freed.
+//
+// Timestamps are kept in their raw REST form (e.g. 2015-05-18T15:02:11.000Z)
+// and are only converted by whoever displays them.
+
+class ListedBucket
+{
+public:
+	ListedBucket();
+
+	const QString& GetName() const;
+	const QString& GetCreationDate() const;
+
+	void SetName(const QString& name);
+	void SetCreationDate(const QString& creationDate);
+
+private:
+	QString m_name;
+	QString m_creationDate;
+};
+
+class ListedObject
+{
+public:
+	ListedObject();
+
+	const QString& GetName() const;
+	const QString& GetOwner() const;
+	uint64_t GetSize() const;
+	const QString& GetLastModified() const;
+
+	void SetName(const QString& name);
+	void SetOwner(const QString& owner);
+	void SetSize(uint64_t size);
+	void SetLastModified(const QString& lastModified);
+
+private:
+	QString m_name;
+	QString m_owner;
+	uint64_t m_size;
+	QString m_lastModified;
+};
+
+class ServiceListing
+{
+public:
+	const QString& GetOwner() const;
+	const QList<ListedBucket>& GetBuckets() const;
+
+	void SetOwner(const QString& owner);
+	void AppendBucket(const ListedBucket& bucket);
+
+private:
+	QString m_owner;
+	QList<ListedBucket> m_buckets;
+};
+
+// BucketListing is used for both get bucket and get objects (search)
+// responses.  The latter never includes common prefixes or a marker.
+class BucketListing
+{
+public:
+	BucketListing();
+
+	const QList<ListedObject>& GetObjects() const;
+	const QStringList& GetCommonPrefixes() const;
+	const QString& GetNextMarker() const;
+	bool IsTruncated() const;
+
+	void AppendObject(const ListedObject& object);
+	void AppendCommonPrefix(const QString& prefix);
+	void SetNextMarker(const QString& nextMarker);
+	void SetTruncated(bool truncated);
+
+private:
+	QList<ListedObject> m_objects;
+	QStringList m_commonPrefixes;
+	QString m_nextMarker;
+	bool m_truncated;
+};
+
+//
+// ListedBucket
+//
+
+inline
+ListedBucket::ListedBucket()
+{
+}
+
+inline const QString&
+ListedBucket::GetName() const
+{
+	return m_name;
+}
+
+inline const QString&
+ListedBucket::GetCreationDate() const
+{
+	return m_creationDate;
+}
+
+inline void
+ListedBucket::SetName(const QString& name)
+{
+	m_name = name;
+}
+
+inline void
+ListedBucket::SetCreationDate(const QString& creationDate)
+{
+	m_creationDate = creationDate;
+}
+
+//
+// ListedObject
+//
+
+inline
+ListedObject::ListedObject()
+	: m_size(0)
+{
+}
+
+inline const QString&
+ListedObject::GetName() const
+{
+	return m_name;
+}
+
+inline const QString&
+ListedObject::GetOwner() const
+{
+	return m_owner;
+}
+
+inline uint64_t
+ListedObject::GetSize() const
+{
+	return m_size;
+}
+
+inline const QString&
+ListedObject::GetLastModified() const
+{
+	return m_lastModified;
+}
+
+inline void
+ListedObject::SetName(const QString& name)
+{
+	m_name = name;
+}
+
+inline void
+ListedObject::SetOwner(const QString& owner)
+{
+	m_owner = owner;
+}
+
+inline void
+ListedObject::SetSize(uint64_t size)
+{
+	m_size = size;
+}
+
+inline void
+ListedObject::SetLastModified(const QString& lastModified)
+{
+	m_lastModified = lastModified;
+}
+
+//
+// ServiceListing
+//
+
+inline const QString&
+ServiceListing::GetOwner() const
+{
+	return m_owner;
+}
+
+inline const QList<ListedBucket>&
+ServiceListing::GetBuckets() const
+{
+	return m_buckets;
+}
+
+inline void
+ServiceListing::SetOwner(const QString& owner)
+{
+	m_owner = owner;
+}
+
+inline void
+ServiceListing::AppendBucket(const ListedBucket& bucket)
+{
+	m_buckets << bucket;
+}
+
+//
+// BucketListing
+//
+
+inline
+BucketListing::BucketListing()
+	: m_truncated(false)
+{
+}
+
+inline const QList<ListedObject>&
+BucketListing::GetObjects() const
+{
+	return m_objects;
+}
+
+inline const QStringList&
+BucketListing::GetCommonPrefixes() const
+{
+	return m_commonPrefixes;
+}
+
+inline const QString&
+BucketListing::GetNextMarker() const
+{
+	return m_nextMarker;
+}
+
+inline bool
+BucketListing::IsTruncated() const
+{
+	return m_truncated;
+}
+
+inline void
+BucketListing::AppendObject(const ListedObject& object)
+{
+	m_objects << object;
+}
+
+inline void
+BucketListing::AppendCommonPrefix(const QString& prefix)
+{
+	m_commonPrefixes << prefix;
+}
+
+inline void
+BucketListing::SetNextMarker(const QString& nextMarker)
+{
+	m_nextMarker = nextMarker;
+}
+
+inline void
+BucketListing::SetTruncated(bool truncated)
+{
+	m_truncated = truncated;
+}
+
+#endif
@@ -23,3 +23,33 @@ Session::Session()
 	  m_withCertificateVerification(false)
 {
 }
+
+QDataStream&
+operator<<(QDataStream& out, const Session& session)
+{
+	out << session.GetHost() << (qint32)session.GetProtocol()
+	    << session.GetPort() << session.GetDataHosts()
+	    << session.GetProxy() << session.GetWithCertificateVerification()
+	    << session.GetAccessId() << session.GetSecretKey();
+	return out;
+}
+
+QDataStream&
+operator>>(QDataStream& in, Session& session)
+{
+	QString host, port, proxy, accessId, secretKey;
+	qint32 protocol;
+	QStringList dataHosts;
+	bool verify;
+	in >> host >> protocol >> port >> dataHosts >> proxy >> verify
+	   >> accessId >> secretKey;
+	session.SetHost(host);
+	session.SetProtocol((int)protocol);
+	session.SetPort(port);
+	session.SetDataHosts(dataHosts);
+	session.SetProxy(proxy);
+	session.SetWithCertificateVerification(verify);
+	session.SetAccessId(accessId);
+	session.SetSecretKey(secretKey);
+	return in;
+}
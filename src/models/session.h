@@ -17,7 +17,9 @@
 #ifndef SESSION_H
 #define SESSION_H
 
+#include <QDataStream>
 #include <QString>
+#include <QStringList>
 
 // Session, a model that represents the data necessary to setup a
 // host<->DS3 session.
@@ -40,6 +42,12 @@ public:
 	QString GetPort() const;
 	void SetPort(const QString& port);
 
+	// Additional BlackPearl data interfaces (DNS names or IP addresses)
+	// that object data can be striped across.  They're reached with the
+	// same protocol and port as the primary host.
+	QStringList GetDataHosts() const;
+	void SetDataHosts(const QStringList& dataHosts);
+
 	QString GetProxy() const;
 	void SetProxy(const QString& proxy);
 
@@ -56,6 +64,7 @@ private:
 	QString m_host;
 	Protocol m_protocol;
 	QString m_port;
+	QStringList m_dataHosts;
 	QString m_proxy;
 	// Whether or not SSL certificates should be verified.  This is only
 	// applicable when using HTTPS.  If this is set to true, the user
@@ -66,6 +75,10 @@ private:
 	QString m_secretKey;
 };
 
+// Used to send sessions from the GUI to the transfer daemon
+QDataStream& operator<<(QDataStream& out, const Session& session);
+QDataStream& operator>>(QDataStream& in, Session& session);
+
 inline QString
 Session::GetHost() const
 {
@@ -114,6 +127,18 @@ Session::SetPort(const QString& port)
 	m_port = port;
 }
 
+inline QStringList
+Session::GetDataHosts() const
+{
+	return m_dataHosts;
+}
+
+inline void
+Session::SetDataHosts(const QStringList& dataHosts)
+{
+	m_dataHosts = dataHosts;
+}
+
 inline QString
 Session::GetProxy() const
 {
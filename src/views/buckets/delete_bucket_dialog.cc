@@ -23,11 +23,12 @@
 DeleteBucketDialog::DeleteBucketDialog(Client* client,
 				       const QString& bucketName,
 				       QWidget* parent)
-	: DS3DeleteDialog(client, bucketName, false, parent)
+	: DS3DeleteDialog(client, bucketName, true, parent)
 {
 	setWindowTitle("Delete Bucket");
 	m_warning->setText("This action will delete the \"" + bucketName +
-			   "\". Are you sure you wish to continue?");
+			   "\" bucket and every object in it. Are you sure " \
+			   "you wish to continue?");
 }
 
 bool
@@ -50,7 +51,8 @@ DeleteBucketDialog::Delete()
 		case 409:
 			body = e.GetErrorBody();
 			if (body.contains("BUCKET_NOT_EMPTY")) {
-				msg = "Only empty buckets can be deleted";
+				m_client->BulkDelete(m_bucketName, QStringList(), true);
+				return true;
 			}
 			break;
 		}
@@ -21,10 +21,10 @@
 
 #include "views/ds3_delete_dialog.h"
 
-// A DS3DeleteDialog for deleting buckets.  Since the AWS delete bucket
-// API only supports deleting empty buckets, the user is not forced
-// to type in the confirmation word.  If we ever support deleting non-empty
-// buckets, this dialog should be changed to require the confirmation.
+// A DS3DeleteDialog for deleting buckets.  The AWS delete bucket API only
+// supports deleting empty buckets so a non-empty bucket's objects are
+// deleted by a background job (see Client::BulkDelete) that deletes the
+// bucket last.  Thus, the user is forced to type in the confirmation word.
 class DeleteBucketDialog : public DS3DeleteDialog
 {
 public:
@@ -14,10 +14,16 @@
  * *****************************************************************************
  */
 
+#include <QFileDialog>
+#include <QFutureInterface>
 #include <QMenu>
+#include <QScrollBar>
+#include <QTimer>
 
 #include "lib/client.h"
+#include "lib/listing_cache.h"
 #include "lib/logger.h"
+#include "lib/mime_data.h"
 #include "models/ds3_browser_model.h"
 #include "models/session.h"
 #include "views/ds3_delete_dialog.h"
@@ -29,10 +35,15 @@
 
 static const QString BUCKET = "Bucket";
 
+// How far past the bottom of the view a page break can be and still have
+// its next page requested
+static const int PREFETCH_ROWS = 200;
+
 DS3Browser::DS3Browser(Client* client, JobsView* jobsView,
 		       QWidget* parent, Qt::WindowFlags flags)
 	: Browser(client, parent, flags),
-	  m_jobsView(jobsView)
+	  m_jobsView(jobsView),
+	  m_prefetchScheduled(false)
 {
 	AddCustomToolBarActions();
 
@@ -60,13 +71,21 @@ DS3Browser::DS3Browser(Client* client, JobsView* jobsView,
 
 	connect(m_searchBar, SIGNAL(returnPressed()),
 		this, SLOT(BeginSearch()));
+
+	connect(m_treeView->verticalScrollBar(), SIGNAL(valueChanged(int)),
+		this, SLOT(SchedulePrefetch()));
+	connect(m_treeView, SIGNAL(expanded(const QModelIndex&)),
+		this, SLOT(SchedulePrefetch()));
+	connect(m_model, SIGNAL(ListingFinished()),
+		this, SLOT(SchedulePrefetch()));
 }
 
 void
 DS3Browser::HandleJobUpdate(const Job job)
 {
 	Job::State state = job.GetState();
-	if (state == Job::FINISHED) {
+	if (state == Job::FINISHED ||
+	    (state == Job::CANCELED && job.GetType() == Job::DELETE_OBJECTS)) {
 		Refresh();
 	}
 }
@@ -115,6 +134,7 @@ DS3Browser::OnContextMenuRequested(const QPoint& /*pos*/)
 	QMenu menu;
 	QAction newBucketAction("New Bucket", &menu);
 	QAction deleteAction("Delete", &menu);
+	QAction archiveAction("Download to Archive...", &menu);
 
 	QModelIndex index = m_treeView->rootIndex();
 	bool atBucketListingLevel = !index.isValid();
@@ -123,6 +143,7 @@ DS3Browser::OnContextMenuRequested(const QPoint& /*pos*/)
 	}
 
 	menu.addAction(&deleteAction);
+	menu.addAction(&archiveAction);
 	if (m_treeView->selectionModel()->selectedRows().count() == 0) {
 		// We could also disable the delete action for other conditions
 		// (selecting a folder object), however, we don't currently
@@ -131,6 +152,7 @@ DS3Browser::OnContextMenuRequested(const QPoint& /*pos*/)
 		// add a tooltip but we can't add a tooltip to a QAction that's
 		// in a QMenu.
 		deleteAction.setEnabled(false);
+		archiveAction.setEnabled(false);
 	}
 
 	QAction* selectedAction = menu.exec(QCursor::pos());
@@ -142,6 +164,8 @@ DS3Browser::OnContextMenuRequested(const QPoint& /*pos*/)
 		CreateBucket();
 	} else if (selectedAction == &deleteAction) {
 		DeleteSelected();
+	} else if (selectedAction == &archiveAction) {
+		ArchiveSelected();
 	}
 }
 
@@ -152,6 +176,7 @@ DS3Browser::OnModelItemDoubleClick(const QModelIndex& index)
 		QString path = IndexToPath(index);
 		m_treeView->setRootIndex(index);
 		UpdatePathLabel(path);
+		SchedulePrefetch();
 	}
 }
 
@@ -172,13 +197,51 @@ DS3Browser::Refresh()
 void
 DS3Browser::OnModelItemClick(const QModelIndex& index)
 {
-	if (m_model->IsPageBreak(index)) {
+	// A refresh of the parent may still be relisting the page
+	if (m_model->IsPageBreak(index) &&
+	    !m_model->IsFetching(index.parent())) {
 		m_model->fetchMore(index.parent());
 	}
 
 	emit Transferable();
 }
 
+void
+DS3Browser::SchedulePrefetch()
+{
+	if (m_prefetchScheduled) {
+		return;
+	}
+	m_prefetchScheduled = true;
+	QTimer::singleShot(0, this, SLOT(PrefetchPages()));
+}
+
+void
+DS3Browser::PrefetchPages()
+{
+	m_prefetchScheduled = false;
+
+	QModelIndex index = m_treeView->indexAt(QPoint(0, 0));
+	if (!index.isValid()) {
+		return;
+	}
+
+	int rowHeight = qMax(m_treeView->visualRect(index).height(), 1);
+	int numRows = m_treeView->viewport()->height() / rowHeight + PREFETCH_ROWS;
+	for (int i = 0; i < numRows && index.isValid(); i++) {
+		if (m_model->IsPageBreak(index)) {
+			QModelIndex parent = index.parent();
+			if (!m_model->IsFetching(parent)) {
+				// This removes the page break so stop walking.
+				// The listing finishing schedules another pass.
+				m_model->fetchMore(parent);
+				return;
+			}
+		}
+		index = m_treeView->indexBelow(index);
+	}
+}
+
 void
 DS3Browser::CreateBucket()
 {
@@ -204,7 +267,7 @@ DS3Browser::DeleteSelected()
 	DS3DeleteDialog* dialog;
 
 	QString bucketName = m_model->GetBucketName(selectedIndex);
-	QStringList objectList, folderList;
+	QStringList objectList;
 	for (int i=0; i<selectedIndexes.size(); i++) {
 		if (m_model->IsBucket(selectedIndexes[i])) {
 			QString name = m_model->GetFullName(selectedIndexes[i]);
@@ -215,7 +278,6 @@ DS3Browser::DeleteSelected()
 			delete dialog;
 			return;
 		} else if (m_model->IsFolder(selectedIndexes[i])) {
-			folderList << m_model->GetFullName(selectedIndexes[i]);
 			objectList << m_model->GetFullName(selectedIndexes[i])+"/";
 		} else {
 			objectList << m_model->GetFullName(selectedIndexes[i]);
@@ -225,16 +287,30 @@ DS3Browser::DeleteSelected()
 
 	if(objectList.size() > 0) {
 		dialog = new DeleteObjectsDialog(m_client, bucketName, objectList);
-		if (dialog->exec() == QDialog::Accepted) {
-			if(folderList.size() > 0) {
-				m_client->DeleteFolders(bucketName, folderList);
-			}
-			Refresh();
-		}
+		// The objects are deleted in the background and the
+		// browser refreshed once they're gone
+		dialog->exec();
 		delete dialog;
 	}
 }
 
+// GET the selected objects in to a single zip or tar file rather than
+// creating a file for every object
+void
+DS3Browser::ArchiveSelected()
+{
+	QString archivePath = QFileDialog::getSaveFileName(this, "Download to Archive",
+							   QString(),
+							   "Zip Archives (*.zip);;Tar Archives (*.tar)");
+	if (archivePath.isEmpty()) {
+		return;
+	}
+
+	MimeData* data = static_cast<MimeData*>(m_model->mimeData(GetSelected()));
+	m_client->ArchiveGet(data->GetDS3URLs(), archivePath);
+	delete data;
+}
+
 bool
 DS3Browser::IsBucketSelectedOnly() const
 {
@@ -269,7 +345,19 @@ DS3Browser::BeginSearch()
 	if(m_model->hasChildren(index)) {
 		GetServiceWatcher* watcher = new GetServiceWatcher(index);
 		connect(watcher, SIGNAL(finished()), this, SLOT(RunSearch()));
-		QFuture<ds3_get_service_response*> future = m_client->GetService();
+		// The browser keeps the cached bucket list up to date so
+		// searches don't have to list the buckets again
+		QFuture<ServiceListing> future;
+		ServiceListing cached;
+		if (m_client->GetListingCache()->GetService(&cached)) {
+			QFutureInterface<ServiceListing> ready;
+			ready.reportStarted();
+			ready.reportResult(cached);
+			ready.reportFinished();
+			future = ready.future();
+		} else {
+			future = m_client->GetService();
+		}
 		watcher->setFuture(future);
 	}
 }
@@ -326,6 +414,17 @@ DS3Browser::CanReceive(QModelIndex& index)
 	return able;
 }
 
+bool
+DS3Browser::GetUploadDestination(QString* bucketName, QString* prefix)
+{
+	QModelIndex index;
+	if (!CanReceive(index)) {
+		return false;
+	}
+	m_model->GetDropDestination(index, bucketName, prefix);
+	return true;
+}
+
 void
 DS3Browser::CanTransfer(bool enable)
 {
@@ -25,7 +25,6 @@
 #include "models/job.h"
 #include "views/browser.h"
 
-class DS3BrowserItem;
 class DS3BrowserModel;
 class DS3SearchModel;
 class DS3SearchTree;
@@ -47,6 +46,9 @@ public:
 	QModelIndexList GetSelected();
 	void GetData(QMimeData* data);
 	void SetViewRoot(const QModelIndex& index);
+	// Where files would be uploaded to if they were transferred now.
+	// Returns false if nothing that can receive them is selected.
+	bool GetUploadDestination(QString* bucketName, QString* prefix);
 
 signals:
 	void Transferable();
@@ -74,16 +76,23 @@ protected slots:
 	void OnModelItemClick(const QModelIndex& index);
 	void CreateSearchTree(bool found);
 	void PrepareTransfer();
+	// Request the next page of any folder whose page break is within
+	// PREFETCH_ROWS rows of the bottom of the view.  Scrolling and model
+	// updates only schedule it so it runs once they've settled.
+	void SchedulePrefetch();
+	void PrefetchPages();
 
 private:
 	void CreateBucket();
 	void DeleteSelected();
+	void ArchiveSelected();
 	bool IsBucketSelectedOnly() const;
 
 	DS3BrowserModel* m_model;
 	DS3SearchModel* m_searchModel;
 	DS3SearchTree* m_searchView;
 	JobsView* m_jobsView;
+	bool m_prefetchScheduled;
 };
 
 
@@ -62,6 +62,7 @@ DS3DeleteDialog::Accept()
 	if (m_confirmationRequired && m_confirmInput->text() != CONFIRM_WORD) {
 		m_confirmLabel->setStyleSheet("QLabel { color: red; }");
 		m_confirmInput->setFocus();
+		return;
 	}
 
 	bool deleteSuccessful = Delete();
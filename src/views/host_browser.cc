@@ -92,6 +92,37 @@ HostBrowser::GoToHome()
 void
 HostBrowser::OnContextMenuRequested(const QPoint& /*pos*/)
 {
+	// Only a single directory can be watched at a time
+	QModelIndexList selected = GetSelected();
+	if (selected.count() != 1 || !m_model->isDir(selected[0])) {
+		return;
+	}
+	QString path = m_model->filePath(selected[0]);
+	bool watched = m_watchedFolders.contains(path);
+
+	QMenu menu;
+	QAction watchAction(watched ? "Stop Watching Folder" :
+			    "Watch Folder and Upload New Files", &menu);
+	menu.addAction(&watchAction);
+	if (menu.exec(QCursor::pos()) != &watchAction) {
+		return;
+	}
+
+	if (watched) {
+		emit StopWatchingFolder(path);
+	} else {
+		emit WatchFolder(path);
+	}
+}
+
+void
+HostBrowser::SetFolderWatched(const QString& path, bool watched)
+{
+	if (watched) {
+		m_watchedFolders.insert(path);
+	} else {
+		m_watchedFolders.remove(path);
+	}
 }
 
 void
@@ -18,6 +18,8 @@
 #define HOST_BROWSER_H
 
 #include <QList>
+#include <QSet>
+#include <QString>
 
 #include "views/browser.h"
 
@@ -37,10 +39,14 @@ public:
 	QModelIndexList GetSelected();
 	void GetData(QMimeData* data);
 	void SetViewRoot(const QModelIndex& index);
+	// Show whether a directory is being watched (see FolderWatcher)
+	void SetFolderWatched(const QString& path, bool watched);
 
 signals:
 	void Transferable();
 	void StartTransfer(QMimeData* data);
+	void WatchFolder(const QString& path);
+	void StopWatchingFolder(const QString& path);
 
 protected:
 	void AddCustomToolBarActions();
@@ -54,6 +60,7 @@ private:
 	QAction* m_homeAction;
 	QAction* m_transferAction;
 	HostBrowserModel* m_model;
+	QSet<QString> m_watchedFolders;
 
 protected slots:
 	void OnModelItemClick(const QModelIndex& index);
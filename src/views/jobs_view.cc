@@ -29,7 +29,7 @@
 const int JobView::MAX_URLS_WIDTH = 250;
 const int JobView::MAX_DEST_WIDTH = 150;
 const QString JobView::RIGHT_ARROW = QChar(0x2192);
-const QString JobView::s_types[] = { "GET", "PUT" };
+const QString JobView::s_types[] = { "GET", "PUT", "DELETE" };
 
 JobView::JobView(Job job, QWidget* parent)
 	: QWidget(parent),
@@ -77,14 +77,18 @@ void
 JobView::Update(Job job)
 {
 	m_host->setText(job.GetHost());
-	QString urlsAndDest = job.GetURLs();
-	QFontMetrics fm(m_urlsAndDestination->font());
-	urlsAndDest = fm.elidedText(urlsAndDest, Qt::ElideRight, MAX_URLS_WIDTH);
-	urlsAndDest += " " + RIGHT_ARROW + " ";
-	QString dest = job.GetDestination();
-	dest = fm.elidedText(dest, Qt::ElideRight, MAX_DEST_WIDTH);
-	urlsAndDest += dest;
-	m_urlsAndDestination->setText(urlsAndDest);
+	if (job.HasURLs()) {
+		QString urlsAndDest = job.GetURLs();
+		QFontMetrics fm(m_urlsAndDestination->font());
+		urlsAndDest = fm.elidedText(urlsAndDest, Qt::ElideRight, MAX_URLS_WIDTH);
+		// Deletes have nowhere the objects go
+		QString dest = job.GetDestination();
+		if (!dest.isEmpty()) {
+			urlsAndDest += " " + RIGHT_ARROW + " ";
+			urlsAndDest += fm.elidedText(dest, Qt::ElideRight, MAX_DEST_WIDTH);
+		}
+		m_urlsAndDestination->setText(urlsAndDest);
+	}
 	m_progressBar->setValue(job.GetProgress());
 	m_progressSummary->setText(ToProgressSummary(job));
 	m_start->setText(job.GetStart().toLocalTime().toString("M/d/yyyy h:mm AP"));
@@ -113,6 +117,18 @@ JobView::ToProgressSummary(Job job) const
 	if (!rate.isEmpty()) {
 		summary += " - " + rate;
 	}
+	if (job.GetState() == Job::INPROGRESS && job.GetConcurrency() > 1) {
+		summary += " - " + QString::number(job.GetConcurrency()) +
+			   " parallel";
+	}
+	const Job::ChunkWaits& chunkWaits = job.GetChunkWaits();
+	if (chunkWaits.longest > 0) {
+		summary += " - chunk wait " + QString::number(chunkWaits.last) +
+			   "s last, " +
+			   QString::number(chunkWaits.total / chunkWaits.count) +
+			   "s avg, " + QString::number(chunkWaits.longest) +
+			   "s max";
+	}
 	return summary;
 }
 
@@ -44,33 +44,23 @@ DeleteObjectsDialog::DeleteObjectsDialog(Client* client,
 	m_warning->setText(warning);
 }
 
+// The objects, and everything in the folders, are deleted by a background
+// job whose progress is shown in the jobs view and whose errors are logged.
+// Reserved buckets are refused up front since the server would only reject
+// every DELETE the job sent with a 403.
 bool
 DeleteObjectsDialog::Delete()
 {
-	try {
-		m_client->DeleteObjects(m_bucketName, m_objectNames);
-	}
-	catch (DS3Error& e) {
-		QString body;
-		QString msg;
-		switch (e.GetStatusCode()) {
-		case 403:
-			body = e.GetErrorBody();
-			if (body.contains("spectra-", Qt::CaseInsensitive)) {
-				msg = "Buckets that start with \"spectra-\" " \
-				      "are reserved and objects within then " \
-				      "cannot be deleted";
-			}
-			break;
-		}
-		if (msg.isEmpty()) {
-			msg = e.ToString();
-		}
+	if (m_bucketName.startsWith("spectra-", Qt::CaseInsensitive)) {
+		QString msg = "Buckets that start with \"spectra-\" " \
+			      "are reserved and objects within them " \
+			      "cannot be deleted";
 		m_baseErrorLabel->setText(msg);
 		m_form->addWidget(m_baseErrorLabel, 0, 0, 1, 3);
 		LOG_ERROR("ERROR:       DELETE OBJECTS failed, "+msg);
 		return false;
 	}
 
+	m_client->BulkDelete(m_bucketName, m_objectNames);
 	return true;
 }
@@ -31,6 +31,7 @@ SessionDialog::SessionDialog(QWidget* parent)
 	  m_header(new QGridLayout),
 	  m_hostLineEdit(new QLineEdit),
 	  m_portComboBox(new QComboBox),
+	  m_dataHostsLineEdit(new QLineEdit),
 	  m_proxyLineEdit(new QLineEdit),
 	  m_accessIdLineEdit(new QLineEdit),
 	  m_secretKeyLineEdit(new QLineEdit),
@@ -85,12 +86,21 @@ SessionDialog::SessionDialog(QWidget* parent)
 	m_form->addWidget(m_portLabel, 2, 0);
 	m_form->addWidget(m_portComboBox, 2, 1);
 
+	tip = "Optional, comma separated DNS names or IP addresses of " \
+	      "the BlackPearl's other network data interfaces.  Object " \
+	      "data is spread across these and the primary data interface";
+	m_dataHostsLabel = new QLabel("Additional Data Interfaces");
+	m_dataHostsLabel->setToolTip(tip);
+	m_dataHostsLineEdit->setToolTip(tip);
+	m_form->addWidget(m_dataHostsLabel, 3, 0);
+	m_form->addWidget(m_dataHostsLineEdit, 3, 1);
+
 	tip = "An optional server to proxy requests";
 	m_proxyLabel = new QLabel("Proxy Server");
 	m_proxyLabel->setToolTip(tip);
 	m_proxyLineEdit->setToolTip(tip);
-	m_form->addWidget(m_proxyLabel, 3, 0);
-	m_form->addWidget(m_proxyLineEdit, 3, 1);
+	m_form->addWidget(m_proxyLabel, 4, 0);
+	m_form->addWidget(m_proxyLineEdit, 4, 1);
 
 	tip = "The user's S3 Access ID.  This is available via the " \
 	      "BlackPearl user interface";
@@ -99,9 +109,9 @@ SessionDialog::SessionDialog(QWidget* parent)
 	m_accessIdLineEdit->setToolTip(tip);
 	m_accessIdErrorLabel = new QLabel;
 	m_accessIdErrorLabel->setStyleSheet("QLabel { color: red; }");
-	m_form->addWidget(m_accessIdLabel, 4, 0);
-	m_form->addWidget(m_accessIdLineEdit, 4, 1);
-	m_form->addWidget(m_accessIdErrorLabel, 4, 2);
+	m_form->addWidget(m_accessIdLabel, 5, 0);
+	m_form->addWidget(m_accessIdLineEdit, 5, 1);
+	m_form->addWidget(m_accessIdErrorLabel, 5, 2);
 
 	tip = "The user's S3 Secret Key.  This is available via the " \
 	      "BlackPearl user interface";
@@ -110,14 +120,14 @@ SessionDialog::SessionDialog(QWidget* parent)
 	m_secretKeyLineEdit->setToolTip(tip);
 	m_secretKeyErrorLabel = new QLabel;
 	m_secretKeyErrorLabel->setStyleSheet("QLabel { color: red; }");
-	m_form->addWidget(m_secretKeyLabel, 5, 0);
-	m_form->addWidget(m_secretKeyLineEdit, 5, 1);
-	m_form->addWidget(m_secretKeyErrorLabel, 5, 2);
+	m_form->addWidget(m_secretKeyLabel, 6, 0);
+	m_form->addWidget(m_secretKeyLineEdit, 6, 1);
+	m_form->addWidget(m_secretKeyErrorLabel, 6, 2);
 
 	m_saveSessionCheckBox = new QCheckBox("Save Session");
-	m_form->addWidget(m_saveSessionCheckBox, 6, 1);
+	m_form->addWidget(m_saveSessionCheckBox, 7, 1);
 
-	m_form->addWidget(m_buttonBox, 7, 1, 1, 2);
+	m_form->addWidget(m_buttonBox, 8, 1, 1, 2);
 
 	LoadSession();
 }
@@ -173,6 +183,7 @@ SessionDialog::LoadSession()
 		m_session.SetHost(settings.value("host").toString());
 		m_session.SetProtocol(settings.value("protocol").toInt());
 		m_session.SetPort(settings.value("port").toString());
+		m_session.SetDataHosts(settings.value("dataHosts").toStringList());
 		m_session.SetProxy(settings.value("proxy").toString());
 		m_session.SetWithCertificateVerification(settings.value("withCertificateVerification").toBool());
 		m_session.SetAccessId(settings.value("accessID").toString());
@@ -187,6 +198,7 @@ SessionDialog::LoadSession()
 	if (portIndex != -1) {
 		m_portComboBox->setCurrentIndex(portIndex);
 	}
+	m_dataHostsLineEdit->setText(m_session.GetDataHosts().join(", "));
 	m_proxyLineEdit->setText(m_session.GetProxy());
 	m_accessIdLineEdit->setText(m_session.GetAccessId());
 	m_secretKeyLineEdit->setText(m_session.GetSecretKey());
@@ -197,6 +209,15 @@ SessionDialog::UpdateSession()
 {
 	m_session.SetHost(m_hostLineEdit->text().trimmed().toUtf8().constData());
 	m_session.SetPort(m_portComboBox->currentText().trimmed().toUtf8().constData());
+	QStringList dataHosts;
+	QStringList rawDataHosts = m_dataHostsLineEdit->text().split(",", QString::SkipEmptyParts);
+	for (int i = 0; i < rawDataHosts.size(); i++) {
+		QString dataHost = rawDataHosts.at(i).trimmed();
+		if (!dataHost.isEmpty()) {
+			dataHosts << dataHost;
+		}
+	}
+	m_session.SetDataHosts(dataHosts);
 	m_session.SetProxy(m_proxyLineEdit->text().trimmed().toUtf8().constData());
 	m_session.SetAccessId(m_accessIdLineEdit->text().trimmed().toUtf8().constData());
 	m_session.SetSecretKey(m_secretKeyLineEdit->text().trimmed().toUtf8().constData());
@@ -224,9 +245,9 @@ SessionDialog::Authenticate()
 	m_watcher = new GetBucketWatcher(QModelIndex(), anyBucket, "");
 	connect(m_watcher, SIGNAL(finished()),
 		this, SLOT(CheckAuthenticationResponse()));
-	QFuture<ds3_get_bucket_response*> future = m_client->GetBucket(anyBucket,
-								       "", "",
-								       true);
+	QFuture<BucketListing> future = m_client->GetBucket(anyBucket,
+							    "", "",
+							    true);
 	m_watcher->setFuture(future);
 }
 
@@ -243,6 +264,7 @@ SessionDialog::SaveSession()
 		settings.setValue("protocol", m_session.GetProtocol());
 		settings.setValue("proxy", m_session.GetProxy());
 		settings.setValue("port", m_session.GetPort());
+		settings.setValue("dataHosts", m_session.GetDataHosts());
 		settings.setValue("withCertificateVerification", m_session.GetWithCertificateVerification());
 		settings.setValue("accessID", m_session.GetAccessId());
 		settings.setValue("secretKey", m_session.GetSecretKey());
@@ -257,15 +279,13 @@ SessionDialog::CheckAuthenticationResponse()
 {
 	bool authenticated = false;
 	try {
-		ds3_get_bucket_response* response = m_watcher->result();
-		if (response) {
+		if (!m_watcher->isCanceled()) {
+			m_watcher->result();
 			// Will most likely never get here since the bucket
 			// we're GET'ing will almost certainly never really
 			// exist but it's theoretically possible that it can.
 			// Thus, it's automatically.
 			authenticated = true;
-
-			ds3_free_bucket_response(response);
 		}
 	}
 	catch (DS3Error& e) {
@@ -59,6 +59,8 @@ private:
 	QLabel* m_hostErrorLabel;
 	QLabel* m_portLabel;
 	QComboBox* m_portComboBox;
+	QLabel* m_dataHostsLabel;
+	QLineEdit* m_dataHostsLineEdit;
 	QLabel* m_proxyLabel;
 	QLineEdit* m_proxyLineEdit;
 	QLabel* m_accessIdLabel;
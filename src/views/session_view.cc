@@ -14,7 +14,11 @@
  * *****************************************************************************
  */
 
+#include <QSettings>
+
 #include "lib/client.h"
+#include "lib/folder_watcher.h"
+#include "lib/logger.h"
 #include "models/session.h"
 #include "views/ds3_browser.h"
 #include "views/host_browser.h"
@@ -26,6 +30,10 @@ SessionView::SessionView(Session* session, JobsView* jobsView, QWidget* parent)
 	  m_session(session)
 {
 	m_client = new Client(session);
+	QSettings settings;
+	if (settings.value("transfers/useDaemon", false).toBool()) {
+		m_client->AttachToDaemon();
+	}
 	connect(jobsView, SIGNAL(JobCanceled(QUuid)),
 		m_client, SLOT(CancelBulkJob(QUuid)));
 
@@ -45,6 +53,10 @@ SessionView::SessionView(Session* session, JobsView* jobsView, QWidget* parent)
 		this, SLOT(SendToDS3(QMimeData*)));
 	connect(m_ds3Browser, SIGNAL(StartTransfer(QMimeData*)),
 		this, SLOT(SendToHost(QMimeData*)));
+	connect(m_hostBrowser, SIGNAL(WatchFolder(const QString&)),
+		this, SLOT(WatchFolder(const QString&)));
+	connect(m_hostBrowser, SIGNAL(StopWatchingFolder(const QString&)),
+		this, SLOT(StopWatchingFolder(const QString&)));
 
 	m_splitter = new QSplitter;
 	m_splitter->addWidget(m_hostBrowser);
@@ -61,6 +73,13 @@ SessionView::SessionView(Session* session, JobsView* jobsView, QWidget* parent)
 
 SessionView::~SessionView()
 {
+	// The Client, and any job it would start, is about to go away so the
+	// watchers' last batches can't be uploaded
+	QHash<QString, FolderWatcher*>::iterator wi;
+	for (wi = m_folderWatchers.begin(); wi != m_folderWatchers.end(); wi++) {
+		wi.value()->DiscardBatch();
+	}
+	qDeleteAll(m_folderWatchers);
 	delete m_client;
 	delete m_session;
 }
@@ -109,6 +128,47 @@ SessionView::SendToHost(QMimeData* data)
 	}
 }
 
+void
+SessionView::WatchFolder(const QString& path)
+{
+	QString bucketName;
+	QString prefix;
+	if (!m_ds3Browser->GetUploadDestination(&bucketName, &prefix)) {
+		LOG_ERROR("ERROR:       Select the bucket or folder to upload " +
+			  path + "'s new files to before watching it");
+		return;
+	}
+
+	FolderWatcher* watcher = new FolderWatcher(path, bucketName, prefix);
+	QString error;
+	if (!watcher->Start(&error)) {
+		LOG_ERROR("ERROR:       " + error);
+		delete watcher;
+		return;
+	}
+	connect(watcher, SIGNAL(BatchReady(const QString&, const QString&, const QList<QUrl>&)),
+		this, SLOT(PutBatch(const QString&, const QString&, const QList<QUrl>&)));
+	m_folderWatchers.insert(path, watcher);
+	m_hostBrowser->SetFolderWatched(path, true);
+}
+
+void
+SessionView::StopWatchingFolder(const QString& path)
+{
+	delete m_folderWatchers.take(path);
+	m_hostBrowser->SetFolderWatched(path, false);
+	LOG_INFO("WATCH FOLDER " + path + " stopped");
+}
+
+void
+SessionView::PutBatch(const QString& bucketName, const QString& prefix,
+		      const QList<QUrl>& urls)
+{
+	// Watch folder batches are background uploads
+	m_client->BulkPut(bucketName, prefix, urls, TransferFilter(),
+			  TransferScheduler::LOW);
+}
+
 void
 SessionView::SendToDS3(QMimeData* data)
 {
@@ -17,12 +17,17 @@
 #ifndef SESSION_VIEW_H
 #define SESSION_VIEW_H
 
+#include <QHash>
+#include <QList>
 #include <QVBoxLayout>
 #include <QSplitter>
+#include <QString>
+#include <QUrl>
 #include <QWidget>
 #include <QMimeData>
 
 class DS3Browser;
+class FolderWatcher;
 class HostBrowser;
 class JobsView;
 class Session;
@@ -51,11 +56,20 @@ private:
 	QVBoxLayout* m_topLayout;
 	QSplitter* m_splitter;
 
+	// Keyed by the watched directory
+	QHash<QString, FolderWatcher*> m_folderWatchers;
+
 private slots:
 	void HostToDS3();
 	void DS3ToHost();
 	void SendToDS3(QMimeData* data);
 	void SendToHost(QMimeData* data);
+	// Upload the files dropped in to a directory, as they're completed,
+	// to the bucket/folder selected in the DS3 browser
+	void WatchFolder(const QString& path);
+	void StopWatchingFolder(const QString& path);
+	void PutBatch(const QString& bucketName, const QString& prefix,
+		      const QList<QUrl>& urls);
 };
 
 #endif
@@ -0,0 +1,43 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QDateTime>
+
+#include "helpers/time_helper_test.h"
+#include "helpers/time_helper.h"
+
+static TimeHelperTest instance;
+
+void
+TimeHelperTest::TestParseRESTTimestamp()
+{
+	qint64 msecs = 0;
+	QVERIFY(TimeHelper::ParseRESTTimestamp("1970-01-01T00:00:00.000Z", &msecs));
+	QCOMPARE(msecs, (qint64)0);
+
+	QVERIFY(TimeHelper::ParseRESTTimestamp("2015-05-18T15:02:11.250Z", &msecs));
+	QDateTime expected(QDate(2015, 5, 18), QTime(15, 2, 11, 250), Qt::UTC);
+	QCOMPARE(msecs, expected.toMSecsSinceEpoch());
+
+	QVERIFY(TimeHelper::ParseRESTTimestamp("2015-05-18T15:02:11Z", &msecs));
+	QCOMPARE(msecs, expected.toMSecsSinceEpoch() - 250);
+
+	QVERIFY(!TimeHelper::ParseRESTTimestamp("", &msecs));
+	QVERIFY(!TimeHelper::ParseRESTTimestamp("2015-05-18 15:02:11.000Z", &msecs));
+	QVERIFY(!TimeHelper::ParseRESTTimestamp("2015-05-18T15:02:11.000", &msecs));
+	QVERIFY(!TimeHelper::ParseRESTTimestamp("2015-02-30T15:02:11.000Z", &msecs));
+	QVERIFY(!TimeHelper::ParseRESTTimestamp("2015-05-18T25:02:11.000Z", &msecs));
+}
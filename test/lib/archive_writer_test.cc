@@ -0,0 +1,179 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QFile>
+#include <QHash>
+#include <QStringList>
+#include <QTemporaryDir>
+
+#include "lib/archive_writer_test.h"
+#include "lib/archive_writer.h"
+#include "quazip/quazip.h"
+#include "quazip/quazipfile.h"
+
+static ArchiveWriterTest instance;
+
+// name -> "offset,size" from an archive's manifest
+static QHash<QString, QString>
+ReadManifest(const QString& archivePath)
+{
+	QHash<QString, QString> entries;
+	QFile manifest(archivePath + ".manifest.csv");
+	manifest.open(QIODevice::ReadOnly | QIODevice::Text);
+	manifest.readLine();
+	while (!manifest.atEnd()) {
+		QString line = QString::fromUtf8(manifest.readLine()).trimmed();
+		entries.insert(line.section(",", 0, 0), line.section(",", 1));
+	}
+	return entries;
+}
+
+static QByteArray
+ReadAt(const QString& path, const QString& offsetAndSize)
+{
+	QFile file(path);
+	file.open(QIODevice::ReadOnly);
+	file.seek(offsetAndSize.section(",", 0, 0).toLongLong());
+	return file.read(offsetAndSize.section(",", 1, 1).toLongLong());
+}
+
+void
+ArchiveWriterTest::TestTar()
+{
+	QTemporaryDir tmp;
+	QString path = tmp.path() + "/objects.tar";
+	QCOMPARE(ArchiveWriter::FormatFromFileName(path), ArchiveWriter::TAR);
+	QString longName = QString(120, 'x');
+	QString error;
+	qint64 dataOffset = 0;
+	{
+		ArchiveWriter writer(path);
+		QVERIFY(writer.Open(&error));
+		QVERIFY(writer.AddDirectory("folder", &error));
+		QVERIFY(writer.AddEntry("folder/small", "hello", &error));
+		QVERIFY(writer.ReserveEntry("folder/split", 10, &dataOffset, &error));
+		QVERIFY(writer.AddEntry(longName, "long", &error));
+
+		// The reserved entry is written out of order by another handle
+		QFile split(path);
+		QVERIFY(split.open(QIODevice::ReadWrite));
+		split.seek(dataOffset + 5);
+		split.write("56789");
+		split.seek(dataOffset);
+		split.write("01234");
+		split.close();
+		QVERIFY(writer.FinishReservedEntry("folder/split", dataOffset, 10,
+						   &error));
+		QVERIFY(writer.Close(&error));
+	}
+
+	QCOMPARE(QFile(path).size() % 512, qint64(0));
+	QHash<QString, QString> entries = ReadManifest(path);
+	QCOMPARE(entries.size(), 3);
+	QCOMPARE(ReadAt(path, entries["folder/small"]), QByteArray("hello"));
+	QCOMPARE(ReadAt(path, entries["folder/split"]), QByteArray("0123456789"));
+	QCOMPARE(ReadAt(path, entries[longName]), QByteArray("long"));
+
+	// The long name is in a pax extended header
+	QFile tar(path);
+	tar.open(QIODevice::ReadOnly);
+	QVERIFY(tar.readAll().contains("path=" + longName.toUtf8() + "\n"));
+}
+
+void
+ArchiveWriterTest::TestZip()
+{
+	QTemporaryDir tmp;
+	QString path = tmp.path() + "/objects.zip";
+	QString error;
+	{
+		ArchiveWriter writer(path);
+		QVERIFY(writer.Open(&error));
+		QVERIFY(writer.AddEntry("a", "first", &error));
+		QIODevice* entry = writer.BeginEntry("folder/b", 6, &error);
+		QVERIFY(entry != NULL);
+		entry->write("sec");
+		entry->write("ond");
+		QVERIFY(writer.EndEntry(&error));
+		// Too short so it's left out of the manifest
+		entry = writer.BeginEntry("c", 10, &error);
+		entry->write("short");
+		QVERIFY(!writer.EndEntry(&error));
+		QVERIFY(writer.Close(&error));
+	}
+
+	QHash<QString, QString> entries = ReadManifest(path);
+	QCOMPARE(entries.size(), 2);
+	// Entries are stored so the manifest points at their data
+	QCOMPARE(ReadAt(path, entries["a"]), QByteArray("first"));
+	QCOMPARE(ReadAt(path, entries["folder/b"]), QByteArray("second"));
+
+	QuaZip zip(path);
+	QVERIFY(zip.open(QuaZip::mdUnzip));
+	QVERIFY(zip.setCurrentFile("folder/b"));
+	QuaZipFile file(&zip);
+	QVERIFY(file.open(QIODevice::ReadOnly));
+	QCOMPARE(file.readAll(), QByteArray("second"));
+}
+
+// A reserved zip entry is filled in after the entries that follow it and
+// its checksum is then corrected so the archive can be read
+void
+ArchiveWriterTest::TestZipReserve()
+{
+	QTemporaryDir tmp;
+	QString path = tmp.path() + "/objects.zip";
+	QString error;
+	qint64 dataOffset = 0;
+	{
+		ArchiveWriter writer(path);
+		QVERIFY(writer.Open(&error));
+		QVERIFY(writer.AddEntry("a", "first", &error));
+		QVERIFY(writer.ReserveEntry("split", 10, &dataOffset, &error));
+		QVERIFY(writer.AddEntry("b", "last", &error));
+
+		QFile split(path);
+		QVERIFY(split.open(QIODevice::ReadWrite));
+		split.seek(dataOffset + 5);
+		split.write("56789");
+		split.seek(dataOffset);
+		split.write("01234");
+		split.close();
+		QVERIFY(writer.FinishReservedEntry("split", dataOffset, 10,
+						   &error));
+		QVERIFY(writer.Close(&error));
+	}
+
+	QHash<QString, QString> entries = ReadManifest(path);
+	QCOMPARE(entries.size(), 3);
+	QCOMPARE(ReadAt(path, entries["split"]), QByteArray("0123456789"));
+
+	QuaZip zip(path);
+	QVERIFY(zip.open(QuaZip::mdUnzip));
+	QStringList names;
+	names << "a" << "split" << "b";
+	QStringList contents;
+	contents << "first" << "0123456789" << "last";
+	for (int i = 0; i < names.size(); i++) {
+		QVERIFY(zip.setCurrentFile(names[i]));
+		QuaZipFile file(&zip);
+		QVERIFY(file.open(QIODevice::ReadOnly));
+		QCOMPARE(file.readAll(), contents[i].toUtf8());
+		file.close();
+		// A bad checksum is only reported when the file is closed
+		QCOMPARE(file.getZipError(), UNZ_OK);
+	}
+}
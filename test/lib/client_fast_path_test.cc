@@ -0,0 +1,241 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QSemaphore>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QUrl>
+
+#include "lib/client.h"
+#include "lib/client_fast_path_test.h"
+#include "models/session.h"
+
+static ClientFastPathTest instance;
+
+// Answers every request with an empty 200 OK, counting the PUTs, for as
+// long as it runs.  Connections are served round robin since the Client
+// sends a fast path drop's objects all at once over separate connections.
+class FakeDS3Server : public QThread
+{
+public:
+	FakeDS3Server()
+		: m_port(0),
+		  m_numPuts(0),
+		  m_stop(false)
+	{
+	}
+
+	// Blocks until the server is listening
+	quint16 GetPort()
+	{
+		m_listening.acquire();
+		return m_port;
+	}
+
+	int GetNumPuts()
+	{
+		m_lock.lock();
+		int numPuts = m_numPuts;
+		m_lock.unlock();
+		return numPuts;
+	}
+
+	void Stop()
+	{
+		m_lock.lock();
+		m_stop = true;
+		m_lock.unlock();
+		wait();
+	}
+
+protected:
+	void run()
+	{
+		QTcpServer server;
+		server.listen(QHostAddress::LocalHost);
+		m_port = server.serverPort();
+		m_listening.release();
+
+		QList<Connection*> connections;
+		while (!IsStopped()) {
+			if (server.waitForNewConnection(10)) {
+				Connection* connection = new Connection;
+				connection->socket = server.nextPendingConnection();
+				connection->bodyRemaining = 0;
+				connection->inBody = false;
+				connections << connection;
+			}
+			for (int i = 0; i < connections.size(); i++) {
+				Serve(connections[i]);
+			}
+		}
+		for (int i = 0; i < connections.size(); i++) {
+			delete connections[i]->socket;
+			delete connections[i];
+		}
+	}
+
+private:
+	struct Connection
+	{
+		QTcpSocket* socket;
+		QByteArray buffer;
+		qint64 bodyRemaining;
+		bool inBody;
+	};
+
+	bool IsStopped()
+	{
+		m_lock.lock();
+		bool stop = m_stop;
+		m_lock.unlock();
+		return stop;
+	}
+
+	void Serve(Connection* connection)
+	{
+		QTcpSocket* socket = connection->socket;
+		socket->waitForReadyRead(1);
+		connection->buffer += socket->readAll();
+		while (true) {
+			if (!connection->inBody) {
+				int end = connection->buffer.indexOf("\r\n\r\n");
+				if (end < 0) {
+					return;
+				}
+				QList<QByteArray> lines = connection->buffer.left(end).split('\n');
+				connection->buffer.remove(0, end + 4);
+				connection->bodyRemaining = 0;
+				bool expectContinue = false;
+				for (int i = 1; i < lines.size(); i++) {
+					QByteArray line = lines[i].trimmed().toLower();
+					if (line.startsWith("content-length:")) {
+						connection->bodyRemaining = line.mid(15).trimmed().toLongLong();
+					} else if (line.startsWith("expect:")) {
+						expectContinue = true;
+					}
+				}
+				if (lines[0].startsWith("PUT ")) {
+					m_lock.lock();
+					m_numPuts++;
+					m_lock.unlock();
+				}
+				if (expectContinue) {
+					Write(socket, "HTTP/1.1 100 Continue\r\n\r\n");
+				}
+				connection->inBody = true;
+			}
+			qint64 consumed = qMin(connection->bodyRemaining,
+					       (qint64)connection->buffer.size());
+			connection->buffer.remove(0, (int)consumed);
+			connection->bodyRemaining -= consumed;
+			if (connection->bodyRemaining > 0) {
+				return;
+			}
+			connection->inBody = false;
+			Write(socket, "HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n");
+		}
+	}
+
+	void Write(QTcpSocket* socket, const QByteArray& data)
+	{
+		socket->write(data);
+		while (socket->bytesToWrite() > 0 &&
+		       socket->waitForBytesWritten(1000)) {
+		}
+	}
+
+	QSemaphore m_listening;
+	QMutex m_lock;
+	quint16 m_port;
+	int m_numPuts;
+	bool m_stop;
+};
+
+Job
+JobRecorder::GetLastJob()
+{
+	m_lock.lock();
+	Job job = m_lastJob;
+	m_lock.unlock();
+	return job;
+}
+
+void
+JobRecorder::Record(const Job job)
+{
+	m_lock.lock();
+	m_lastJob = job;
+	m_lock.unlock();
+}
+
+// A drop of a few small files shouldn't wait to be coalesced or queued
+// before it's sent.  Either would take seconds.
+void
+ClientFastPathTest::TestSmallDrop()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	QList<QUrl> urls;
+	for (int i = 0; i < 3; i++) {
+		QString path = QDir(dir.path()).filePath("file" + QString::number(i));
+		QFile file(path);
+		QVERIFY(file.open(QIODevice::WriteOnly));
+		file.write(QByteArray(1024, 'a' + i));
+		file.close();
+		urls << QUrl::fromLocalFile(path);
+	}
+
+	FakeDS3Server server;
+	server.start();
+	Session session;
+	session.SetHost("127.0.0.1");
+	session.SetProtocol(Session::HTTP);
+	session.SetPort(QString::number(server.GetPort()));
+	session.SetAccessId("access");
+	session.SetSecretKey("secret");
+	Client* client = new Client(&session);
+	JobRecorder recorder;
+	QObject::connect(client, SIGNAL(JobProgressUpdate(const Job)),
+			 &recorder, SLOT(Record(const Job)),
+			 Qt::DirectConnection);
+
+	QElapsedTimer timer;
+	timer.start();
+	client->BulkPut("bucket", "", urls);
+	while (recorder.GetLastJob().GetState() != Job::FINISHED &&
+	       timer.elapsed() < 5000) {
+		QThread::msleep(10);
+	}
+	qint64 elapsed = timer.elapsed();
+
+	Job job = recorder.GetLastJob();
+	QCOMPARE(job.GetState(), Job::FINISHED);
+	QCOMPARE(job.GetNumFailedObjects(), (uint64_t)0);
+	QCOMPARE(server.GetNumPuts(), 3);
+	QVERIFY2(elapsed < 1000,
+		 qPrintable("took " + QString::number(elapsed) + " ms"));
+
+	delete client;
+	server.Stop();
+}
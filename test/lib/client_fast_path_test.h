@@ -0,0 +1,52 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+
+#ifndef CLIENT_FAST_PATH_TEST_H
+#define CLIENT_FAST_PATH_TEST_H
+
+#include <QMutex>
+#include <QObject>
+
+#include "models/job.h"
+#include "test.h"
+
+class ClientFastPathTest : public Test
+{
+	Q_OBJECT
+
+private slots:
+	void TestSmallDrop();
+};
+
+// Keeps the last progress update of a job, which arrives on whichever
+// thread the Client sent it from
+class JobRecorder : public QObject
+{
+	Q_OBJECT
+
+public:
+	Job GetLastJob();
+
+public slots:
+	void Record(const Job job);
+
+private:
+	QMutex m_lock;
+	Job m_lastJob;
+};
+
+#endif
@@ -0,0 +1,102 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include "lib/concurrency_controller_test.h"
+#include "lib/concurrency_controller.h"
+
+static ConcurrencyControllerTest instance;
+
+// Report a full round of identical transfers at the controller's current
+// limit
+static void
+CompleteRound(ConcurrencyController& controller, uint64_t bytes,
+	      qint64 elapsedInMs, bool failed = false)
+{
+	int limit = controller.GetLimit();
+	for (int i = 0; i < limit; i++) {
+		controller.ReportCompletion(bytes, elapsedInMs, failed);
+	}
+}
+
+void
+ConcurrencyControllerTest::TestLimitsAreBounded()
+{
+	ConcurrencyController controller(0, 1000);
+	QCOMPARE(controller.GetMin(), 1);
+	QCOMPARE(controller.GetMax(), ConcurrencyController::MAX_LIMIT);
+	QCOMPARE(controller.GetLimit(), 1);
+
+	ConcurrencyController inverted(8, 4);
+	QCOMPARE(inverted.GetMin(), 8);
+	QCOMPARE(inverted.GetMax(), 8);
+	QCOMPARE(inverted.GetLimit(), 8);
+}
+
+void
+ConcurrencyControllerTest::TestAdditiveIncrease()
+{
+	ConcurrencyController controller(1, 4);
+	// Each transfer takes the same time so adding more transfers
+	// increases throughput
+	for (int i = 2; i <= 4; i++) {
+		CompleteRound(controller, 1024, 100);
+		QCOMPARE(controller.GetLimit(), i);
+	}
+	CompleteRound(controller, 1024, 100);
+	QCOMPARE(controller.GetLimit(), 4);
+}
+
+void
+ConcurrencyControllerTest::TestDecreaseOnThroughputDrop()
+{
+	ConcurrencyController controller(1, 16);
+	for (int i = 0; i < 7; i++) {
+		CompleteRound(controller, 1024, 100);
+	}
+	QCOMPARE(controller.GetLimit(), 8);
+	// The transfers got so much slower that adding the last one
+	// decreased overall throughput
+	CompleteRound(controller, 1024, 1000);
+	QCOMPARE(controller.GetLimit(), 6);
+}
+
+void
+ConcurrencyControllerTest::TestDecreaseOnFailure()
+{
+	ConcurrencyController controller(2, 16);
+	for (int i = 0; i < 6; i++) {
+		CompleteRound(controller, 1024, 100);
+	}
+	QCOMPARE(controller.GetLimit(), 8);
+	CompleteRound(controller, 1024, 100, true);
+	QCOMPARE(controller.GetLimit(), 4);
+	CompleteRound(controller, 1024, 100, true);
+	CompleteRound(controller, 1024, 100, true);
+	QCOMPARE(controller.GetLimit(), 2);
+}
+
+void
+ConcurrencyControllerTest::TestAcquireRelease()
+{
+	ConcurrencyController controller(1, 4);
+	QVERIFY(controller.Acquire(0));
+	QVERIFY(!controller.Acquire(0));
+	controller.Release(1024, 100, false);
+	QCOMPARE(controller.GetLimit(), 2);
+	QVERIFY(controller.Acquire(0));
+	QVERIFY(controller.Acquire(0));
+	QVERIFY(!controller.Acquire(0));
+}
@@ -0,0 +1,130 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QFile>
+#include <QSignalSpy>
+#include <QTemporaryDir>
+#include <QUrl>
+
+#include "lib/folder_watcher_test.h"
+#include "lib/folder_watcher.h"
+
+static FolderWatcherTest instance;
+
+static void
+WriteFile(const QString& path, const QByteArray& data)
+{
+	QFile file(path);
+	QVERIFY(file.open(QIODevice::WriteOnly));
+	file.write(data);
+	file.close();
+}
+
+// The URLs of every batch the spy has seen
+static QList<QUrl>
+BatchedUrls(const QSignalSpy& spy)
+{
+	QList<QUrl> urls;
+	for (int i = 0; i < spy.count(); i++) {
+		urls << spy.at(i).at(2).value<QList<QUrl> >();
+	}
+	return urls;
+}
+
+void
+FolderWatcherTest::TestBatchWindow()
+{
+	qRegisterMetaType<QList<QUrl> >();
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	WriteFile(dir.path() + "/existing", "old");
+
+	FolderWatcher watcher(dir.path(), "bucket", "incoming/");
+	watcher.SetStableCheckInterval(50);
+	watcher.SetBatchWindow(500);
+	QSignalSpy spy(&watcher, SIGNAL(BatchReady(const QString&, const QString&, const QList<QUrl>&)));
+	QString error;
+	QVERIFY(watcher.Start(&error));
+
+	WriteFile(dir.path() + "/a", "aaa");
+	WriteFile(dir.path() + "/b", "bbb");
+	WriteFile(dir.path() + "/c", "ccc");
+
+	// All three files end up in the same batch
+	QVERIFY(spy.wait(5000));
+	QCOMPARE(spy.count(), 1);
+	QCOMPARE(spy.at(0).at(0).toString(), QString("bucket"));
+	QCOMPARE(spy.at(0).at(1).toString(), QString("incoming/"));
+	QList<QUrl> urls = BatchedUrls(spy);
+	QCOMPARE(urls.size(), 3);
+	QVERIFY(urls.contains(QUrl::fromLocalFile(dir.path() + "/a")));
+	QVERIFY(!urls.contains(QUrl::fromLocalFile(dir.path() + "/existing")));
+
+}
+
+void
+FolderWatcherTest::TestRewrittenFile()
+{
+	qRegisterMetaType<QList<QUrl> >();
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+
+	FolderWatcher watcher(dir.path(), "bucket", "");
+	watcher.SetStableCheckInterval(50);
+	watcher.SetBatchWindow(200);
+	QSignalSpy batchSpy(&watcher, SIGNAL(BatchReady(const QString&, const QString&, const QList<QUrl>&)));
+	QSignalSpy rewrittenSpy(&watcher, SIGNAL(FileRewritten(const QString&)));
+	QString error;
+	QVERIFY(watcher.Start(&error));
+
+	WriteFile(dir.path() + "/a", "aaa");
+	QVERIFY(batchSpy.wait(5000));
+
+	// The uploaded object can't be overwritten so the rewritten file is
+	// reported instead of being put in the next batch with the new file
+	WriteFile(dir.path() + "/a", "aaaa");
+	WriteFile(dir.path() + "/b", "bbb");
+	QVERIFY(batchSpy.wait(5000));
+	QCOMPARE(batchSpy.count(), 2);
+	QList<QUrl> urls = batchSpy.at(1).at(2).value<QList<QUrl> >();
+	QCOMPARE(urls.size(), 1);
+	QCOMPARE(urls.at(0), QUrl::fromLocalFile(dir.path() + "/b"));
+	QCOMPARE(rewrittenSpy.count(), 1);
+	QCOMPARE(rewrittenSpy.at(0).at(0).toString(), dir.path() + "/a");
+}
+
+void
+FolderWatcherTest::TestBatchLimit()
+{
+	qRegisterMetaType<QList<QUrl> >();
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+
+	FolderWatcher watcher(dir.path(), "bucket", "");
+	watcher.SetStableCheckInterval(50);
+	watcher.SetBatchWindow(60000);
+	watcher.SetBatchLimits(1024, 2);
+	QSignalSpy spy(&watcher, SIGNAL(BatchReady(const QString&, const QString&, const QList<QUrl>&)));
+	QString error;
+	QVERIFY(watcher.Start(&error));
+
+	for (int i = 0; i < 4; i++) {
+		WriteFile(dir.path() + "/" + QString::number(i), "data");
+	}
+	// Full batches don't wait for the window
+	QTRY_COMPARE_WITH_TIMEOUT(BatchedUrls(spy).size(), 4, 5000);
+	QCOMPARE(spy.count(), 2);
+}
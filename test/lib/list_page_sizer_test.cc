@@ -0,0 +1,62 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include "lib/list_page_sizer_test.h"
+#include "lib/list_page_sizer.h"
+
+static ListPageSizerTest instance;
+
+void
+ListPageSizerTest::TestFastServerGrowsPages()
+{
+	ListPageSizer sizer;
+	QCOMPARE(sizer.GetPageSize(), ListPageSizer::INITIAL_PAGE_SIZE);
+
+	// Never more than double at a time
+	sizer.ReportListing(1000, 10);
+	QCOMPARE(sizer.GetPageSize(), (uint32_t)2000);
+
+	for (int i = 0; i < 10; i++) {
+		sizer.ReportListing(sizer.GetPageSize(), 10);
+	}
+	QCOMPARE(sizer.GetPageSize(), ListPageSizer::MAX_PAGE_SIZE);
+}
+
+void
+ListPageSizerTest::TestSlowServerShrinksPages()
+{
+	ListPageSizer sizer;
+	// Twice the target latency
+	sizer.ReportListing(1000, ListPageSizer::TARGET_LATENCY_IN_MS * 2);
+	QCOMPARE(sizer.GetPageSize(), (uint32_t)500);
+
+	for (int i = 0; i < 10; i++) {
+		sizer.ReportListing(sizer.GetPageSize(), 60000);
+	}
+	QCOMPARE(sizer.GetPageSize(), ListPageSizer::MIN_PAGE_SIZE);
+}
+
+void
+ListPageSizerTest::TestShortPagesOnlyGrow()
+{
+	ListPageSizer sizer;
+	// The last few keys of a folder, mostly round trip time
+	sizer.ReportListing(10, ListPageSizer::TARGET_LATENCY_IN_MS);
+	QCOMPARE(sizer.GetPageSize(), ListPageSizer::INITIAL_PAGE_SIZE);
+
+	sizer.ReportListing(0, 0);
+	QCOMPARE(sizer.GetPageSize(), ListPageSizer::INITIAL_PAGE_SIZE);
+}
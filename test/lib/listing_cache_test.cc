@@ -0,0 +1,155 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QTemporaryDir>
+
+#include "lib/listing_cache_test.h"
+#include "lib/listing_cache.h"
+
+static ListingCacheTest instance;
+
+static BucketListing
+MakeListing(int numObjects, const QString& owner = "owner")
+{
+	BucketListing listing;
+	for (int i = 0; i < numObjects; i++) {
+		ListedObject object;
+		object.SetName("dir/" + QString::number(i));
+		object.SetOwner(owner);
+		object.SetSize(i * 1024);
+		object.SetLastModified("2015-05-18T15:02:11.000Z");
+		listing.AppendObject(object);
+	}
+	listing.AppendCommonPrefix("dir/sub/");
+	listing.SetNextMarker("dir/9");
+	listing.SetTruncated(true);
+	return listing;
+}
+
+void
+ListingCacheTest::TestRoundTrip()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	ListingCache cache(dir.path());
+
+	BucketListing listing;
+	QVERIFY(!cache.GetBucket("b", "dir/", &listing));
+
+	cache.PutBucket("b", "dir/", MakeListing(10));
+	cache.WaitForWrites();
+	QVERIFY(cache.GetBucket("b", "dir/", &listing));
+	QCOMPARE(listing.GetObjects().size(), 10);
+	QCOMPARE(listing.GetObjects().at(3).GetName(), QString("dir/3"));
+	QCOMPARE(listing.GetObjects().at(3).GetSize(), (uint64_t)3072);
+	QCOMPARE(listing.GetObjects().at(3).GetLastModified(),
+		 QString("2015-05-18T15:02:11.000Z"));
+	QCOMPARE(listing.GetCommonPrefixes(), QStringList("dir/sub/"));
+	QCOMPARE(listing.GetNextMarker(), QString("dir/9"));
+	QVERIFY(listing.IsTruncated());
+
+	// Other folders and buckets aren't mixed up with it
+	BucketListing other;
+	QVERIFY(!cache.GetBucket("b", "", &other));
+	QVERIFY(!cache.GetBucket("c", "dir/", &other));
+
+	ServiceListing service;
+	QVERIFY(!cache.GetService(&service));
+	ServiceListing buckets;
+	buckets.SetOwner("owner");
+	ListedBucket bucket;
+	bucket.SetName("b");
+	bucket.SetCreationDate("2015-05-18T15:02:11.000Z");
+	buckets.AppendBucket(bucket);
+	cache.PutService(buckets);
+	cache.WaitForWrites();
+	QVERIFY(cache.GetService(&service));
+	QCOMPARE(service.GetOwner(), QString("owner"));
+	QCOMPARE(service.GetBuckets().size(), 1);
+	QCOMPARE(service.GetBuckets().at(0).GetName(), QString("b"));
+
+	// A new instance picks up the existing entries
+	ListingCache reopened(dir.path());
+	QCOMPARE(reopened.GetSize(), cache.GetSize());
+	BucketListing again;
+	QVERIFY(reopened.GetBucket("b", "dir/", &again));
+	QCOMPARE(again.GetObjects().size(), 10);
+}
+
+void
+ListingCacheTest::TestChanged()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	ListingCache cache(dir.path());
+
+	// Compared with what was last read, which is what was displayed
+	BucketListing listing;
+	QVERIFY(cache.PutBucket("b", "", MakeListing(5)));
+	cache.WaitForWrites();
+	QVERIFY(cache.GetBucket("b", "", &listing));
+	QVERIFY(!cache.PutBucket("b", "", MakeListing(5)));
+	cache.WaitForWrites();
+	QVERIFY(cache.GetBucket("b", "", &listing));
+	QVERIFY(cache.PutBucket("b", "", MakeListing(6)));
+	cache.WaitForWrites();
+	QVERIFY(cache.GetBucket("b", "", &listing));
+	QVERIFY(cache.PutBucket("b", "", MakeListing(6, "other")));
+}
+
+void
+ListingCacheTest::TestDefaultDir()
+{
+	// Different users of the same endpoint don't share a cache
+	QString dir = ListingCache::GetDefaultDir("https://ds3:443", "alice");
+	QCOMPARE(ListingCache::GetDefaultDir("https://ds3:443", "alice"), dir);
+	QVERIFY(ListingCache::GetDefaultDir("https://ds3:443", "bob") != dir);
+	QVERIFY(ListingCache::GetDefaultDir("https://other:443", "alice") != dir);
+}
+
+void
+ListingCacheTest::TestExpired()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	ListingCache cache(dir.path(), -1);
+
+	cache.PutBucket("b", "", MakeListing(5));
+	cache.WaitForWrites();
+	BucketListing listing;
+	QVERIFY(!cache.GetBucket("b", "", &listing));
+	// The expired entry was removed
+	QCOMPARE(cache.GetSize(), (qint64)0);
+}
+
+void
+ListingCacheTest::TestSizeCap()
+{
+	QTemporaryDir dir;
+	QVERIFY(dir.isValid());
+	const qint64 maxSize = 64 * 1024;
+	ListingCache cache(dir.path(), ListingCache::DEFAULT_TTL_IN_SECS,
+			   maxSize);
+
+	for (int i = 0; i < 50; i++) {
+		cache.PutBucket("b", QString::number(i) + "/", MakeListing(50));
+		cache.WaitForWrites();
+		QVERIFY(cache.GetSize() <= maxSize);
+	}
+	// The most recent entry survives
+	BucketListing listing;
+	QVERIFY(cache.GetBucket("b", "49/", &listing));
+}
@@ -0,0 +1,87 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QBuffer>
+
+#include "lib/manifest_reader_test.h"
+#include "lib/manifest_reader.h"
+
+static ManifestReaderTest instance;
+
+void
+ManifestReaderTest::TestParseLines()
+{
+	ManifestEntry entry;
+	QVERIFY(ManifestReader::ParseLine("/bucket/dir/object, 1",
+					  ManifestReader::LINES, &entry));
+	QCOMPARE(entry.bucket, QString("bucket"));
+	QCOMPARE(entry.object, QString("dir/object, 1"));
+	QVERIFY(entry.destination.isEmpty());
+
+	QVERIFY(!ManifestReader::ParseLine("bucket", ManifestReader::LINES,
+					   &entry));
+	QVERIFY(!entry.error.isEmpty());
+}
+
+void
+ManifestReaderTest::TestParseCSV()
+{
+	ManifestEntry entry;
+	QVERIFY(ManifestReader::ParseLine("bucket,\"a, \"\"quoted\"\" object\",out/file",
+					  ManifestReader::CSV, &entry));
+	QCOMPARE(entry.bucket, QString("bucket"));
+	QCOMPARE(entry.object, QString("a, \"quoted\" object"));
+	QCOMPARE(entry.destination, QString("out/file"));
+
+	QVERIFY(ManifestReader::ParseLine("bucket,object", ManifestReader::CSV,
+					  &entry));
+	QVERIFY(entry.destination.isEmpty());
+
+	QVERIFY(!ManifestReader::ParseLine("bucket,\"object", ManifestReader::CSV,
+					   &entry));
+	QVERIFY(!ManifestReader::ParseLine("bucket,object,dest,extra",
+					   ManifestReader::CSV, &entry));
+}
+
+void
+ManifestReaderTest::TestReadEntries()
+{
+	QByteArray data("bucket,object,destination\n"
+			"b1,o1\n"
+			"\n"
+			"# comment\n"
+			"b1\n"
+			"b2,o2,d2\n");
+	QBuffer buffer(&data);
+	buffer.open(QIODevice::ReadOnly | QIODevice::Text);
+	ManifestReader reader(&buffer, ManifestReader::CSV);
+
+	ManifestEntry entry;
+	QVERIFY(reader.ReadEntry(&entry));
+	QCOMPARE(entry.line, (qint64)2);
+	QCOMPARE(entry.object, QString("o1"));
+
+	QVERIFY(reader.ReadEntry(&entry));
+	QCOMPARE(entry.line, (qint64)5);
+	QVERIFY(!entry.error.isEmpty());
+
+	QVERIFY(reader.ReadEntry(&entry));
+	QCOMPARE(entry.line, (qint64)6);
+	QCOMPARE(entry.destination, QString("d2"));
+
+	QVERIFY(!reader.ReadEntry(&entry));
+	QVERIFY(reader.AtEnd());
+}
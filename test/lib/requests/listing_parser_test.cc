@@ -0,0 +1,112 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include "lib/requests/listing_parser_test.h"
+#include "lib/requests/listing_parser.h"
+
+static ListingParserTest instance;
+
+void
+ListingParserTest::TestParseService()
+{
+	QByteArray body = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+		"<ListAllMyBucketsResult>"
+		"<Owner><ID>1</ID><DisplayName>jdoe</DisplayName></Owner>"
+		"<Buckets>"
+		"<Bucket><CreationDate>2015-05-18T15:02:11.000Z</CreationDate><Name>books</Name></Bucket>"
+		"<Bucket><CreationDate>2015-05-19T10:00:00.000Z</CreationDate><Name>movies</Name></Bucket>"
+		"</Buckets>"
+		"</ListAllMyBucketsResult>";
+	ServiceListing listing;
+	QString error;
+	QVERIFY(ListingParser::ParseService(body, &listing, &error));
+	QCOMPARE(listing.GetOwner(), QString("jdoe"));
+	QCOMPARE(listing.GetBuckets().size(), 2);
+	QCOMPARE(listing.GetBuckets().at(0).GetName(), QString("books"));
+	QCOMPARE(listing.GetBuckets().at(1).GetCreationDate(),
+		 QString("2015-05-19T10:00:00.000Z"));
+}
+
+void
+ListingParserTest::TestParseBucket()
+{
+	QByteArray body = "<ListBucketResult>"
+		"<Name>books</Name>"
+		"<Prefix>fiction/</Prefix>"
+		"<NextMarker>fiction/ulysses.txt</NextMarker>"
+		"<IsTruncated>true</IsTruncated>"
+		"<Contents>"
+		"<Key>fiction/ulysses.txt</Key>"
+		"<LastModified>2015-05-18T15:02:11.000Z</LastModified>"
+		"<Size>1536</Size>"
+		"<Owner><DisplayName>jdoe</DisplayName></Owner>"
+		"</Contents>"
+		"<CommonPrefixes><Prefix>fiction/russian/</Prefix></CommonPrefixes>"
+		"</ListBucketResult>";
+	BucketListing listing;
+	QString error;
+	QVERIFY(ListingParser::ParseBucket(body, &listing, &error));
+	QVERIFY(listing.IsTruncated());
+	QCOMPARE(listing.GetNextMarker(), QString("fiction/ulysses.txt"));
+	QCOMPARE(listing.GetCommonPrefixes(),
+		 QStringList() << "fiction/russian/");
+	QCOMPARE(listing.GetObjects().size(), 1);
+	const ListedObject& object = listing.GetObjects().at(0);
+	QCOMPARE(object.GetName(), QString("fiction/ulysses.txt"));
+	QCOMPARE(object.GetSize(), (uint64_t)1536);
+	QCOMPARE(object.GetOwner(), QString("jdoe"));
+	QCOMPARE(object.GetLastModified(), QString("2015-05-18T15:02:11.000Z"));
+}
+
+void
+ListingParserTest::TestParseObjects()
+{
+	QByteArray body = "<Data>"
+		"<S3Object>"
+		"<BucketId>books</BucketId>"
+		"<CreationDate>2015-05-18T15:02:11.000Z</CreationDate>"
+		"<Name>fiction/ulysses.txt</Name>"
+		"<Size>1536</Size>"
+		"</S3Object>"
+		"</Data>";
+	BucketListing listing;
+	QString error;
+	QVERIFY(ListingParser::ParseObjects(body, &listing, &error));
+	QVERIFY(!listing.IsTruncated());
+	QCOMPARE(listing.GetObjects().size(), 1);
+	const ListedObject& object = listing.GetObjects().at(0);
+	QCOMPARE(object.GetName(), QString("fiction/ulysses.txt"));
+	QCOMPARE(object.GetLastModified(), QString("2015-05-18T15:02:11.000Z"));
+}
+
+void
+ListingParserTest::TestParseEmptyBody()
+{
+	BucketListing listing;
+	QString error;
+	QVERIFY(ListingParser::ParseBucket(QByteArray(), &listing, &error));
+	QCOMPARE(listing.GetObjects().size(), 0);
+}
+
+void
+ListingParserTest::TestParseInvalidBody()
+{
+	BucketListing listing;
+	QString error;
+	QVERIFY(!ListingParser::ParseBucket("<ListBucketResult><Contents>",
+					    &listing, &error));
+	QVERIFY(!error.isEmpty());
+}
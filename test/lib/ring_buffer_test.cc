@@ -0,0 +1,98 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QByteArray>
+#include <QFuture>
+#include <QtConcurrent>
+
+#include "lib/ring_buffer_test.h"
+#include "lib/ring_buffer.h"
+
+static RingBufferTest instance;
+
+static void
+Produce(RingBuffer* buffer, QByteArray data)
+{
+	// Odd sized writes so they straddle the end of the buffer
+	for (int i = 0; i < data.size(); i += 7) {
+		buffer->write(data.constData() + i, qMin(7, data.size() - i));
+	}
+	buffer->CloseWrite();
+}
+
+static qint64
+ReadOne(RingBuffer* buffer)
+{
+	char c;
+	return buffer->read(&c, 1);
+}
+
+void
+RingBufferTest::TestWrapAround()
+{
+	RingBuffer buffer(8);
+	char data[8];
+
+	QCOMPARE(buffer.write("abcdef", 6), qint64(6));
+	QCOMPARE(buffer.read(data, 4), qint64(4));
+	QCOMPARE(QByteArray(data, 4), QByteArray("abcd"));
+
+	// Wraps around the end of the underlying buffer
+	QCOMPARE(buffer.write("ghijkl", 6), qint64(6));
+	QCOMPARE(buffer.bytesAvailable(), qint64(8));
+	QCOMPARE(buffer.read(data, 8), qint64(8));
+	QCOMPARE(QByteArray(data, 8), QByteArray("efghijkl"));
+
+	buffer.CloseWrite();
+	QVERIFY(buffer.atEnd());
+	QCOMPARE(buffer.read(data, 8), qint64(-1));
+}
+
+void
+RingBufferTest::TestProducerConsumer()
+{
+	QByteArray data;
+	for (int i = 0; i < 10000; i++) {
+		data.append(char(i % 251));
+	}
+
+	RingBuffer buffer(64);
+	QFuture<void> producer = QtConcurrent::run(Produce, &buffer, data);
+	QByteArray received;
+	char chunk[13];
+	qint64 n;
+	while ((n = buffer.read(chunk, sizeof(chunk))) > 0) {
+		received.append(chunk, n);
+	}
+	producer.waitForFinished();
+
+	QCOMPARE(received.size(), data.size());
+	QVERIFY(received == data);
+}
+
+void
+RingBufferTest::TestAbort()
+{
+	RingBuffer buffer(8);
+	QFuture<qint64> reader = QtConcurrent::run(ReadOne, &buffer);
+	QTest::qWait(50);
+	QVERIFY(!reader.isFinished());
+
+	buffer.Abort();
+	QCOMPARE(reader.result(), qint64(-1));
+	QVERIFY(buffer.WasAborted());
+	QCOMPARE(buffer.write("a", 1), qint64(-1));
+}
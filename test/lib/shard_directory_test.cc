@@ -0,0 +1,122 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#include "lib/shard_directory_test.h"
+#include "lib/shard_directory.h"
+
+static ShardDirectoryTest instance;
+
+static QString
+CreateManifest(const QTemporaryDir& tmp)
+{
+	QString path = tmp.path() + "/manifest.csv";
+	QFile manifest(path);
+	manifest.open(QIODevice::WriteOnly | QIODevice::Text);
+	manifest.write("bucket,object\n"
+		       "b,o1\n"
+		       "b,o2\n"
+		       "\n"
+		       "b,o3\n"
+		       "b,o4\n"
+		       "b,o5\n");
+	return path;
+}
+
+void
+ShardDirectoryTest::TestCreateShards()
+{
+	QTemporaryDir tmp;
+	QString shardsPath = tmp.path() + "/shards";
+	QString error;
+	int numShards = ShardDirectory::CreateShards(CreateManifest(tmp),
+						     shardsPath, 2, &error);
+	QCOMPARE(numShards, 3);
+
+	QStringList pending = QDir(shardsPath + "/pending").entryList(QDir::Files,
+								      QDir::Name);
+	QCOMPARE(pending, QStringList() << "000001.csv" << "000002.csv"
+					<< "000003.csv");
+	QFile last(shardsPath + "/pending/000003.csv");
+	last.open(QIODevice::ReadOnly | QIODevice::Text);
+	QCOMPARE(last.readAll(), QByteArray("b,o5\n"));
+
+	// Shards aren't added to a directory already in use
+	QCOMPARE(ShardDirectory::CreateShards(CreateManifest(tmp), shardsPath,
+					      2, &error), -1);
+}
+
+void
+ShardDirectoryTest::TestLeaseAndReclaim()
+{
+	QTemporaryDir tmp;
+	QString shardsPath = tmp.path() + "/shards";
+	QString error;
+	ShardDirectory::CreateShards(CreateManifest(tmp), shardsPath, 3, &error);
+
+	ShardDirectory worker1(shardsPath, "worker1");
+	ShardDirectory worker2(shardsPath, "worker2");
+	QString shard1, shard2, shard3;
+	QVERIFY(worker1.Lease(&shard1));
+	QVERIFY(worker2.Lease(&shard2));
+	QVERIFY(shard1 != shard2);
+	QVERIFY(!worker2.Lease(&shard3));
+	QVERIFY(!worker1.IsFinished());
+
+	QVERIFY(worker2.Renew(shard2));
+	QVERIFY(worker2.Complete(shard2));
+
+	// worker1's lease expires (e.g. it crashed) so worker2 takes over
+	worker2.SetLeaseTime(-60 * 1000);
+	QVERIFY(worker2.Lease(&shard3));
+	QCOMPARE(QFileInfo(shard3).fileName(), QFileInfo(shard1).fileName());
+	QVERIFY(!worker1.Renew(shard1));
+	QVERIFY(!worker1.Complete(shard1));
+
+	QVERIFY(worker2.Complete(shard3));
+	QVERIFY(worker1.IsFinished());
+}
+
+// A canceled shard goes back to pending instead of done
+void
+ShardDirectoryTest::TestRelease()
+{
+	QTemporaryDir tmp;
+	QString shardsPath = tmp.path() + "/shards";
+	QString error;
+	ShardDirectory::CreateShards(CreateManifest(tmp), shardsPath, 5, &error);
+
+	ShardDirectory worker1(shardsPath, "worker1");
+	ShardDirectory worker2(shardsPath, "worker2");
+	QString shard1, shard2;
+	QVERIFY(worker1.Lease(&shard1));
+	QVERIFY(worker1.Release(shard1));
+	QVERIFY(!QFile::exists(shard1 + ".lease"));
+	QVERIFY(QDir(shardsPath + "/done").entryList(QDir::Files).isEmpty());
+	QVERIFY(!worker1.IsFinished());
+
+	// Another worker can run it
+	QVERIFY(worker2.Lease(&shard2));
+	QCOMPARE(QFileInfo(shard2).fileName(), QFileInfo(shard1).fileName());
+	// Once it's been taken, it can't be released again
+	QVERIFY(!worker1.Release(shard1));
+	QVERIFY(worker2.Complete(shard2));
+	QVERIFY(worker2.IsFinished());
+}
@@ -0,0 +1,64 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include "lib/stream_manifest_test.h"
+#include "lib/stream_manifest.h"
+
+static StreamManifestTest instance;
+
+void
+StreamManifestTest::TestRoundTrip()
+{
+	StreamManifest manifest;
+	manifest.AppendPart(64);
+	manifest.AppendPart(64);
+	manifest.AppendPart(5);
+	QCOMPARE(manifest.GetSize(), uint64_t(133));
+
+	QByteArray data = manifest.ToByteArray();
+	QCOMPARE(data, QByteArray("ds3-stream-manifest 1\n64\n64\n5\n"));
+
+	StreamManifest parsed;
+	QString error;
+	QVERIFY(parsed.Parse(data, &error));
+	QCOMPARE(parsed.GetNumParts(), 3);
+	QCOMPARE(parsed.GetPartSize(2), uint64_t(5));
+	QCOMPARE(parsed.GetSize(), uint64_t(133));
+
+	// An empty stream has no parts
+	QVERIFY(parsed.Parse(StreamManifest().ToByteArray(), &error));
+	QCOMPARE(parsed.GetNumParts(), 0);
+}
+
+void
+StreamManifestTest::TestPartNames()
+{
+	QCOMPARE(StreamManifest::GetPartName("dumps/db.sql", 0),
+		 QString("dumps/db.sql.parts/00000000"));
+	QCOMPARE(StreamManifest::GetPartName("dumps/db.sql", 123),
+		 QString("dumps/db.sql.parts/00000123"));
+}
+
+void
+StreamManifestTest::TestInvalid()
+{
+	StreamManifest manifest;
+	QString error;
+	QVERIFY(!manifest.Parse("not a manifest\n1\n", &error));
+	QVERIFY(!error.isEmpty());
+	QVERIFY(!manifest.Parse("ds3-stream-manifest 1\n12\nabc\n", &error));
+	QCOMPARE(manifest.GetNumParts(), 0);
+}
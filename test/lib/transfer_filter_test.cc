@@ -0,0 +1,122 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QBuffer>
+
+#include "lib/transfer_filter_test.h"
+#include "lib/transfer_filter.h"
+
+static TransferFilterTest instance;
+
+void
+TransferFilterTest::TestGlobs()
+{
+	QCOMPARE(TransferFilter::GlobToRegex("*.dpx"), QString("^[^/]*\\.dpx$"));
+	QCOMPARE(TransferFilter::GlobToRegex("a?[!0-9]"), QString("^a[^/][^0-9]$"));
+	QCOMPARE(TransferFilter::GlobToRegex("a["), QString("^a\\[$"));
+
+	TransferFilter filter;
+	QVERIFY(filter.IsEmpty());
+	QVERIFY(filter.Accepts("anything", 0, QDateTime()));
+	filter.AddInclude("*.dpx");
+	filter.AddInclude("renders/*.exr");
+	QVERIFY(!filter.IsEmpty());
+	QVERIFY(filter.Accepts("reel1/frame0001.dpx", 10, QDateTime()));
+	QVERIFY(!filter.Accepts("reel1/frame0001.dpx.tmp", 10, QDateTime()));
+	QVERIFY(filter.Accepts("renders/a.exr", 10, QDateTime()));
+	QVERIFY(!filter.Accepts("reel1/renders/a.exr", 10, QDateTime()));
+	// Folders can't be judged by include rules
+	QVERIFY(!filter.AcceptsFolder("reel1/"));
+
+	QString error;
+	QVERIFY(filter.AddIncludeRegex("^shot_[0-9]+/", &error));
+	QVERIFY(filter.Accepts("shot_12/notes.txt", 10, QDateTime()));
+	QVERIFY(!filter.AddIncludeRegex("(", &error));
+	QVERIFY(!error.isEmpty());
+}
+
+void
+TransferFilterTest::TestExcludedFolders()
+{
+	TransferFilter filter;
+	filter.AddExclude(".git");
+	filter.AddExclude("*.tmp");
+	filter.AddExclude("build/cache");
+	QVERIFY(!filter.HasFileRules());
+	QVERIFY(filter.Accepts("src/main.cc", 10, QDateTime()));
+	QVERIFY(!filter.Accepts(".git/config", 10, QDateTime()));
+	QVERIFY(!filter.Accepts("lib/.git/objects/ab/cd", 10, QDateTime()));
+	QVERIFY(!filter.Accepts("lib/scratch.tmp", 10, QDateTime()));
+	QVERIFY(!filter.Accepts("build/cache/a.o", 10, QDateTime()));
+	QVERIFY(filter.Accepts("lib/build/cache/a.o", 10, QDateTime()));
+	QVERIFY(filter.AcceptsFolder("lib/"));
+	QVERIFY(!filter.AcceptsFolder("lib/.git/"));
+
+	QString error;
+	QVERIFY(filter.AddExcludeRegex("/~[^/]*$", &error));
+	QVERIFY(!filter.Accepts("docs/~lock.doc", 10, QDateTime()));
+	QVERIFY(filter.Accepts("docs/lock.doc", 10, QDateTime()));
+}
+
+void
+TransferFilterTest::TestSizeAndTime()
+{
+	QDateTime start(QDate(2024, 1, 1), QTime(0, 0), Qt::UTC);
+	QDateTime end(QDate(2024, 2, 1), QTime(0, 0), Qt::UTC);
+	TransferFilter filter;
+	filter.SetMinSize(100);
+	filter.SetMaxSize(200);
+	filter.SetModifiedAfter(start);
+	filter.SetModifiedBefore(end);
+	QVERIFY(filter.HasFileRules());
+	QVERIFY(filter.Accepts("a", 100, start));
+	QVERIFY(filter.Accepts("a", 200, end.addSecs(-1)));
+	QVERIFY(!filter.Accepts("a", 99, start));
+	QVERIFY(!filter.Accepts("a", 201, start));
+	QVERIFY(!filter.Accepts("a", 150, start.addSecs(-1)));
+	QVERIFY(!filter.Accepts("a", 150, end));
+	// An unknown modification time isn't held against the file
+	QVERIFY(filter.Accepts("a", 150, QDateTime()));
+}
+
+void
+TransferFilterTest::TestSerialization()
+{
+	TransferFilter filter;
+	QString error;
+	filter.AddInclude("*.dpx");
+	filter.AddExclude(".DS_Store");
+	QVERIFY(filter.AddExcludeRegex("\\.tmp$", &error));
+	filter.SetMinSize(1);
+	filter.SetModifiedAfter(QDateTime(QDate(2024, 1, 1), QTime(0, 0), Qt::UTC));
+
+	QByteArray data;
+	QBuffer buffer(&data);
+	buffer.open(QIODevice::WriteOnly);
+	QDataStream out(&buffer);
+	out << filter;
+	buffer.close();
+
+	TransferFilter copy;
+	buffer.open(QIODevice::ReadOnly);
+	QDataStream in(&buffer);
+	in >> copy;
+	QCOMPARE(copy.ToString(), filter.ToString());
+	QVERIFY(copy.Accepts("a.dpx", 1, QDateTime()));
+	QVERIFY(!copy.Accepts("a.dpx.tmp", 1, QDateTime()));
+	QVERIFY(!copy.Accepts(".DS_Store", 1, QDateTime()));
+	QVERIFY(!copy.Accepts("a.dpx", 0, QDateTime()));
+}
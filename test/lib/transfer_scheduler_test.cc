@@ -0,0 +1,270 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+
+#include "lib/transfer_scheduler_test.h"
+#include "lib/transfer_scheduler.h"
+#include "lib/work_items/delete_work_item.h"
+
+static TransferSchedulerTest instance;
+
+// Records admitted jobs instead of starting them.  Clients are only used
+// to tell flows apart so the tests use made up pointers for them.
+class TestScheduler : public TransferScheduler
+{
+public:
+	TestScheduler(int maxActiveJobs, int maxActiveJobsPerHost)
+	{
+		SetLimits(maxActiveJobs, maxActiveJobsPerHost);
+	}
+
+	QList<BulkWorkItem*> started;
+
+protected:
+	void StartJob(Client* /*client*/, BulkWorkItem* workItem)
+	{
+		started << workItem;
+	}
+};
+
+static Client* const CLIENT_1 = reinterpret_cast<Client*>(1);
+static Client* const CLIENT_2 = reinterpret_cast<Client*>(2);
+static Client* const CLIENT_3 = reinterpret_cast<Client*>(3);
+
+// Runs on a pool thread until the job gets a transfer slot
+static void
+WaitForTransferSlot(TransferScheduler* scheduler, Client* client,
+		    BulkWorkItem* workItem, QList<BulkWorkItem*>* granted,
+		    QMutex* grantedLock)
+{
+	while (!scheduler->AcquireTransferSlot(client, workItem, 50)) {
+	}
+	grantedLock->lock();
+	*granted << workItem;
+	grantedLock->unlock();
+}
+
+// Wait up to a few seconds for a condition another thread will make true
+static bool
+WaitFor(TransferScheduler* scheduler, int waiting,
+	const QList<BulkWorkItem*>* granted, QMutex* grantedLock, int numGranted)
+{
+	QElapsedTimer timer;
+	timer.start();
+	while (timer.elapsed() < 5000) {
+		grantedLock->lock();
+		bool done = granted->size() == numGranted;
+		grantedLock->unlock();
+		if (done && scheduler->GetNumWaitingForTransferSlots() == waiting) {
+			return true;
+		}
+		QThread::msleep(5);
+	}
+	return false;
+}
+
+static BulkWorkItem*
+CreateJob(QList<BulkWorkItem*>& jobs, const QString& host,
+	  TransferScheduler::Priority priority = TransferScheduler::NORMAL)
+{
+	BulkWorkItem* workItem = new DeleteWorkItem(host, QList<QUrl>(), false);
+	workItem->SetPriority(priority);
+	jobs << workItem;
+	return workItem;
+}
+
+void
+TransferSchedulerTest::TestLimits()
+{
+	QList<BulkWorkItem*> jobs;
+	TestScheduler scheduler(2, 1);
+	BulkWorkItem* a1 = CreateJob(jobs, "a");
+	BulkWorkItem* a2 = CreateJob(jobs, "a");
+	BulkWorkItem* a3 = CreateJob(jobs, "a");
+	BulkWorkItem* b1 = CreateJob(jobs, "b");
+	scheduler.Submit(CLIENT_1, a1);
+	scheduler.Submit(CLIENT_1, a2);
+	scheduler.Submit(CLIENT_1, a3);
+	scheduler.Submit(CLIENT_1, b1);
+	QCOMPARE(scheduler.started, QList<BulkWorkItem*>() << a1 << b1);
+	QCOMPARE(scheduler.GetNumActive(), 2);
+	QCOMPARE(scheduler.GetNumQueued(), 2);
+
+	// A queued job is dequeued rather than freeing a slot
+	scheduler.Release(a3);
+	QCOMPARE(scheduler.GetNumQueued(), 1);
+	QCOMPARE(scheduler.GetNumActive(), 2);
+
+	scheduler.Release(a1);
+	QCOMPARE(scheduler.started.last(), a2);
+	QCOMPARE(scheduler.GetNumQueued(), 0);
+	qDeleteAll(jobs);
+}
+
+void
+TransferSchedulerTest::TestFairShare()
+{
+	QList<BulkWorkItem*> jobs;
+	TestScheduler scheduler(1, 1);
+	BulkWorkItem* first = CreateJob(jobs, "a");
+	scheduler.Submit(CLIENT_1, first);
+
+	// The first client queuing up more jobs doesn't starve the second
+	BulkWorkItem* c1a = CreateJob(jobs, "a");
+	BulkWorkItem* c1b = CreateJob(jobs, "a");
+	BulkWorkItem* c1c = CreateJob(jobs, "a");
+	BulkWorkItem* c2a = CreateJob(jobs, "a");
+	BulkWorkItem* c2b = CreateJob(jobs, "a");
+	scheduler.Submit(CLIENT_1, c1a);
+	scheduler.Submit(CLIENT_1, c1b);
+	scheduler.Submit(CLIENT_1, c1c);
+	scheduler.Submit(CLIENT_2, c2a);
+	scheduler.Submit(CLIENT_2, c2b);
+
+	for (int i = 0; i < 5; i++) {
+		scheduler.Release(scheduler.started.last());
+	}
+	QCOMPARE(scheduler.started, QList<BulkWorkItem*>() << first << c1a
+		 << c2a << c1b << c2b << c1c);
+	qDeleteAll(jobs);
+}
+
+void
+TransferSchedulerTest::TestPriority()
+{
+	QList<BulkWorkItem*> jobs;
+	TestScheduler scheduler(1, 1);
+	BulkWorkItem* first = CreateJob(jobs, "a");
+	scheduler.Submit(CLIENT_1, first);
+
+	// HIGH jobs cost a quarter of a LOW job's share
+	BulkWorkItem* low = CreateJob(jobs, "a", TransferScheduler::LOW);
+	BulkWorkItem* high1 = CreateJob(jobs, "a", TransferScheduler::HIGH);
+	BulkWorkItem* high2 = CreateJob(jobs, "a", TransferScheduler::HIGH);
+	BulkWorkItem* high3 = CreateJob(jobs, "a", TransferScheduler::HIGH);
+	scheduler.Submit(CLIENT_2, low);
+	scheduler.Submit(CLIENT_3, high1);
+	scheduler.Submit(CLIENT_3, high2);
+	scheduler.Submit(CLIENT_3, high3);
+
+	for (int i = 0; i < 4; i++) {
+		scheduler.Release(scheduler.started.last());
+	}
+	QCOMPARE(scheduler.started, QList<BulkWorkItem*>() << first << high1
+		 << high2 << high3 << low);
+	qDeleteAll(jobs);
+}
+
+void
+TransferSchedulerTest::TestVirtualTimeNeverDecreases()
+{
+	QList<BulkWorkItem*> jobs;
+	TestScheduler scheduler(2, 1);
+	BulkWorkItem* a1 = CreateJob(jobs, "a");
+	BulkWorkItem* a2 = CreateJob(jobs, "a");
+	BulkWorkItem* b1 = CreateJob(jobs, "b");
+	// a1 (finish tag 1) and b1 (3) are admitted while a2 (2) waits for
+	// host a
+	scheduler.Submit(CLIENT_1, a1);
+	scheduler.Submit(CLIENT_1, a2);
+	scheduler.Submit(CLIENT_1, b1);
+	QCOMPARE(scheduler.started, QList<BulkWorkItem*>() << a1 << b1);
+	// a2 is admitted after b1 even though its tag is lower
+	scheduler.Release(a1);
+	QCOMPARE(scheduler.started.last(), a2);
+
+	// Both are tagged 4.  Had virtual time gone back to 2 when a2 was
+	// admitted, the new client's job would have been tagged 3 and cut
+	// ahead of the one queued first.
+	BulkWorkItem* c1 = CreateJob(jobs, "c");
+	BulkWorkItem* c2 = CreateJob(jobs, "c");
+	scheduler.Submit(CLIENT_1, c1);
+	scheduler.Submit(CLIENT_2, c2);
+	scheduler.Release(b1);
+	QCOMPARE(scheduler.started.last(), c1);
+	qDeleteAll(jobs);
+}
+
+void
+TransferSchedulerTest::TestRemoveClient()
+{
+	QList<BulkWorkItem*> jobs;
+	TestScheduler scheduler(2, 2);
+	BulkWorkItem* c1a = CreateJob(jobs, "a");
+	BulkWorkItem* c1b = CreateJob(jobs, "a");
+	BulkWorkItem* c2a = CreateJob(jobs, "a");
+	scheduler.Submit(CLIENT_1, c1a);
+	scheduler.Submit(CLIENT_1, c1b);
+	scheduler.Submit(CLIENT_2, c2a);
+	QCOMPARE(scheduler.GetNumActive(), 2);
+	QCOMPARE(scheduler.GetNumQueued(), 1);
+
+	// A client that goes away mid job gives its slots back
+	scheduler.RemoveClient(CLIENT_1);
+	QCOMPARE(scheduler.started.last(), c2a);
+	QCOMPARE(scheduler.GetNumActive(), 1);
+	QCOMPARE(scheduler.GetNumQueued(), 0);
+	qDeleteAll(jobs);
+}
+
+void
+TransferSchedulerTest::TestTransferSlotsFairShare()
+{
+	QList<BulkWorkItem*> jobs;
+	TestScheduler scheduler(4, 4);
+	scheduler.SetMaxTransferSlots(1);
+	BulkWorkItem* big = CreateJob(jobs, "a");
+	BulkWorkItem* small = CreateJob(jobs, "a");
+	QVERIFY(scheduler.AcquireTransferSlot(CLIENT_1, big, 0));
+	QVERIFY(!scheduler.AcquireTransferSlot(CLIENT_2, small, 0));
+
+	// The first client's job wants three more slots before the second
+	// client's job asks for one
+	QThreadPool pool;
+	pool.setMaxThreadCount(4);
+	QList<BulkWorkItem*> granted;
+	QMutex grantedLock;
+	QList<BulkWorkItem*> order;
+	order << big << big << big << small;
+	QList<Client*> clients;
+	clients << CLIENT_1 << CLIENT_1 << CLIENT_1 << CLIENT_2;
+	for (int i = 0; i < order.size(); i++) {
+		QtConcurrent::run(&pool, WaitForTransferSlot,
+				  static_cast<TransferScheduler*>(&scheduler),
+				  clients.at(i), order.at(i), &granted,
+				  &grantedLock);
+		QVERIFY(WaitFor(&scheduler, i + 1, &granted, &grantedLock, 0));
+	}
+
+	// The second client isn't starved by the first client's big job
+	for (int i = 0; i < order.size(); i++) {
+		scheduler.ReleaseTransferSlot();
+		QVERIFY(WaitFor(&scheduler, order.size() - i - 1, &granted,
+				&grantedLock, i + 1));
+	}
+	pool.waitForDone();
+	QCOMPARE(granted, QList<BulkWorkItem*>() << small << big << big << big);
+	QCOMPARE(scheduler.GetNumTransferSlotsInUse(), 1);
+	scheduler.ReleaseTransferSlot();
+	qDeleteAll(jobs);
+}
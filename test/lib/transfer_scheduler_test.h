@@ -0,0 +1,35 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#ifndef TRANSFER_SCHEDULER_TEST_H
+#define TRANSFER_SCHEDULER_TEST_H
+
+#include "test.h"
+
+class TransferSchedulerTest : public Test
+{
+	Q_OBJECT
+
+private slots:
+	void TestLimits();
+	void TestFairShare();
+	void TestPriority();
+	void TestVirtualTimeNeverDecreases();
+	void TestRemoveClient();
+	void TestTransferSlotsFairShare();
+};
+
+#endif
@@ -0,0 +1,95 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include "lib/work_items/delete_work_item_test.h"
+#include "lib/work_items/delete_work_item.h"
+
+static DeleteWorkItemTest instance;
+
+static QList<QUrl>
+FolderURLs()
+{
+	QList<QUrl> urls;
+	urls << QUrl("ds3://host/bucket/a/") << QUrl("ds3://host/bucket/b/");
+	return urls;
+}
+
+void
+DeleteWorkItemTest::TestBatches()
+{
+	DeleteWorkItem workItem("host", FolderURLs(), true);
+	QVERIFY(workItem.IsBatchEmpty());
+	for (int i = 0; i < DeleteWorkItem::BATCH_SIZE - 1; i++) {
+		QVERIFY(!workItem.AddToBatch("a/" + QString::number(i), 2));
+	}
+	QVERIFY(workItem.AddToBatch("a/last", 2));
+
+	uint64_t size = 0;
+	QStringList batch = workItem.TakeBatch(&size);
+	QCOMPARE(batch.size(), DeleteWorkItem::BATCH_SIZE);
+	QCOMPARE(batch.first(), QString("a/0"));
+	QCOMPARE(batch.last(), QString("a/last"));
+	QCOMPARE(size, (uint64_t)DeleteWorkItem::BATCH_SIZE * 2);
+	QVERIFY(workItem.IsBatchEmpty());
+
+	// The next batch starts from nothing
+	QVERIFY(!workItem.AddToBatch("b/0", 5));
+	batch = workItem.TakeBatch(&size);
+	QCOMPARE(batch, QStringList() << "b/0");
+	QCOMPARE(size, (uint64_t)5);
+}
+
+void
+DeleteWorkItemTest::TestListingFailed()
+{
+	DeleteWorkItem workItem("host", FolderURLs(), true);
+	QCOMPARE(workItem.GetType(), Job::DELETE_OBJECTS);
+	QVERIFY(workItem.ShouldDeleteBucket());
+	workItem.SetState(Job::INPROGRESS);
+	workItem.AddListedSize(10);
+	workItem.AddListedSize(20);
+	QCOMPARE(workItem.GetSize(), (uint64_t)30);
+
+	workItem.MarkListingFailed();
+	// The job carries on with the other folders but fails, and the bucket
+	// that still has objects in it is kept
+	QVERIFY(!workItem.WasCanceled());
+	QVERIFY(!workItem.ShouldDeleteBucket());
+	QCOMPARE(workItem.GetNumFailedObjects(), (uint64_t)1);
+
+	QList<QUrl>::const_iterator& ui(workItem.GetUrlsIterator());
+	QVERIFY(!workItem.IsFinished());
+	while (ui != workItem.GetUrlsConstEnd()) {
+		ui++;
+	}
+	QVERIFY(workItem.IsFinished());
+	workItem.SetState(Job::FINISHED);
+	Job job = workItem.ToJob();
+	QCOMPARE(job.GetState(), Job::FINISHED);
+	QCOMPARE(job.GetNumFailedObjects(), (uint64_t)1);
+}
+
+void
+DeleteWorkItemTest::TestCanceled()
+{
+	DeleteWorkItem workItem("host", FolderURLs(), false);
+	QVERIFY(!workItem.ShouldDeleteBucket());
+	workItem.SetState(Job::INPROGRESS);
+	QVERIFY(!workItem.WasCanceled());
+	workItem.SetState(Job::CANCELING);
+	QVERIFY(workItem.WasCanceled());
+	QCOMPARE(workItem.GetNumFailedObjects(), (uint64_t)0);
+}
@@ -0,0 +1,174 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QList>
+#include <QVector>
+
+#include "models/browser_node_store_test.h"
+#include "models/browser_node_store.h"
+
+static BrowserNodeStoreTest instance;
+
+void
+BrowserNodeStoreTest::TestAppend()
+{
+	BrowserNodeStore nodes;
+	BrowserNodeStore::ID bucket = nodes.Append(BrowserNodeStore::ROOT,
+						   BrowserNodeStore::BUCKET,
+						   "b", "b", "", "owner");
+	BrowserNodeStore::ID folder = nodes.Append(bucket,
+						   BrowserNodeStore::FOLDER,
+						   "f", "b", "", "owner");
+	BrowserNodeStore::ID object = nodes.Append(folder,
+						   BrowserNodeStore::OBJECT,
+						   "o", "b", "f/", "owner",
+						   10, 1000);
+
+	QCOMPARE(nodes.GetNumNodes(), 4);
+	QCOMPARE(nodes.GetChildCount(BrowserNodeStore::ROOT), 1);
+	QCOMPARE(nodes.GetChild(BrowserNodeStore::ROOT, 0), bucket);
+	QCOMPARE(nodes.GetChild(BrowserNodeStore::ROOT, 1), BrowserNodeStore::INVALID);
+	QCOMPARE(nodes.GetParent(object), folder);
+	QCOMPARE(nodes.GetParent(folder), bucket);
+	QCOMPARE(nodes.GetRow(object), 0);
+	QCOMPARE(nodes.GetKind(object), BrowserNodeStore::OBJECT);
+	QCOMPARE(nodes.GetName(object), QString("o"));
+	QCOMPARE(nodes.GetBucketName(object), QString("b"));
+	QCOMPARE(nodes.GetPrefix(object), QString("f/"));
+	QCOMPARE(nodes.GetPrefix(folder), QString(""));
+	QCOMPARE(nodes.GetOwner(object), QString("owner"));
+	QCOMPARE(nodes.GetSize(object), (uint64_t)10);
+	QCOMPARE(nodes.GetSize(folder), BrowserNodeStore::NO_SIZE);
+	QCOMPARE(nodes.GetCreated(object), (qint64)1000);
+	QCOMPARE(nodes.GetCreated(folder), BrowserNodeStore::NO_TIME);
+	QVERIFY(nodes.IsBucketOrFolder(folder));
+	QVERIFY(!nodes.IsBucketOrFolder(object));
+	QVERIFY(nodes.GetCanFetchMore(object));
+}
+
+void
+BrowserNodeStoreTest::TestInsert()
+{
+	BrowserNodeStore nodes;
+	BrowserNodeStore::ID a = nodes.Append(BrowserNodeStore::ROOT,
+					      BrowserNodeStore::BUCKET, "a", "a");
+	BrowserNodeStore::ID c = nodes.Append(BrowserNodeStore::ROOT,
+					      BrowserNodeStore::BUCKET, "c", "c");
+	BrowserNodeStore::ID b = nodes.Insert(BrowserNodeStore::ROOT, 1,
+					      BrowserNodeStore::BUCKET, "b", "b");
+
+	QCOMPARE(nodes.GetChildCount(BrowserNodeStore::ROOT), 3);
+	QCOMPARE(nodes.GetChild(BrowserNodeStore::ROOT, 1), b);
+	QCOMPARE(nodes.GetRow(a), 0);
+	QCOMPARE(nodes.GetRow(b), 1);
+	QCOMPARE(nodes.GetRow(c), 2);
+	QCOMPARE(nodes.GetParent(b), BrowserNodeStore::ROOT);
+
+	// Out of range rows are clamped
+	BrowserNodeStore::ID d = nodes.Insert(BrowserNodeStore::ROOT, 10,
+					      BrowserNodeStore::BUCKET, "d", "d");
+	QCOMPARE(nodes.GetRow(d), 3);
+}
+
+void
+BrowserNodeStoreTest::TestInsertChildren()
+{
+	BrowserNodeStore nodes;
+	BrowserNodeStore::ID a = nodes.Append(BrowserNodeStore::ROOT,
+					      BrowserNodeStore::BUCKET, "a", "a");
+	BrowserNodeStore::ID d = nodes.Append(BrowserNodeStore::ROOT,
+					      BrowserNodeStore::BUCKET, "d", "d");
+	QVector<BrowserNodeStore::ID> run;
+	run << nodes.Create(BrowserNodeStore::BUCKET, "b", "b")
+	    << nodes.Create(BrowserNodeStore::BUCKET, "c", "c");
+	// Created nodes aren't anyone's children until they're inserted
+	QCOMPARE(nodes.GetParent(run.at(0)), BrowserNodeStore::INVALID);
+	QCOMPARE(nodes.GetChildCount(BrowserNodeStore::ROOT), 2);
+
+	nodes.InsertChildren(BrowserNodeStore::ROOT, 1, run);
+	QCOMPARE(nodes.GetChildCount(BrowserNodeStore::ROOT), 4);
+	QCOMPARE(nodes.GetChild(BrowserNodeStore::ROOT, 1), run.at(0));
+	QCOMPARE(nodes.GetChild(BrowserNodeStore::ROOT, 2), run.at(1));
+	QCOMPARE(nodes.GetParent(run.at(1)), BrowserNodeStore::ROOT);
+	QCOMPARE(nodes.GetRow(a), 0);
+	QCOMPARE(nodes.GetRow(run.at(0)), 1);
+	QCOMPARE(nodes.GetRow(run.at(1)), 2);
+	QCOMPARE(nodes.GetRow(d), 3);
+	QCOMPARE(nodes.GetName(run.at(1)), QString("c"));
+
+	// Nothing to insert changes nothing
+	nodes.InsertChildren(BrowserNodeStore::ROOT, 0,
+			     QVector<BrowserNodeStore::ID>());
+	QCOMPARE(nodes.GetChildCount(BrowserNodeStore::ROOT), 4);
+	QCOMPARE(nodes.GetRow(a), 0);
+}
+
+void
+BrowserNodeStoreTest::TestRemove()
+{
+	BrowserNodeStore nodes;
+	BrowserNodeStore::ID bucket = nodes.Append(BrowserNodeStore::ROOT,
+						   BrowserNodeStore::BUCKET,
+						   "b", "b");
+	QList<BrowserNodeStore::ID> objects;
+	for (int i = 0; i < 5; i++) {
+		objects << nodes.Append(bucket, BrowserNodeStore::OBJECT,
+					QString::number(i), "b");
+	}
+	nodes.Append(objects.at(1), BrowserNodeStore::OBJECT, "child", "b");
+	QCOMPARE(nodes.GetNumNodes(), 8);
+
+	nodes.Remove(bucket, 1, 2);
+	// Node 1's child is removed along with it
+	QCOMPARE(nodes.GetNumNodes(), 5);
+	QCOMPARE(nodes.GetChildCount(bucket), 3);
+	QCOMPARE(nodes.GetChild(bucket, 1), objects.at(3));
+	QCOMPARE(nodes.GetRow(objects.at(3)), 1);
+	QCOMPARE(nodes.GetRow(objects.at(4)), 2);
+
+	// Out of range removes are ignored
+	nodes.Remove(bucket, 2, 2);
+	QCOMPARE(nodes.GetChildCount(bucket), 3);
+
+	// Removed IDs are reused and come back with fresh state
+	BrowserNodeStore::ID reused = nodes.Append(bucket,
+						   BrowserNodeStore::FOLDER,
+						   "new", "b");
+	QCOMPARE(reused, objects.at(2));
+	QCOMPARE(nodes.GetKind(reused), BrowserNodeStore::FOLDER);
+	QCOMPARE(nodes.GetNumNodes(), 6);
+	QCOMPARE(nodes.GetChildCount(reused), 0);
+	QCOMPARE(nodes.GetRow(reused), 3);
+	QCOMPARE(nodes.GetNextMarker(reused), QString());
+}
+
+void
+BrowserNodeStoreTest::TestUpdate()
+{
+	BrowserNodeStore nodes;
+	BrowserNodeStore::ID object = nodes.Append(BrowserNodeStore::ROOT,
+						   BrowserNodeStore::OBJECT,
+						   "o", "b", "", "owner",
+						   10, 1000);
+	QVERIFY(!nodes.Update(object, "owner", 10, 1000));
+
+	QVERIFY(nodes.Update(object, "other", 20, 2000));
+	QCOMPARE(nodes.GetOwner(object), QString("other"));
+	QCOMPARE(nodes.GetSize(object), (uint64_t)20);
+	QCOMPARE(nodes.GetCreated(object), (qint64)2000);
+	QCOMPARE(nodes.GetName(object), QString("o"));
+	QCOMPARE(nodes.GetBucketName(object), QString("b"));
+}
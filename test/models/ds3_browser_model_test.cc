@@ -0,0 +1,104 @@
+/*
+ * *****************************************************************************
+ *   Copyright 2014-2015 Spectra Logic Corporation. All Rights Reserved.
+ *   Licensed under the Apache License, Version 2.0 (the "License"). You may not
+ *   use this file except in compliance with the License. A copy of the License
+ *   is located at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *   or in the "license" file accompanying this file.
+ *   This file is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+ *   CONDITIONS OF ANY KIND, either express or implied. See the License for the
+ *   specific language governing permissions and limitations under the License.
+ * *****************************************************************************
+ */
+
+#include <QList>
+
+#include "models/ds3_browser_model_test.h"
+#include "models/ds3_browser_model.h"
+#include "models/listing.h"
+
+static DS3BrowserModelTest instance;
+
+static BucketListing
+MakePage(const QString& nextMarker, bool truncated)
+{
+	BucketListing page;
+	page.SetNextMarker(nextMarker);
+	page.SetTruncated(truncated);
+	return page;
+}
+
+// A folder listed in three pages
+static QList<BucketListing>
+ThreePages()
+{
+	QList<BucketListing> pages;
+	pages << MakePage("f/b", true) << MakePage("f/d", true)
+	      << MakePage("", false);
+	return pages;
+}
+
+// Relist pages the way a refresh does until it's covered what was loaded
+// before.  Returns how many pages were relisted and sets the marker the
+// refresh finished with.
+static int
+Relist(const QList<BucketListing>& pages, const QString& stopMarker,
+       QString* nextMarker)
+{
+	int relisted = 0;
+	do {
+		*nextMarker = DS3BrowserModel::GetNextPageMarker(QString(),
+								 pages.at(relisted));
+		relisted++;
+	} while (relisted < pages.size() &&
+		 DS3BrowserModel::ShouldRefreshNextPage(*nextMarker, stopMarker));
+	return relisted;
+}
+
+void
+DS3BrowserModelTest::TestRefreshKeepsLastPage()
+{
+	QList<BucketListing> pages = ThreePages();
+	QString marker;
+	for (int i = 0; i < pages.size(); i++) {
+		marker = DS3BrowserModel::GetNextPageMarker(marker, pages.at(i));
+	}
+	// The folder was paged to its end
+	QVERIFY(marker.isEmpty());
+
+	// Every page is relisted, not just up to the previous page's marker,
+	// so the last page's rows are seen and kept and no page break is
+	// added back
+	QString nextMarker;
+	QCOMPARE(Relist(pages, marker, &nextMarker), 3);
+	QVERIFY(nextMarker.isEmpty());
+}
+
+void
+DS3BrowserModelTest::TestRefreshStopsAtLoadedPages()
+{
+	QList<BucketListing> pages = ThreePages();
+	QString marker;
+	for (int i = 0; i < 2; i++) {
+		marker = DS3BrowserModel::GetNextPageMarker(marker, pages.at(i));
+	}
+	QCOMPARE(marker, QString("f/d"));
+
+	// Pages that were never loaded aren't listed by the refresh and the
+	// page break stays
+	QString nextMarker;
+	QCOMPARE(Relist(pages, marker, &nextMarker), 2);
+	QCOMPARE(nextMarker, QString("f/d"));
+}
+
+void
+DS3BrowserModelTest::TestTruncatedWithoutMarker()
+{
+	QCOMPARE(DS3BrowserModel::GetNextPageMarker("f/b", MakePage("", true)),
+		 QString("f/b"));
+	QCOMPARE(DS3BrowserModel::GetNextPageMarker("f/b", MakePage("f/x", false)),
+		 QString());
+}
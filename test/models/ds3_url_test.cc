@@ -82,3 +82,20 @@ DS3URLTest::TestIsBucketOrFolder()
 	QVERIFY(!DS3URL("http://host", "a/b").IsBucketOrFolder());
 	QVERIFY(DS3URL("http://host", "a/b/").IsBucketOrFolder());
 }
+
+void
+DS3URLTest::TestObjectSize()
+{
+	uint64_t size = 0;
+	QVERIFY(!DS3URL("http://host", "a/b").GetObjectSize(&size));
+
+	DS3URL url("http://host", "a/b?c=d");
+	url.SetObjectSize(1234);
+	QVERIFY(url.GetObjectSize(&size));
+	QCOMPARE(size, (uint64_t)1234);
+	QCOMPARE(url.GetObjectName(), QString("b?c=d"));
+
+	url.SetObjectSize(Q_UINT64_C(18446744073709551615));
+	QVERIFY(DS3URL(QUrl(url)).GetObjectSize(&size));
+	QCOMPARE(size, Q_UINT64_C(18446744073709551615));
+}
@@ -29,6 +29,7 @@ private slots:
 	void TestGetLastPathPart();
 	void TestIsBucket();
 	void TestIsBucketOrFolder();
+	void TestObjectSize();
 };
 
 #endif
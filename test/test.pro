@@ -29,12 +29,46 @@ UI_DIR = ui
 HEADERS += \
 	test.h \
 	helpers/number_helper_test.h \
+	helpers/time_helper_test.h \
+	lib/archive_writer_test.h \
+	lib/client_fast_path_test.h \
+	lib/concurrency_controller_test.h \
+	lib/folder_watcher_test.h \
+	lib/list_page_sizer_test.h \
+	lib/listing_cache_test.h \
+	lib/manifest_reader_test.h \
 	lib/mime_data_test.h \
+	lib/ring_buffer_test.h \
+	lib/shard_directory_test.h \
+	lib/stream_manifest_test.h \
+	lib/transfer_filter_test.h \
+	lib/transfer_scheduler_test.h \
+	lib/requests/listing_parser_test.h \
+	lib/work_items/delete_work_item_test.h \
+	models/browser_node_store_test.h \
+	models/ds3_browser_model_test.h \
 	models/ds3_url_test.h
 
 SOURCES += \
 	main.cc \
 	test.cc \
 	helpers/number_helper_test.cc \
+	helpers/time_helper_test.cc \
+	lib/archive_writer_test.cc \
+	lib/client_fast_path_test.cc \
+	lib/concurrency_controller_test.cc \
+	lib/folder_watcher_test.cc \
+	lib/list_page_sizer_test.cc \
+	lib/listing_cache_test.cc \
+	lib/manifest_reader_test.cc \
 	lib/mime_data_test.cc \
+	lib/ring_buffer_test.cc \
+	lib/shard_directory_test.cc \
+	lib/stream_manifest_test.cc \
+	lib/transfer_filter_test.cc \
+	lib/transfer_scheduler_test.cc \
+	lib/requests/listing_parser_test.cc \
+	lib/work_items/delete_work_item_test.cc \
+	models/browser_node_store_test.cc \
+	models/ds3_browser_model_test.cc \
 	models/ds3_url_test.cc